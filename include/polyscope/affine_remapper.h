@@ -40,6 +40,11 @@ template <typename T>
 std::pair<typename FIELD_MAG<T>::type, typename FIELD_MAG<T>::type>
 robustMinMax(const std::vector<T>& data, typename FIELD_MAG<T>::type rangeEPS = 1e-12);
 
+// Same as above, but starting from the min and max of the finite values, which have already been computed
+// (anyFinite should be false if there were no finite values)
+template <typename M>
+std::pair<M, M> robustMinMax(M minVal, M maxVal, bool anyFinite, M rangeEPS = 1e-12);
+
 
 // Map data in to the range [0,1]
 template <typename T>
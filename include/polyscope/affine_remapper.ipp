@@ -75,17 +75,24 @@ std::pair<typename FIELD_MAG<T>::type, typename FIELD_MAG<T>::type> robustMinMax
       anyFinite = true;
     }
   }
+
+  return robustMinMax(minVal, maxVal, anyFinite, rangeEPS);
+}
+
+template <typename M>
+std::pair<M, M> robustMinMax(M minVal, M maxVal, bool anyFinite, M rangeEPS) {
+
   if (!anyFinite) {
     return std::make_pair(-1.0, 1.0);
   }
-  typename FIELD_MAG<T>::type maxMag = std::max(std::abs(minVal), std::abs(maxVal));
+  M maxMag = std::max(std::abs(minVal), std::abs(maxVal));
 
   // Hack to do less ugly things when constants (or near-constant) are passed in
   if (maxMag < rangeEPS) {
     maxVal = rangeEPS;
     minVal = -rangeEPS;
   } else if ((maxVal - minVal) / maxMag < rangeEPS) {
-    typename FIELD_MAG<T>::type mid = (minVal + maxVal) / 2.0;
+    M mid = (minVal + maxVal) / 2.0;
     maxVal = mid + maxMag * rangeEPS;
     minVal = mid - maxMag * rangeEPS;
   }
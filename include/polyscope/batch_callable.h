@@ -0,0 +1,57 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/parallel.h"
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace polyscope {
+namespace detail {
+
+// Evaluate a batch callable func(const float* positions, float* results, size_t N) at the N points positionOf(i), in
+// chunks of at most chunkSize points. Query positions are generated per chunk, so that the only full-size array is the
+// result. If funcIsThreadSafe, chunks are evaluated in parallel (positionOf must then be safe to call concurrently).
+template <class PositionFunc, class Func>
+std::vector<double> sampleBatchCallable(size_t N, PositionFunc&& positionOf, Func&& func, bool funcIsThreadSafe,
+                                        size_t chunkSize) {
+
+  std::vector<double> result(N);
+
+  auto sampleRange = [&](size_t iStart, size_t iEnd) {
+    size_t rangeChunkSize = std::min(iEnd - iStart, chunkSize);
+    std::vector<float> queries(3 * rangeChunkSize);
+    std::vector<float> chunkResult(rangeChunkSize);
+
+    for (size_t iChunk = iStart; iChunk < iEnd; iChunk += rangeChunkSize) {
+      size_t nChunk = std::min(rangeChunkSize, iEnd - iChunk);
+      for (size_t j = 0; j < nChunk; j++) {
+        glm::vec3 pos = positionOf(iChunk + j);
+        queries[3 * j + 0] = pos.x;
+        queries[3 * j + 1] = pos.y;
+        queries[3 * j + 2] = pos.z;
+      }
+
+      func(&queries.front(), &chunkResult.front(), nChunk);
+
+      for (size_t j = 0; j < nChunk; j++) {
+        result[iChunk + j] = chunkResult[j];
+      }
+    }
+  };
+
+  if (funcIsThreadSafe) {
+    parallelForRanges(N, sampleRange, chunkSize);
+  } else if (N > 0) {
+    sampleRange(0, N);
+  }
+
+  return result;
+}
+
+} // namespace detail
+} // namespace polyscope
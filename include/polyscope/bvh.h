@@ -0,0 +1,85 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "polyscope/utilities.h"
+
+#include "glm/glm.hpp"
+
+namespace polyscope {
+
+// A bounding volume hierarchy over a set of primitives, each of which is represented only by its axis-aligned bounding
+// box. It is used for CPU-side spatial queries, such as finding the tets a slice plane passes through, or casting pick
+// rays against a structure. What the primitives are is up to the caller, who tests them with the callbacks passed to the
+// queries below.
+//
+// The queries only read the hierarchy, so several of them may run concurrently, as long as nothing builds or refits
+// it at the same time.
+class BVH {
+public:
+  // Maximum number of primitives in a leaf
+  static const uint32_t LEAF_SIZE = 8;
+
+  // Build the hierarchy over the given primitive boxes, each stored as {min, max}. Replaces any existing hierarchy.
+  void build(const std::vector<std::array<glm::vec3, 2>>& primBoxes);
+
+  // Update the existing hierarchy for new primitive boxes, without changing its structure. This is much cheaper than
+  // rebuilding, and suitable for deforming geometry, though queries get slower if the primitives move far from where
+  // they were when it was built. There must be the same number of primitives as when it was built.
+  void refit(const std::vector<std::array<glm::vec3, 2>>& primBoxes);
+
+  void clear();
+  bool empty() const;
+  size_t nPrimitives() const;
+
+  // Call primFunc(primInd) on the primitives in each leaf whose box passes boxTest(boxMin, boxMax). Subtrees whose box
+  // fails the test are skipped entirely.
+  template <class BoxTest, class PrimFunc>
+  void traverse(BoxTest&& boxTest, PrimFunc&& primFunc) const;
+
+  // Find the nearest primitive along the ray rayStart + t * rayDir, for t in [0, tMax). primHit(primInd, tCurr) tests
+  // one primitive, returning the t where the ray hits it, or any value >= tCurr (such as infinity) if it does not hit
+  // the primitive before the nearest hit found so far. Children are visited nearest-first, and subtrees beyond the
+  // nearest hit are skipped. Returns {primInd, t} for the nearest hit, or {INVALID_IND_64, tMax} if there is none.
+  template <class PrimHit>
+  std::pair<uint64_t, float> closestRayHit(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, PrimHit&& primHit) const;
+
+private:
+  // Nodes are stored depth-first, so the first child of an interior node immediately follows it
+  struct Node {
+    glm::vec3 boxMin;
+    glm::vec3 boxMax;
+    uint32_t start; // leaves: first entry in primOrder. interior nodes: index of the second child
+    uint32_t count; // leaves: number of primitives. interior nodes: 0
+  };
+  std::vector<Node> nodes;
+  std::vector<uint32_t> primOrder; // primitive indices, permuted so each leaf holds a contiguous range
+
+  void buildNode(const std::vector<std::array<glm::vec3, 2>>& primBoxes, uint32_t start, uint32_t count);
+
+  // Entry point of the ray in to the box, or infinity if it misses the box before tMax
+  static float rayBoxEntry(const Node& node, glm::vec3 rayStart, glm::vec3 invRayDir, float tMax);
+};
+
+
+// == Ray intersection helpers, for testing primitives in BVH::closestRayHit()
+// Each returns the ray parameter t of the first hit, or infinity if the ray misses. t may be negative, if the ray
+// starts inside the primitive or the primitive is behind the start.
+
+// Triangle, from either side. On a hit, baryCoord is set to the barycentric coordinates of the hit point.
+float rayTriangleIntersection(glm::vec3 rayStart, glm::vec3 rayDir, glm::vec3 pA, glm::vec3 pB, glm::vec3 pC,
+                              glm::vec3& baryCoord);
+
+float raySphereIntersection(glm::vec3 rayStart, glm::vec3 rayDir, glm::vec3 center, float radius);
+
+// Cylinder between pA and pB, not including the end caps (which are typically covered by spheres)
+float rayCylinderIntersection(glm::vec3 rayStart, glm::vec3 rayDir, glm::vec3 pA, glm::vec3 pB, float radius);
+
+} // namespace polyscope
+
+#include "polyscope/bvh.ipp"
@@ -0,0 +1,97 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <limits>
+
+namespace polyscope {
+
+template <class BoxTest, class PrimFunc>
+void BVH::traverse(BoxTest&& boxTest, PrimFunc&& primFunc) const {
+  if (nodes.empty()) return;
+
+  std::vector<uint32_t> nodeStack{0};
+  while (!nodeStack.empty()) {
+    uint32_t iNode = nodeStack.back();
+    nodeStack.pop_back();
+    const Node& node = nodes[iNode];
+
+    if (!boxTest(node.boxMin, node.boxMax)) continue;
+
+    if (node.count == 0) {
+      nodeStack.push_back(node.start);
+      nodeStack.push_back(iNode + 1);
+      continue;
+    }
+
+    for (uint32_t i = node.start; i < node.start + node.count; i++) {
+      primFunc(primOrder[i]);
+    }
+  }
+}
+
+template <class PrimHit>
+std::pair<uint64_t, float> BVH::closestRayHit(glm::vec3 rayStart, glm::vec3 rayDir, float tMax,
+                                              PrimHit&& primHit) const {
+
+  uint64_t hitPrim = INVALID_IND_64;
+  float hitT = tMax;
+  if (nodes.empty()) return {hitPrim, hitT};
+
+  // (divisions by zero give infinities, which the box test handles)
+  glm::vec3 invRayDir = 1.f / rayDir;
+
+  std::vector<uint32_t> nodeStack;
+  if (rayBoxEntry(nodes[0], rayStart, invRayDir, hitT) < hitT) nodeStack.push_back(0);
+
+  while (!nodeStack.empty()) {
+    uint32_t iNode = nodeStack.back();
+    nodeStack.pop_back();
+    const Node& node = nodes[iNode];
+
+    if (node.count == 0) {
+      // Push the farther child first, so the nearer one is visited next
+      uint32_t iChildA = iNode + 1;
+      uint32_t iChildB = node.start;
+      float tA = rayBoxEntry(nodes[iChildA], rayStart, invRayDir, hitT);
+      float tB = rayBoxEntry(nodes[iChildB], rayStart, invRayDir, hitT);
+      if (tA > tB) {
+        std::swap(iChildA, iChildB);
+        std::swap(tA, tB);
+      }
+      if (tB < hitT) nodeStack.push_back(iChildB);
+      if (tA < hitT) nodeStack.push_back(iChildA);
+      continue;
+    }
+
+    // The nearest hit may have gotten closer since this node was pushed
+    if (rayBoxEntry(node, rayStart, invRayDir, hitT) >= hitT) continue;
+
+    for (uint32_t i = node.start; i < node.start + node.count; i++) {
+      uint32_t iPrim = primOrder[i];
+      float t = primHit(iPrim, hitT);
+      if (t >= 0. && t < hitT) {
+        hitT = t;
+        hitPrim = iPrim;
+      }
+    }
+  }
+
+  return {hitPrim, hitT};
+}
+
+inline float BVH::rayBoxEntry(const Node& node, glm::vec3 rayStart, glm::vec3 invRayDir, float tMax) {
+  float tEnter = 0.;
+  float tExit = tMax;
+  for (int i = 0; i < 3; i++) {
+    float t0 = (node.boxMin[i] - rayStart[i]) * invRayDir[i];
+    float t1 = (node.boxMax[i] - rayStart[i]) * invRayDir[i];
+    // fmin/fmax drop the NaNs from a ray which lies exactly on a face of the box, parallel to it
+    tEnter = std::fmax(tEnter, std::fmin(t0, t1));
+    tExit = std::fmin(tExit, std::fmax(t0, t1));
+  }
+  if (tEnter > tExit) return std::numeric_limits<float>::infinity();
+  return tEnter;
+}
+
+} // namespace polyscope
@@ -22,4 +22,7 @@ glm::vec3 HSVtoRGB(glm::vec3 hsv);
 // Stateful helper to color things uniquely
 glm::vec3 getNextUniqueColor();
 
+// The index-th color of a sequence of distinct colors, without advancing the state above
+glm::vec3 getIndexedUniqueColor(size_t index);
+
 } // namespace polyscope
@@ -0,0 +1,41 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "polyscope/disjoint_sets.h"
+#include "polyscope/utilities.h"
+
+#include "glm/glm.hpp"
+
+namespace polyscope {
+
+// The connected components of a set of elements, such as the vertices of a mesh or the points of a point cloud.
+// Components are numbered by decreasing size, so component 0 is the largest. Ties are broken by the smallest element in
+// each component, so the numbering is deterministic.
+struct ConnectedComponents {
+  std::vector<size_t> labels; // the component of each element
+  std::vector<size_t> sizes;  // the number of elements in each component
+
+  size_t nComponents() const;
+
+  // Per-element visibility mask, true for elements in one of the maxCount largest components which also has at least
+  // minSize elements. For instance, mask(1, 1) keeps only the largest component, and mask(100) hides small debris.
+  std::vector<bool> mask(size_t minSize, size_t maxCount = INVALID_IND) const;
+
+  // The same, as 0/1 values which can be passed directly to a scalar quantity
+  std::vector<double> indicator(size_t minSize, size_t maxCount = INVALID_IND) const;
+
+  // A distinct color for each element's component
+  std::vector<glm::vec3> colors() const;
+};
+
+// Label the components of a disjoint set forest, once all merges are done
+ConnectedComponents labelConnectedComponents(ParallelDisjointSets& sets);
+
+// Components of a point set, where points are connected if they are within epsilon of each other
+ConnectedComponents computeEpsilonConnectedComponents(const std::vector<glm::vec3>& points, float epsilon);
+
+} // namespace polyscope
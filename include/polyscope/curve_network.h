@@ -3,7 +3,9 @@
 #pragma once
 
 #include "polyscope/affine_remapper.h"
+#include "polyscope/bvh.h"
 #include "polyscope/color_management.h"
+#include "polyscope/connected_components.h"
 #include "polyscope/curve_network_quantity.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
@@ -52,6 +54,10 @@ public:
   virtual void draw() override;
   virtual void drawDelayed() override;
   virtual void drawPick() override;
+  virtual void prepareRayCast() override;
+  virtual bool rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) override;
+  virtual void updateSelectionQuantities(const SelectionSet& selection) override;
+  virtual void gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes) override;
 
   virtual void updateObjectSpaceBounds() override;
   virtual std::string typeName() override;
@@ -69,6 +75,8 @@ public:
 
   // internally-computed geometry
   render::ManagedBuffer<glm::vec3> edgeCenters;
+  render::ManagedBuffer<uint32_t> polylineStripInds; // node indices along each polyline, separated by INVALID_IND_32
+  render::ManagedBuffer<uint32_t> polylineJointInds; // nodes which get a sphere when drawing polylines
 
   // === Quantities
 
@@ -100,6 +108,12 @@ public:
   CurveNetworkEdgeVectorQuantity* addEdgeVectorQuantity2D(std::string name, const T& vectors,
                                                           VectorType vectorType = VectorType::STANDARD);
 
+  // === Connected components
+  // Components of the nodes, connected by the edges
+  ConnectedComponents computeConnectedComponents();
+  // Show each component in a distinct color
+  CurveNetworkNodeColorQuantity* addConnectedComponentsQuantity(std::string name = "connected components");
+
 
   // === Members and utilities
 
@@ -117,6 +131,9 @@ public:
   void setCurveNetworkEdgeUniforms(render::ShaderProgram& p);
   void fillEdgeGeometryBuffers(render::ShaderProgram& program);
   void fillNodeGeometryBuffers(render::ShaderProgram& program);
+  bool usePolylineStrips(); // draw edges with fillPolylineStripGeometryBuffers(), nodes with the joint buffers
+  void fillPolylineStripGeometryBuffers(render::ShaderProgram& program);
+  void fillPolylineJointGeometryBuffers(render::ShaderProgram& program);
   std::vector<std::string> addCurveNetworkNodeRules(std::vector<std::string> initRules);
   std::vector<std::string> addCurveNetworkEdgeRules(std::vector<std::string> initRules);
 
@@ -149,6 +166,11 @@ public:
   CurveNetwork* setMaterial(std::string name);
   std::string getMaterial();
 
+  // Draw chains of degree-2 nodes as polyline strips which share the node positions, with spheres only at the nodes
+  // which need them (ends, junctions, and sharp bends). Not used while a variable radius quantity is set.
+  CurveNetwork* setPolylineStrips(bool newVal);
+  bool getPolylineStrips();
+
 
 private:
   // Storage for the managed buffers above. You should generally interact with these through the managed buffers, not
@@ -157,13 +179,21 @@ private:
   std::vector<uint32_t> edgeTailIndsData;
   std::vector<uint32_t> edgeTipIndsData;
   std::vector<glm::vec3> edgeCentersData;
+  std::vector<uint32_t> polylineStripIndsData;
+  std::vector<uint32_t> polylineJointIndsData;
+
+  // The edge drawn by each segment of the polyline strips, in draw order. Populated along with polylineStripInds.
+  std::vector<uint32_t> polylineStripEdgeInds;
 
   void computeEdgeCenters();
+  void computePolylineStripInds();
+  void computePolylineJointInds();
 
   // === Visualization parameters
   PersistentValue<glm::vec3> color;
   PersistentValue<ScaledValue<float>> radius;
   PersistentValue<std::string> material;
+  PersistentValue<bool> polylineStrips;
 
   // Drawing related things
   // if nullptr, prepare() (resp. preparePick()) needs to be called
@@ -171,6 +201,8 @@ private:
   std::shared_ptr<render::ShaderProgram> nodeProgram;
   std::shared_ptr<render::ShaderProgram> edgePickProgram;
   std::shared_ptr<render::ShaderProgram> nodePickProgram;
+  bool pickUsesPolylineStrips = false; // the pick programs above were built with polyline strips
+  size_t polylineEdgePickStart = 0;    // global pick index of the first polyline segment
 
   // === Helpers
 
@@ -199,6 +231,15 @@ private:
   std::string nodeRadiusQuantityName = ""; // empty string means none
   bool nodeRadiusQuantityAutoscale = true;
   CurveNetworkNodeScalarQuantity& resolveNodeRadiusQuantity(); // helper
+
+  // CPU ray casting, see prepareRayCast(). Primitives are the nodes (as spheres), followed by the edges (as cylinders).
+  BVH rayCastBVH;
+  std::vector<float> rayCastNodeRadii;           // in object space
+  std::vector<uint32_t> rayCastEdgeSegmentInds; // inverse of polylineStripEdgeInds, when picking uses polyline strips
+  uint64_t rayCastBVHPositionsVersion = 0;
+  std::string rayCastBVHRadiusQuantityName = "";
+  uint64_t rayCastBVHRadiusValuesVersion = 0;
+  float rayCastBVHRadiusScale = -1.;
 };
 
 
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <vector>
 
@@ -53,4 +54,28 @@ private:
   std::vector<bool> marked;
 };
 
+// A disjoint set forest which supports concurrent find() and merge() calls from many threads, without locks.
+//
+// Sets are linked by index: merging always points the root with the larger index at the one with the smaller index,
+// so the root of each set is its smallest element, and the forest can never form a cycle. find() compresses paths by
+// halving, using compare-and-swap so concurrent updates never lose a link.
+class ParallelDisjointSets {
+public:
+  // Constructor
+  ParallelDisjointSets(size_t n_);
+
+  // Find the root of the set containing element x, which is its smallest element (once all merges are done)
+  size_t find(size_t x);
+
+  // Union the sets containing x and y
+  void merge(size_t x, size_t y);
+
+  size_t size() const;
+
+private:
+  // Member variables
+  size_t n;
+  std::vector<std::atomic<size_t>> parent;
+};
+
 } // namespace polyscope
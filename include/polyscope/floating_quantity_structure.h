@@ -29,6 +29,8 @@ class FloatingQuantityStructure;
 class Quantity;
 class ScalarImageQuantity;
 class ColorImageQuantity;
+class StreamingScalarImageQuantity;
+class StreamingColorImageQuantity;
 
 
 class FloatingQuantityStructure : public QuantityStructure<FloatingQuantityStructure> {
@@ -81,6 +83,12 @@ template <class T>
 ColorImageQuantity* addColorAlphaImageQuantity(std::string name, size_t dimX, size_t dimY, const T& values_rgba,
                                                ImageOrigin imageOrigin);
 
+StreamingScalarImageQuantity* addStreamingScalarImageQuantity(std::string name, size_t dimX, size_t dimY,
+                                                              ImageOrigin imageOrigin,
+                                                              DataType type = DataType::STANDARD);
+
+StreamingColorImageQuantity* addStreamingColorImageQuantity(std::string name, size_t dimX, size_t dimY,
+                                                            ImageOrigin imageOrigin);
 
 template <class T1, class T2>
 DepthRenderImageQuantity* addDepthRenderImageQuantity(std::string name, size_t dimX, size_t dimY, const T1& depthData,
@@ -4,6 +4,8 @@
 
 #include "polyscope/render/color_maps.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/render/managed_buffer.h"
+#include "polyscope/weak_handle.h"
 
 #include <vector>
 
@@ -11,7 +13,7 @@
 namespace polyscope {
 
 // A histogram that shows up in ImGUI
-class Histogram {
+class Histogram : public virtual WeakReferrable {
 public:
   Histogram();                            // must call buildHistogram() with data after
   Histogram(std::vector<double>& values); // internally calls buildHistogram()
@@ -19,6 +21,15 @@ public:
   ~Histogram();
 
   void buildHistogram(const std::vector<double>& values);
+
+  // Build the histogram from `values` in a later frame as deferred work (see scheduler.h), or as soon as it is shown,
+  // whichever comes first. The histogram shows the contents of `values` as of the build. The pending build is dropped if
+  // the histogram is destroyed first, but nothing tracks `values`, so it must outlive the histogram.
+  // Unlike buildHistogram(), this leaves colormapRange as it is.
+  void buildHistogramDeferred(render::ManagedBuffer<double>& values);
+  bool hasPendingBuild() const { return pendingValues != nullptr; }
+  std::pair<double, double> getDataRange() const { return dataRange; } // of the values it was last built from
+
   void updateColormap(const std::string& newColormap);
 
   // Width = -1 means set automatically
@@ -30,6 +41,8 @@ private:
   // = Helpers
 
   // Manage the actual histogram
+  render::ManagedBuffer<double>* pendingValues = nullptr; // set while a deferred build is waiting
+  void finishPendingBuild();
   void fillBuffers();
   size_t rawHistBinCount = 51;
 
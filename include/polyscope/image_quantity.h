@@ -14,3 +14,4 @@
 #include "polyscope/raw_color_render_image_quantity.h"
 #include "polyscope/scalar_image_quantity.h"
 #include "polyscope/scalar_render_image_quantity.h"
+#include "polyscope/streaming_image_quantity.h"
@@ -0,0 +1,113 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace polyscope {
+
+// Pixel layouts which can be pushed in to an ImageStream. All are row-major, with no padding between rows.
+enum class ImageStreamFormat {
+  Float,     // 1 float per pixel (scalar streams only)
+  UInt16,    // 1 uint16_t per pixel, multiplied by the stream's value scale (scalar streams only)
+  RGBAFloat, // 4 floats per pixel (color streams only)
+  RGB8,      // 3 bytes per pixel (color streams only)
+  RGBA8,     // 4 bytes per pixel (color streams only)
+  NV12,      // 8-bit YUV 4:2:0, a Y plane followed by a half-resolution interleaved UV plane (color streams only)
+  I420,      // 8-bit YUV 4:2:0, a Y plane followed by half-resolution U and V planes (color streams only)
+};
+
+// A half-open pixel rectangle [x0, x1) x [y0, y1)
+struct ImageStreamRect {
+  size_t x0 = 0;
+  size_t y0 = 0;
+  size_t x1 = 0;
+  size_t y1 = 0;
+
+  bool isEmpty() const { return x0 >= x1 || y0 >= y1; }
+  size_t width() const { return isEmpty() ? 0 : x1 - x0; }
+  size_t height() const { return isEmpty() ? 0 : y1 - y0; }
+  void expand(const ImageStreamRect& other); // grow to the bounding box of this and other
+};
+
+// A thread-safe triple buffer of image frames, which backs the streaming image quantities.
+//
+// A producer pushes whole frames or sub-rectangles from any thread. Pixels are converted to floats on the producer
+// thread, then the frame is published to the render loop, which only ever consumes the most recent one. Frames which
+// are superseded before being drawn are dropped, but the regions they touched are carried forward, so sub-rectangle
+// updates are never lost. Neither side waits on the other beyond a brief lock to exchange buffer indices.
+//
+// Memory: one producer-side image plus three slots, each dimX*dimY*nChannels floats.
+class ImageStream {
+public:
+  // nChannels is 1 for scalar streams, 4 for (RGBA) color streams
+  ImageStream(size_t dimX, size_t dimY, size_t nChannels);
+
+  // == Producer side (any thread; concurrent pushes are serialized against each other, never against rendering)
+
+  // Push a full frame. The size of `data` is implied by the format and the stream dimensions.
+  void pushFrame(ImageStreamFormat format, const void* data);
+
+  // Push a [x0, x0+width) x [y0, y0+height) sub-rectangle, leaving other pixels as they were. For the YUV 4:2:0
+  // formats, all four arguments must be even.
+  void pushSubRect(ImageStreamFormat format, size_t x0, size_t y0, size_t width, size_t height, const void* data);
+
+  // Scale applied to UInt16 pixels (for instance 0.001 to map millimeter depths to meters)
+  void setValueScale(float newScale);
+  float getValueScale() const;
+
+  // == Consumer side (the render loop)
+
+  // If a frame has been published since the last call, make it current and return true.
+  bool acquireLatest();
+
+  // All pixels of the current frame, row-major with nChannels floats per pixel
+  const std::vector<float>& currentPixels() const;
+
+  // The region which differs between the current frame and the one acquired before it
+  ImageStreamRect currentChangedRect() const;
+
+  // == Info
+
+  size_t getDimX() const { return dimX; }
+  size_t getDimY() const { return dimY; }
+  size_t getNChannels() const { return nChannels; }
+  uint64_t getPushedFrameCount() const { return nPushed.load(); }
+  uint64_t getDroppedFrameCount() const { return nDropped.load(); } // published, but superseded before acquired
+  uint64_t getAcquiredFrameCount() const { return nAcquired.load(); }
+
+private:
+  const size_t dimX, dimY, nChannels;
+
+  struct Slot {
+    std::vector<float> pixels;
+    ImageStreamRect changedRect; // relative to the frame the consumer acquired before this one
+  };
+
+  // Producer-owned: the latest image, and for each slot the region where it is out of date relative to that image
+  std::mutex producerMutex;
+  std::vector<float> producerPixels;
+  std::array<ImageStreamRect, 3> slotStaleRects;
+  std::atomic<float> valueScale{1.f};
+
+  // The triple buffer. The producer owns slots[writeInd], the consumer owns slots[readInd], and the third is handed
+  // between them. Indices are only exchanged while holding swapMutex.
+  std::array<Slot, 3> slots;
+  size_t writeInd = 0;
+  size_t readyInd = 1;
+  size_t readInd = 2;
+  bool readyIsFresh = false;
+  std::mutex swapMutex;
+
+  std::atomic<uint64_t> nPushed{0}, nDropped{0}, nAcquired{0};
+
+  void convertToProducerPixels(ImageStreamFormat format, const ImageStreamRect& rect, const void* data);
+  void publish(const ImageStreamRect& rect);
+};
+
+} // namespace polyscope
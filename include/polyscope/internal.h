@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 
@@ -22,6 +24,18 @@ uint64_t getNextUniqueID();
 // track various fire-once warnings
 extern bool pointCloudEfficiencyWarningReported;
 
+// number of depth peeling passes actually rendered in the most recent frame, which may be fewer than requested
+extern int transparencyPeelPassesLastFrame;
+
+// incremented by every requestRedraw() (but not requestViewRedraw()), so that renders which depend only on the contents
+// of the scene can be cached across frames
+extern std::atomic<uint64_t> sceneContentVersion;
+
+// incremented only when something changes the shape of what is drawn (structure geometry & transforms, the enabled
+// structures & quantities, radii, slice planes...), so that renders which do not depend on colors or materials can be
+// cached across frames
+extern std::atomic<uint64_t> sceneGeometryVersion;
+
 // global members
 extern FloatingQuantityStructure* globalFloatingQuantityStructure;
 
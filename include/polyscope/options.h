@@ -31,6 +31,10 @@ extern bool errorsThrowExceptions;
 // Don't let the main loop run at more than this speed. (-1 disables) (default: 60)
 extern int maxFPS;
 
+// The most time per frame spent on deferred work, like building histograms. Less is used when the frame itself takes
+// most of the time allowed by maxFPS. See scheduler.h. (default: 4.)
+extern float frameWorkBudgetMs;
+
 // If enable or disable swap synchronization (limits render ray to display refresh rate). (default: true)
 // NOTE: some platforms may ignore the setting.
 extern bool enableVSync;
@@ -41,6 +45,9 @@ extern bool usePrefsFile;
 // Should we redraw every frame, even if not requested? (default: false)
 extern bool alwaysRedraw;
 
+// Record per-frame CPU/GPU timings and counters, and show the profiler window. See profiler.h (default: false)
+extern bool enableProfiler;
+
 // Should we center/scale every structure after it is loaded up (default: false)
 extern bool autocenterStructures;
 extern bool autoscaleStructures;
@@ -51,6 +58,10 @@ extern bool autoscaleStructures;
 // bounding box and length scale manually. (default: true)
 extern bool automaticallyComputeSceneExtents;
 
+// Maximum number of threads Polyscope may use internally to process large data arrays, e.g. when computing bounding
+// boxes. -1 means use all hardware threads. (default: -1)
+extern int maxParallelThreads;
+
 // If true, the user callback will be invoked for nested calls to polyscope::show(), otherwise not (default: false)
 extern bool invokeUserCallbackForNestedShow;
 
@@ -69,20 +80,59 @@ extern ScaledValue<float> groundPlaneHeightFactor;
 extern int shadowBlurIters;
 extern float shadowDarkness;
 
+// The ground plane renders its shadow and reflection once, and reuses them on later frames until the scene contents, the
+// ground plane settings, or the camera change. With temporal reuse enabled, a cached shadow is also reused while the
+// camera moves, reprojected on to the ground, and only re-rendered once the camera comes to rest. Shadows cast from
+// parts of the scene which were off-screen when the shadow was rendered appear after the camera stops (default: true)
+extern bool groundPlaneTemporalReuse;
+
 extern bool screenshotTransparency;     // controls whether screenshots taken by clicking the GUI button have a
                                         // transparent background
 extern std::string screenshotExtension; // sets the extension used for automatically-numbered screenshots (e.g. by
                                         // clicking the GUI button)
 
+// How pick queries (e.g. clicking on the scene) are answered
+// - Render: draw the scene in to a pick buffer, with each element in a unique color, and read back the pixel
+// - RayCast: cast a ray through the pixel and intersect it with the structures on the CPU, using a spatial index built
+//   for each structure on first use. Nothing is rendered, but only structures which support ray casting (surface
+//   meshes, point clouds, curve networks and volume meshes) can be picked. See pick::rayCast().
+// (default: Render)
+extern PickBackend pickBackend;
+
 // === Rendering parameters
 
 // SSAA scaling in pixel multiples
 extern int ssaaFactor;
 
+// Temporal anti-aliasing, a much cheaper alternative to SSAA. The camera is jittered by a sub-pixel offset each frame,
+// and frames are blended in to a history buffer. While the view is still, up to taaMaxSamples frames are averaged,
+// converging to a supersampled image. While it changes, the history is reprojected using the depth buffer, clamped to
+// the colors around each pixel to avoid ghosting, and blended with weight taaBlendFactor for the new frame.
+extern bool enableTAA;
+extern int taaMaxSamples;
+extern float taaBlendFactor;
+
 // Transparency settings for the renderer
+// - Simple: one pass, additive, ignores depth order entirely
+// - Pretty: depth peeling, exact up to transparencyRenderPasses layers, but draws the scene once per pass
+// - Weighted: weighted blended order-independent transparency. Opaque structures are drawn once as usual, and
+//   transparent structures once in to an accumulation buffer, so it costs about as much as a single pass of Pretty.
+//   Colors of overlapping layers are averaged with weights that favor near surfaces rather than sorted, so it is an
+//   approximation: the frontmost of several similar-alpha layers is less dominant than with peeling. Coverage is exact.
 extern TransparencyMode transparencyMode;
 extern int transparencyRenderPasses;
 
+// Depth peeling stops early once a pass peels nothing. While the camera is moving it also caps the passes to about this
+// many milliseconds of GPU time (as measured in earlier frames), then redraws at full quality when the camera comes to
+// rest. <= 0 disables the budget.
+extern float transparencyPeelTimeBudgetMs;
+
+// When the transparency mode changes, compile the new shader variants a few per frame while still drawing the old mode,
+// rather than stalling for all of them at once. Compilation stops for the frame once it has taken
+// shaderCompileBudgetMs.
+extern bool backgroundShaderCompile;
+extern float shaderCompileBudgetMs;
+
 // === Advanced ImGui configuration
 
 // If false, Polyscope will not create any ImGui UIs at all, but will still set up ImGui and invoke its render steps
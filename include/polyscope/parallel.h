@@ -0,0 +1,46 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <vector>
+
+namespace polyscope {
+
+// == Simple data-parallel helpers
+//
+// These are used internally to speed up loops over large data arrays, such as computing bounding boxes or data ranges.
+// Work is only split across threads when there is enough of it to be worthwhile; otherwise everything runs serially on
+// the calling thread. The number of threads used is capped by options::maxParallelThreads.
+//
+// The functions passed in may be invoked concurrently from several threads, so they must only write to disjoint data.
+// If any invocation throws, the exception is re-thrown on the calling thread after all work has finished.
+
+// Default minimum number of elements processed by each parallel task
+const size_t DEFAULT_PARALLEL_RANGE_SIZE = 1 << 15;
+
+// The number of threads that parallel work may use, according to options::maxParallelThreads
+size_t parallelThreadCount();
+
+// Split [0, N) in to contiguous [start, end) ranges, each of which is a unit of parallel work
+std::vector<std::tuple<size_t, size_t>> parallelRanges(size_t N, size_t minRangeSize = DEFAULT_PARALLEL_RANGE_SIZE);
+
+// Invoke func(iTask) for each iTask in [0, nTasks), potentially concurrently. Blocks until all tasks are done.
+void parallelInvoke(size_t nTasks, const std::function<void(size_t)>& func);
+
+// Invoke func(iStart, iEnd) for a set of disjoint ranges which cover [0, N), potentially concurrently
+void parallelForRanges(size_t N, const std::function<void(size_t, size_t)>& func,
+                       size_t minRangeSize = DEFAULT_PARALLEL_RANGE_SIZE);
+
+// Reduce over [0, N). reduceRange(iStart, iEnd) computes the value for one range, and combine(a, b) merges two partial
+// values, which always happens in order on the calling thread (so the result is deterministic).
+template <typename T>
+T parallelReduce(size_t N, T initVal, const std::function<T(size_t, size_t)>& reduceRange,
+                 const std::function<T(const T&, const T&)>& combine,
+                 size_t minRangeSize = DEFAULT_PARALLEL_RANGE_SIZE);
+
+} // namespace polyscope
+
+#include "polyscope/parallel.ipp"
@@ -0,0 +1,27 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+namespace polyscope {
+
+template <typename T>
+T parallelReduce(size_t N, T initVal, const std::function<T(size_t, size_t)>& reduceRange,
+                 const std::function<T(const T&, const T&)>& combine, size_t minRangeSize) {
+
+  std::vector<std::tuple<size_t, size_t>> ranges = parallelRanges(N, minRangeSize);
+
+  // Compute one partial result per range
+  std::vector<T> partials(ranges.size(), initVal);
+  parallelInvoke(ranges.size(), [&](size_t iRange) {
+    partials[iRange] = reduceRange(std::get<0>(ranges[iRange]), std::get<1>(ranges[iRange]));
+  });
+
+  // Merge them in order
+  T result = initVal;
+  for (const T& p : partials) {
+    result = combine(result, p);
+  }
+  return result;
+}
+
+} // namespace polyscope
@@ -2,10 +2,14 @@
 
 #pragma once
 
+#include "polyscope/selection_set.h"
 #include "polyscope/structure.h"
+#include "polyscope/types.h"
 
 #include <cstdint>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace polyscope {
 namespace pick {
@@ -19,10 +23,30 @@ size_t requestPickBufferRange(Structure* requestingStructure, size_t count);
 
 // == Main query
 // Get the structure which was clicked on (nullptr if none), and the pick ID in local indices for that structure (such
-// that 0 is the first index as returned from requestPickBufferRange())
+// that 0 is the first index as returned from requestPickBufferRange()). Uses the backend set by options::pickBackend.
 std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos);
 
 
+// == Ray-cast picking
+// Pick queries answered on the CPU, without rendering: a ray is intersected with each enabled structure which supports
+// ray casting (see Structure::rayCast()), using a spatial index per structure which is built on first use and refit as
+// the structure's geometry changes. Results use the same local indices as evaluatePickQuery().
+
+struct RayCastResult {
+  Structure* structure = nullptr; // nullptr if nothing was hit
+  size_t localIndex = 0;
+  float t = 0.;                   // distance along the ray, in units of the ray direction
+  glm::vec3 position{0., 0., 0.}; // world-space hit point
+};
+
+// Same as evaluatePickQuery() with PickBackend::RayCast, for the ray through the given pixel
+std::pair<Structure*, size_t> evaluatePickQueryRayCast(int xPos, int yPos);
+
+// Cast world-space rays. The batch version processes the rays in parallel.
+RayCastResult rayCast(glm::vec3 rayStart, glm::vec3 rayDir);
+std::vector<RayCastResult> rayCast(const std::vector<glm::vec3>& rayStarts, const std::vector<glm::vec3>& rayDirs);
+
+
 // == Stateful picking: track and update a current selection
 
 // Get/Set the "selected" item, if there is one (output has same meaning as evaluatePickQuery());
@@ -31,7 +55,29 @@ void setSelection(std::pair<Structure*, size_t> newPick);
 void resetSelection();
 bool haveSelection();
 void resetSelectionIfStructure(Structure* s); // If something from this structure is selected, clear the selection
-                                              // (useful if a structure is being deleted)
+                                              // and its selection set (useful if a structure is being deleted)
+
+
+// == Region selection
+// Select every element drawn in a region of the screen, such as a box or lasso dragged by the user. The pick buffer is
+// rendered and the whole region is read back at once, so this scales to regions covering many thousands of elements.
+// Only the elements visible in the region are found (not those hidden behind others). Coordinates are pixels in the
+// render buffer, as for evaluatePickQuery().
+
+// The elements drawn in an axis-aligned rectangle (inclusive), or in a polygon, as sorted local indices per structure.
+std::unordered_map<Structure*, std::vector<size_t>> evaluatePickQueryRect(int xMin, int yMin, int xMax, int yMax);
+std::unordered_map<Structure*, std::vector<size_t>> evaluatePickQueryLasso(const std::vector<glm::vec2>& lasso);
+
+// Each structure has a selection set, which these update from a region of the screen. Structures which have a
+// selection show it as quantities (see Structure::updateSelectionQuantities()).
+void selectRect(int xMin, int yMin, int xMax, int yMax, SelectionMode mode = SelectionMode::Replace);
+void selectLasso(const std::vector<glm::vec2>& lasso, SelectionMode mode = SelectionMode::Replace);
+void applySelection(const std::unordered_map<Structure*, std::vector<size_t>>& elements, SelectionMode mode);
+
+// Get/Set the selection set of a structure (empty if nothing has been selected)
+const SelectionSet& getSelectionSet(Structure* s);
+void setSelectionSet(Structure* s, const SelectionSet& selection);
+void clearSelectionSets();
 
 
 // == Helpers
@@ -40,11 +86,20 @@ void resetSelectionIfStructure(Structure* s); // If something from this structur
 std::pair<Structure*, size_t> globalIndexToLocal(size_t globalInd);
 size_t localIndexToGlobal(std::pair<Structure*, size_t> localPick);
 
+// Decode pixels read back from the pick buffer (RGBA floats) to the distinct elements they show, as sorted local indices
+// per structure. If a mask is given, only the pixels where it is nonzero are used.
+std::unordered_map<Structure*, std::vector<size_t>> decodePickPixels(const std::vector<float>& pixelsRGBA,
+                                                                     const std::vector<char>& pixelMask = {});
+
 // Convert indices to float3 color and back
 // Structures will want to use these to fill their pick buffers
 inline glm::vec3 indToVec(uint64_t globalInd);
 inline uint64_t vecToInd(glm::vec3 vec);
 
+// The base-2^22 digits {low, med, high} of a global index, as encoded by indToVec(). Shaders which compute pick colors
+// themselves take the start of a range of indices in this form, and add a 32-bit offset to it with carries.
+inline glm::uvec3 indToDigits(uint64_t globalInd);
+
 } // namespace pick
 } // namespace polyscope
 
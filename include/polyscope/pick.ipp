@@ -11,7 +11,7 @@ namespace pick {
 const uint64_t bitsForPickPacking = 22;
 // const int bitsForPickPacking = 7; // useful for testing, makes pick coloring visually distingushable
 
-inline glm::vec3 indToVec(size_t globalInd) {
+inline glm::vec3 indToVec(uint64_t globalInd) {
 
   // Can comfortably fit a 22 bit integer exactly in a single precision float
   uint64_t factor = 1 << bitsForPickPacking;
@@ -48,5 +48,13 @@ inline uint64_t vecToInd(glm::vec3 vec) {
   return ind;
 }
 
+inline glm::uvec3 indToDigits(uint64_t globalInd) {
+  uint64_t mask = (1 << bitsForPickPacking) - 1;
+  uint64_t low = globalInd & mask;
+  uint64_t med = (globalInd >> bitsForPickPacking) & mask;
+  uint64_t high = globalInd >> (2 * bitsForPickPacking);
+  return glm::uvec3{static_cast<uint32_t>(low), static_cast<uint32_t>(med), static_cast<uint32_t>(high)};
+}
+
 } // namespace pick
 } // namespace polyscope
@@ -3,7 +3,9 @@
 #pragma once
 
 #include "polyscope/affine_remapper.h"
+#include "polyscope/bvh.h"
 #include "polyscope/color_management.h"
+#include "polyscope/connected_components.h"
 #include "polyscope/persistent_value.h"
 #include "polyscope/point_cloud_quantity.h"
 #include "polyscope/polyscope.h"
@@ -55,6 +57,9 @@ public:
   virtual void draw() override;
   virtual void drawDelayed() override;
   virtual void drawPick() override;
+  virtual void prepareRayCast() override;
+  virtual bool rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) override;
+  virtual void updateSelectionQuantities(const SelectionSet& selection) override;
   virtual void updateObjectSpaceBounds() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
@@ -88,6 +93,12 @@ public:
   PointCloudVectorQuantity* addVectorQuantity2D(std::string name, const T& vectors,
                                                 VectorType vectorType = VectorType::STANDARD);
 
+  // === Connected components
+  // Components of the points, where points within epsilon of each other (in object space) are connected
+  ConnectedComponents computeConnectedComponents(float epsilon);
+  // Show each component in a distinct color
+  PointCloudColorQuantity* addConnectedComponentsQuantity(std::string name, float epsilon);
+
   // === Mutate
   template <class V>
   void updatePointPositions(const V& newPositions);
@@ -177,6 +188,15 @@ private:
   std::string pointRadiusQuantityName = ""; // empty string means none
   bool pointRadiusQuantityAutoscale = true;
   PointCloudScalarQuantity& resolvePointRadiusQuantity(); // helper
+  float computePointRadiusUniform();                      // multiplies the radius quantity, if any
+
+  // CPU ray casting, see prepareRayCast()
+  BVH rayCastBVH;
+  std::vector<float> rayCastRadii; // in object space
+  uint64_t rayCastBVHPositionsVersion = 0;
+  std::string rayCastBVHRadiusQuantityName = "";
+  uint64_t rayCastBVHRadiusValuesVersion = 0;
+  float rayCastBVHRadiusScale = -1.;
 };
 
 
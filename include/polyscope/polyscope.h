@@ -130,6 +130,10 @@ void removeAllStructures();
 // Recompute the global state::lengthScale, boundingBox, and center by looping over registered structures
 void updateStructureExtents();
 
+// Update the global state::lengthScale, boundingBox, and center after the extents of a single structure changed. This
+// is O(log n) in the number of structures.
+void updateStructureExtents(Structure* structure);
+
 // Essentially regenerates all state and programs within Polyscope, calling refresh() recurisvely on all structures and
 // quantities
 void refresh();
@@ -141,8 +145,13 @@ void refresh();
 void draw(bool withUI = true, bool withContextCallback = true);
 
 // Request that the 3D scene be redrawn for the next frame. Should be called anytime something changes in the scene.
+// Safe to call from any thread.
 void requestRedraw();
 
+// Like requestRedraw(), for changes which affect only the camera and not the contents of the scene. Renders which do not
+// depend on the camera are reused rather than recomputed. Safe to call from any thread.
+void requestViewRedraw();
+
 // Has a redraw been requested for the next frame?
 bool redrawRequested();
 
@@ -164,6 +173,7 @@ ImGuiContext* getCurrentContext();
 void buildPolyscopeGui();
 void buildStructureGui();
 void buildPickGui();
+void buildSelectionDragOverlay(); // outline of a region selection in progress
 void buildUserGuiAndInvokeCallback();
 
 
@@ -0,0 +1,121 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace polyscope {
+namespace profiler {
+
+// A lightweight built-in profiler, enabled via options::enableProfiler.
+//
+// Each main loop iteration is recorded as a frame, made up of nested named timers. Timers measure CPU wall time, and
+// when the render engine supports timer queries, GPU time as well. GPU results arrive asynchronously, a few frames
+// later, and are filled in to the frame history as they do. Counters track draw calls, bytes uploaded to the GPU, and
+// shader compilations per frame.
+//
+// All functions must be called from the main thread. When the profiler is off, timers and counters cost a single
+// branch.
+
+// Counts of GPU work issued during a frame
+struct Counters {
+  uint64_t drawCalls = 0;
+  uint64_t bytesUploaded = 0;
+  uint64_t shaderCompiles = 0;
+};
+
+// One timed scope within a frame
+struct TimerEvent {
+  std::string name;
+  int depth = 0;            // nesting level, 0 for top-level scopes
+  double cpuStartMs = 0.;   // relative to the start of the frame
+  double cpuEndMs = 0.;     // relative to the start of the frame
+  double gpuMs = -1.;       // GPU time, or -1 if not (yet) available
+  uint32_t gpuQueryStart = 0;
+  uint32_t gpuQueryEnd = 0;
+  bool gpuPending = false;
+
+  double cpuMs() const { return cpuEndMs - cpuStartMs; }
+};
+
+struct FrameProfile {
+  uint64_t frameIndex = 0;
+  double startMs = 0.; // relative to when the profiler was (last) enabled
+  double cpuMs = 0.;
+  std::vector<TimerEvent> events; // in the order the scopes were opened
+  Counters counters;
+  bool gpuPending = false; // some GPU results have not arrived yet
+};
+
+// Number of completed frames retained in the history
+const size_t HISTORY_LENGTH = 240;
+
+// == Frames (called by the main loop)
+void beginFrame();
+void endFrame();
+
+// Is a frame currently being recorded?
+bool isRecording();
+
+// == Timers
+
+// Open and close a named scope. Prefer ScopedTimer.
+void pushTimer(const std::string& name);
+void popTimer();
+
+// Times the enclosing C++ scope. The two-argument version concatenates its arguments, but only when recording, so
+// per-structure timers don't allocate when the profiler is off.
+class ScopedTimer {
+public:
+  ScopedTimer(const char* name);
+  ScopedTimer(const char* prefix, const std::string& name);
+  ~ScopedTimer();
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  bool active;
+};
+
+// == Counters (called by the render engine)
+namespace detail {
+extern bool recording;
+extern Counters frameCounters;
+} // namespace detail
+
+inline void countDrawCall() {
+  if (detail::recording) detail::frameCounters.drawCalls++;
+}
+inline void countBytesUploaded(size_t nBytes) {
+  if (detail::recording) detail::frameCounters.bytesUploaded += nBytes;
+}
+inline void countShaderCompile() {
+  if (detail::recording) detail::frameCounters.shaderCompiles++;
+}
+
+// == Results
+
+// Completed frames, oldest first
+const std::deque<FrameProfile>& getFrameHistory();
+void clearHistory();
+
+// A JSON summary: per-timer averages over the history, plus the raw frames
+std::string exportJSON();
+
+// The history in the Chrome trace event format, which can be loaded in chrome://tracing or Perfetto
+std::string exportChromeTrace();
+
+// Write the exports above to a file
+void writeJSON(std::string filename);
+void writeChromeTrace(std::string filename);
+
+// Build an ImGui window showing the profiler
+void buildProfilerUI();
+
+} // namespace profiler
+} // namespace polyscope
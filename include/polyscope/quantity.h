@@ -38,6 +38,7 @@ public:
 
   // Enable and disable the quantity
   bool isEnabled();
+  virtual bool hasVisualImpact() override; // whether the parent structure has one
   // there is no setEnabled() here, only in subclasses, because subclasses have different return types
 
   // = Utility
@@ -2,6 +2,7 @@
 
 #include "imgui.h"
 
+#include "polyscope/internal.h"
 #include "polyscope/messages.h"
 #include "polyscope/structure.h"
 
@@ -33,6 +34,7 @@ QuantityS<S>* QuantityS<S>::setEnabled(bool newEnabled) {
   if (newEnabled == enabled.get()) return this;
 
   enabled = newEnabled;
+  internal::sceneGeometryVersion++;
 
   // Dominating quantities need to update themselves as their parent's dominating quantity
   if (dominates) {
@@ -0,0 +1,88 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "polyscope/messages.h"
+#include "polyscope/weak_handle.h"
+
+namespace polyscope {
+
+// forward declaration
+void requestRedraw();
+
+namespace render {
+
+// A lock-free slot through which a worker thread hands new contents for a ManagedBuffer to the render loop. Get one
+// from ManagedBuffer<T>::getStagingSlot() (on the render thread), then publish() to it from any thread. At the start
+// of each frame, the render loop swaps the most recently published array in to the buffer, without copying it.
+// Arrays which are superseded before a frame picks them up are dropped.
+//
+// Ownership is passed around with atomic exchanges only, so neither side ever waits for the other, and each array is
+// owned by exactly one side at any time. Memory is reclaimed deterministically: a dropped array is freed (or kept for
+// reuse) by the thread which dropped it, and whatever is still in the slot is freed with the slot, once both the buffer
+// and the producer have released it.
+//
+// The intended pattern is one producer per slot. Several producers are safe, but the last publish() wins.
+template <typename T>
+class BufferStagingSlot {
+public:
+  BufferStagingSlot(size_t expectedSize);
+  ~BufferStagingSlot();
+
+  BufferStagingSlot(const BufferStagingSlot&) = delete;
+  BufferStagingSlot& operator=(const BufferStagingSlot&) = delete;
+
+  // == Producer side (any thread)
+
+  // Get an array to fill for the next publish(). This is the storage of an earlier array which the render loop is done
+  // with, if one is available, so that steady-state publishing doesn't allocate. Its contents are unspecified.
+  std::vector<T> acquire();
+
+  // Hand over new contents for the buffer. It must have the same number of entries as the buffer (this is checked here,
+  // so that a bad size throws on the producer's thread).
+  void publish(std::vector<T>&& data);
+
+  // == Consumer side (the render loop)
+
+  // If an array has been published since the last call, swap it with `target` and return true. The previous contents
+  // of `target` are kept for the producer to acquire().
+  bool consume(std::vector<T>& target);
+
+  // == Info
+  size_t getExpectedSize() const { return expectedSize; }
+  uint64_t getPublishedCount() const { return nPublished.load(); }
+  uint64_t getConsumedCount() const { return nConsumed.load(); }
+  uint64_t getDroppedCount() const { return nDropped.load(); } // published, but superseded before consumed
+
+private:
+  const size_t expectedSize;
+
+  struct Node {
+    std::vector<T> data;
+  };
+
+  std::atomic<Node*> pending{nullptr}; // the latest published array, not yet consumed
+  std::atomic<Node*> spare{nullptr};   // storage which is free for the producer to reuse
+
+  std::atomic<uint64_t> nPublished{0}, nConsumed{0}, nDropped{0};
+
+  void putSpare(Node* node); // takes ownership
+};
+
+// Swap in the latest published contents of every buffer which has a staging slot. Called at the start of each frame,
+// once the render context is current.
+void applyStagedBufferUpdates();
+
+// Used by ManagedBuffer: call `apply` from applyStagedBufferUpdates() for as long as `buffer` is alive
+void registerStagedBuffer(GenericWeakHandle buffer, std::function<void()> apply);
+
+} // namespace render
+} // namespace polyscope
+
+#include "polyscope/render/buffer_staging.ipp"
@@ -0,0 +1,61 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+namespace polyscope {
+namespace render {
+
+template <typename T>
+BufferStagingSlot<T>::BufferStagingSlot(size_t expectedSize_) : expectedSize(expectedSize_) {}
+
+template <typename T>
+BufferStagingSlot<T>::~BufferStagingSlot() {
+  delete pending.exchange(nullptr);
+  delete spare.exchange(nullptr);
+}
+
+template <typename T>
+std::vector<T> BufferStagingSlot<T>::acquire() {
+  Node* node = spare.exchange(nullptr);
+  if (node == nullptr) return std::vector<T>();
+  std::vector<T> data = std::move(node->data);
+  delete node;
+  return data;
+}
+
+template <typename T>
+void BufferStagingSlot<T>::publish(std::vector<T>&& data) {
+  if (data.size() != expectedSize) {
+    exception("staged buffer data has size " + std::to_string(data.size()) + ", but the buffer has size " +
+              std::to_string(expectedSize));
+  }
+
+  Node* node = new Node();
+  node->data = std::move(data);
+
+  Node* superseded = pending.exchange(node);
+  if (superseded != nullptr) {
+    nDropped++;
+    putSpare(superseded);
+  }
+  nPublished++;
+
+  requestRedraw();
+}
+
+template <typename T>
+bool BufferStagingSlot<T>::consume(std::vector<T>& target) {
+  Node* node = pending.exchange(nullptr);
+  if (node == nullptr) return false;
+  target.swap(node->data);
+  putSpare(node);
+  nConsumed++;
+  return true;
+}
+
+template <typename T>
+void BufferStagingSlot<T>::putSpare(Node* node) {
+  // Only one spare is kept; whichever one it displaces is ours to free
+  delete spare.exchange(node);
+}
+
+} // namespace render
+} // namespace polyscope
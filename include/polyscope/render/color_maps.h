@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "polyscope/color_management.h"
@@ -76,7 +77,7 @@ struct ValueColorMap {
     double lowerVal = std::floor(scaledVal);
     double upperBlendVal = scaledVal - lowerVal;
     unsigned int lowerInd = static_cast<unsigned int>(lowerVal);
-    unsigned int upperInd = lowerInd + 1;
+    unsigned int upperInd = std::min(lowerInd + 1, static_cast<unsigned int>(values.size() - 1));
 
     return (float)(1.0 - upperBlendVal) * values[lowerInd] + (float)upperBlendVal * values[upperInd];
   }
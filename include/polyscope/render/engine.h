@@ -4,7 +4,10 @@
 
 #include <array>
 #include <cstdint>
+#include <deque>
+#include <limits>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "polyscope/render/color_maps.h"
@@ -23,6 +26,7 @@ namespace polyscope {
 // The drawing modes available
 enum class DrawMode {
   Points = 0,
+  IndexedPoints,
   LinesAdjacency,
   Triangles,
   TrianglesAdjacency,
@@ -40,7 +44,7 @@ enum class FilterMode { Nearest = 0, Linear };
 enum class TextureFormat { RGB8 = 0, RGBA8, RG16F, RGB16F, RGBA16F, RGBA32F, RGB32F, R32F, R16F, DEPTH24 };
 enum class RenderBufferType { Color, ColorAlpha, Depth, Float4 };
 enum class DepthMode { Less, LEqual, LEqualReadOnly, Greater, Disable, PassReadOnly };
-enum class BlendMode { AlphaOver, OverNoWrite, AlphaUnder, Zero, WeightedAdd, Add, Source, Disable };
+enum class BlendMode { AlphaOver, OverNoWrite, AlphaUnder, Zero, WeightedAdd, Add, Source, MaxColorAddAlpha, Disable };
 enum class RenderDataType {
   Vector2Float,
   Vector3Float,
@@ -67,6 +71,15 @@ std::string deviceBufferTypeName(const DeviceBufferType& d);
 
 namespace render {
 
+// Summary statistics of the values in a buffer. Scalar data is summarized by its values, and vector data by the length
+// of each vector. See ManagedBuffer::getReduction().
+struct BufferReduction {
+  double minVal = std::numeric_limits<double>::infinity(); // over finite entries only
+  double maxVal = -std::numeric_limits<double>::infinity();
+  size_t nFinite = 0;
+  size_t nNonFinite = 0; // NaN and inf entries
+};
+
 class AttributeBuffer {
 public:
   AttributeBuffer(RenderDataType dataType_, int arrayCount);
@@ -169,6 +182,12 @@ public:
   virtual void setData(const std::vector<std::array<glm::vec3, 3>>& data) = 0;
   virtual void setData(const std::vector<std::array<glm::vec3, 4>>& data) = 0;
 
+  // Fill the rectangle [x0, x0+w) x [y0, y0+h) of a 2D texture from float data, leaving the rest untouched. The number
+  // of floats per pixel is implied by the texture format. Source rows start rowLength pixels apart, so a sub-rectangle
+  // can be uploaded straight out of a larger image without copying it first.
+  virtual void setSubData2D(unsigned int x0, unsigned int y0, unsigned int w, unsigned int h, const float* data,
+                            unsigned int rowLength);
+
   unsigned int getSizeX() const { return sizeX; }
   unsigned int getSizeY() const { return sizeY; }
   unsigned int getSizeZ() const { return sizeZ; }
@@ -263,6 +282,8 @@ public:
 
   // Query pixel
   virtual std::array<float, 4> readFloat4(int xPos, int yPos) = 0;
+  // Read a block of pixels in one go, as RGBA floats in rows starting from the bottom. The block must lie in the buffer.
+  virtual std::vector<float> readFloat4Region(int xStart, int yStart, int xSize, int ySize) = 0;
   virtual float readDepth(int xPos, int yPos) = 0;
   virtual void blitTo(FrameBuffer* other) = 0;
   virtual std::vector<unsigned char> readBuffer() = 0;
@@ -342,6 +363,13 @@ enum class ShaderReplacementDefaults {
   None                // no defaults applied
 };
 
+// Everything needed to (re)create a program via requestShader()
+struct ShaderProgramRequest {
+  std::string programName;
+  std::vector<std::string> customRules;
+  ShaderReplacementDefaults defaults;
+};
+
 // Encapsulate a shader program
 class ShaderProgram {
 
@@ -457,6 +485,10 @@ public:
   virtual bool bindSceneBuffer();
   virtual void resizeScreenBuffers(); // applies to all buffers tied to display size
   virtual void setScreenBufferViewports();
+  // The scene buffers alone. They may be smaller than the display, e.g. when rendering a viewport.
+  void resizeSceneBuffers();
+  void setSceneBufferViewports();
+  void ensureSceneBufferSize(); // resize the scene buffers to view::bufferWidth/Height, if they differ
   virtual void
   applyLightingTransform(std::shared_ptr<TextureBuffer>& texture); // tonemap and gamma correct, render to active buffer
   void updateMinDepthTexture();
@@ -465,6 +497,8 @@ public:
   // Manage render state
   virtual void setDepthMode(DepthMode newMode) = 0;
   virtual void setBlendMode(BlendMode newMode) = 0;
+  DepthMode getDepthMode(); // as last set with setDepthMode()
+  BlendMode getBlendMode(); // as last set with setBlendMode()
   virtual void setColorMask(std::array<bool, 4> mask = {true, true, true, true}) = 0;
   virtual void setBackfaceCull(bool newVal = false) = 0;
 
@@ -556,23 +590,66 @@ public:
   std::shared_ptr<FrameBuffer> sceneBuffer, sceneBufferFinal;
   std::shared_ptr<FrameBuffer> pickFramebuffer;
   std::shared_ptr<FrameBuffer> sceneDepthMinFrame;
+  std::shared_ptr<FrameBuffer> sceneBufferWeighted; // accumulation target for TransparencyMode::Weighted
+  std::array<std::shared_ptr<FrameBuffer>, 2> sceneBufferHistory; // alternating history for temporal anti-aliasing
   FrameBuffer& getDisplayBuffer();
 
   // Main buffers for rendering
   // sceneDepthMin is an optional texture copy of the depth buffe used for some effects
   std::shared_ptr<TextureBuffer> sceneColor, sceneColorFinal, sceneDepth, sceneDepthMin;
+  std::shared_ptr<TextureBuffer> sceneWeightedAccum, sceneWeightedRevealage;
+  std::array<std::shared_ptr<TextureBuffer>, 2> sceneColorHistory;
   std::shared_ptr<RenderBuffer> pickColorBuffer, pickDepthBuffer;
   TextureBuffer& getFinalSceneColorTexture();
 
   // General-use programs used by the engine
   std::shared_ptr<ShaderProgram> renderTexturePlain, renderTextureDot3, renderTextureMap3, renderTextureSphereBG;
-  std::shared_ptr<ShaderProgram> compositePeel, mapLight, copyDepth;
+  std::shared_ptr<ShaderProgram> compositePeel, compositeWeighted, mapLight, copyDepth, resolveTAA;
+
+  // Compute a BufferReduction of an attribute buffer directly on the device, without reading the data back. Returns
+  // false if the buffer type is not supported (or the backend can't do it), in which case the caller should reduce
+  // the values on the host instead.
+  virtual bool computeBufferReduction(std::shared_ptr<AttributeBuffer> buffer, BufferReduction& result);
+
+  // GPU timestamps, used by the profiler. issueGPUTimestamp() records the GPU clock (in nanoseconds) once all
+  // previously issued commands have completed, and returns a handle. The result arrives asynchronously:
+  // tryGetGPUTimestamp() never blocks, and returns false until it is available. Release handles when done with them.
+  virtual bool supportsGPUTimestamps();
+  virtual uint32_t issueGPUTimestamp();
+  virtual bool tryGetGPUTimestamp(uint32_t handle, int64_t& timeNs);
+  virtual void releaseGPUTimestamp(uint32_t handle);
+
+  // == Background program preparation
+  // Changing the transparency mode changes the default rules of every scene program. Rather than discarding them all and
+  // recompiling synchronously on the next frame, the variants for the new mode are first compiled a few per frame (see
+  // options::shaderCompileBudgetMs), while structures keep drawing with the old programs in the old mode. Once all are
+  // compiled the new mode takes effect, and the programs are re-requested from the cache.
+  void processPendingPrograms(); // called once per main loop iteration, with the context current
+  void finishPendingPrograms();  // compile everything that remains and switch now
+  bool hasPendingPrograms();
+
+  // Compile a program in to the cache without creating a ShaderProgram. Returns false if it was already cached.
+  virtual bool precompileShader(const ShaderProgramRequest& request);
+  // The requests behind all cached programs which are currently in use by some ShaderProgram
+  virtual std::vector<ShaderProgramRequest> getLiveShaderRequests();
+
+  // Occlusion queries: did any fragment pass the depth test between begin and end? Like the timestamps above,
+  // tryGetAnySamplesResult() never blocks, and returns false until the result is available. Backends without queries
+  // conservatively report true. Queries may not be nested. Release handles when done with them.
+  virtual uint32_t beginAnySamplesQuery();
+  virtual void endAnySamplesQuery();
+  virtual bool tryGetAnySamplesResult(uint32_t handle, bool& anyPassed);
+  virtual void releaseAnySamplesQuery(uint32_t handle);
 
   // Manage transparency and culling
   void setTransparencyMode(TransparencyMode newMode);
   TransparencyMode getTransparencyMode();
   bool transparencyEnabled();
   virtual void applyTransparencySettings() = 0;
+  // TransparencyMode::Weighted draws opaque structures first, then transparent ones in to an accumulation buffer.
+  // applyTransparencySettings() sets up the blend & depth state for whichever phase is active.
+  void setWeightedTransparencyAccumulate(bool newVal);
+  bool getWeightedTransparencyAccumulate();
   void addSlicePlane(std::string uniquePostfix);
   void removeSlicePlane(std::string uniquePostfix);
   bool slicePlanesEnabled();                     // true if there is at least one slice plane in the scene
@@ -590,6 +667,14 @@ public:
   void setSSAAFactor(int newVal);
   int getSSAAFactor();
 
+  // Temporal anti-aliasing (see options::enableTAA). beginTemporalAntiAliasing() jitters the camera for the frame about
+  // to be rendered. resolveTemporalAntiAliasing() blends the rendered frame in to the history, writes the result back
+  // to the final scene buffer, and removes the jitter.
+  void beginTemporalAntiAliasing();
+  void resolveTemporalAntiAliasing();
+  void invalidateTemporalHistory();
+  int getTemporalSampleCount(); // number of frames accumulated at the current view
+
 
   // == Cached data
 
@@ -629,10 +714,27 @@ protected:
   // Render state
   int ssaaFactor = 1;
   bool enableFXAA = true;
+  glm::ivec2 sceneBufferSize{-1, -1}; // size of the scene buffers, before SSAA
+  bool taaHistoryValid = false;
+  int taaHistoryInd = 0; // which of the history buffers holds the most recent result
+  int taaSampleCount = 0;
+  int taaJitterInd = 0;
+  glm::mat4 taaPrevViewProjMat{1.};
+  uint64_t taaSceneContentVersion = 0;
   glm::vec4 currViewport; // TODO remove global viewport size. There is no reason for this, and stops us from doing
                           // screenshot renders while minimized.
   float currPixelScale;
+  DepthMode currDepthMode = DepthMode::Less; // backends record these in setDepthMode() and setBlendMode()
+  BlendMode currBlendMode = BlendMode::AlphaOver;
   TransparencyMode transparencyMode = TransparencyMode::None;
+  bool weightedTransparencyAccumulate = false;
+
+  // A transparency mode switch waiting on its programs, see processPendingPrograms()
+  bool transparencyModePending = false;
+  TransparencyMode pendingTransparencyMode = TransparencyMode::None;
+  std::deque<ShaderProgramRequest> pendingProgramRequests;
+  std::vector<std::string> sceneObjectRulesForTransparencyMode(TransparencyMode mode);
+  void commitPendingTransparencyMode();
   int slicePlaneCount = 0;
   bool frontFaceCCW = true;
   std::vector<FrameBuffer*> renderFramebufferStack; // supports push/popBindFramebufferForRendering
@@ -641,6 +743,10 @@ protected:
   int currLightingSampleLevel = -1;
   TransparencyMode currLightingTransparencyMode = TransparencyMode::None;
 
+  // Lazily-allocated 1x1 target and programs for computeBufferReduction(), programs are keyed by value rule
+  std::shared_ptr<FrameBuffer> reductionFramebuffer;
+  std::unordered_map<std::string, std::shared_ptr<ShaderProgram>> reductionPrograms;
+
   // Helpers
   void configureImGui();
   void loadDefaultMaterials();
@@ -5,9 +5,14 @@
 #include "polyscope/types.h"
 #include "polyscope/view.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
 
 namespace polyscope {
+
+class Viewport;
+
 namespace render {
 
 // Forward declare necessary types
@@ -32,6 +37,9 @@ public:
   void buildGui();
   void prepare(); // does any and all setup work / allocations / etc. Should be called whenever the mode is changed.
 
+  // Number of times the shadow or reflection has actually been rendered, rather than reused from a previous frame
+  uint64_t getEffectRenderCount() const { return effectRenderCount; }
+
 
   // == Appearance Parameters
 
@@ -59,6 +67,29 @@ private:
   std::shared_ptr<render::ShaderProgram> blurProgram, copyTexProgram;
 
   void populateGroundPlaneGeometry();
+
+  // == Caching of the shadow & reflection renders (see options::groundPlaneTemporalReuse)
+
+  // Everything the effect renders depend on, other than the camera
+  struct EffectCacheKey {
+    const Viewport* viewport = nullptr; // viewports may hide structures, so each one needs its own render
+    uint64_t sceneGeometryVersion = 0; // see internal::sceneGeometryVersion
+    uint64_t sceneContentVersion = 0;  // reflections only
+    GroundPlaneMode mode = GroundPlaneMode::None;
+    view::UpDir upDir = view::UpDir::XUp;
+    double groundHeight = 0.;
+    int bufferWidth = 0;
+    int bufferHeight = 0;
+    int blurIters = 0;
+    bool transparencyEnabled = false;
+    bool operator==(const EffectCacheKey& other) const;
+  };
+  bool effectCacheValid = false;
+  EffectCacheKey effectCacheKey;
+  glm::mat4 effectCacheViewMat{1.}, effectCacheProjMat{1.}; // the camera the cached effect was rendered from
+  glm::mat4 prevDrawViewMat{1.}, prevDrawProjMat{1.};       // the camera at the previous draw, to detect it stopping
+  uint64_t effectRenderCount = 0;
+
   bool groundPlanePrepared = false;
   // which direction the ground plane faces
   view::UpDir groundPlaneViewCached = view::UpDir::XUp; // not actually valid, must populate first time
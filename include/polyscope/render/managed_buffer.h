@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "polyscope/render/buffer_staging.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/utilities.h"
 #include "polyscope/weak_handle.h"
@@ -16,6 +17,18 @@ namespace render {
 // forward declaration
 class ManagedBufferRegistry;
 
+// A lazily-computed buffer which is about to be needed, gathered by ManagedBuffer<T>::gatherPendingCompute() so that
+// many buffers can be computed together by computeBuffersConcurrently().
+struct PendingBufferCompute {
+  uint64_t bufferID;
+  std::vector<uint64_t> dependencyIDs; // other gathered buffers which must be computed first
+  std::function<void()> compute;
+};
+
+// Compute a set of gathered buffers. Buffers whose dependencies are done are computed concurrently, with threads taking
+// the next buffer as they finish their last one. Must be called from the render thread.
+void computeBuffersConcurrently(const std::vector<PendingBufferCompute>& computes);
+
 /*
  * This class is a wrapper which sits on top of data buffers in Polyscope, and handles common data-management concerns
  * of:
@@ -88,6 +101,23 @@ public:
   bool dataGetsComputed;             // if true, the value gets computed on-demand by calling computeFunc()
   std::function<void()> computeFunc; // (optional) callback which populates the `data` buffer
 
+  // Declare another buffer which computeFunc() reads. This lets computeBuffersConcurrently() compute buffers in a
+  // valid order, and on other threads: computed dependencies get computed first, and plain ones are copied to the host
+  // beforehand, since only the render thread may read back from the device. Every buffer which computeFunc() reads must
+  // be declared, for the buffer to be gathered safely.
+  template <typename U>
+  void addComputeDependency(ManagedBuffer<U>& dependency);
+
+  // If the data still needs to be computed, add it to `computes` (after any dependencies which also need to be), to be
+  // computed later by computeBuffersConcurrently(). Returns true if it is in `computes`.
+  bool gatherPendingCompute(std::vector<PendingBufferCompute>& computes);
+
+  // == Members for staged data
+
+  // (optional) callback which runs after new data from the staging slot is swapped in. Owning structures set this to
+  // do the same work as their own update functions, such as recomputing normals after new vertex positions.
+  std::function<void()> stagedDataFunc;
+
 
   // mark as texture, set size
   void setTextureSize(uint32_t sizeX);
@@ -132,11 +162,29 @@ public:
   bool hasData(); // true if there is valid data on either the host or device
   size_t size();  // size of the data (number of entries)
 
+  // Incremented whenever the data is updated, on either the host or device
+  uint64_t getDataVersion() const { return dataVersion; }
+
+  // Summary statistics of the data (min/max over finite entries, count of non-finite entries). Vector-valued buffers
+  // are summarized by the length of each vector. The result is cached until the data is next updated. If the data
+  // currently lives only in a device attribute buffer, the reduction is computed on the device where possible, rather
+  // than reading the data back to the host.
+  BufferReduction getReduction();
+
   // Is it an attribute, texture1d, texture2d, etc?
   DeviceBufferType getDeviceBufferType();
 
   std::string summaryString(); // for debugging
 
+  // ========================================================================
+  // == Updates from other threads
+  // ========================================================================
+
+  // Get a slot through which any thread can publish new contents for this buffer, to be swapped in at the start of the
+  // next frame (see BufferStagingSlot). Must be called from the render thread; later calls return the same slot. Not
+  // available for computed buffers.
+  std::shared_ptr<BufferStagingSlot<T>> getStagingSlot();
+
   // ========================================================================
   // == Direct access to the GPU (device-side) render attribute buffer
   // ========================================================================
@@ -191,9 +239,20 @@ protected:
 
   bool hostBufferIsPopulated; // true if the host buffer contains currently-valid data
 
+  uint64_t dataVersion = 0;
+  bool reductionIsCached = false;
+  uint64_t cachedReductionVersion = 0;
+  BufferReduction cachedReduction;
+
   std::shared_ptr<render::AttributeBuffer> renderAttributeBuffer;
   std::shared_ptr<render::TextureBuffer> renderTextureBuffer;
 
+  std::shared_ptr<BufferStagingSlot<T>> stagingSlot;
+  void applyStagedData(); // swap in the latest data from stagingSlot, if any, then call stagedDataFunc
+
+  // Each gathers one dependency declared by addComputeDependency(), adding its ID to the list if it got gathered
+  std::vector<std::function<void(std::vector<PendingBufferCompute>&, std::vector<uint64_t>&)>> computeDependencies;
+
   // For storing as textures
 
   // For data that can be interpreted as a 1/2/3 dimensional texture
@@ -215,6 +274,7 @@ protected:
   // == Internal helper functions
 
   void invalidateHostBuffer();
+  void requestRedrawForUpdate(); // via the registry, which may skip it
   bool deviceBufferTypeIsTexture();
   void checkDeviceBufferTypeIs(DeviceBufferType targetType);
   void checkDeviceBufferTypeIsTexture();
@@ -264,6 +324,8 @@ public:
   template <typename T>
   bool hasManagedBuffer(std::string name);
 
+  virtual ~ManagedBufferRegistry() = default;
+
   // checks for a managed buffer with the given name of any type
   // return value is (bool, type), the bool indicates whether the buffer was found, and if so the type indicates what
   // type it was
@@ -272,6 +334,13 @@ public:
   template <typename T>
   void addManagedBuffer(ManagedBuffer<T>* buffer);
 
+  // Could changes to these buffers currently show up on screen? Structures and quantities override this, so that
+  // updating data which can't be seen (e.g. on a disabled structure) doesn't redraw the scene.
+  virtual bool hasVisualImpact();
+
+  // Called when the device-side data of one of the buffers changes. Requests a redraw if it has a visual impact.
+  void requestRedrawIfVisible();
+
   // clang-format off
   ManagedBufferMap<float>        managedBufferMap_float;
   ManagedBufferMap<double>       managedBufferMap_double;
@@ -5,6 +5,22 @@
 namespace polyscope {
 namespace render {
 
+template <typename T>
+template <typename U>
+void ManagedBuffer<T>::addComputeDependency(ManagedBuffer<U>& dependency) {
+  if (!dataGetsComputed) exception("called addComputeDependency() on buffer " + name + " which does not get computed");
+
+  // the dependency belongs to the same structure or quantity as this buffer, so it lives as long as this does
+  ManagedBuffer<U>* dep = &dependency;
+  computeDependencies.push_back([dep](std::vector<PendingBufferCompute>& computes, std::vector<uint64_t>& pendingIDs) {
+    if (dep->dataGetsComputed && dep->gatherPendingCompute(computes)) {
+      pendingIDs.push_back(dep->uniqueID);
+    } else {
+      dep->ensureHostBufferPopulated();
+    }
+  });
+}
+
 template <typename T>
 ManagedBuffer<T>& ManagedBufferRegistry::getManagedBuffer(std::string name) {
   return ManagedBufferMap<T>::getManagedBufferMapRef(this).getManagedBuffer(name);
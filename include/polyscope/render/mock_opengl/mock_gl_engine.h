@@ -126,6 +126,9 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  void setSubData2D(unsigned int x0, unsigned int y0, unsigned int w, unsigned int h, const float* data,
+                    unsigned int rowLength) override;
+
   void setFilterMode(FilterMode newMode) override;
   void* getNativeHandle() override;
   uint32_t getNativeBufferID() override;
@@ -178,6 +181,7 @@ public:
   // Query pixels
   std::vector<unsigned char> readBuffer() override;
   std::array<float, 4> readFloat4(int xPos, int yPos) override;
+  std::vector<float> readFloat4Region(int xStart, int yStart, int xSize, int ySize) override;
   float readDepth(int xPos, int yPos) override;
   void blitTo(FrameBuffer* other) override;
 
@@ -390,6 +394,11 @@ public:
   std::shared_ptr<ShaderProgram>
   requestShader(const std::string& programName, const std::vector<std::string>& customRules,
                 ShaderReplacementDefaults defaults = ShaderReplacementDefaults::SceneObject) override;
+  virtual bool precompileShader(const ShaderProgramRequest& request) override;
+  virtual std::vector<ShaderProgramRequest> getLiveShaderRequests() override;
+
+  // Each program compilation sleeps this long, to simulate a real driver when testing background compilation
+  double simulatedCompileLatencyMs = 0.;
 
   // === Implementation details
 
@@ -400,6 +409,20 @@ public:
 
   // Transparency
   virtual void applyTransparencySettings() override;
+  virtual bool computeBufferReduction(std::shared_ptr<AttributeBuffer> buffer, BufferReduction& result) override;
+
+  // GPU timestamps
+  virtual bool supportsGPUTimestamps() override;
+  virtual uint32_t issueGPUTimestamp() override;
+  virtual bool tryGetGPUTimestamp(uint32_t handle, int64_t& timeNs) override;
+  virtual void releaseGPUTimestamp(uint32_t handle) override;
+
+  // Occlusion queries, emulated as "was anything drawn"
+  virtual uint32_t beginAnySamplesQuery() override;
+  virtual void endAnySamplesQuery() override;
+  virtual bool tryGetAnySamplesResult(uint32_t handle, bool& anyPassed) override;
+  virtual void releaseAnySamplesQuery(uint32_t handle) override;
+  uint64_t drawCallCount = 0;
 
   virtual void setFrontFaceCCW(bool newVal) override;
 
@@ -412,7 +435,18 @@ protected:
   std::unordered_map<std::string, ShaderReplacementRule> registeredShaderRules;
   void populateDefaultShadersAndRules();
 
+  // Emulated GPU timestamps, which are just the CPU clock at issue time. Released handles are recycled.
+  std::vector<int64_t> emulatedTimestamps;
+  std::vector<uint32_t> freeTimestampHandles;
+
+  // Emulated occlusion queries, which report whether any draw calls were made. Released handles are recycled.
+  std::vector<bool> emulatedAnySamplesResults;
+  std::vector<uint32_t> freeAnySamplesHandles;
+  uint32_t currAnySamplesHandle = 0;
+  uint64_t anySamplesQueryStartCount = 0;
+
   std::unordered_map<std::string, std::shared_ptr<GLCompiledProgram>> compiledProgamCache;
+  std::unordered_map<std::string, ShaderProgramRequest> compiledProgramRequests; // what each cache entry was built from
   std::string programKeyFromRules(const std::string& programName, const std::vector<std::string>& rules,
                                   ShaderReplacementDefaults defaults);
   std::shared_ptr<GLCompiledProgram> getCompiledProgram(const std::string& programName,
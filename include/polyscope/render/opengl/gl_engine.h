@@ -167,6 +167,9 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  void setSubData2D(unsigned int x0, unsigned int y0, unsigned int w, unsigned int h, const float* data,
+                    unsigned int rowLength) override;
+
   void setFilterMode(FilterMode newMode) override;
   void* getNativeHandle() override;
   uint32_t getNativeBufferID() override;
@@ -224,6 +227,7 @@ public:
   // Query pixels
   std::vector<unsigned char> readBuffer() override;
   std::array<float, 4> readFloat4(int xPos, int yPos) override;
+  std::vector<float> readFloat4Region(int xStart, int yStart, int xSize, int ySize) override;
   float readDepth(int xPos, int yPos) override;
   void blitTo(FrameBuffer* other) override;
 
@@ -445,6 +449,8 @@ public:
   std::shared_ptr<ShaderProgram>
   requestShader(const std::string& programName, const std::vector<std::string>& customRules,
                 ShaderReplacementDefaults defaults = ShaderReplacementDefaults::SceneObject) override;
+  virtual bool precompileShader(const ShaderProgramRequest& request) override;
+  virtual std::vector<ShaderProgramRequest> getLiveShaderRequests() override;
 
   // === Implementation details
 
@@ -456,6 +462,18 @@ public:
   // Transparency
   virtual void applyTransparencySettings() override;
 
+  // GPU timestamps
+  virtual bool supportsGPUTimestamps() override;
+  virtual uint32_t issueGPUTimestamp() override;
+  virtual bool tryGetGPUTimestamp(uint32_t handle, int64_t& timeNs) override;
+  virtual void releaseGPUTimestamp(uint32_t handle) override;
+
+  // Occlusion queries
+  virtual uint32_t beginAnySamplesQuery() override;
+  virtual void endAnySamplesQuery() override;
+  virtual bool tryGetAnySamplesResult(uint32_t handle, bool& anyPassed) override;
+  virtual void releaseAnySamplesQuery(uint32_t handle) override;
+
   virtual void setFrontFaceCCW(bool newVal) override;
 
 protected:
@@ -470,7 +488,14 @@ protected:
   std::unordered_map<std::string, ShaderReplacementRule> registeredShaderRules;
   void populateDefaultShadersAndRules();
 
+  // Query objects for GPU timestamps, recycled once released
+  std::vector<GLuint> freeTimestampQueries;
+
+  // Query objects for occlusion queries, recycled once released
+  std::vector<GLuint> freeAnySamplesQueries;
+
   std::unordered_map<std::string, std::shared_ptr<GLCompiledProgram>> compiledProgamCache;
+  std::unordered_map<std::string, ShaderProgramRequest> compiledProgramRequests; // what each cache entry was built from
   std::string programKeyFromRules(const std::string& programName, const std::vector<std::string>& rules,
                                   ShaderReplacementDefaults defaults);
   std::shared_ptr<GLCompiledProgram> getCompiledProgram(const std::string& programName,
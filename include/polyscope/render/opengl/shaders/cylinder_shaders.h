@@ -12,13 +12,18 @@ namespace backend_openGL3_glfw {
 extern const ShaderStageSpecification FLEX_CYLINDER_VERT_SHADER;
 extern const ShaderStageSpecification FLEX_CYLINDER_GEOM_SHADER;
 extern const ShaderStageSpecification FLEX_CYLINDER_FRAG_SHADER;
+extern const ShaderStageSpecification FLEX_CYLINDER_STRIP_VERT_SHADER;
+extern const ShaderStageSpecification FLEX_CYLINDER_STRIP_GEOM_SHADER;
 
 // Rules specific to cylinders
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_VALUE;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_BLEND_VALUE;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_COLOR;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_BLEND_COLOR;
+extern const ShaderReplacementRule CYLINDER_STRIP_PROPAGATE_BLEND_VALUE;
+extern const ShaderReplacementRule CYLINDER_STRIP_PROPAGATE_BLEND_COLOR;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_PICK;
+extern const ShaderReplacementRule CYLINDER_STRIP_PROPAGATE_PICK;
 extern const ShaderReplacementRule CYLINDER_CULLPOS_FROM_MID;
 extern const ShaderReplacementRule CYLINDER_VARIABLE_SIZE;
 
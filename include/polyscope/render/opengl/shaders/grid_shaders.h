@@ -16,12 +16,20 @@ extern const ShaderStageSpecification FLEX_GRIDCUBE_FRAG_SHADER;
 extern const ShaderStageSpecification FLEX_GRIDCUBE_PLANE_VERT_SHADER;
 extern const ShaderStageSpecification FLEX_GRIDCUBE_PLANE_FRAG_SHADER;
 
+extern const ShaderStageSpecification FLEX_SPARSE_GRIDCUBE_PLANE_VERT_SHADER;
+
+extern const ShaderStageSpecification FLEX_GRID_VOLUME_RAYMARCH_VERT_SHADER;
+extern const ShaderStageSpecification FLEX_GRID_VOLUME_RAYMARCH_FRAG_SHADER;
+
 // Rules
 extern const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE;
 extern const ShaderReplacementRule GRIDCUBE_PROPAGATE_CELL_VALUE;
 extern const ShaderReplacementRule GRIDCUBE_WIREFRAME;
 extern const ShaderReplacementRule GRIDCUBE_CONSTANT_PICK;
 extern const ShaderReplacementRule GRIDCUBE_CULLPOS_FROM_CENTER;
+extern const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE;
+extern const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE;
+extern const ShaderReplacementRule SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER;
 
 
 } // namespace backend_openGL3_glfw
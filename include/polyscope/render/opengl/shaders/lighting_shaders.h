@@ -23,6 +23,7 @@ extern const ShaderReplacementRule TRANSPARENCY_RESOLVE_SIMPLE;
 extern const ShaderReplacementRule TRANSPARENCY_STRUCTURE;
 extern const ShaderReplacementRule TRANSPARENCY_PEEL_STRUCTURE;
 extern const ShaderReplacementRule TRANSPARENCY_PEEL_GROUND;
+extern const ShaderReplacementRule TRANSPARENCY_WEIGHTED_STRUCTURE;
 
 } // namespace backend_openGL3_glfw
 } // namespace render
@@ -0,0 +1,23 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/render/opengl/gl_shaders.h"
+
+namespace polyscope {
+namespace render {
+namespace backend_openGL3_glfw {
+
+// High level pipeline
+extern const ShaderStageSpecification BUFFER_REDUCE_VERT_SHADER;
+extern const ShaderStageSpecification BUFFER_REDUCE_FRAG_SHADER;
+
+// Rules which select the type of the reduced buffer
+extern const ShaderReplacementRule REDUCE_VALUE_FLOAT;
+extern const ShaderReplacementRule REDUCE_VALUE_VEC2_LENGTH;
+extern const ShaderReplacementRule REDUCE_VALUE_VEC3_LENGTH;
+extern const ShaderReplacementRule REDUCE_VALUE_VEC4_LENGTH;
+
+} // namespace backend_openGL3_glfw
+} // namespace render
+} // namespace polyscope
@@ -37,6 +37,9 @@ protected:
   void prepareIntermediateRender();
   void prepareBillboard();
 
+  // The texture holding the values to draw. Bound again before each draw, so subclasses may change it between frames.
+  virtual render::TextureBuffer& imageTexture();
+
   virtual void showFullscreen() override;
   virtual void showInImGuiWindow() override;
   virtual void showInBillboard(glm::vec3 center, glm::vec3 upVec, glm::vec3 rightVec) override;
@@ -18,7 +18,7 @@ namespace polyscope {
 template <typename QuantityT>
 class ScalarQuantity {
 public:
-  ScalarQuantity(QuantityT& quantity, const std::vector<double>& values, DataType dataType);
+  ScalarQuantity(QuantityT& quantity, std::vector<double> values, DataType dataType);
 
   // Build the ImGUI UIs for scalars
   void buildScalarUI();
@@ -51,6 +51,7 @@ public:
   std::pair<double, double> getMapRange();
   QuantityT* resetMapRange(); // reset to full range
   std::pair<double, double> getDataRange();
+  const Histogram& getHistogram();
 
   // Isolines
   QuantityT* setIsolinesEnabled(bool newEnabled);
@@ -64,6 +65,8 @@ protected:
   std::vector<double> valuesData;
   const DataType dataType;
 
+  std::pair<float, float> fullMapRange(); // the range resetMapRange() sets, from the data range and type
+
   // === Visualization parameters
 
   // Affine data maps and limits
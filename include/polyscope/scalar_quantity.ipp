@@ -4,10 +4,17 @@
 #include "polyscope/utilities.h"
 namespace polyscope {
 
+// robustMinMax() via the (cached, possibly parallel or on-device) reduction of a buffer
+inline std::pair<double, double> robustMinMaxOfValues(render::ManagedBuffer<double>& values, double rangeEPS) {
+  render::BufferReduction reduction = values.getReduction();
+  return robustMinMax(reduction.minVal, reduction.maxVal, reduction.nFinite > 0, rangeEPS);
+}
+
 template <typename QuantityT>
-ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vector<double>& values_, DataType dataType_)
-    : quantity(quantity_), values(&quantity, quantity.uniquePrefix() + "values", valuesData), valuesData(values_),
-      dataType(dataType_), dataRange(robustMinMax(values.data, 1e-5)),
+ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, std::vector<double> values_, DataType dataType_)
+    : quantity(quantity_), values(&quantity, quantity.uniquePrefix() + "values", valuesData),
+      valuesData(std::move(values_)),
+      dataType(dataType_), dataRange(robustMinMaxOfValues(values, 1e-5)),
       cMap(quantity.uniquePrefix() + "cmap", defaultColorMap(dataType)),
       isolinesEnabled(quantity.uniquePrefix() + "isolinesEnabled", false),
       isolineWidth(quantity.uniquePrefix() + "isolineWidth",
@@ -16,7 +23,7 @@ ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vecto
 
 {
   hist.updateColormap(cMap.get());
-  hist.buildHistogram(values.data);
+  hist.buildHistogramDeferred(values);
   resetMapRange();
 }
 
@@ -173,21 +180,24 @@ void ScalarQuantity<QuantityT>::setScalarUniforms(render::ShaderProgram& p) {
 
 template <typename QuantityT>
 QuantityT* ScalarQuantity<QuantityT>::resetMapRange() {
+  vizRange = fullMapRange();
+  requestRedraw();
+  return &quantity;
+}
+
+template <typename QuantityT>
+std::pair<float, float> ScalarQuantity<QuantityT>::fullMapRange() {
   switch (dataType) {
   case DataType::STANDARD:
-    vizRange = dataRange;
-    break;
+    return dataRange;
   case DataType::SYMMETRIC: {
     double absRange = std::max(std::abs(dataRange.first), std::abs(dataRange.second));
-    vizRange = std::make_pair(-absRange, absRange);
-  } break;
+    return std::make_pair(-absRange, absRange);
+  }
   case DataType::MAGNITUDE:
-    vizRange = std::make_pair(0., dataRange.second);
-    break;
+    return std::make_pair(0., dataRange.second);
   }
-
-  requestRedraw();
-  return &quantity;
+  return dataRange; // unreachable
 }
 
 template <typename QuantityT>
@@ -226,6 +236,10 @@ template <typename QuantityT>
 std::pair<double, double> ScalarQuantity<QuantityT>::getDataRange() {
   return dataRange;
 }
+template <typename QuantityT>
+const Histogram& ScalarQuantity<QuantityT>::getHistogram() {
+  return hist;
+}
 
 template <typename QuantityT>
 QuantityT* ScalarQuantity<QuantityT>::setIsolineWidth(double size, bool isRelative) {
@@ -0,0 +1,69 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "polyscope/weak_handle.h"
+
+namespace polyscope {
+namespace scheduler {
+
+// Paces the main loop, and spreads deferred work (e.g. building histograms, compiling shader variants) across frames.
+//
+// Each frame gets a budget for deferred work: whatever is left of the target frame time (from options::maxFPS) after
+// the frame's own work, capped at options::frameWorkBudgetMs. Deferred tasks run after the frame has been presented,
+// until the budget runs out, but always at least one per frame so that work can't stall. While the user is
+// interacting with the view (dragging, scrolling, or a camera flight), low-priority tasks wait, so that they don't add
+// latency to the interaction.
+//
+// All functions must be called from the main thread.
+
+enum class TaskPriority {
+  High, // affects what the user is looking at right now
+  Low,  // background refinement, which can wait until the user stops interacting
+};
+
+// Run `task` during a later frame. With the `owner` variant, the task is skipped if the owner has been deleted by then.
+void deferTask(std::function<void()> task, TaskPriority priority = TaskPriority::Low);
+void deferTask(GenericWeakHandle owner, std::function<void()> task, TaskPriority priority = TaskPriority::Low);
+
+// Run all deferred tasks now, regardless of the budget
+void finishDeferredTasks();
+
+size_t getDeferredTaskCount();
+
+// The budget for deferred work in the current frame, and how much of it is left. Incremental work which is not a
+// deferred task (such as background shader compilation) can spend from it too, via addDeferredWorkTime().
+double getFrameBudgetMs();
+double getRemainingFrameBudgetMs();
+void addDeferredWorkTime(double ms);
+
+// Is the user interacting with the view? Input handling marks interaction, which then lasts for a short while.
+void markInteraction();
+bool isInteracting();
+
+// Statistics of recent frame times: the main loop's work per frame, excluding any wait to pace frames
+struct FrameTimeStats {
+  size_t nFrames = 0;
+  double meanMs = 0.;
+  double p50Ms = 0.;
+  double p90Ms = 0.;
+  double p99Ms = 0.;
+  double maxMs = 0.;
+};
+FrameTimeStats getFrameTimeStats();
+void clearFrameTimeStats();
+
+// Number of recent frames which the statistics cover
+const size_t FRAME_TIME_HISTORY_LENGTH = 600;
+
+// == Frames (called by the main loop)
+void beginFrame();
+void runDeferredTasks(); // spends the rest of the frame's budget
+void endFrame();
+void waitForNextFrame(); // sleep until it is time to start the next frame, according to options::maxFPS
+
+} // namespace scheduler
+} // namespace polyscope
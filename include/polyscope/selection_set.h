@@ -0,0 +1,49 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace polyscope {
+
+// Structures show their selection as quantities whose names start with this reserved prefix (see
+// Structure::updateSelectionQuantities()). User names cannot contain '#', so these never replace a user's quantity.
+extern const std::string selectionQuantityPrefix;
+
+// A set of elements of one structure, identified by their local pick indices (the same indices returned by
+// pick::evaluatePickQuery(), see Structure::buildPickUI()). Stored as a bitset, so it stays compact even when it holds
+// hundreds of thousands of elements, and membership tests are cheap.
+class SelectionSet {
+public:
+  bool contains(size_t ind) const;
+  void insert(size_t ind);
+  void erase(size_t ind);
+
+  // Bulk versions of the above, for many indices at once
+  void insert(const std::vector<size_t>& inds);
+  void erase(const std::vector<size_t>& inds);
+
+  void clear();
+  bool empty() const;
+
+  // Number of elements in the set, or in the range [start, end) of indices
+  size_t count() const;
+  size_t count(size_t start, size_t end) const;
+
+  // The elements in the set, in increasing order
+  std::vector<size_t> indices() const;
+
+  // For each index in [start, start + count), 1 if it is in the set and 0 otherwise
+  std::vector<double> indicator(size_t start, size_t count) const;
+
+  bool operator==(const SelectionSet& other) const;
+  bool operator!=(const SelectionSet& other) const;
+
+private:
+  std::vector<uint64_t> words; // bit i of word w is index 64 * w + i
+};
+
+} // namespace polyscope
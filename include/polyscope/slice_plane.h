@@ -35,6 +35,12 @@ public:
                               bool alwaysPass = false); // if alwaysPass, fake values are given so the plane does
                                                         // nothing (regardless of this plane's active setting)
   void setSliceGeomUniforms(render::ShaderProgram& p);
+  bool cullsPoint(glm::vec3 worldPos); // does the plane cut away this point? (CPU version of the shader test)
+
+  // Point a slice program (one using "SLICE_TETS_INDEXED") at the tets of the inspected mesh which the plane might cut.
+  // Returns false if there are no such tets, in which case there is nothing to draw.
+  bool setSliceGeomIndex(render::ShaderProgram& p);
+  size_t getSliceCandidateTetCount(); // number of tets currently submitted for slicing the inspected mesh
 
   const std::string name;
   const std::string postfix;
@@ -89,17 +95,23 @@ protected:
 
   std::shared_ptr<render::ShaderProgram> volumeInspectProgram;
 
+  // The tets of the inspected mesh which the plane might cut, found with the mesh's spatial index. They are gathered for
+  // a slab around the plane, so the plane can move within the slab (with the same normal) without a new query.
+  std::shared_ptr<render::AttributeBuffer> sliceCandidateTets;
+  std::vector<uint32_t> sliceCandidateTetsData;
+  glm::vec3 sliceCandidateNormal{0., 0., 0.};
+  float sliceCandidateSlabMin = 0.;
+  float sliceCandidateSlabMax = 0.;
+  uint64_t sliceCandidatePositionsVersion = 0;
+  void ensureSliceCandidatesUpdated();
+  void clearSliceCandidates();
+
   // Widget that wraps the transform
   TransformationGizmo transformGizmo;
 
-  // these are optionally filled when slice-visualizing into a volume mesh
-  std::array<std::vector<uint32_t>, 4> sliceBufferDataArr;
-  std::array<render::ManagedBuffer<uint32_t>, 4> sliceBufferArr;
-
   std::shared_ptr<render::ShaderProgram> planeProgram;
 
   // Helpers
-  void setSliceAttributes(render::ShaderProgram& p);
   void createVolumeSliceProgram();
   void prepare();
   glm::vec3 getCenter();
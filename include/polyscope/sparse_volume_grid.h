@@ -0,0 +1,265 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/affine_remapper.h"
+#include "polyscope/batch_callable.h"
+#include "polyscope/color_management.h"
+#include "polyscope/parallel.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/standardize_data_array.h"
+#include "polyscope/structure.h"
+
+#include "polyscope/sparse_volume_grid_quantity.h"
+#include "polyscope/sparse_volume_grid_scalar_quantity.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace polyscope {
+
+class SparseVolumeGrid;
+class SparseVolumeGridNodeScalarQuantity;
+class SparseVolumeGridCellScalarQuantity;
+
+template <> // Specialize the quantity type
+struct QuantityTypeHelper<SparseVolumeGrid> {
+  typedef SparseVolumeGridQuantity type;
+};
+
+
+// A regular grid where only some blocks of cells are allocated, for data which is mostly empty (narrow-band level sets,
+// adaptive simulations, etc).
+//
+// The grid is an infinite lattice of cells with size gridSpacing, where cell (i,j,k) covers [origin + (i,j,k) *
+// gridSpacing, origin + (i+1,j+1,k+1) * gridSpacing]. Cells are allocated in bricks of BRICK_SIZE^3, and brick (a,b,c)
+// holds the cells from BRICK_SIZE * (a,b,c) up to (but not including) BRICK_SIZE * (a+1,b+1,c+1). Nodes are the corners
+// of allocated cells. Everything stored (element data, quantity values, and the atlas textures which hold them on the
+// GPU) is proportional to the number of allocated bricks, not to the extent of the grid.
+//
+// Element indices: cells are numbered brick by brick, in the order the bricks were given, with BRICK_SIZE^3 cells per
+// brick. Nodes shared between neighboring bricks appear only once; they are numbered in order of first appearance when
+// iterating over the bricks in the same way. Use cellIndexOf() / nodeIndexOf() to look up an index from integer grid
+// coordinates.
+class SparseVolumeGrid : public QuantityStructure<SparseVolumeGrid> {
+public:
+  // Construct a new sparse volume grid structure
+  SparseVolumeGrid(std::string name, glm::vec3 origin_, glm::vec3 gridSpacing_, std::vector<glm::ivec3> brickCoords_);
+
+  // === Overloads
+
+  // Standard structure overrides
+  virtual void draw() override;
+  virtual void drawDelayed() override;
+  virtual void drawPick() override;
+  virtual void updateObjectSpaceBounds() override;
+  virtual std::string typeName() override;
+  virtual void refresh() override;
+
+  // Build the imgui display
+  virtual void buildCustomUI() override;
+  virtual void buildCustomOptionsUI() override;
+  virtual void buildPickUI(size_t localPickID) override;
+
+  // Misc data
+  static const std::string structureTypeName;
+
+  // Number of cells along each side of a brick
+  static const uint32_t BRICK_SIZE = 8;
+
+  // === Geometry members
+
+  // The grid cube visualization of a single brick, in a reference [0,1]^3 space. It is drawn once per allocated brick
+  // with instancing; each instance looks up where its brick is from the brickOrigins texture.
+  render::ManagedBuffer<glm::vec3> brickPlaneReferencePositions;
+  render::ManagedBuffer<glm::vec3> brickPlaneReferenceNormals;
+  render::ManagedBuffer<int32_t> brickPlaneAxisInds;
+
+  // World-space min corner of each brick, as a 2D texture with BRICK_TABLE_WIDTH entries per row
+  render::ManagedBuffer<glm::vec3> brickOrigins;
+  static const uint32_t BRICK_TABLE_WIDTH = 1024;
+
+
+  // === Quantity-related
+  // clang-format off
+
+  // The callable variants are the same as for VolumeGrid, but only sample at the nodes (or cells) of allocated bricks
+
+  template <class T>
+  SparseVolumeGridNodeScalarQuantity* addNodeScalarQuantity(std::string name, const T& values, DataType dataType_ = DataType::STANDARD);
+
+  template <class Func>
+  SparseVolumeGridNodeScalarQuantity* addNodeScalarQuantityFromCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
+
+  template <class Func>
+  SparseVolumeGridNodeScalarQuantity* addNodeScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
+
+  template <class T>
+  SparseVolumeGridCellScalarQuantity* addCellScalarQuantity(std::string name, const T& values, DataType dataType_ = DataType::STANDARD);
+
+  template <class Func>
+  SparseVolumeGridCellScalarQuantity* addCellScalarQuantityFromCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
+
+  template <class Func>
+  SparseVolumeGridCellScalarQuantity* addCellScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
+
+  static const size_t CALLABLE_SAMPLE_CHUNK_SIZE = 1 << 16;
+
+
+  // Rendering helpers used by quantities
+  std::vector<std::string> addGridCubeRules(std::vector<std::string> initRules, bool withShade=true);
+  void setGridCubeUniforms(render::ShaderProgram& p, bool withShade=true);
+  void setGridCubeAttributes(render::ShaderProgram& p); // geometry, brick table, and instance count
+
+  // == Atlas textures
+  //
+  // Quantity values are uploaded as a 3D texture atlas, which packs one tile per allocated brick (and nothing for the
+  // empty space between them). Node tiles are (BRICK_SIZE+1)^3, so that nodes on the boundary of a brick are repeated
+  // in each brick's tile, and the values can be interpolated in hardware without reaching across tiles. Cell tiles are
+  // BRICK_SIZE^3. Brick i goes in tile atlasTileOfBrick(i), in a getAtlasBrickDim() arrangement of tiles.
+
+  glm::uvec3 getAtlasBrickDim() const;
+  glm::uvec3 atlasTileOfBrick(uint64_t brickInd) const;
+  glm::uvec3 getNodeAtlasSize() const; // in texels
+  glm::uvec3 getCellAtlasSize() const; // in texels
+  void fillNodeAtlas(const std::vector<double>& nodeValues, std::vector<float>& atlas) const;
+  void fillCellAtlas(const std::vector<double>& cellValues, std::vector<float>& atlas) const;
+
+  // == Helpers for computing with the grid
+
+  uint64_t nBricks() const; // number of allocated bricks
+  uint64_t nNodes() const;  // total number of nodes
+  uint64_t nCells() const;  // total number of cells
+  glm::vec3 getOrigin() const;
+  glm::vec3 getGridSpacing() const; // size of a cell, in world units
+  float minGridSpacing() const; // smallest coordinate of getGridSpacing()
+  const std::vector<glm::ivec3>& getBrickCoords() const;
+
+  // Look up elements from their integer coordinates. These return INVALID_IND_64 if the element is not allocated.
+  uint64_t brickIndexOf(glm::ivec3 brickCoord) const;
+  uint64_t cellIndexOf(glm::ivec3 cellCoord) const;
+  uint64_t nodeIndexOf(glm::ivec3 nodeCoord) const;
+
+  // bricks
+  glm::vec3 positionOfBrickIndex(uint64_t i) const; // min corner
+
+  // nodes
+  glm::ivec3 nodeCoordOfIndex(uint64_t i) const;
+  glm::vec3 positionOfNodeIndex(uint64_t i) const;
+
+  // cells
+  glm::ivec3 cellCoordOfIndex(uint64_t i) const;
+  glm::vec3 positionOfCellIndex(uint64_t i) const; // center
+
+  // For each brick, the index of each of its (BRICK_SIZE+1)^3 nodes, ordered as flattenBrickNode()
+  const std::vector<uint32_t>& getBrickNodeIndices() const;
+  static uint32_t flattenBrickNode(glm::uvec3 localInds);
+  static uint32_t flattenBrickCell(glm::uvec3 localInds);
+
+  // force the grid to act as if the specified elements are in use (aka enable them for picking, etc)
+  void markNodesAsUsed();
+  void markCellsAsUsed();
+
+  // === Getters and setters for visualization settings
+
+  // Color of the mesh
+  SparseVolumeGrid* setColor(glm::vec3 val);
+  glm::vec3 getColor();
+
+  // Color of edges
+  SparseVolumeGrid* setEdgeColor(glm::vec3 val);
+  glm::vec3 getEdgeColor();
+
+  // Material
+  SparseVolumeGrid* setMaterial(std::string name);
+  std::string getMaterial();
+
+  // Width of the edges. Scaled such that 1 is a reasonable weight for visible edges, but values  1 can be used for
+  // bigger edges. Use 0. to disable.
+  SparseVolumeGrid* setEdgeWidth(double newVal);
+  double getEdgeWidth();
+
+
+private:
+
+  // Field data
+  glm::vec3 origin;
+  glm::vec3 gridSpacing;
+  std::vector<glm::ivec3> brickCoords;
+  glm::uvec3 atlasBrickDim;
+
+  // Occupancy index, from packed brick coordinates to the index of the brick
+  std::unordered_map<uint64_t, uint32_t> brickIndexMap;
+
+  // Nodes
+  std::vector<glm::ivec3> nodeCoords;
+  std::vector<uint32_t> brickNodeInds;
+  void buildNodeIndex();
+
+  // === Storage for managed quantities
+  std::vector<glm::vec3> brickPlaneReferencePositionsData;
+  std::vector<glm::vec3> brickPlaneReferenceNormalsData;
+  std::vector<int32_t> brickPlaneAxisIndsData;
+  std::vector<glm::vec3> brickOriginsData;
+
+  // === Visualization parameters
+  PersistentValue<glm::vec3> color;
+  PersistentValue<glm::vec3> edgeColor;
+  PersistentValue<std::string> material;
+  PersistentValue<float> edgeWidth;
+  PersistentValue<float> cubeSizeFactor;
+
+  // == Compute indices & geometry data
+  void computeBrickPlaneReferenceGeometry();
+  void computeBrickOrigins();
+
+  // Evaluate a batch callable at every node (or cell) position, one chunk at a time
+  template <class Func>
+  std::vector<double> sampleBatchCallable(Func&& func, bool atNodes, bool funcIsThreadSafe);
+
+  // Picking-related
+  // As with VolumeGrid, the whole grid is drawn with a single pick index, and the element is found CPU-side
+  size_t globalPickConstant = INVALID_IND_64;
+  glm::vec3 pickColor;
+  void buildNodeInfoGUI(size_t vInd);
+  void buildCellInfoGUI(size_t cInd);
+  bool nodesHaveBeenUsed = false;
+  bool cellsHaveBeenUsed = false;
+
+
+  // Drawing related things
+  // if nullptr, prepare() (resp. preparePick()) needs to be called
+  std::shared_ptr<render::ShaderProgram> program;
+  std::shared_ptr<render::ShaderProgram> pickProgram;
+
+  // === Helpers
+
+  // Do setup work related to drawing, including allocating openGL data
+  void ensureGridCubeRenderProgramPrepared();
+  void ensureGridCubePickProgramPrepared();
+
+  // === Quantity adder implementations
+  // clang-format off
+
+  SparseVolumeGridNodeScalarQuantity* addNodeScalarQuantityImpl(std::string name, std::vector<double> data, DataType dataType_);
+  SparseVolumeGridCellScalarQuantity* addCellScalarQuantityImpl(std::string name, std::vector<double> data, DataType dataType_);
+
+  // clang-format on
+};
+
+
+// Register a sparse grid made of the bricks with the given integer coordinates (see SparseVolumeGrid)
+template <class T>
+SparseVolumeGrid* registerSparseVolumeGrid(std::string name, glm::vec3 origin, glm::vec3 gridSpacing,
+                                           const T& brickCoords);
+
+// Shorthand to get a sparse volume grid from polyscope
+inline SparseVolumeGrid* getSparseVolumeGrid(std::string name = "");
+inline bool hasSparseVolumeGrid(std::string name = "");
+inline void removeSparseVolumeGrid(std::string name = "", bool errorIfAbsent = false);
+
+} // namespace polyscope
+
+#include "polyscope/sparse_volume_grid.ipp"
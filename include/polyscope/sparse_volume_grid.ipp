@@ -0,0 +1,160 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+namespace polyscope {
+
+inline uint64_t SparseVolumeGrid::nBricks() const { return brickCoords.size(); }
+
+inline uint64_t SparseVolumeGrid::nNodes() const { return nodeCoords.size(); }
+
+inline uint64_t SparseVolumeGrid::nCells() const {
+  return static_cast<uint64_t>(brickCoords.size()) * BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+}
+
+// Field data
+inline glm::vec3 SparseVolumeGrid::getOrigin() const { return origin; }
+inline glm::vec3 SparseVolumeGrid::getGridSpacing() const { return gridSpacing; }
+inline float SparseVolumeGrid::minGridSpacing() const {
+  return std::fmin(std::fmin(gridSpacing[0], gridSpacing[1]), gridSpacing[2]);
+}
+inline const std::vector<glm::ivec3>& SparseVolumeGrid::getBrickCoords() const { return brickCoords; }
+inline const std::vector<uint32_t>& SparseVolumeGrid::getBrickNodeIndices() const { return brickNodeInds; }
+
+inline uint32_t SparseVolumeGrid::flattenBrickNode(glm::uvec3 inds) {
+  return ((BRICK_SIZE + 1) * inds.x + inds.y) * (BRICK_SIZE + 1) + inds.z;
+}
+
+inline uint32_t SparseVolumeGrid::flattenBrickCell(glm::uvec3 inds) {
+  return (BRICK_SIZE * inds.x + inds.y) * BRICK_SIZE + inds.z;
+}
+
+inline glm::vec3 SparseVolumeGrid::positionOfBrickIndex(uint64_t i) const {
+  return origin + glm::vec3(brickCoords[i] * static_cast<int32_t>(BRICK_SIZE)) * gridSpacing;
+}
+
+inline glm::ivec3 SparseVolumeGrid::nodeCoordOfIndex(uint64_t i) const { return nodeCoords[i]; }
+
+inline glm::vec3 SparseVolumeGrid::positionOfNodeIndex(uint64_t i) const {
+  return origin + glm::vec3(nodeCoords[i]) * gridSpacing;
+}
+
+inline glm::ivec3 SparseVolumeGrid::cellCoordOfIndex(uint64_t i) const {
+  const uint64_t cellsPerBrick = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+  uint64_t iBrick = i / cellsPerBrick;
+  uint32_t iLocal = static_cast<uint32_t>(i - iBrick * cellsPerBrick);
+  glm::uvec3 local{iLocal / (BRICK_SIZE * BRICK_SIZE), (iLocal / BRICK_SIZE) % BRICK_SIZE, iLocal % BRICK_SIZE};
+  return brickCoords[iBrick] * static_cast<int32_t>(BRICK_SIZE) + glm::ivec3(local);
+}
+
+inline glm::vec3 SparseVolumeGrid::positionOfCellIndex(uint64_t i) const {
+  return origin + (glm::vec3(cellCoordOfIndex(i)) + 0.5f) * gridSpacing;
+}
+
+inline glm::uvec3 SparseVolumeGrid::getAtlasBrickDim() const { return atlasBrickDim; }
+
+inline glm::uvec3 SparseVolumeGrid::atlasTileOfBrick(uint64_t i) const {
+  uint32_t iBrick = static_cast<uint32_t>(i);
+  return glm::uvec3{iBrick % atlasBrickDim.x, (iBrick / atlasBrickDim.x) % atlasBrickDim.y,
+                    iBrick / (atlasBrickDim.x * atlasBrickDim.y)};
+}
+
+inline glm::uvec3 SparseVolumeGrid::getNodeAtlasSize() const { return atlasBrickDim * (BRICK_SIZE + 1); }
+inline glm::uvec3 SparseVolumeGrid::getCellAtlasSize() const { return atlasBrickDim * BRICK_SIZE; }
+
+
+template <class T>
+SparseVolumeGrid* registerSparseVolumeGrid(std::string name, glm::vec3 origin, glm::vec3 gridSpacing,
+                                           const T& brickCoords) {
+  SparseVolumeGrid* s =
+      new SparseVolumeGrid(name, origin, gridSpacing, standardizeVectorArray<glm::ivec3, 3>(brickCoords));
+  bool success = registerStructure(s);
+  if (!success) {
+    safeDelete(s);
+  }
+  return s;
+}
+
+// Shorthand to get a sparse volume grid from polyscope
+inline SparseVolumeGrid* getSparseVolumeGrid(std::string name) {
+  return dynamic_cast<SparseVolumeGrid*>(getStructure(SparseVolumeGrid::structureTypeName, name));
+}
+inline bool hasSparseVolumeGrid(std::string name) { return hasStructure(SparseVolumeGrid::structureTypeName, name); }
+inline void removeSparseVolumeGrid(std::string name, bool errorIfAbsent) {
+  removeStructure(SparseVolumeGrid::structureTypeName, name, errorIfAbsent);
+}
+
+
+// =====================================================
+// ============== Quantities
+// =====================================================
+
+template <class T>
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGrid::addNodeScalarQuantity(std::string name, const T& values,
+                                                                            DataType dataType_) {
+  validateSize(values, nNodes(), "sparse grid node scalar quantity " + name);
+  return addNodeScalarQuantityImpl(name, standardizeArray<double, T>(values), dataType_);
+}
+
+template <class Func>
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGrid::addNodeScalarQuantityFromCallable(std::string name, Func&& func,
+                                                                                        DataType dataType_,
+                                                                                        bool funcIsThreadSafe) {
+
+  // Boostrap off the batch version
+  auto batchFunc = [&](const float* pos_ptr, float* result_ptr, size_t N) {
+    for (size_t i = 0; i < N; i++) {
+      glm::vec3 pos{pos_ptr[3 * i + 0], pos_ptr[3 * i + 1], pos_ptr[3 * i + 2]};
+      result_ptr[i] = func(pos);
+    }
+  };
+
+  return addNodeScalarQuantityFromBatchCallable(name, batchFunc, dataType_, funcIsThreadSafe);
+}
+
+template <class Func>
+SparseVolumeGridNodeScalarQuantity*
+SparseVolumeGrid::addNodeScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_,
+                                                         bool funcIsThreadSafe) {
+  return addNodeScalarQuantityImpl(name, sampleBatchCallable(func, true, funcIsThreadSafe), dataType_);
+}
+
+template <class T>
+SparseVolumeGridCellScalarQuantity* SparseVolumeGrid::addCellScalarQuantity(std::string name, const T& values,
+                                                                            DataType dataType_) {
+  validateSize(values, nCells(), "sparse grid cell scalar quantity " + name);
+  return addCellScalarQuantityImpl(name, standardizeArray<double, T>(values), dataType_);
+}
+
+template <class Func>
+SparseVolumeGridCellScalarQuantity* SparseVolumeGrid::addCellScalarQuantityFromCallable(std::string name, Func&& func,
+                                                                                        DataType dataType_,
+                                                                                        bool funcIsThreadSafe) {
+
+  // Boostrap off the batch version
+  auto batchFunc = [&](const float* pos_ptr, float* result_ptr, size_t N) {
+    for (size_t i = 0; i < N; i++) {
+      glm::vec3 pos{pos_ptr[3 * i + 0], pos_ptr[3 * i + 1], pos_ptr[3 * i + 2]};
+      result_ptr[i] = func(pos);
+    }
+  };
+
+  return addCellScalarQuantityFromBatchCallable(name, batchFunc, dataType_, funcIsThreadSafe);
+}
+
+template <class Func>
+SparseVolumeGridCellScalarQuantity*
+SparseVolumeGrid::addCellScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_,
+                                                         bool funcIsThreadSafe) {
+  return addCellScalarQuantityImpl(name, sampleBatchCallable(func, false, funcIsThreadSafe), dataType_);
+}
+
+template <class Func>
+std::vector<double> SparseVolumeGrid::sampleBatchCallable(Func&& func, bool atNodes, bool funcIsThreadSafe) {
+  auto positionOf = [&](size_t i) { return atNodes ? positionOfNodeIndex(i) : positionOfCellIndex(i); };
+  return detail::sampleBatchCallable(atNodes ? nNodes() : nCells(), positionOf, func, funcIsThreadSafe,
+                                     CALLABLE_SAMPLE_CHUNK_SIZE);
+}
+
+
+} // namespace polyscope
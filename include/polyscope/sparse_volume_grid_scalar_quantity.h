@@ -0,0 +1,128 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/polyscope.h"
+
+#include "polyscope/affine_remapper.h"
+#include "polyscope/histogram.h"
+#include "polyscope/render/color_maps.h"
+#include "polyscope/scalar_quantity.h"
+#include "polyscope/sparse_volume_grid.h"
+#include "polyscope/surface_mesh.h"
+
+namespace polyscope {
+
+// ========================================================
+// ==========            Node Scalar             ==========
+// ========================================================
+
+class SparseVolumeGridNodeScalarQuantity : public SparseVolumeGridQuantity,
+                                           public ScalarQuantity<SparseVolumeGridNodeScalarQuantity> {
+
+public:
+  SparseVolumeGridNodeScalarQuantity(std::string name, SparseVolumeGrid& grid_, std::vector<double> values_,
+                                     DataType dataType_);
+
+  virtual void draw() override;
+  virtual void buildCustomUI() override;
+  virtual void refresh() override;
+  virtual void buildNodeInfoGUI(size_t ind) override;
+
+  virtual std::string niceName() override;
+
+  virtual bool isDrawingGridcubes() override;
+
+  // The values, gathered in to a texture atlas with one tile per brick (see SparseVolumeGrid)
+  render::ManagedBuffer<float> atlasValues;
+
+  // == Getters and setters
+
+  // Gridcube viz
+
+  SparseVolumeGridNodeScalarQuantity* setGridcubeVizEnabled(bool val);
+  bool getGridcubeVizEnabled();
+
+
+  // Isosurface viz
+
+  SparseVolumeGridNodeScalarQuantity* setIsosurfaceVizEnabled(bool val);
+  bool getIsosurfaceVizEnabled();
+
+  SparseVolumeGridNodeScalarQuantity* setIsosurfaceLevel(float value);
+  float getIsosurfaceLevel();
+
+  SparseVolumeGridNodeScalarQuantity* setIsosurfaceColor(glm::vec3 val);
+  glm::vec3 getIsosurfaceColor();
+
+  SparseVolumeGridNodeScalarQuantity* setSlicePlanesAffectIsosurface(bool val);
+  bool getSlicePlanesAffectIsosurface();
+
+  SurfaceMesh* registerIsosurfaceAsMesh(std::string structureName = "");
+
+protected:
+  std::vector<float> atlasValuesData;
+  uint64_t atlasValuesSourceVersion = 0;
+  void computeAtlasValues();
+
+  // Visualize as a grid of cubes
+  PersistentValue<bool> gridcubeVizEnabled;
+  std::shared_ptr<render::ShaderProgram> gridcubeProgram;
+  void createGridcubeProgram();
+
+  // Visualize as isosurface
+  PersistentValue<bool> isosurfaceVizEnabled;
+  PersistentValue<float> isosurfaceLevel;
+  PersistentValue<glm::vec3> isosurfaceColor;
+  PersistentValue<bool> slicePlanesAffectIsosurface;
+  std::shared_ptr<render::ShaderProgram> isosurfaceProgram;
+  void createIsosurfaceProgram();
+
+  // Marching cubes, brick by brick, skipping bricks which the level set does not pass through
+  void extractIsosurface(std::vector<glm::vec3>& vertices, std::vector<uint32_t>& indices);
+};
+
+
+// ========================================================
+// ==========            Cell Scalar             ==========
+// ========================================================
+
+class SparseVolumeGridCellScalarQuantity : public SparseVolumeGridQuantity,
+                                           public ScalarQuantity<SparseVolumeGridCellScalarQuantity> {
+
+public:
+  SparseVolumeGridCellScalarQuantity(std::string name, SparseVolumeGrid& grid_, std::vector<double> values_,
+                                     DataType dataType_);
+
+  virtual void draw() override;
+  virtual void buildCustomUI() override;
+  virtual void refresh() override;
+  virtual void buildCellInfoGUI(size_t ind) override;
+
+  virtual std::string niceName() override;
+
+  virtual bool isDrawingGridcubes() override;
+
+  // The values, gathered in to a texture atlas with one tile per brick (see SparseVolumeGrid)
+  render::ManagedBuffer<float> atlasValues;
+
+  // == Getters and setters
+
+  // Gridcube viz
+
+  SparseVolumeGridCellScalarQuantity* setGridcubeVizEnabled(bool val);
+  bool getGridcubeVizEnabled();
+
+
+protected:
+  std::vector<float> atlasValuesData;
+  uint64_t atlasValuesSourceVersion = 0;
+  void computeAtlasValues();
+
+  // Visualize as a grid of cubes
+  PersistentValue<bool> gridcubeVizEnabled;
+  std::shared_ptr<render::ShaderProgram> gridcubeProgram;
+  void createGridcubeProgram();
+};
+
+} // namespace polyscope
@@ -0,0 +1,129 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/color_image_quantity.h"
+#include "polyscope/image_stream.h"
+#include "polyscope/persistent_value.h"
+#include "polyscope/scalar_image_quantity.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace polyscope {
+
+// Common machinery for images which are continuously updated by a producer, such as a live camera feed. Mixed in to
+// the scalar and color image quantities, which draw the stream's texture in place of their own buffer.
+//
+// Pixels flow from the producer in to an ImageStream (see image_stream.h), and from there in to a ring of three
+// textures. Each acquired frame is uploaded to the next texture in the ring, so an upload never targets the texture
+// the GPU may still be sampling for the previous frame, and only the region which changed since that texture was last
+// written gets uploaded.
+class StreamingImage {
+
+public:
+  StreamingImage(size_t dimX, size_t dimY, size_t nChannels);
+  virtual ~StreamingImage();
+
+  // The producer handle. A producer thread may keep its own copy of the pointer; pushing to it remains safe even after
+  // the quantity has been removed.
+  std::shared_ptr<ImageStream> getStream();
+
+  // Convenience forwards to the stream (safe to call from any thread)
+  void pushFrame(ImageStreamFormat format, const void* data);
+  void pushSubRect(ImageStreamFormat format, size_t x0, size_t y0, size_t width, size_t height, const void* data);
+
+  // Pull the latest frame from the stream in to the texture ring, returns true if there was a new frame. Called
+  // automatically each time the quantity is drawn.
+  bool updateFromStream();
+
+protected:
+  std::shared_ptr<ImageStream> stream;
+
+  // the texture ring
+  static const size_t TEXTURE_RING_SIZE = 3;
+  std::array<std::shared_ptr<render::TextureBuffer>, TEXTURE_RING_SIZE> textureRing;
+  std::array<ImageStreamRect, TEXTURE_RING_SIZE> textureRingStaleRects; // where each texture lags the current frame
+  size_t currTextureInd = 0;
+
+  render::TextureBuffer& currentTexture(); // the texture holding the current frame, created lazily
+  void ensureTextureRing();
+
+  virtual TextureFormat streamTextureFormat() = 0;
+
+  // hook for subclasses to react to newly acquired pixels
+  virtual void frameAcquired(const ImageStreamRect& changedRect);
+
+  void buildStreamUI();
+};
+
+
+class StreamingScalarImageQuantity : public ScalarImageQuantity, public StreamingImage {
+
+public:
+  StreamingScalarImageQuantity(Structure& parent_, std::string name, size_t dimX, size_t dimY, ImageOrigin imageOrigin,
+                               DataType dataType);
+
+  virtual void draw() override;
+  virtual void buildCustomUI() override;
+  virtual std::string niceName() override;
+
+  // == Setters and getters
+
+  virtual StreamingScalarImageQuantity* setEnabled(bool newEnabled) override;
+
+  // When enabled, the colormap range follows the data range of incoming frames. The rate in (0, 1] is how far the
+  // range moves towards each new frame's range; values below 1 smooth out flicker from noisy frames.
+  StreamingScalarImageQuantity* setAutoRange(bool newVal);
+  bool getAutoRange();
+  StreamingScalarImageQuantity* setAutoRangeRate(float newVal);
+  float getAutoRangeRate();
+
+  // The range of finite values in the current frame
+  std::pair<double, double> getFrameRange();
+
+protected:
+  PersistentValue<bool> autoRange;
+  PersistentValue<float> autoRangeRate;
+
+  // Per-tile min/max of the current frame. Only tiles overlapping the changed region of a new frame are rescanned,
+  // then the (few thousand, for 4K) tiles are merged.
+  static const size_t RANGE_TILE_SIZE = 64;
+  size_t nRangeTilesX, nRangeTilesY;
+  std::vector<std::pair<float, float>> rangeTiles;
+  std::pair<double, double> frameRange;
+  bool haveAcquiredFrame = false;
+
+  // the histogram is rebuilt from a subsample, and only every so often
+  static const size_t HISTOGRAM_FRAME_PERIOD = 30;
+  static const size_t HISTOGRAM_MAX_SAMPLES = 1 << 16;
+  size_t framesSinceHistogram = 0;
+
+  virtual render::TextureBuffer& imageTexture() override;
+  virtual TextureFormat streamTextureFormat() override;
+  virtual void frameAcquired(const ImageStreamRect& changedRect) override;
+  void updateRangeTiles(const ImageStreamRect& changedRect);
+  void rebuildHistogram();
+};
+
+
+class StreamingColorImageQuantity : public ColorImageQuantity, public StreamingImage {
+
+public:
+  StreamingColorImageQuantity(Structure& parent_, std::string name, size_t dimX, size_t dimY, ImageOrigin imageOrigin);
+
+  virtual void draw() override;
+  virtual void buildCustomUI() override;
+  virtual std::string niceName() override;
+
+  // == Setters and getters
+
+  virtual StreamingColorImageQuantity* setEnabled(bool newEnabled) override;
+
+protected:
+  virtual render::TextureBuffer& imageTexture() override;
+  virtual TextureFormat streamTextureFormat() override;
+};
+
+} // namespace polyscope
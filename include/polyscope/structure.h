@@ -19,6 +19,8 @@
 
 namespace polyscope {
 
+class SelectionSet;
+
 
 // A 'structure' in Polyscope terms, is an object with which we can associate data in the UI, such as a point cloud,
 // or a mesh. This in contrast to 'quantities', which we associate with the structures. For instance, a surface mesh
@@ -41,6 +43,11 @@ public:
   virtual void drawDelayed() = 0;
   virtual void drawPick() = 0;
 
+  // Gather the lazily-computed buffers which draw() is about to need, so that the scene can compute them all
+  // concurrently before drawing (see render::computeBuffersConcurrently()). Anything not gathered still gets computed on
+  // demand.
+  virtual void gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes);
+
   // == Add rendering rules
   std::vector<std::string> addStructureRules(std::vector<std::string> initRules);
 
@@ -53,6 +60,19 @@ public:
   virtual void buildSharedStructureUI();  // Draw any UI elements shared between all instances of the structure
   virtual void buildPickUI(size_t localPickID) = 0; // Draw pick UI elements when index localPickID is selected
 
+  // == CPU ray casting
+  // An alternative to drawPick(), which intersects a world-space ray with the structure on the CPU rather than
+  // rendering anything (see pick::rayCast()). Structures which support it override both functions. prepareRayCast()
+  // builds or refits any acceleration data, and must be called on the main thread before rayCast(), which only reads
+  // data and may be called concurrently. On a hit with 0 <= t < tMax, rayCast() returns true and sets tHit and the local
+  // pick index of the element which was hit, which is what the pick buffer would have held at that point.
+  virtual void prepareRayCast();
+  virtual bool rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd);
+
+  // Called when the region selection set of this structure changes (see pick::selectRect()), so that the structure can
+  // show it, typically as quantities which are 1 on the selected elements.
+  virtual void updateSelectionQuantities(const SelectionSet& selection);
+
   // = Identifying data
   const std::string name; // should be unique amongst registered structures with this type
   std::string uniquePrefix();
@@ -65,6 +85,13 @@ public:
   float lengthScale();                            // get characteristic length
   virtual bool hasExtents();                      // bounding box and length scale are only meaningful if true
 
+  // Optionally, supply a conservative object-space bounding box for the structure. While set, it is used in place of
+  // scanning the structure's data whenever the bounds are updated, which is useful for very large structures whose
+  // geometry changes frequently. The length scale is taken to be the diagonal of the box.
+  Structure* setObjectSpaceBoundsHint(glm::vec3 bboxMin, glm::vec3 bboxMax);
+  void clearObjectSpaceBoundsHint();
+  bool hasObjectSpaceBoundsHint();
+
   // = Basic state
   virtual std::string typeName() = 0;
 
@@ -91,6 +118,7 @@ public:
   // Selection tools
   virtual Structure* setEnabled(bool newEnabled);
   bool isEnabled();
+  virtual bool hasVisualImpact() override; // enabled, and shown in some viewport
   void enableIsolate();                      // enable this structure, disable all of same type
   void setEnabledAllOfType(bool newEnabled); // enable/disable all structures of this type
 
@@ -116,6 +144,10 @@ protected:
   // Widget that wraps the transform
   TransformationGizmo transformGizmo;
 
+  // Helpers for implementing rayCast()
+  bool isCulledBySlicePlanes(glm::vec3 worldPos); // would the slice planes cut away this point of the structure?
+  float objectTransformScale(); // how much the transform scales lengths (exact for uniform scaling, approximate otherwise)
+
   PersistentValue<bool> cullWholeElements;
 
   PersistentValue<std::vector<std::string>> ignoredSlicePlaneNames;
@@ -127,6 +159,14 @@ protected:
   std::tuple<glm::vec3, glm::vec3> objectSpaceBoundingBox;
   float objectSpaceLengthScale;
   virtual void updateObjectSpaceBounds() = 0;
+
+  // Helpers for implementing updateObjectSpaceBounds()
+  bool applyObjectSpaceBoundsHint(); // if a hint is set, use it for the bounds and return true
+  void computeObjectSpaceBoundsFromPoints(const std::vector<glm::vec3>& points); // (parallel over the points)
+
+private:
+  bool haveObjectSpaceBoundsHint = false;
+  std::tuple<glm::vec3, glm::vec3> objectSpaceBoundsHint;
 };
 
 
@@ -146,6 +186,8 @@ class QuantityS;
 class FloatingQuantity;
 class ScalarImageQuantity;
 class ColorImageQuantity;
+class StreamingScalarImageQuantity;
+class StreamingColorImageQuantity;
 class DepthRenderImageQuantity;
 class ColorRenderImageQuantity;
 class ScalarRenderImageQuantity;
@@ -217,6 +259,15 @@ public:
   ColorImageQuantity* addColorAlphaImageQuantity(std::string name, size_t dimX, size_t dimY, const T& values_rgba,
                                                  ImageOrigin imageOrigin = ImageOrigin::UpperLeft);
 
+  // Images which are continuously updated, e.g. from a camera feed. They start out all zeros; push frames via the
+  // quantity's getStream() handle, from any thread.
+  StreamingScalarImageQuantity* addStreamingScalarImageQuantity(std::string name, size_t dimX, size_t dimY,
+                                                                ImageOrigin imageOrigin = ImageOrigin::UpperLeft,
+                                                                DataType type = DataType::STANDARD);
+
+  StreamingColorImageQuantity* addStreamingColorImageQuantity(std::string name, size_t dimX, size_t dimY,
+                                                              ImageOrigin imageOrigin = ImageOrigin::UpperLeft);
+
   template <class T1, class T2>
   DepthRenderImageQuantity* addDepthRenderImageQuantity(std::string name, size_t dimX, size_t dimY, const T1& depthData,
                                                         const T2& normalData,
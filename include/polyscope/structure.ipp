@@ -318,6 +318,11 @@ ScalarImageQuantity* createScalarImageQuantity(Structure& parent, std::string na
                                                DataType dataType);
 ColorImageQuantity* createColorImageQuantity(Structure& parent, std::string name, size_t dimX, size_t dimY,
                                              const std::vector<glm::vec4>& data, ImageOrigin imageOrigin);
+StreamingScalarImageQuantity* createStreamingScalarImageQuantity(Structure& parent, std::string name, size_t dimX,
+                                                                 size_t dimY, ImageOrigin imageOrigin,
+                                                                 DataType dataType);
+StreamingColorImageQuantity* createStreamingColorImageQuantity(Structure& parent, std::string name, size_t dimX,
+                                                               size_t dimY, ImageOrigin imageOrigin);
 DepthRenderImageQuantity* createDepthRenderImage(Structure& parent, std::string name, size_t dimX, size_t dimY,
                                                  const std::vector<float>& depthData,
                                                  const std::vector<glm::vec3>& normalData, ImageOrigin imageOrigin);
@@ -365,6 +370,27 @@ ColorImageQuantity* QuantityStructure<S>::addColorImageQuantityImpl(std::string
   return q;
 }
 
+template <typename S>
+StreamingScalarImageQuantity* QuantityStructure<S>::addStreamingScalarImageQuantity(std::string name, size_t dimX,
+                                                                                    size_t dimY,
+                                                                                    ImageOrigin imageOrigin,
+                                                                                    DataType type) {
+  checkForQuantityWithNameAndDeleteOrError(name);
+  StreamingScalarImageQuantity* q = createStreamingScalarImageQuantity(*this, name, dimX, dimY, imageOrigin, type);
+  addQuantity(q);
+  return q;
+}
+
+template <typename S>
+StreamingColorImageQuantity* QuantityStructure<S>::addStreamingColorImageQuantity(std::string name, size_t dimX,
+                                                                                  size_t dimY,
+                                                                                  ImageOrigin imageOrigin) {
+  checkForQuantityWithNameAndDeleteOrError(name);
+  StreamingColorImageQuantity* q = createStreamingColorImageQuantity(*this, name, dimX, dimY, imageOrigin);
+  addQuantity(q);
+  return q;
+}
+
 template <typename S>
 DepthRenderImageQuantity* QuantityStructure<S>::addDepthRenderImageQuantityImpl(
     std::string name, size_t dimX, size_t dimY, const std::vector<float>& depthData,
@@ -6,7 +6,9 @@
 #include <vector>
 
 #include "polyscope/affine_remapper.h"
+#include "polyscope/bvh.h"
 #include "polyscope/color_management.h"
+#include "polyscope/connected_components.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/managed_buffer.h"
@@ -79,6 +81,10 @@ public:
   virtual void draw() override;
   virtual void drawDelayed() override;
   virtual void drawPick() override;
+  virtual void prepareRayCast() override;
+  virtual bool rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) override;
+  virtual void updateSelectionQuantities(const SelectionSet& selection) override;
+  virtual void gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes) override;
   virtual void updateObjectSpaceBounds() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
@@ -163,6 +169,12 @@ public:
   // special quantity-related methods
   SurfaceParameterizationQuantity* getParameterization(std::string name);
 
+  // === Connected components
+  // Components of the vertices, connected through the faces of the mesh (each face is in the component of its vertices)
+  ConnectedComponents computeConnectedComponents();
+  // Show each component in a distinct color
+  SurfaceVertexColorQuantity* addConnectedComponentsQuantity(std::string name = "connected components");
+
 
   // === Make a one-time selection
   long long int selectVertex();
@@ -282,6 +294,10 @@ public:
   void setMeshPickAttributes(render::ShaderProgram& p);
   void setSurfaceMeshUniforms(render::ShaderProgram& p);
 
+  // Index attributes for the pick shaders, set by setMeshPickAttributes(). These are kept across refreshes, and only
+  // rebuilt when the connectivity data they were built from changes.
+  std::shared_ptr<render::AttributeBuffer> pickVertexIndsBuffer, pickHalfedgeIndsBuffer, pickCornerIndsBuffer;
+
 
   // === ~DANGER~ experimental/unsupported functions
 
@@ -369,12 +385,21 @@ private:
   // Within each set, uses the implicit ordering from the mesh data structure
   // These starts are LOCAL indices, indexing elements only with the mesh
   size_t facePickIndStart, edgePickIndStart, halfedgePickIndStart, cornerPickIndStart;
+  size_t computePickIndStarts(); // sets the starts above, returns the total number of pick indices
   void buildVertexInfoGui(size_t vInd);
   void buildFaceInfoGui(size_t fInd);
   void buildEdgeInfoGui(size_t eInd);
   void buildHalfedgeInfoGui(size_t heInd);
   void buildCornerInfoGui(size_t cInd);
 
+  // Keys for the pick index attributes: {triangle vertex version, source data version, source type}
+  std::array<uint64_t, 3> pickVertexIndsKey, pickHalfedgeIndsKey, pickCornerIndsKey;
+
+  // Ray casting, against the triangulated faces
+  BVH rayCastBVH;
+  uint64_t rayCastBVHPositionsVersion = 0;
+  size_t pickIndOfTriangleHit(size_t iTri, glm::vec3 baryCoord); // matches the pick shaders
+
   // ==== Gui implementation details
 
   std::shared_ptr<render::ShaderProgram> program;
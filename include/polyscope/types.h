@@ -11,11 +11,13 @@ enum class UpDir { XUp = 0, YUp, ZUp, NegXUp, NegYUp, NegZUp };
 enum class FrontDir { XFront = 0, YFront, ZFront, NegXFront, NegYFront, NegZFront };
 enum class BackgroundView { None = 0 };
 enum class ProjectionMode { Perspective = 0, Orthographic };
-enum class TransparencyMode { None = 0, Simple, Pretty };
+enum class TransparencyMode { None = 0, Simple, Pretty, Weighted };
 enum class GroundPlaneMode { None, Tile, TileReflection, ShadowOnly };
 enum class BackFacePolicy { Identical, Different, Custom, Cull };
 
 enum class PointRenderMode { Sphere = 0, Quad };
+enum class PickBackend { Render = 0, RayCast };
+enum class SelectionMode { Replace = 0, Add, Remove };
 enum class MeshElement { VERTEX = 0, FACE, EDGE, HALFEDGE, CORNER };
 enum class MeshShadeStyle { Smooth = 0, Flat, TriFlat };
 enum class VolumeMeshElement { VERTEX = 0, EDGE, FACE, CELL };
@@ -42,6 +42,7 @@ void VectorQuantityBase<QuantityT>::buildVectorUI() {
     if (ImGui::SliderFloat("Length", vectorLengthMult.get().getValuePtr(), 0.0, .1, "%.5f",
                            ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
       vectorLengthMult.manuallyChanged();
+      internal::sceneGeometryVersion++;
       requestRedraw();
     }
   }
@@ -49,6 +50,7 @@ void VectorQuantityBase<QuantityT>::buildVectorUI() {
   if (ImGui::SliderFloat("Radius", vectorRadius.get().getValuePtr(), 0.0, .1, "%.5f",
                          ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
     vectorRadius.manuallyChanged();
+    internal::sceneGeometryVersion++;
     requestRedraw();
   }
 
@@ -61,6 +63,7 @@ void VectorQuantityBase<QuantityT>::buildVectorUI() {
 template <typename QuantityT>
 QuantityT* VectorQuantityBase<QuantityT>::setVectorLengthScale(double newLength, bool isRelative) {
   vectorLengthMult = ScaledValue<double>(newLength, isRelative);
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return &quantity;
 }
@@ -73,6 +76,7 @@ template <typename QuantityT>
 QuantityT* VectorQuantityBase<QuantityT>::setVectorLengthRange(double newLength) {
   vectorLengthRange = newLength;
   vectorLengthRangeManuallySet = true;
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return &quantity;
 }
@@ -84,6 +88,7 @@ double VectorQuantityBase<QuantityT>::getVectorLengthRange() {
 template <typename QuantityT>
 QuantityT* VectorQuantityBase<QuantityT>::setVectorRadius(double val, bool isRelative) {
   vectorRadius = ScaledValue<double>(val, isRelative);
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return &quantity;
 }
@@ -184,12 +189,8 @@ template <typename QuantityT>
 void VectorQuantity<QuantityT>::updateMaxLength() {
   if (this->vectorLengthRangeManuallySet) return; // do nothing if it has already been set manually
 
-  vectors.ensureHostBufferPopulated();
-  float maxLength = 0.;
-  for (const glm::vec3& vec : vectors.data) {
-    maxLength = std::max(maxLength, glm::length(vec));
-  }
-  this->vectorLengthRange = maxLength;
+  // the reduction is cached, and runs on the device if that is where the vectors live
+  this->vectorLengthRange = std::max(0., vectors.getReduction().maxVal);
 }
 
 template <typename QuantityT>
@@ -302,12 +303,7 @@ template <typename QuantityT>
 void TangentVectorQuantity<QuantityT>::updateMaxLength() {
   if (this->vectorLengthRangeManuallySet) return; // do nothing if it has already been set manually
 
-  tangentVectors.ensureHostBufferPopulated();
-  float maxLength = 0.;
-  for (const glm::vec2& vec : tangentVectors.data) {
-    maxLength = std::max(maxLength, glm::length(vec));
-  }
-  this->vectorLengthRange = maxLength;
+  this->vectorLengthRange = std::max(0., tangentVectors.getReduction().maxVal);
 }
 
 template <typename QuantityT>
@@ -57,6 +57,8 @@ extern std::array<float, 4> bgColor;
 extern glm::mat4x4 viewMat;
 extern double fov; // in the y direction
 extern ProjectionMode projectionMode;
+extern glm::vec2 projectionJitter; // sub-pixel offset of the projection in normalized device coordinates, set during
+                                   // rendering by temporal anti-aliasing and zero otherwise
 
 // "Flying" view
 extern bool midflight;
@@ -106,6 +108,7 @@ void lookAt(glm::vec3 cameraLocation, glm::vec3 target, glm::vec3 upDir, bool fl
 glm::mat4 getCameraViewMatrix();
 void setCameraViewMatrix(glm::mat4 newMat);
 glm::mat4 getCameraPerspectiveMatrix();
+glm::mat4 getUnjitteredCameraPerspectiveMatrix(); // without projectionJitter, to compare cameras across frames
 glm::vec3 getCameraWorldPosition();
 void getCameraFrame(glm::vec3& lookDir, glm::vec3& upDir, glm::vec3& rightDir);
 
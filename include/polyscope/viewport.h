@@ -0,0 +1,164 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/render/engine.h"
+#include "polyscope/structure.h"
+#include "polyscope/types.h"
+#include "polyscope/view.h"
+
+#include <array>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace polyscope {
+
+// A viewport is a region of the window which shows the scene from its own camera. Several viewports can show the same
+// structures side-by-side: they all draw the same GPU buffers with the same shader programs, so nothing is uploaded or
+// compiled more than once. Each frame, the viewports are rendered one after another in to the shared scene buffers,
+// and the result of each is kept in a texture of its own, which is then composited in to the window.
+//
+// While any viewports exist, they replace the usual full-window view. Mouse navigation and picking act on the viewport
+// under the mouse.
+//
+// Each viewport has its own camera, background color, ground plane setting, and set of visible structures. Other
+// settings are shared. Temporal anti-aliasing and other frame-to-frame reuse in the renderer apply only to the main
+// view. Viewports of different sizes resize the shared scene buffers as they are rendered, so equal sizes (e.g. from
+// arrangeViewportsInGrid()) are cheapest.
+class Viewport {
+
+public:
+  Viewport(std::string name, glm::vec4 region);
+  ~Viewport();
+
+  // No copy constructor/assignment
+  Viewport(const Viewport&) = delete;
+  Viewport& operator=(const Viewport&) = delete;
+
+  const std::string name;
+
+  // == Layout
+
+  // The region of the window covered by the viewport, as {x, y, width, height} fractions of the window size. The origin
+  // is the upper-left corner, like screen coordinates.
+  void setRegion(glm::vec4 newRegion);
+  glm::vec4 getRegion();
+
+  // The region in buffer pixels {x, y, width, height} (upper-left origin), for the current window size
+  glm::ivec4 getPixelRegion();
+
+  // Window coordinates, like ImGui mouse positions
+  bool containsScreenCoords(glm::vec2 screenCoords);
+  glm::vec2 toLocalScreenCoords(glm::vec2 screenCoords); // relative to the viewport's upper-left corner
+
+  // == Camera
+
+  void setViewMatrix(glm::mat4 newViewMat);
+  glm::mat4 getViewMatrix();
+  void setFieldOfView(double newFov); // in degrees, in the y direction
+  double getFieldOfView();
+  void setProjectionMode(ProjectionMode newMode);
+  ProjectionMode getProjectionMode();
+  void lookAt(glm::vec3 cameraLocation, glm::vec3 target);
+  void resetCameraToHomeView();
+
+  // == Appearance
+
+  void setBackgroundColor(std::array<float, 4> newColor);
+  std::array<float, 4> getBackgroundColor();
+  void setGroundPlaneEnabled(bool newVal); // whether options::groundPlaneMode is drawn in this viewport
+  bool getGroundPlaneEnabled();
+
+  // Which structures are drawn in this viewport (all of them, by default)
+  void setStructureVisible(Structure* s, bool visible);
+  bool isStructureVisible(Structure* s);
+  void setAllStructuresVisible();
+
+  // == Picking
+
+  // Pick at the given pixel within the viewport (upper-left origin, buffer pixels)
+  std::pair<Structure*, size_t> pick(glm::ivec2 pixelCoords);
+
+  // == Results
+
+  // The most recent render of the viewport: linear color with premultiplied alpha, before tone mapping, at SSAA
+  // resolution
+  std::shared_ptr<render::TextureBuffer> getColorTexture(); // null if the viewport has not been rendered yet
+
+  // Copy the final scene buffer in to this viewport's texture (called by the render loop)
+  void storeRenderedScene();
+
+private:
+  glm::vec4 region;
+
+  // camera & appearance
+  glm::mat4 viewMat;
+  double fov;
+  ProjectionMode projectionMode;
+  double nearClipRatio, farClipRatio;
+  std::array<float, 4> bgColor;
+  bool groundPlaneEnabled = true;
+
+  // structures which are not drawn, by {type name, name}
+  std::set<std::pair<std::string, std::string>> hiddenStructures;
+
+  std::shared_ptr<render::TextureBuffer> colorTexture;
+  std::shared_ptr<render::FrameBuffer> frameBuffer;
+
+  friend class ViewportScope;
+};
+
+// While one of these exists, the global view state (camera, buffer size, background color...) is that of the given
+// viewport. Changes made to the camera within the scope are kept by the viewport when the scope ends.
+class ViewportScope {
+public:
+  ViewportScope(Viewport& viewport);
+  ~ViewportScope();
+
+  ViewportScope(const ViewportScope&) = delete;
+  ViewportScope& operator=(const ViewportScope&) = delete;
+
+private:
+  Viewport& viewport;
+  Viewport* prevViewport;
+
+  // the global state which was replaced
+  glm::mat4 viewMat;
+  double fov;
+  ProjectionMode projectionMode;
+  double nearClipRatio, farClipRatio;
+  std::array<float, 4> bgColor;
+  int bufferWidth, bufferHeight, windowWidth, windowHeight;
+  bool enableTAA, groundPlaneTemporalReuse;
+  float transparencyPeelTimeBudgetMs;
+};
+
+// == Manage viewports
+
+Viewport* addViewport(std::string name, glm::vec4 region = glm::vec4{0., 0., 1., 1.});
+Viewport* getViewport(std::string name);
+bool hasViewport(std::string name);
+void removeViewport(std::string name, bool errorIfAbsent = false);
+void removeAllViewports();
+
+// Tile the window with the viewports, in the order they were added. With nColumns <= 0, the grid is as close to square
+// as possible.
+void arrangeViewportsInGrid(int nColumns = -1);
+
+// The viewport which is currently being rendered or receiving input, or null for the main view
+Viewport* getCurrentViewport();
+
+// Should the structure be drawn in the viewport which is currently being rendered?
+bool isStructureVisibleInCurrentViewport(Structure* s);
+
+namespace state {
+
+// all viewports, in the order they were added
+extern std::vector<std::unique_ptr<Viewport>> viewports;
+
+} // namespace state
+
+} // namespace polyscope
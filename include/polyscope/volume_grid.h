@@ -3,7 +3,9 @@
 #pragma once
 
 #include "polyscope/affine_remapper.h"
+#include "polyscope/batch_callable.h"
 #include "polyscope/color_management.h"
+#include "polyscope/parallel.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/standardize_data_array.h"
@@ -12,6 +14,7 @@
 #include "polyscope/volume_grid_quantity.h"
 #include "polyscope/volume_grid_scalar_quantity.h"
 
+#include <algorithm>
 #include <vector>
 
 namespace polyscope {
@@ -62,23 +65,31 @@ public:
   // clang-format off
 
 
+  // The callable variants sample a function at the node (or cell) positions. The plain version takes func(glm::vec3)
+  // -> float, and the batch version takes func(const float* positions, float* results, size_t N), with positions packed
+  // as xyzxyz... The batch function is called many times, on chunks of at most CALLABLE_SAMPLE_CHUNK_SIZE points, so
+  // memory use stays bounded no matter how big the grid is. If the function is safe to call concurrently, pass
+  // funcIsThreadSafe = true to sample chunks in parallel.
+
   template <class T>
   VolumeGridNodeScalarQuantity* addNodeScalarQuantity(std::string name, const T& values, DataType dataType_ = DataType::STANDARD);
   
   template <class Func>
-  VolumeGridNodeScalarQuantity* addNodeScalarQuantityFromCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD);
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantityFromCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
   
   template <class Func>
-  VolumeGridNodeScalarQuantity* addNodeScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD);
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
   
   template <class T>
   VolumeGridCellScalarQuantity* addCellScalarQuantity(std::string name, const T& values, DataType dataType_ = DataType::STANDARD);
   
   template <class Func>
-  VolumeGridCellScalarQuantity* addCellScalarQuantityFromCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD);
+  VolumeGridCellScalarQuantity* addCellScalarQuantityFromCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
   
   template <class Func>
-  VolumeGridCellScalarQuantity* addCellScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD);
+  VolumeGridCellScalarQuantity* addCellScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD, bool funcIsThreadSafe = false);
+
+  static const size_t CALLABLE_SAMPLE_CHUNK_SIZE = 1 << 16;
 
   
   // Rendering helpers used by quantities
@@ -158,6 +169,10 @@ private:
 
   // == Compute indices & geometry data
   void computeGridPlaneReferenceGeometry();
+
+  // Evaluate a batch callable at every node (or cell) position, one chunk at a time (see the callable adders above)
+  template <class Func>
+  std::vector<double> sampleBatchCallable(Func&& func, bool atNodes, bool funcIsThreadSafe);
   
   // Picking-related
   // Order of indexing: vertices, cells
@@ -185,8 +200,8 @@ private:
   // === Quantity adder implementations
   // clang-format off
   
-  VolumeGridNodeScalarQuantity* addNodeScalarQuantityImpl(std::string name, const std::vector<double>& data, DataType dataType_);
-  VolumeGridCellScalarQuantity* addCellScalarQuantityImpl(std::string name, const std::vector<double>& data, DataType dataType_);
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantityImpl(std::string name, std::vector<double> data, DataType dataType_);
+  VolumeGridCellScalarQuantity* addCellScalarQuantityImpl(std::string name, std::vector<double> data, DataType dataType_);
 
   // clang-format on
 };
@@ -108,38 +108,25 @@ VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantity(std::string name
 
 template <class Func>
 VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityFromCallable(std::string name, Func&& func,
-                                                                            DataType dataType_) {
+                                                                            DataType dataType_, bool funcIsThreadSafe) {
 
   // Boostrap off the batch version
-  auto batchFunc = [&](float* pos_ptr, float* result_ptr, size_t N) {
+  auto batchFunc = [&](const float* pos_ptr, float* result_ptr, size_t N) {
     for (size_t i = 0; i < N; i++) {
       glm::vec3 pos{pos_ptr[3 * i + 0], pos_ptr[3 * i + 1], pos_ptr[3 * i + 2]};
       result_ptr[i] = func(pos);
     }
   };
 
-  return addNodeScalarQuantityFromBatchCallable(name, batchFunc, dataType_);
+  return addNodeScalarQuantityFromBatchCallable(name, batchFunc, dataType_, funcIsThreadSafe);
 }
 
 
 template <class Func>
 VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityFromBatchCallable(std::string name, Func&& func,
-                                                                                 DataType dataType_) {
-  // Build list of points to query
-  std::vector<float> queries(3 * nNodes());
-  std::vector<float> result(nNodes());
-
-  // Sample to grid
-  for (size_t i = 0; i < nNodes(); i++) {
-    glm::vec3 pos = positionOfNodeIndex(i);
-    queries[3 * i + 0] = pos.x;
-    queries[3 * i + 1] = pos.y;
-    queries[3 * i + 2] = pos.z;
-  }
-
-  func(&queries.front(), &result.front(), static_cast<size_t>(nNodes()));
-
-  return addNodeScalarQuantity(name, result, dataType_);
+                                                                                 DataType dataType_,
+                                                                                 bool funcIsThreadSafe) {
+  return addNodeScalarQuantityImpl(name, sampleBatchCallable(func, true, funcIsThreadSafe), dataType_);
 }
 
 template <class T>
@@ -151,38 +138,32 @@ VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantity(std::string name
 
 template <class Func>
 VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityFromCallable(std::string name, Func&& func,
-                                                                            DataType dataType_) {
+                                                                            DataType dataType_, bool funcIsThreadSafe) {
 
   // Boostrap off the batch version
-  auto batchFunc = [&](float* pos_ptr, float* result_ptr, size_t N) {
+  auto batchFunc = [&](const float* pos_ptr, float* result_ptr, size_t N) {
     for (size_t i = 0; i < N; i++) {
       glm::vec3 pos{pos_ptr[3 * i + 0], pos_ptr[3 * i + 1], pos_ptr[3 * i + 2]};
       result_ptr[i] = func(pos);
     }
   };
 
-  return addCellScalarQuantityFromBatchCallable(name, batchFunc, dataType_);
+  return addCellScalarQuantityFromBatchCallable(name, batchFunc, dataType_, funcIsThreadSafe);
 }
 
 
 template <class Func>
 VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityFromBatchCallable(std::string name, Func&& func,
-                                                                                 DataType dataType_) {
-  // Build list of points to query
-  std::vector<float> queries(3 * nCells());
-  std::vector<float> result(nCells());
-
-  // Sample to grid
-  for (size_t i = 0; i < nCells(); i++) {
-    glm::vec3 pos = positionOfCellIndex(i);
-    queries[3 * i + 0] = pos.x;
-    queries[3 * i + 1] = pos.y;
-    queries[3 * i + 2] = pos.z;
-  }
-
-  func(&queries.front(), &result.front(), static_cast<size_t>(nCells()));
-
-  return addCellScalarQuantity(name, result, dataType_);
+                                                                                 DataType dataType_,
+                                                                                 bool funcIsThreadSafe) {
+  return addCellScalarQuantityImpl(name, sampleBatchCallable(func, false, funcIsThreadSafe), dataType_);
+}
+
+template <class Func>
+std::vector<double> VolumeGrid::sampleBatchCallable(Func&& func, bool atNodes, bool funcIsThreadSafe) {
+  auto positionOf = [&](size_t i) { return atNodes ? positionOfNodeIndex(i) : positionOfCellIndex(i); };
+  return detail::sampleBatchCallable(atNodes ? nNodes() : nCells(), positionOf, func, funcIsThreadSafe,
+                                     CALLABLE_SAMPLE_CHUNK_SIZE);
 }
 
 
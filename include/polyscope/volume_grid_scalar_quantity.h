@@ -20,10 +20,10 @@ namespace polyscope {
 class VolumeGridNodeScalarQuantity : public VolumeGridQuantity, public ScalarQuantity<VolumeGridNodeScalarQuantity> {
 
 public:
-  VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_, const std::vector<double>& values_,
-                               DataType dataType_);
+  VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_, std::vector<double> values_, DataType dataType_);
 
   virtual void draw() override;
+  virtual void drawDelayed() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
   virtual void buildNodeInfoGUI(size_t ind) override;
@@ -56,6 +56,42 @@ public:
 
   SurfaceMesh* registerIsosurfaceAsMesh(std::string structureName = "");
 
+
+  // Volume viz
+  // The values are ray marched on the GPU, with color from the colormap and opacity from a linear ramp. All of these
+  // settings are uniforms, so changing them does not require any work on the host.
+
+  VolumeGridNodeScalarQuantity* setVolumeVizEnabled(bool val);
+  bool getVolumeVizEnabled();
+
+  // Opacity is 0 at `start` and 1 at `end` (in data units), linear in between. If start > end, it decreases instead.
+  VolumeGridNodeScalarQuantity* setVolumeOpacityRamp(float start, float end);
+  std::pair<float, float> getVolumeOpacityRamp();
+
+  // Optical depth of one grid cell at full opacity
+  VolumeGridNodeScalarQuantity* setVolumeDensity(float val);
+  float getVolumeDensity();
+
+  // Distance between samples along a ray, relative to the smallest grid spacing
+  VolumeGridNodeScalarQuantity* setVolumeStepSize(float val);
+  float getVolumeStepSize();
+
+  // Also stop rays at the first crossing of the isosurface level, and shade it as an opaque surface
+  VolumeGridNodeScalarQuantity* setVolumeIsosurfaceEnabled(bool val);
+  bool getVolumeIsosurfaceEnabled();
+
+  // The smallest and largest node value in each block of VOLUME_BLOCK_SIZE^3 cells, used to skip empty space.
+  // Recomputed only when the values change.
+  static const uint32_t VOLUME_BLOCK_SIZE = 8;
+  static const int VOLUME_MAX_STEPS = 8192;
+  render::ManagedBuffer<float> blockMinValues;
+  render::ManagedBuffer<float> blockMaxValues;
+  glm::uvec3 getVolumeBlockDim();
+
+  // CPU version of the GPU ray marcher, for testing. The ray is in the grid's object space (the same space as
+  // getBoundMin()), and the result is a premultiplied color. An isosurface hit is composited with its unlit color.
+  glm::vec4 marchVolumeRay(glm::vec3 rayStart, glm::vec3 rayDir, bool skipEmptySpace = true);
+
 protected:
   // Visualize as a grid of cubes
   PersistentValue<bool> gridcubeVizEnabled;
@@ -72,7 +108,19 @@ protected:
   void createIsosurfaceProgram();
 
   // Visualize as raymarched volume
-  // TODO
+  PersistentValue<bool> volumeVizEnabled;
+  PersistentValue<float> volumeOpacityStart;
+  PersistentValue<float> volumeOpacityEnd;
+  PersistentValue<float> volumeDensity;
+  PersistentValue<float> volumeStepSize;
+  PersistentValue<bool> volumeIsosurfaceEnabled;
+  std::shared_ptr<render::ShaderProgram> volumeProgram;
+  void createVolumeProgram();
+
+  std::vector<float> blockMinValuesData;
+  std::vector<float> blockMaxValuesData;
+  uint64_t blockValuesSourceVersion = 0;
+  void computeBlockValues();
 };
 
 
@@ -83,8 +131,7 @@ protected:
 class VolumeGridCellScalarQuantity : public VolumeGridQuantity, public ScalarQuantity<VolumeGridCellScalarQuantity> {
 
 public:
-  VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_, const std::vector<double>& values_,
-                               DataType dataType_);
+  VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_, std::vector<double> values_, DataType dataType_);
 
   virtual void draw() override;
   virtual void buildCustomUI() override;
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "polyscope/affine_remapper.h"
+#include "polyscope/bvh.h"
 #include "polyscope/color_management.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/standardize_data_array.h"
@@ -57,6 +58,10 @@ public:
   virtual void draw() override;
   virtual void drawDelayed() override;
   virtual void drawPick() override;
+  virtual void prepareRayCast() override;
+  virtual bool rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) override;
+  virtual void updateSelectionQuantities(const SelectionSet& selection) override;
+  virtual void gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes) override;
   virtual void updateObjectSpaceBounds() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
@@ -82,6 +87,10 @@ public:
   render::ManagedBuffer<glm::vec3> faceNormals;
   render::ManagedBuffer<glm::vec3> cellCenters;
 
+  // the vertex at each corner of the tets, one buffer per corner [nTets]. Volumetric visualizations (slices, level sets)
+  // draw per-tet data as indexed views through these, which are shared by all programs drawing the same data.
+  std::array<render::ManagedBuffer<uint32_t>, 4> tetCornerVertexInds;
+
   // === Quantity-related
   // clang-format off
 
@@ -138,6 +147,12 @@ public:
   void computeTets();    // fills tet buffer
   void ensureHaveTets(); //  ensure the tet buffer is filled (but don't rebuild if already done)
 
+  // Find the tets whose extent along `normal` overlaps [planeMin, planeMax], that is, every tet which could be cut by a
+  // plane dot(normal, x) = c for some c in that range. Positions are in object space, like the slice shaders. This uses
+  // a bounding volume hierarchy over the tets, which is built on first use and rebuilt when the vertex positions change,
+  // so the cost scales with the number of tets near the plane rather than the size of the mesh.
+  void gatherTetsInSlab(glm::vec3 normal, float planeMin, float planeMax, std::vector<uint32_t>& tetInds);
+
   // === Member variables ===
   static const std::string structureTypeName;
 
@@ -201,6 +216,7 @@ private:
   // other internally-computed geometry
   std::vector<glm::vec3> faceNormalsData;
   std::vector<glm::vec3> cellCentersData;
+  std::array<std::vector<uint32_t>, 4> tetCornerVertexIndsData;
 
   // Visualization settings
   PersistentValue<glm::vec3> color;
@@ -231,6 +247,16 @@ private:
   /// == Compute indices & geometry data
   void computeFaceNormals();
   void computeCellCenters();
+  void computeTetCornerVertexInds(int iCorner);
+
+  // Bounding volume hierarchy over the tets, for slicing (see gatherTetsInSlab())
+  BVH tetBVH;
+  uint64_t tetBVHPositionsVersion = 0;
+  void ensureHaveTetBVH();
+
+  // Bounding volume hierarchy over the triangulated faces, for CPU ray casting (see prepareRayCast())
+  BVH rayCastBVH;
+  uint64_t rayCastBVHPositionsVersion = 0;
 
   // Gui implementation details
 
@@ -51,6 +51,7 @@ public:
   void setLevelSetVisibleQuantity(std::string name);
   void setLevelSetUniforms(render::ShaderProgram& p);
   void fillLevelSetData(render::ShaderProgram& p);
+  std::shared_ptr<render::ShaderProgram> createLevelSetProgram();
   std::shared_ptr<render::ShaderProgram> levelSetProgram;
 
   void fillSliceColorBuffers(render::ShaderProgram& p);
@@ -0,0 +1,163 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/bvh.h"
+
+#include "polyscope/messages.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace polyscope {
+
+void BVH::build(const std::vector<std::array<glm::vec3, 2>>& primBoxes) {
+  nodes.clear();
+  primOrder.resize(primBoxes.size());
+  std::iota(primOrder.begin(), primOrder.end(), 0);
+  if (primBoxes.empty()) return;
+
+  nodes.reserve(4 * (primBoxes.size() / LEAF_SIZE + 1));
+  buildNode(primBoxes, 0, static_cast<uint32_t>(primBoxes.size()));
+}
+
+void BVH::buildNode(const std::vector<std::array<glm::vec3, 2>>& primBoxes, uint32_t start, uint32_t count) {
+
+  // NOTE: children get appended below, so hold on to the index of this node rather than a reference
+  size_t iNode = nodes.size();
+  nodes.emplace_back();
+
+  glm::vec3 boxMin{std::numeric_limits<float>::infinity()};
+  glm::vec3 boxMax{-std::numeric_limits<float>::infinity()};
+  glm::vec3 centerMin{std::numeric_limits<float>::infinity()};
+  glm::vec3 centerMax{-std::numeric_limits<float>::infinity()};
+  for (uint32_t i = start; i < start + count; i++) {
+    const std::array<glm::vec3, 2>& box = primBoxes[primOrder[i]];
+    boxMin = glm::min(boxMin, box[0]);
+    boxMax = glm::max(boxMax, box[1]);
+    glm::vec3 center = 0.5f * (box[0] + box[1]);
+    centerMin = glm::min(centerMin, center);
+    centerMax = glm::max(centerMax, center);
+  }
+
+  if (count <= LEAF_SIZE) {
+    nodes[iNode] = Node{boxMin, boxMax, start, count};
+    return;
+  }
+
+  // Split in half at the median primitive along the longest axis of the primitive centers
+  glm::vec3 centerExtent = centerMax - centerMin;
+  int axis = 0;
+  if (centerExtent.y > centerExtent[axis]) axis = 1;
+  if (centerExtent.z > centerExtent[axis]) axis = 2;
+  uint32_t nFirst = count / 2;
+  std::nth_element(primOrder.begin() + start, primOrder.begin() + start + nFirst, primOrder.begin() + start + count,
+                   [&](uint32_t a, uint32_t b) {
+                     return primBoxes[a][0][axis] + primBoxes[a][1][axis] <
+                            primBoxes[b][0][axis] + primBoxes[b][1][axis];
+                   });
+
+  buildNode(primBoxes, start, nFirst);
+  uint32_t iSecondChild = static_cast<uint32_t>(nodes.size());
+  buildNode(primBoxes, start + nFirst, count - nFirst);
+  nodes[iNode] = Node{boxMin, boxMax, iSecondChild, 0};
+}
+
+void BVH::refit(const std::vector<std::array<glm::vec3, 2>>& primBoxes) {
+  if (primBoxes.size() != primOrder.size()) {
+    exception("BVH refit() has " + std::to_string(primBoxes.size()) + " primitives, but it was built with " +
+              std::to_string(primOrder.size()));
+  }
+
+  // Children always come after their parent, so a reverse sweep visits them first
+  for (size_t iNode = nodes.size(); iNode-- > 0;) {
+    Node& node = nodes[iNode];
+    if (node.count == 0) {
+      const Node& childA = nodes[iNode + 1];
+      const Node& childB = nodes[node.start];
+      node.boxMin = glm::min(childA.boxMin, childB.boxMin);
+      node.boxMax = glm::max(childA.boxMax, childB.boxMax);
+    } else {
+      node.boxMin = glm::vec3{std::numeric_limits<float>::infinity()};
+      node.boxMax = glm::vec3{-std::numeric_limits<float>::infinity()};
+      for (uint32_t i = node.start; i < node.start + node.count; i++) {
+        node.boxMin = glm::min(node.boxMin, primBoxes[primOrder[i]][0]);
+        node.boxMax = glm::max(node.boxMax, primBoxes[primOrder[i]][1]);
+      }
+    }
+  }
+}
+
+void BVH::clear() {
+  nodes.clear();
+  primOrder.clear();
+}
+
+bool BVH::empty() const { return nodes.empty(); }
+
+size_t BVH::nPrimitives() const { return primOrder.size(); }
+
+
+float rayTriangleIntersection(glm::vec3 rayStart, glm::vec3 rayDir, glm::vec3 pA, glm::vec3 pB, glm::vec3 pC,
+                              glm::vec3& baryCoord) {
+  // Moller-Trumbore
+  const float inf = std::numeric_limits<float>::infinity();
+  glm::vec3 eAB = pB - pA;
+  glm::vec3 eAC = pC - pA;
+  glm::vec3 pVec = glm::cross(rayDir, eAC);
+  float det = glm::dot(eAB, pVec);
+  if (det == 0. || !std::isfinite(det)) return inf;
+  float invDet = 1.f / det;
+
+  glm::vec3 tVec = rayStart - pA;
+  float u = glm::dot(tVec, pVec) * invDet;
+  if (u < 0. || u > 1.) return inf;
+
+  glm::vec3 qVec = glm::cross(tVec, eAB);
+  float v = glm::dot(rayDir, qVec) * invDet;
+  if (v < 0. || u + v > 1.) return inf;
+
+  baryCoord = glm::vec3{1.f - u - v, u, v};
+  return glm::dot(eAC, qVec) * invDet;
+}
+
+float raySphereIntersection(glm::vec3 rayStart, glm::vec3 rayDir, glm::vec3 center, float radius) {
+  glm::vec3 offset = rayStart - center;
+  float a = glm::dot(rayDir, rayDir);
+  float b = glm::dot(offset, rayDir);
+  float c = glm::dot(offset, offset) - radius * radius;
+  float disc = b * b - a * c;
+  if (disc < 0. || a == 0.) return std::numeric_limits<float>::infinity();
+  float sqrtDisc = std::sqrt(disc);
+  float t = (-b - sqrtDisc) / a;
+  if (t < 0.) t = (-b + sqrtDisc) / a; // starting inside the sphere
+  return t;
+}
+
+float rayCylinderIntersection(glm::vec3 rayStart, glm::vec3 rayDir, glm::vec3 pA, glm::vec3 pB, float radius) {
+  const float inf = std::numeric_limits<float>::infinity();
+  glm::vec3 axis = pB - pA;
+  float axisLen2 = glm::dot(axis, axis);
+  if (axisLen2 == 0.) return inf;
+
+  // Work with the components perpendicular to the axis
+  glm::vec3 offset = rayStart - pA;
+  glm::vec3 dirPerp = rayDir - axis * (glm::dot(rayDir, axis) / axisLen2);
+  glm::vec3 offsetPerp = offset - axis * (glm::dot(offset, axis) / axisLen2);
+  float a = glm::dot(dirPerp, dirPerp);
+  float b = glm::dot(offsetPerp, dirPerp);
+  float c = glm::dot(offsetPerp, offsetPerp) - radius * radius;
+  float disc = b * b - a * c;
+  if (disc < 0. || a == 0.) return inf;
+  float sqrtDisc = std::sqrt(disc);
+
+  // Take the first hit which lies between the ends
+  for (float t : {(-b - sqrtDisc) / a, (-b + sqrtDisc) / a}) {
+    if (t < 0.) continue;
+    float s = glm::dot(offset + t * rayDir, axis) / axisLen2;
+    if (s >= 0. && s <= 1.) return t;
+  }
+  return inf;
+}
+
+} // namespace polyscope
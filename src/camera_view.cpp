@@ -5,6 +5,7 @@
 #include "polyscope/file_helpers.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "polyscope/point_cloud_color_quantity.h"
@@ -79,9 +80,11 @@ void CameraView::draw() {
 
   // Draw the quantities
   for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
   for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 }
@@ -152,7 +155,6 @@ void CameraView::preparePick() {
   if (pickStart == INVALID_IND) {
     size_t pickCount = 1;
     pickStart = pick::requestPickBufferRange(this, pickCount);
-    pickColor = pick::indToVec(pickStart);
   }
 
   // Create a new pick program
@@ -274,21 +276,25 @@ void CameraView::fillCameraWidgetGeometry(render::ShaderProgram* nodeProgram, re
     addPolygon({triangleTop, triangleRight, triangleLeft});
 
     pickFrameProgram->setAttribute("a_vertexPositions", positions);
-    // pickFrameProgram->setAttribute("a_vertexNormals", normals); // unused
+    if (pickFrameProgram->hasAttribute("a_vertexNormals")) {
+      // unused by the pick shader, but the program may still declare it
+      pickFrameProgram->setAttribute("a_vertexNormals", normals);
+    }
     pickFrameProgram->setAttribute("a_barycoord", bcoord);
 
+    // The whole widget is one pick element, so every index is 0 relative to the start
     size_t nFaces = 7;
-    std::vector<glm::vec3> faceColor(3 * nFaces, pickColor);
-    std::vector<std::array<glm::vec3, 3>> tripleColors(3 * nFaces,
-                                                       std::array<glm::vec3, 3>{pickColor, pickColor, pickColor});
-
+    std::vector<uint32_t> faceInds(3 * nFaces, 0);
+    std::vector<glm::uvec3> vertexInds(3 * nFaces, glm::uvec3{0});
 
-    std::shared_ptr<render::AttributeBuffer> tripleColorsBuff =
-        render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-    tripleColorsBuff->setData(tripleColors);
+    std::shared_ptr<render::AttributeBuffer> vertexIndsBuff =
+        render::engine->generateAttributeBuffer(RenderDataType::Vector3UInt);
+    vertexIndsBuff->setData(vertexInds);
 
-    pickFrameProgram->setAttribute("a_vertexColors", tripleColorsBuff);
-    pickFrameProgram->setAttribute("a_faceColor", faceColor);
+    pickFrameProgram->setAttribute("a_vertexInds", vertexIndsBuff);
+    pickFrameProgram->setAttribute("a_faceInd", faceInds);
+    pickFrameProgram->setUniform("u_vertexPickStart", pick::indToDigits(pickStart));
+    pickFrameProgram->setUniform("u_facePickStart", pick::indToDigits(pickStart));
     if (wantsCullPosition()) {
       pickFrameProgram->setAttribute("a_cullPos", cullPos);
     }
@@ -380,6 +386,7 @@ void CameraView::buildCustomOptionsUI() {
 }
 
 void CameraView::updateObjectSpaceBounds() {
+  if (applyObjectSpaceBoundsHint()) return;
 
   // bounding box is just the camera root location
   glm::vec3 cameraPos = params.getPosition();
@@ -47,7 +47,7 @@ void ColorImageQuantity::prepareFullscreen() {
   fullscreenProgram->setAttribute("a_position", render::engine->screenTrianglesCoords());
   // TODO throughout polyscope we discard the shared pointer when adding textures/attributes to programs... should we
   // just track the shared pointer?
-  fullscreenProgram->setTextureFromBuffer("t_image", colors.getRenderTextureBuffer().get());
+  fullscreenProgram->setTextureFromBuffer("t_image", &imageTexture());
 }
 
 void ColorImageQuantity::prepareBillboard() {
@@ -59,7 +59,7 @@ void ColorImageQuantity::prepareBillboard() {
                                                     getIsPremultiplied() ? "" : "TEXTURE_PREMULTIPLY_OUT"},
                                                    render::ShaderReplacementDefaults::Process);
   billboardProgram->setAttribute("a_position", render::engine->screenTrianglesCoords());
-  billboardProgram->setTextureFromBuffer("t_image", colors.getRenderTextureBuffer().get());
+  billboardProgram->setTextureFromBuffer("t_image", &imageTexture());
 }
 
 void ColorImageQuantity::showFullscreen() {
@@ -73,6 +73,7 @@ void ColorImageQuantity::showFullscreen() {
 
   // Set uniforms
   fullscreenProgram->setUniform("u_transparency", getTransparency());
+  fullscreenProgram->setTextureFromBuffer("t_image", &imageTexture());
   render::engine->setTonemapUniforms(*fullscreenProgram);
 
   fullscreenProgram->draw();
@@ -92,9 +93,9 @@ void ColorImageQuantity::showInImGuiWindow() {
 
   // since we are showing directly from the user's texture, we need to resposect the upper left ordering
   if (imageOrigin == ImageOrigin::LowerLeft) {
-    ImGui::Image(colors.getRenderTextureBuffer()->getNativeHandle(), ImVec2(w, h), ImVec2(0, 1), ImVec2(1, 0));
+    ImGui::Image(imageTexture().getNativeHandle(), ImVec2(w, h), ImVec2(0, 1), ImVec2(1, 0));
   } else if (imageOrigin == ImageOrigin::UpperLeft) {
-    ImGui::Image(colors.getRenderTextureBuffer()->getNativeHandle(), ImVec2(w, h));
+    ImGui::Image(imageTexture().getNativeHandle(), ImVec2(w, h));
   }
 
   ImGui::End();
@@ -115,6 +116,7 @@ void ColorImageQuantity::showInBillboard(glm::vec3 center, glm::vec3 upVec, glm:
   billboardProgram->setUniform("u_billboardCenter", center);
   billboardProgram->setUniform("u_billboardUp", upVec);
   billboardProgram->setUniform("u_billboardRight", rightVec);
+  billboardProgram->setTextureFromBuffer("t_image", &imageTexture());
   render::engine->setTonemapUniforms(*billboardProgram);
 
   render::engine->setBackfaceCull(false);
@@ -125,6 +127,7 @@ void ColorImageQuantity::showInBillboard(glm::vec3 center, glm::vec3 upVec, glm:
   render::engine->applyTransparencySettings();
 }
 
+render::TextureBuffer& ColorImageQuantity::imageTexture() { return *colors.getRenderTextureBuffer(); }
 
 void ColorImageQuantity::refresh() {
   fullscreenProgram.reset();
@@ -66,6 +66,11 @@ int iUniqueColor = 0;
 
 glm::vec3 getNextUniqueColor() { return indexOffsetHue(uniqueColorBase, iUniqueColor++); }
 
+glm::vec3 getIndexedUniqueColor(size_t index) {
+  // (past 2^24 the hues are no longer distinguishable anyway, so just wrap around)
+  return indexOffsetHue(uniqueColorBase, static_cast<int>(index % (1 << 24)));
+}
+
 glm::vec3 RGBtoHSV(glm::vec3 rgb) {
   glm::vec3 hsv;
   ImGui::ColorConvertRGBtoHSV(rgb[0], rgb[1], rgb[2], hsv[0], hsv[1], hsv[2]);
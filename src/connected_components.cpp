@@ -0,0 +1,254 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/connected_components.h"
+
+#include "polyscope/color_management.h"
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace polyscope {
+
+size_t ConnectedComponents::nComponents() const { return sizes.size(); }
+
+std::vector<bool> ConnectedComponents::mask(size_t minSize, size_t maxCount) const {
+  // Components are sorted by decreasing size, so the kept ones are a prefix
+  size_t nKeep = std::min(maxCount, nComponents());
+  while (nKeep > 0 && sizes[nKeep - 1] < minSize) nKeep--;
+
+  // (std::vector<bool> packs bits, so neighboring elements can't be written from different threads)
+  std::vector<bool> result(labels.size());
+  for (size_t i = 0; i < labels.size(); i++) {
+    result[i] = labels[i] < nKeep;
+  }
+  return result;
+}
+
+std::vector<double> ConnectedComponents::indicator(size_t minSize, size_t maxCount) const {
+  size_t nKeep = std::min(maxCount, nComponents());
+  while (nKeep > 0 && sizes[nKeep - 1] < minSize) nKeep--;
+
+  std::vector<double> result(labels.size());
+  parallelForRanges(labels.size(), [&](size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) result[i] = labels[i] < nKeep ? 1. : 0.;
+  });
+  return result;
+}
+
+std::vector<glm::vec3> ConnectedComponents::colors() const {
+  std::vector<glm::vec3> componentColors(nComponents());
+  for (size_t iComp = 0; iComp < nComponents(); iComp++) {
+    componentColors[iComp] = getIndexedUniqueColor(iComp);
+  }
+
+  std::vector<glm::vec3> result(labels.size());
+  parallelForRanges(labels.size(), [&](size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) result[i] = componentColors[labels[i]];
+  });
+  return result;
+}
+
+ConnectedComponents labelConnectedComponents(ParallelDisjointSets& sets) {
+
+  size_t n = sets.size();
+  ConnectedComponents result;
+  result.labels.resize(n);
+  std::vector<size_t>& labels = result.labels;
+
+  // Find the root of every element. The root of each set is its smallest element, so it is easy to spot.
+  std::vector<size_t> roots(n);
+  std::vector<std::tuple<size_t, size_t>> ranges = parallelRanges(n);
+  std::vector<size_t> rangeRootCounts(ranges.size(), 0);
+  parallelInvoke(ranges.size(), [&](size_t iRange) {
+    size_t count = 0;
+    for (size_t i = std::get<0>(ranges[iRange]); i < std::get<1>(ranges[iRange]); i++) {
+      roots[i] = sets.find(i);
+      if (roots[i] == i) count++;
+    }
+    rangeRootCounts[iRange] = count;
+  });
+
+  // Number the roots in order, which numbers the components by their smallest element
+  std::vector<size_t> rangeRootStarts(ranges.size(), 0);
+  size_t nComponents = 0;
+  for (size_t iRange = 0; iRange < ranges.size(); iRange++) {
+    rangeRootStarts[iRange] = nComponents;
+    nComponents += rangeRootCounts[iRange];
+  }
+  parallelInvoke(ranges.size(), [&](size_t iRange) {
+    size_t iComp = rangeRootStarts[iRange];
+    for (size_t i = std::get<0>(ranges[iRange]); i < std::get<1>(ranges[iRange]); i++) {
+      if (roots[i] == i) labels[i] = iComp++;
+    }
+  });
+
+  // Every other element takes the number of its root, and counts towards the size of its component. Runs of elements in
+  // the same component are common, so each run is counted with a single atomic add.
+  std::vector<std::atomic<size_t>> counts(nComponents);
+  parallelInvoke(ranges.size(), [&](size_t iRange) {
+    size_t runComp = INVALID_IND;
+    size_t runLength = 0;
+    for (size_t i = std::get<0>(ranges[iRange]); i < std::get<1>(ranges[iRange]); i++) {
+      size_t iComp = labels[roots[i]];
+      if (roots[i] != i) labels[i] = iComp;
+      if (iComp != runComp) {
+        if (runLength > 0) counts[runComp].fetch_add(runLength, std::memory_order_relaxed);
+        runComp = iComp;
+        runLength = 0;
+      }
+      runLength++;
+    }
+    if (runLength > 0) counts[runComp].fetch_add(runLength, std::memory_order_relaxed);
+  });
+  std::vector<size_t>().swap(roots);
+
+  // Renumber by decreasing size. This is a counting sort on the sizes, which keeps components of equal size in order of
+  // their smallest element. (There are often millions of components, most of them tiny, so a comparison sort is slow.)
+  size_t maxSize = 0;
+  for (size_t iComp = 0; iComp < nComponents; iComp++) {
+    maxSize = std::max(maxSize, counts[iComp].load(std::memory_order_relaxed));
+  }
+  std::vector<size_t> sizeStarts(maxSize + 2, 0); // first new index for each size, larger sizes first
+  for (size_t iComp = 0; iComp < nComponents; iComp++) {
+    sizeStarts[maxSize - counts[iComp].load(std::memory_order_relaxed) + 1]++;
+  }
+  for (size_t i = 1; i < sizeStarts.size(); i++) sizeStarts[i] += sizeStarts[i - 1];
+  std::vector<size_t> renumber(nComponents);
+  result.sizes.resize(nComponents);
+  for (size_t iComp = 0; iComp < nComponents; iComp++) {
+    size_t compSize = counts[iComp].load(std::memory_order_relaxed);
+    size_t iNew = sizeStarts[maxSize - compSize]++;
+    renumber[iComp] = iNew;
+    result.sizes[iNew] = compSize;
+  }
+  parallelForRanges(n, [&](size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) labels[i] = renumber[labels[i]];
+  });
+
+  return result;
+}
+
+ConnectedComponents computeEpsilonConnectedComponents(const std::vector<glm::vec3>& points, float epsilon) {
+
+  if (!(epsilon > 0.)) {
+    exception("connected components distance must be positive, got " + std::to_string(epsilon));
+  }
+
+  size_t n = points.size();
+  ParallelDisjointSets sets(n);
+  if (n == 0) return labelConnectedComponents(sets);
+
+  // Bucket the points in to a grid of cells with width epsilon. Points within epsilon of each other are always in the
+  // same or adjacent cells.
+  std::array<glm::vec3, 2> bbox = parallelReduce<std::array<glm::vec3, 2>>(
+      n, {points[0], points[0]},
+      [&](size_t iStart, size_t iEnd) {
+        std::array<glm::vec3, 2> b{points[iStart], points[iStart]};
+        for (size_t i = iStart; i < iEnd; i++) {
+          b[0] = glm::min(b[0], points[i]);
+          b[1] = glm::max(b[1], points[i]);
+        }
+        return b;
+      },
+      [](const std::array<glm::vec3, 2>& a, const std::array<glm::vec3, 2>& b) {
+        return std::array<glm::vec3, 2>{glm::min(a[0], b[0]), glm::max(a[1], b[1])};
+      });
+
+  // Cell coordinates are packed in to a single 64-bit key, 21 bits per axis
+  const uint64_t bitsPerAxis = 21;
+  const uint64_t maxCellsPerAxis = uint64_t(1) << bitsPerAxis;
+  glm::vec3 extent = bbox[1] - bbox[0];
+  for (int i = 0; i < 3; i++) {
+    if (!std::isfinite(extent[i])) exception("connected components: point positions must be finite");
+    if (std::floor(extent[i] / epsilon) + 1 >= maxCellsPerAxis) {
+      exception("connected components distance " + std::to_string(epsilon) +
+                " is too small relative to the extent of the points");
+    }
+  }
+  auto cellKey = [&](glm::uvec3 c) {
+    return (uint64_t(c.x) << (2 * bitsPerAxis)) | (uint64_t(c.y) << bitsPerAxis) | uint64_t(c.z);
+  };
+
+  std::vector<std::pair<uint64_t, size_t>> keyedPoints(n);
+  parallelForRanges(n, [&](size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) {
+      glm::uvec3 c{glm::floor((points[i] - bbox[0]) / epsilon)};
+      keyedPoints[i] = {cellKey(c), i};
+    }
+  });
+  std::sort(keyedPoints.begin(), keyedPoints.end());
+
+  // Ranges of the sorted points in each occupied cell
+  std::vector<uint64_t> cellKeys;
+  std::vector<size_t> cellStarts;
+  for (size_t i = 0; i < n; i++) {
+    if (i == 0 || keyedPoints[i].first != keyedPoints[i - 1].first) {
+      cellKeys.push_back(keyedPoints[i].first);
+      cellStarts.push_back(i);
+    }
+  }
+  cellStarts.push_back(n);
+
+  // Test each cell against itself and the half of its neighbors which come after it, so each pair of cells is only
+  // tested once
+  std::vector<glm::ivec3> neighborOffsets;
+  for (int dx = -1; dx <= 1; dx++) {
+    for (int dy = -1; dy <= 1; dy++) {
+      for (int dz = -1; dz <= 1; dz++) {
+        if (std::make_tuple(dx, dy, dz) > std::make_tuple(0, 0, 0)) neighborOffsets.emplace_back(dx, dy, dz);
+      }
+    }
+  }
+
+  float epsilon2 = epsilon * epsilon;
+  uint64_t axisMask = maxCellsPerAxis - 1;
+  parallelForRanges(
+      cellKeys.size(),
+      [&](size_t iCellStart, size_t iCellEnd) {
+        for (size_t iCell = iCellStart; iCell < iCellEnd; iCell++) {
+          uint64_t key = cellKeys[iCell];
+          glm::ivec3 c(static_cast<int>(key >> (2 * bitsPerAxis)), static_cast<int>((key >> bitsPerAxis) & axisMask),
+                       static_cast<int>(key & axisMask));
+
+          // Pairs within the cell
+          for (size_t iA = cellStarts[iCell]; iA < cellStarts[iCell + 1]; iA++) {
+            for (size_t iB = iA + 1; iB < cellStarts[iCell + 1]; iB++) {
+              glm::vec3 d = points[keyedPoints[iA].second] - points[keyedPoints[iB].second];
+              if (glm::dot(d, d) <= epsilon2) sets.merge(keyedPoints[iA].second, keyedPoints[iB].second);
+            }
+          }
+
+          // Pairs with neighboring cells
+          for (glm::ivec3 offset : neighborOffsets) {
+            glm::ivec3 cN = c + offset;
+            if (glm::any(glm::lessThan(cN, glm::ivec3(0))) ||
+                glm::any(glm::greaterThanEqual(cN, glm::ivec3(static_cast<int>(maxCellsPerAxis))))) {
+              continue;
+            }
+            std::vector<uint64_t>::const_iterator it =
+                std::lower_bound(cellKeys.begin(), cellKeys.end(), cellKey(glm::uvec3(cN)));
+            if (it == cellKeys.end() || *it != cellKey(glm::uvec3(cN))) continue;
+            size_t iCellN = it - cellKeys.begin();
+
+            for (size_t iA = cellStarts[iCell]; iA < cellStarts[iCell + 1]; iA++) {
+              for (size_t iB = cellStarts[iCellN]; iB < cellStarts[iCellN + 1]; iB++) {
+                glm::vec3 d = points[keyedPoints[iA].second] - points[keyedPoints[iB].second];
+                if (glm::dot(d, d) <= epsilon2) sets.merge(keyedPoints[iA].second, keyedPoints[iB].second);
+              }
+            }
+          }
+        }
+      },
+      64);
+
+  return labelConnectedComponents(sets);
+}
+
+} // namespace polyscope
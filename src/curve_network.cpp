@@ -2,20 +2,31 @@
 
 #include "polyscope/curve_network.h"
 
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "imgui.h"
 
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 namespace polyscope {
 
 // Initialize statics
 const std::string CurveNetwork::structureTypeName = "Curve Network";
 
+namespace {
+// When drawing polyline strips, degree-2 nodes whose polyline bends more sharply than this (cosine of the turning
+// angle) still get a joint sphere, to cover the gap between the adjacent cylinders
+const float polylineJointMinBendCos = 0.995;
+} // namespace
+
 // Constructor
 CurveNetwork::CurveNetwork(std::string name, std::vector<glm::vec3> nodes_, std::vector<std::array<size_t, 2>> edges_)
     : // clang-format off
@@ -24,10 +35,13 @@ CurveNetwork::CurveNetwork(std::string name, std::vector<glm::vec3> nodes_, std:
       edgeTailInds(this, uniquePrefix() + "edgeTailInds", edgeTailIndsData),
       edgeTipInds(this, uniquePrefix() + "edgeTipInds", edgeTipIndsData),
       edgeCenters(this, uniquePrefix() + "edgeCenters", edgeCentersData, std::bind(&CurveNetwork::computeEdgeCenters, this)),         
+      polylineStripInds(this, uniquePrefix() + "polylineStripInds", polylineStripIndsData, std::bind(&CurveNetwork::computePolylineStripInds, this)),
+      polylineJointInds(this, uniquePrefix() + "polylineJointInds", polylineJointIndsData, std::bind(&CurveNetwork::computePolylineJointInds, this)),
       nodePositionsData(std::move(nodes_)), 
       color(uniquePrefix() + "#color", getNextUniqueColor()), 
       radius(uniquePrefix() + "#radius", relativeValue(0.005)),
-      material(uniquePrefix() + "#material", "clay")
+      material(uniquePrefix() + "#material", "clay"),
+      polylineStrips(uniquePrefix() + "#polylineStrips", false)
 // clang-format on
 {
 
@@ -59,6 +73,19 @@ CurveNetwork::CurveNetwork(std::string name, std::vector<glm::vec3> nodes_, std:
     nodeDegrees[nB]++;
   }
 
+  // the buffers which each compute function reads
+  edgeCenters.addComputeDependency(nodePositions);
+  edgeCenters.addComputeDependency(edgeTailInds);
+  edgeCenters.addComputeDependency(edgeTipInds);
+  polylineStripInds.addComputeDependency(edgeTailInds);
+  polylineStripInds.addComputeDependency(edgeTipInds);
+  polylineJointInds.addComputeDependency(nodePositions);
+  polylineJointInds.addComputeDependency(edgeTailInds);
+  polylineJointInds.addComputeDependency(edgeTipInds);
+
+  // staged positions need the same follow-up as updateNodePositions()
+  nodePositions.stagedDataFunc = std::bind(&CurveNetwork::recomputeGeometryIfPopulated, this);
+
   updateObjectSpaceBounds();
 }
 
@@ -96,6 +123,14 @@ void CurveNetwork::setCurveNetworkEdgeUniforms(render::ShaderProgram& p) {
   p.setUniform("u_radius", computeRadiusMultiplierUniform());
 }
 
+void CurveNetwork::gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes) {
+  // the index buffers used by prepare(), when drawing polylines
+  if (usePolylineStrips()) {
+    polylineStripInds.gatherPendingCompute(computes);
+    polylineJointInds.gatherPendingCompute(computes);
+  }
+}
+
 void CurveNetwork::draw() {
   if (!isEnabled()) {
     return;
@@ -129,9 +164,11 @@ void CurveNetwork::draw() {
 
   // Draw the quantities
   for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
   for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 }
@@ -166,6 +203,10 @@ void CurveNetwork::drawPick() {
   setCurveNetworkEdgeUniforms(*edgePickProgram);
   setCurveNetworkNodeUniforms(*nodePickProgram);
 
+  if (pickUsesPolylineStrips) {
+    edgePickProgram->setUniform("u_edgePickStart", pick::indToDigits(polylineEdgePickStart));
+  }
+
   edgePickProgram->draw();
   nodePickProgram->draw();
 }
@@ -212,7 +253,7 @@ void CurveNetwork::prepare() {
     );
 
 
-  edgeProgram = render::engine->requestShader("RAYCAST_CYLINDER", 
+  edgeProgram = render::engine->requestShader(usePolylineStrips() ? "RAYCAST_CYLINDER_STRIP" : "RAYCAST_CYLINDER", 
       render::engine->addMaterialRules(getMaterial(),
         addCurveNetworkEdgeRules(
           {"SHADE_BASECOLOR"}
@@ -225,8 +266,13 @@ void CurveNetwork::prepare() {
   render::engine->setMaterial(*edgeProgram, getMaterial());
 
   // Fill out the geometry data for the programs
-  fillNodeGeometryBuffers(*nodeProgram);
-  fillEdgeGeometryBuffers(*edgeProgram);
+  if (usePolylineStrips()) {
+    fillPolylineJointGeometryBuffers(*nodeProgram);
+    fillPolylineStripGeometryBuffers(*edgeProgram);
+  } else {
+    fillNodeGeometryBuffers(*nodeProgram);
+    fillEdgeGeometryBuffers(*edgeProgram);
+  }
 }
 
 void CurveNetwork::preparePick() {
@@ -242,6 +288,37 @@ void CurveNetwork::preparePick() {
   size_t totalPickElements = nNodes() + nEdges();
   size_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
 
+  // Polyline strips compute edge pick indices in the shader from the (32-bit) primitive ID. When drawing polylines, the
+  // edge pick indices are in strip segment order rather than edge order; buildPickUI() maps them back to edges.
+  pickUsesPolylineStrips =
+      usePolylineStrips() && (pickStart + totalPickElements) <= std::numeric_limits<uint32_t>::max();
+  polylineEdgePickStart = pickStart + nNodes();
+
+  if (pickUsesPolylineStrips) {
+
+    // Packed node indices, which are shared by the joints and strips
+    std::vector<glm::vec3> pickColors;
+    pickColors.reserve(nNodes());
+    for (size_t i = pickStart; i < pickStart + nNodes(); i++) {
+      pickColors.push_back(pick::indToVec(i));
+    }
+
+    nodePickProgram =
+        render::engine->requestShader("RAYCAST_SPHERE", addCurveNetworkNodeRules({"SPHERE_PROPAGATE_COLOR"}),
+                                      render::ShaderReplacementDefaults::Pick);
+    polylineJointInds.ensureHostBufferPopulated();
+    nodePickProgram->setAttribute("a_color", gather(pickColors, polylineJointInds.data));
+    fillPolylineJointGeometryBuffers(*nodePickProgram);
+
+    edgePickProgram = render::engine->requestShader(
+        "RAYCAST_CYLINDER_STRIP", addCurveNetworkEdgeRules({"CYLINDER_STRIP_PROPAGATE_PICK"}),
+        render::ShaderReplacementDefaults::Pick);
+    edgePickProgram->setAttribute("a_color", pickColors);
+    fillPolylineStripGeometryBuffers(*edgePickProgram);
+
+    return;
+  }
+
   { // Set up node picking program
     nodePickProgram =
         render::engine->requestShader("RAYCAST_SPHERE", addCurveNetworkNodeRules({"SPHERE_PROPAGATE_COLOR"}),
@@ -311,6 +388,18 @@ void CurveNetwork::fillEdgeGeometryBuffers(render::ShaderProgram& program) {
   }
 }
 
+void CurveNetwork::fillPolylineStripGeometryBuffers(render::ShaderProgram& program) {
+  program.setAttribute("a_position", nodePositions.getRenderAttributeBuffer());
+  program.setIndex(polylineStripInds.getRenderAttributeBuffer());
+  program.setPrimitiveRestartIndex(INVALID_IND_32);
+}
+
+void CurveNetwork::fillPolylineJointGeometryBuffers(render::ShaderProgram& program) {
+  program.setAttribute("a_position", nodePositions.getIndexedRenderAttributeBuffer(polylineJointInds));
+}
+
+bool CurveNetwork::usePolylineStrips() { return getPolylineStrips() && nodeRadiusQuantityName == ""; }
+
 void CurveNetwork::computeEdgeCenters() {
   nodePositions.ensureHostBufferPopulated();
   edgeTailInds.ensureHostBufferPopulated();
@@ -328,6 +417,120 @@ void CurveNetwork::computeEdgeCenters() {
   edgeCenters.markHostBufferUpdated();
 }
 
+void CurveNetwork::computePolylineStripInds() {
+  edgeTailInds.ensureHostBufferPopulated();
+  edgeTipInds.ensureHostBufferPopulated();
+
+  // Gather the edges incident on each node
+  std::vector<size_t> adjStart(nNodes() + 1, 0);
+  for (size_t iE = 0; iE < nEdges(); iE++) {
+    adjStart[edgeTailInds.data[iE] + 1]++;
+    adjStart[edgeTipInds.data[iE] + 1]++;
+  }
+  for (size_t iN = 0; iN < nNodes(); iN++) {
+    adjStart[iN + 1] += adjStart[iN];
+  }
+  std::vector<uint32_t> adjEdges(2 * nEdges());
+  std::vector<size_t> adjFill(adjStart.begin(), adjStart.end() - 1);
+  for (size_t iE = 0; iE < nEdges(); iE++) {
+    adjEdges[adjFill[edgeTailInds.data[iE]]++] = iE;
+    adjEdges[adjFill[edgeTipInds.data[iE]]++] = iE;
+  }
+
+  std::vector<uint32_t>& stripInds = polylineStripInds.data;
+  stripInds.clear();
+  stripInds.reserve(2 * nEdges());
+  polylineStripEdgeInds.clear();
+  polylineStripEdgeInds.reserve(nEdges());
+  std::vector<char> edgeUsed(nEdges(), false);
+
+  // Walk from a starting node along a chain of degree-2 nodes, emitting one strip
+  auto walkStrip = [&](uint32_t startNode, uint32_t startEdge) {
+    if (!stripInds.empty()) {
+      stripInds.push_back(INVALID_IND_32);
+    }
+    stripInds.push_back(startNode);
+
+    uint32_t currNode = startNode;
+    uint32_t currEdge = startEdge;
+    while (currEdge != INVALID_IND_32) {
+      edgeUsed[currEdge] = true;
+      polylineStripEdgeInds.push_back(currEdge);
+      uint32_t eTail = edgeTailInds.data[currEdge];
+      uint32_t eTip = edgeTipInds.data[currEdge];
+      currNode = (eTail == currNode) ? eTip : eTail;
+      stripInds.push_back(currNode);
+
+      // Continue through degree-2 nodes, unless we've come back around to an edge already in a strip
+      currEdge = INVALID_IND_32;
+      if (nodeDegrees[currNode] != 2) break;
+      for (size_t iA = adjStart[currNode]; iA < adjStart[currNode + 1]; iA++) {
+        if (!edgeUsed[adjEdges[iA]]) {
+          currEdge = adjEdges[iA];
+          break;
+        }
+      }
+    }
+  };
+
+  // Open chains run between nodes which are not degree-2
+  for (size_t iN = 0; iN < nNodes(); iN++) {
+    if (nodeDegrees[iN] == 2) continue;
+    for (size_t iA = adjStart[iN]; iA < adjStart[iN + 1]; iA++) {
+      if (!edgeUsed[adjEdges[iA]]) {
+        walkStrip(iN, adjEdges[iA]);
+      }
+    }
+  }
+
+  // Any remaining edges form closed loops of degree-2 nodes
+  for (size_t iE = 0; iE < nEdges(); iE++) {
+    if (!edgeUsed[iE]) {
+      walkStrip(edgeTailInds.data[iE], iE);
+    }
+  }
+
+  polylineStripInds.markHostBufferUpdated();
+}
+
+void CurveNetwork::computePolylineJointInds() {
+  nodePositions.ensureHostBufferPopulated();
+  edgeTailInds.ensureHostBufferPopulated();
+  edgeTipInds.ensureHostBufferPopulated();
+
+  // The two neighbors of each degree-2 node
+  std::vector<std::array<uint32_t, 2>> nodeNeighbors(nNodes(), {INVALID_IND_32, INVALID_IND_32});
+  auto addNeighbor = [&](uint32_t iN, uint32_t iNeighbor) {
+    std::array<uint32_t, 2>& nbrs = nodeNeighbors[iN];
+    if (nbrs[0] == INVALID_IND_32) {
+      nbrs[0] = iNeighbor;
+    } else {
+      nbrs[1] = iNeighbor;
+    }
+  };
+  for (size_t iE = 0; iE < nEdges(); iE++) {
+    addNeighbor(edgeTailInds.data[iE], edgeTipInds.data[iE]);
+    addNeighbor(edgeTipInds.data[iE], edgeTailInds.data[iE]);
+  }
+
+  polylineJointInds.data.clear();
+  for (size_t iN = 0; iN < nNodes(); iN++) {
+    bool isJoint = true;
+    if (nodeDegrees[iN] == 2) {
+      glm::vec3 p = nodePositions.data[iN];
+      glm::vec3 dIn = p - nodePositions.data[nodeNeighbors[iN][0]];
+      glm::vec3 dOut = nodePositions.data[nodeNeighbors[iN][1]] - p;
+      float lenProd = glm::length(dIn) * glm::length(dOut);
+      isJoint = lenProd > 0. && glm::dot(dIn, dOut) < polylineJointMinBendCos * lenProd;
+    }
+    if (isJoint) {
+      polylineJointInds.data.push_back(iN);
+    }
+  }
+
+  polylineJointInds.markHostBufferUpdated();
+}
+
 void CurveNetwork::refresh() {
   recomputeGeometryIfPopulated();
 
@@ -339,14 +542,170 @@ void CurveNetwork::refresh() {
   QuantityStructure<CurveNetwork>::refresh(); // call base class version, which refreshes quantities
 }
 
-void CurveNetwork::recomputeGeometryIfPopulated() { edgeCenters.recomputeIfPopulated(); }
+void CurveNetwork::recomputeGeometryIfPopulated() {
+  edgeCenters.recomputeIfPopulated();
+
+  // Which nodes need joints depends on the geometry. Existing indexed views don't follow changes to the index set, so
+  // rebuild the joint programs (including those of quantities drawn on the joints) if it changed.
+  std::vector<uint32_t> oldJointInds = polylineJointInds.data;
+  polylineJointInds.recomputeIfPopulated();
+  if (polylineJointInds.data != oldJointInds) {
+    nodeProgram.reset();
+    nodePickProgram.reset();
+    for (auto& q : quantities) {
+      q.second->refresh();
+    }
+  }
+}
+
+void CurveNetwork::prepareRayCast() {
+
+  nodePositions.ensureHostBufferPopulated();
+  edgeTailInds.ensureHostBufferPopulated();
+  edgeTipInds.ensureHostBufferPopulated();
+
+  // Edge pick indices must match what buildPickUI() expects, see preparePick()
+  if (pickUsesPolylineStrips) {
+    if (rayCastEdgeSegmentInds.size() != nEdges()) {
+      polylineStripInds.ensureHostBufferPopulated();
+      rayCastEdgeSegmentInds.resize(nEdges());
+      for (size_t iSeg = 0; iSeg < polylineStripEdgeInds.size(); iSeg++) {
+        rayCastEdgeSegmentInds[polylineStripEdgeInds[iSeg]] = iSeg;
+      }
+    }
+  } else {
+    rayCastEdgeSegmentInds.clear();
+  }
+
+  float radiusScale = computeRadiusMultiplierUniform() / objectTransformScale();
+  uint64_t radiusValuesVersion = 0;
+  CurveNetworkNodeScalarQuantity* radQ = nullptr;
+  if (nodeRadiusQuantityName != "") {
+    radQ = &resolveNodeRadiusQuantity();
+    radQ->values.ensureHostBufferPopulated();
+    radiusValuesVersion = radQ->values.getDataVersion();
+  }
+
+  size_t nPrims = nNodes() + nEdges();
+  bool haveBVH = rayCastBVH.nPrimitives() == nPrims && !rayCastBVH.empty();
+  if (haveBVH && rayCastBVHPositionsVersion == nodePositions.getDataVersion() &&
+      rayCastBVHRadiusQuantityName == nodeRadiusQuantityName &&
+      rayCastBVHRadiusValuesVersion == radiusValuesVersion && rayCastBVHRadiusScale == radiusScale) {
+    return;
+  }
+
+  rayCastNodeRadii.resize(nNodes());
+  for (size_t iN = 0; iN < nNodes(); iN++) {
+    float r = radiusScale;
+    if (radQ) r *= static_cast<float>(radQ->values.data[iN]);
+    rayCastNodeRadii[iN] = r;
+  }
+
+  std::vector<std::array<glm::vec3, 2>> primBoxes(nPrims);
+  for (size_t iN = 0; iN < nNodes(); iN++) {
+    glm::vec3 p = nodePositions.data[iN];
+    float r = rayCastNodeRadii[iN];
+    primBoxes[iN] = {p - glm::vec3{r}, p + glm::vec3{r}};
+  }
+  for (size_t iE = 0; iE < nEdges(); iE++) {
+    uint32_t iTail = edgeTailInds.data[iE];
+    uint32_t iTip = edgeTipInds.data[iE];
+    glm::vec3 pTail = nodePositions.data[iTail];
+    glm::vec3 pTip = nodePositions.data[iTip];
+    float r = std::max(rayCastNodeRadii[iTail], rayCastNodeRadii[iTip]);
+    primBoxes[nNodes() + iE] = {glm::min(pTail, pTip) - glm::vec3{r}, glm::max(pTail, pTip) + glm::vec3{r}};
+  }
+
+  if (haveBVH) {
+    rayCastBVH.refit(primBoxes);
+  } else {
+    rayCastBVH.build(primBoxes);
+  }
+  rayCastBVHPositionsVersion = nodePositions.getDataVersion();
+  rayCastBVHRadiusQuantityName = nodeRadiusQuantityName;
+  rayCastBVHRadiusValuesVersion = radiusValuesVersion;
+  rayCastBVHRadiusScale = radiusScale;
+}
+
+bool CurveNetwork::rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) {
+
+  // Intersect in object space. The ray parameter t is the same in both spaces.
+  glm::mat4 invTransform = glm::inverse(objectTransform.get());
+  glm::vec3 objRayStart = glm::vec3(invTransform * glm::vec4(rayStart, 1.));
+  glm::vec3 objRayDir = glm::vec3(invTransform * glm::vec4(rayDir, 0.));
+
+  size_t nN = nNodes();
+  auto hitPrim = [&](uint32_t iPrim, float tCurr) {
+    float t;
+    if (iPrim < nN) {
+      t = raySphereIntersection(objRayStart, objRayDir, nodePositions.data[iPrim], rayCastNodeRadii[iPrim]);
+    } else {
+      // Variable-radius edges are tapered cones when drawn; the cylinder of the larger radius is close enough to pick
+      uint32_t iTail = edgeTailInds.data[iPrim - nN];
+      uint32_t iTip = edgeTipInds.data[iPrim - nN];
+      t = rayCylinderIntersection(objRayStart, objRayDir, nodePositions.data[iTail], nodePositions.data[iTip],
+                                  std::max(rayCastNodeRadii[iTail], rayCastNodeRadii[iTip]));
+    }
+    if (!(t >= 0. && t < tCurr) || isCulledBySlicePlanes(rayStart + t * rayDir)) {
+      return std::numeric_limits<float>::infinity();
+    }
+    return t;
+  };
+
+  std::pair<uint64_t, float> hit = rayCastBVH.closestRayHit(objRayStart, objRayDir, tMax, hitPrim);
+  if (hit.first == INVALID_IND_64) return false;
+
+  tHit = hit.second;
+  if (hit.first < nN) {
+    localPickInd = hit.first;
+  } else {
+    size_t iE = hit.first - nN;
+    localPickInd = nN + (pickUsesPolylineStrips ? rayCastEdgeSegmentInds[iE] : iE);
+  }
+  return true;
+}
+
+void CurveNetwork::updateSelectionQuantities(const SelectionSet& selection) {
+  // Show the selected nodes and edges. Each quantity is only added once something has been selected, but is kept up to
+  // date after that.
+
+  std::string nodeQName = selectionQuantityPrefix + " nodes";
+  bool nodeIsNew = getQuantity(nodeQName) == nullptr;
+  if (!nodeIsNew || selection.count(0, nNodes()) > 0) {
+    CurveNetworkNodeScalarQuantity* q =
+        addNodeScalarQuantityImpl(nodeQName, selection.indicator(0, nNodes()), DataType::STANDARD);
+    if (nodeIsNew) q->setEnabled(true);
+  }
+
+  std::string edgeQName = selectionQuantityPrefix + " edges";
+  bool edgeIsNew = getQuantity(edgeQName) == nullptr;
+  if (!edgeIsNew || selection.count(nNodes(), nNodes() + nEdges()) > 0) {
+    std::vector<double> edgeVals = selection.indicator(nNodes(), nEdges());
+    if (pickUsesPolylineStrips) {
+      // edge pick indices are in strip segment order, see preparePick()
+      polylineStripInds.ensureHostBufferPopulated();
+      std::vector<double> segmentVals = edgeVals;
+      for (size_t iSeg = 0; iSeg < polylineStripEdgeInds.size(); iSeg++) {
+        edgeVals[polylineStripEdgeInds[iSeg]] = segmentVals[iSeg];
+      }
+    }
+    CurveNetworkEdgeScalarQuantity* q = addEdgeScalarQuantityImpl(edgeQName, edgeVals, DataType::STANDARD);
+    if (edgeIsNew) q->setEnabled(true);
+  }
+}
 
 void CurveNetwork::buildPickUI(size_t localPickID) {
 
   if (localPickID < nNodes()) {
     buildNodePickUI(localPickID);
   } else if (localPickID < nNodes() + nEdges()) {
-    buildEdgePickUI(localPickID - nNodes());
+    size_t edgeInd = localPickID - nNodes();
+    if (pickUsesPolylineStrips) {
+      // edge pick indices are in strip segment order, see preparePick()
+      polylineStripInds.ensureHostBufferPopulated();
+      edgeInd = polylineStripEdgeInds[edgeInd];
+    }
+    buildEdgePickUI(edgeInd);
   } else {
     exception("Bad pick index in curve network");
   }
@@ -405,6 +764,7 @@ void CurveNetwork::buildCustomUI() {
   if (ImGui::SliderFloat("Radius", radius.get().getValuePtr(), 0.0, .1, "%.5f",
                          ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
     radius.manuallyChanged();
+    internal::sceneGeometryVersion++;
     requestRedraw();
   }
   ImGui::PopItemWidth();
@@ -428,6 +788,7 @@ void CurveNetwork::buildCustomOptionsUI() {
     ImGui::EndMenu();
   }
 
+  if (ImGui::MenuItem("Polyline Strips", NULL, getPolylineStrips())) setPolylineStrips(!getPolylineStrips());
 
   if (render::buildMaterialOptionsGui(material.get())) {
     material.manuallyChanged();
@@ -436,25 +797,18 @@ void CurveNetwork::buildCustomOptionsUI() {
 }
 
 void CurveNetwork::updateObjectSpaceBounds() {
-  nodePositions.ensureHostBufferPopulated();
+  if (applyObjectSpaceBoundsHint()) return;
 
-  // bounding box
-  glm::vec3 min = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  glm::vec3 max = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  for (const glm::vec3& p : nodePositions.data) {
-    min = componentwiseMin(min, p);
-    max = componentwiseMax(max, p);
-  }
-  objectSpaceBoundingBox = std::make_tuple(min, max);
+  nodePositions.ensureHostBufferPopulated();
+  computeObjectSpaceBoundsFromPoints(nodePositions.data);
+}
 
-  // length scale, as twice the radius from the center of the bounding box
-  glm::vec3 center = 0.5f * (min + max);
-  float lengthScale = 0.0;
-  for (const glm::vec3& p : nodePositions.data) {
-    lengthScale = std::max(lengthScale, glm::length2(p - center));
-  }
-  objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+CurveNetwork* CurveNetwork::setPolylineStrips(bool newVal) {
+  polylineStrips = newVal;
+  refresh();
+  return this;
 }
+bool CurveNetwork::getPolylineStrips() { return polylineStrips.get(); }
 
 CurveNetwork* CurveNetwork::setColor(glm::vec3 newVal) {
   color = newVal;
@@ -483,6 +837,7 @@ void CurveNetwork::clearNodeRadiusQuantity() {
 
 CurveNetwork* CurveNetwork::setRadius(float newVal, bool isRelative) {
   radius = ScaledValue<float>(newVal, isRelative);
+  internal::sceneGeometryVersion++;
   polyscope::requestRedraw();
   return this;
 }
@@ -510,6 +865,20 @@ void CurveNetworkQuantity::buildEdgeInfoGUI(size_t edgeInd) {}
 // === Quantity adders
 
 
+ConnectedComponents CurveNetwork::computeConnectedComponents() {
+  const std::vector<uint32_t>& tails = edgeTailInds.getPopulatedHostBufferRef();
+  const std::vector<uint32_t>& tips = edgeTipInds.getPopulatedHostBufferRef();
+  ParallelDisjointSets sets(nNodes());
+  parallelForRanges(nEdges(), [&](size_t iStart, size_t iEnd) {
+    for (size_t iE = iStart; iE < iEnd; iE++) sets.merge(tails[iE], tips[iE]);
+  });
+  return labelConnectedComponents(sets);
+}
+
+CurveNetworkNodeColorQuantity* CurveNetwork::addConnectedComponentsQuantity(std::string name) {
+  return addNodeColorQuantityImpl(name, computeConnectedComponents().colors());
+}
+
 CurveNetworkNodeColorQuantity* CurveNetwork::addNodeColorQuantityImpl(std::string name,
                                                                       const std::vector<glm::vec3>& colors) {
   checkForQuantityWithNameAndDeleteOrError(name);
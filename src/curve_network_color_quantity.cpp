@@ -54,26 +54,28 @@ void CurveNetworkNodeColorQuantity::createProgram() {
         )
       )
     );
-  edgeProgram = render::engine->requestShader("RAYCAST_CYLINDER", 
+  bool useStrips = parent.usePolylineStrips();
+  edgeProgram = render::engine->requestShader(useStrips ? "RAYCAST_CYLINDER_STRIP" : "RAYCAST_CYLINDER", 
       render::engine->addMaterialRules(parent.getMaterial(),
         addColorRules(
           parent.addCurveNetworkEdgeRules(
-            {"CYLINDER_PROPAGATE_BLEND_COLOR", "SHADE_COLOR"}
+            {useStrips ? "CYLINDER_STRIP_PROPAGATE_BLEND_COLOR" : "CYLINDER_PROPAGATE_BLEND_COLOR", "SHADE_COLOR"}
           )
         )
       )
     );
   // clang-format on
 
-  // Fill geometry buffers
-  parent.fillEdgeGeometryBuffers(*edgeProgram);
-  parent.fillNodeGeometryBuffers(*nodeProgram);
-
-  { // Fill node color buffers
+  // Fill geometry and color buffers
+  if (useStrips) {
+    parent.fillPolylineJointGeometryBuffers(*nodeProgram);
+    parent.fillPolylineStripGeometryBuffers(*edgeProgram);
+    nodeProgram->setAttribute("a_color", colors.getIndexedRenderAttributeBuffer(parent.polylineJointInds));
+    edgeProgram->setAttribute("a_color", colors.getRenderAttributeBuffer());
+  } else {
+    parent.fillEdgeGeometryBuffers(*edgeProgram);
+    parent.fillNodeGeometryBuffers(*nodeProgram);
     nodeProgram->setAttribute("a_color", colors.getRenderAttributeBuffer());
-  }
-
-  { // Fill edge color buffers
     edgeProgram->setAttribute("a_color_tail", colors.getIndexedRenderAttributeBuffer(parent.edgeTailInds));
     edgeProgram->setAttribute("a_color_tip", colors.getIndexedRenderAttributeBuffer(parent.edgeTipInds));
   }
@@ -87,26 +87,28 @@ void CurveNetworkNodeScalarQuantity::createProgram() {
         )
       )
     );
-  edgeProgram = render::engine->requestShader("RAYCAST_CYLINDER", 
+  bool useStrips = parent.usePolylineStrips();
+  edgeProgram = render::engine->requestShader(useStrips ? "RAYCAST_CYLINDER_STRIP" : "RAYCAST_CYLINDER", 
       render::engine->addMaterialRules(parent.getMaterial(),
         addScalarRules(
           parent.addCurveNetworkEdgeRules(
-            {"CYLINDER_PROPAGATE_BLEND_VALUE"}
+            {useStrips ? "CYLINDER_STRIP_PROPAGATE_BLEND_VALUE" : "CYLINDER_PROPAGATE_BLEND_VALUE"}
           )
         )
       )
     );
   // clang-format on
 
-  // Fill geometry buffers
-  parent.fillNodeGeometryBuffers(*nodeProgram);
-  parent.fillEdgeGeometryBuffers(*edgeProgram);
-
-  { // Fill node color buffers
+  // Fill geometry and color buffers
+  if (useStrips) {
+    parent.fillPolylineJointGeometryBuffers(*nodeProgram);
+    parent.fillPolylineStripGeometryBuffers(*edgeProgram);
+    nodeProgram->setAttribute("a_value", values.getIndexedRenderAttributeBuffer(parent.polylineJointInds));
+    edgeProgram->setAttribute("a_value", values.getRenderAttributeBuffer());
+  } else {
+    parent.fillNodeGeometryBuffers(*nodeProgram);
+    parent.fillEdgeGeometryBuffers(*edgeProgram);
     nodeProgram->setAttribute("a_value", values.getRenderAttributeBuffer());
-  }
-
-  { // Fill edge color buffers
     edgeProgram->setAttribute("a_value_tail", values.getIndexedRenderAttributeBuffer(parent.edgeTailInds));
     edgeProgram->setAttribute("a_value_tip", values.getIndexedRenderAttributeBuffer(parent.edgeTipInds));
   }
@@ -2,6 +2,10 @@
 
 #include "polyscope/disjoint_sets.h"
 
+#include "polyscope/parallel.h"
+
+#include <utility>
+
 using std::vector;
 
 namespace polyscope {
@@ -86,4 +90,42 @@ void MarkedDisjointSets::merge(size_t x, size_t y) {
   }
 }
 
+// Constructor
+ParallelDisjointSets::ParallelDisjointSets(size_t n_) : n(n_), parent(n) {
+  // Initialize all elements to be in different sets
+  parallelForRanges(n, [&](size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) parent[i].store(i, std::memory_order_relaxed);
+  });
+}
+
+// Find root of element x
+// (relaxed ordering is enough: parents only ever move to a smaller index in the same set, so any value read is valid)
+size_t ParallelDisjointSets::find(size_t x) {
+  while (true) {
+    size_t p = parent[x].load(std::memory_order_relaxed);
+    size_t gp = parent[p].load(std::memory_order_relaxed);
+    if (p == gp) return p;
+
+    // Path halving. If this fails, someone else already moved x closer to the root.
+    parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+    x = gp;
+  }
+}
+
+// Union by index
+void ParallelDisjointSets::merge(size_t x, size_t y) {
+  while (true) {
+    x = find(x);
+    y = find(y);
+    if (x == y) return;
+    if (x < y) std::swap(x, y);
+
+    // Link the larger root under the smaller. If x stopped being a root in the meantime, try again from the top.
+    size_t expected = x;
+    if (parent[x].compare_exchange_strong(expected, y, std::memory_order_relaxed)) return;
+  }
+}
+
+size_t ParallelDisjointSets::size() const { return n; }
+
 } // namespace polyscope
@@ -4,7 +4,9 @@
 
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/streaming_image_quantity.h"
 
 #include "imgui.h"
 
@@ -31,9 +33,11 @@ void FloatingQuantityStructure::draw() {
   if (!isEnabled()) return;
 
   for (auto& qp : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", qp.second->name);
     qp.second->draw();
   }
   for (auto& qp : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", qp.second->name);
     qp.second->draw();
   }
 }
@@ -113,6 +117,18 @@ void removeAllFloatingQuantities() {
   internal::globalFloatingQuantityStructure->removeAllQuantities();
 }
 
+StreamingScalarImageQuantity* addStreamingScalarImageQuantity(std::string name, size_t dimX, size_t dimY,
+                                                              ImageOrigin imageOrigin, DataType type) {
+  FloatingQuantityStructure* q = getGlobalFloatingQuantityStructure();
+  return q->addStreamingScalarImageQuantity(name, dimX, dimY, imageOrigin, type);
+}
+
+StreamingColorImageQuantity* addStreamingColorImageQuantity(std::string name, size_t dimX, size_t dimY,
+                                                            ImageOrigin imageOrigin) {
+  FloatingQuantityStructure* q = getGlobalFloatingQuantityStructure();
+  return q->addStreamingColorImageQuantity(name, dimX, dimY, imageOrigin);
+}
+
 // Quantity default methods
 FloatingQuantity::FloatingQuantity(std::string name_, Structure& parent_) : Quantity(name_, parent_) {}
 
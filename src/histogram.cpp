@@ -4,6 +4,7 @@
 
 #include "polyscope/affine_remapper.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/scheduler.h"
 
 #include "imgui.h"
 
@@ -21,6 +22,8 @@ Histogram::~Histogram() {}
 
 void Histogram::buildHistogram(const std::vector<double>& values) {
 
+  pendingValues = nullptr; // supersedes any deferred build
+
   // Build arrays of values
   size_t N = values.size();
 
@@ -79,6 +82,23 @@ void Histogram::buildHistogram(const std::vector<double>& values) {
 }
 
 
+void Histogram::buildHistogramDeferred(render::ManagedBuffer<double>& values) {
+  bool taskQueued = pendingValues != nullptr;
+  pendingValues = &values;
+  if (!taskQueued) {
+    scheduler::deferTask(getGenericWeakHandle(), [this]() { finishPendingBuild(); });
+  }
+}
+
+void Histogram::finishPendingBuild() {
+  if (pendingValues == nullptr) return;
+  // The buffer may have been updated since the build was queued, or may only hold its data on the device by now
+  pendingValues->ensureHostBufferPopulated();
+  std::pair<double, double> prevColormapRange = colormapRange;
+  buildHistogram(pendingValues->data);
+  colormapRange = prevColormapRange;
+}
+
 void Histogram::updateColormap(const std::string& newColormap) {
   colormap = newColormap;
   if (program) {
@@ -172,6 +192,8 @@ void Histogram::renderToTexture() {
 
 void Histogram::buildUI(float width) {
 
+  finishPendingBuild();
+
   // NOTE: I'm surprised this works, since we're drawing in the middle of imgui's processing. Possible source of bugs?
   renderToTexture();
 
@@ -0,0 +1,241 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/image_stream.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+#include "polyscope/polyscope.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace polyscope {
+
+namespace {
+
+// Run func(iRow) over the rows of a rectangle, in parallel when the rectangle is large
+template <typename F>
+void forEachRow(const ImageStreamRect& rect, size_t nChannels, F&& func) {
+  size_t rowSize = std::max(rect.width() * nChannels, static_cast<size_t>(1));
+  size_t minRows = std::max(DEFAULT_PARALLEL_RANGE_SIZE / rowSize, static_cast<size_t>(1));
+  parallelForRanges(
+      rect.height(),
+      [&](size_t iStart, size_t iEnd) {
+        for (size_t iRow = iStart; iRow < iEnd; iRow++) {
+          func(rect.y0 + iRow);
+        }
+      },
+      minRows);
+}
+
+inline float unorm8(uint8_t v) { return v / 255.f; }
+
+// BT.601 limited-range ("video range") YUV to RGB, as produced by most camera pipelines
+inline void yuvToRGBA(uint8_t y, uint8_t u, uint8_t v, float* out) {
+  float c = 1.164383f * (static_cast<float>(y) - 16.f);
+  float d = static_cast<float>(u) - 128.f;
+  float e = static_cast<float>(v) - 128.f;
+  out[0] = std::min(std::max((c + 1.596027f * e) / 255.f, 0.f), 1.f);
+  out[1] = std::min(std::max((c - 0.391762f * d - 0.812968f * e) / 255.f, 0.f), 1.f);
+  out[2] = std::min(std::max((c + 2.017232f * d) / 255.f, 0.f), 1.f);
+  out[3] = 1.f;
+}
+
+bool formatIsScalar(ImageStreamFormat format) {
+  return format == ImageStreamFormat::Float || format == ImageStreamFormat::UInt16;
+}
+
+bool formatIsYUV420(ImageStreamFormat format) {
+  return format == ImageStreamFormat::NV12 || format == ImageStreamFormat::I420;
+}
+
+} // namespace
+
+void ImageStreamRect::expand(const ImageStreamRect& other) {
+  if (other.isEmpty()) return;
+  if (isEmpty()) {
+    *this = other;
+    return;
+  }
+  x0 = std::min(x0, other.x0);
+  y0 = std::min(y0, other.y0);
+  x1 = std::max(x1, other.x1);
+  y1 = std::max(y1, other.y1);
+}
+
+ImageStream::ImageStream(size_t dimX_, size_t dimY_, size_t nChannels_)
+    : dimX(dimX_), dimY(dimY_), nChannels(nChannels_) {
+  if (nChannels != 1 && nChannels != 4) {
+    exception("image stream must have 1 or 4 channels, got " + std::to_string(nChannels));
+  }
+  producerPixels.resize(dimX * dimY * nChannels, 0.f);
+  for (Slot& s : slots) {
+    s.pixels.resize(dimX * dimY * nChannels, 0.f);
+  }
+}
+
+void ImageStream::pushFrame(ImageStreamFormat format, const void* data) {
+  pushSubRect(format, 0, 0, dimX, dimY, data);
+}
+
+void ImageStream::pushSubRect(ImageStreamFormat format, size_t x0, size_t y0, size_t width, size_t height,
+                              const void* data) {
+
+  // Validate
+  if (formatIsScalar(format) != (nChannels == 1)) {
+    exception("image stream format does not match the stream's channel count");
+  }
+  if (x0 + width > dimX || y0 + height > dimY) {
+    exception("image stream sub-rectangle is out of bounds");
+  }
+  if (formatIsYUV420(format) && (x0 % 2 != 0 || y0 % 2 != 0 || width % 2 != 0 || height % 2 != 0)) {
+    exception("image stream YUV 4:2:0 sub-rectangles must have even offsets and sizes");
+  }
+
+  ImageStreamRect rect;
+  rect.x0 = x0;
+  rect.y0 = y0;
+  rect.x1 = x0 + width;
+  rect.y1 = y0 + height;
+  if (rect.isEmpty()) return;
+
+  std::lock_guard<std::mutex> lock(producerMutex);
+
+  convertToProducerPixels(format, rect, data);
+
+  // Every slot is now out of date in this region
+  for (ImageStreamRect& stale : slotStaleRects) {
+    stale.expand(rect);
+  }
+
+  // Bring the write slot fully up to date, which also covers anything it missed while it was the ready/read slot
+  ImageStreamRect& writeStale = slotStaleRects[writeInd];
+  std::vector<float>& writePixels = slots[writeInd].pixels;
+  size_t rowLen = writeStale.width() * nChannels;
+  forEachRow(writeStale, nChannels, [&](size_t iRow) {
+    size_t offset = (iRow * dimX + writeStale.x0) * nChannels;
+    std::memcpy(&writePixels[offset], &producerPixels[offset], rowLen * sizeof(float));
+  });
+  writeStale = ImageStreamRect();
+
+  publish(rect);
+}
+
+void ImageStream::publish(const ImageStreamRect& rect) {
+  slots[writeInd].changedRect = rect;
+
+  std::lock_guard<std::mutex> lock(swapMutex);
+  if (readyIsFresh) {
+    // The consumer never saw the ready frame; it is dropped, but the region it changed must still be re-read
+    slots[writeInd].changedRect.expand(slots[readyInd].changedRect);
+    nDropped++;
+  }
+  std::swap(writeInd, readyInd);
+  readyIsFresh = true;
+  nPushed++;
+
+  requestRedraw();
+}
+
+bool ImageStream::acquireLatest() {
+  std::lock_guard<std::mutex> lock(swapMutex);
+  if (!readyIsFresh) return false;
+  std::swap(readInd, readyInd);
+  readyIsFresh = false;
+  nAcquired++;
+  return true;
+}
+
+const std::vector<float>& ImageStream::currentPixels() const { return slots[readInd].pixels; }
+
+ImageStreamRect ImageStream::currentChangedRect() const { return slots[readInd].changedRect; }
+
+void ImageStream::setValueScale(float newScale) { valueScale.store(newScale); }
+float ImageStream::getValueScale() const { return valueScale.load(); }
+
+void ImageStream::convertToProducerPixels(ImageStreamFormat format, const ImageStreamRect& rect, const void* data) {
+
+  const size_t w = rect.width();
+  const size_t h = rect.height();
+  const float scale = valueScale.load();
+
+  // Pointer to the first output float of pixel (iRow, x0)
+  auto outRow = [&](size_t iRow) { return &producerPixels[(iRow * dimX + rect.x0) * nChannels]; };
+
+  switch (format) {
+
+  case ImageStreamFormat::Float: {
+    const float* src = static_cast<const float*>(data);
+    forEachRow(rect, nChannels, [&](size_t iRow) {
+      std::memcpy(outRow(iRow), src + (iRow - rect.y0) * w, w * sizeof(float));
+    });
+    break;
+  }
+
+  case ImageStreamFormat::UInt16: {
+    const uint16_t* src = static_cast<const uint16_t*>(data);
+    forEachRow(rect, nChannels, [&](size_t iRow) {
+      const uint16_t* in = src + (iRow - rect.y0) * w;
+      float* out = outRow(iRow);
+      for (size_t i = 0; i < w; i++) {
+        out[i] = scale * static_cast<float>(in[i]);
+      }
+    });
+    break;
+  }
+
+  case ImageStreamFormat::RGBAFloat: {
+    const float* src = static_cast<const float*>(data);
+    forEachRow(rect, nChannels, [&](size_t iRow) {
+      std::memcpy(outRow(iRow), src + (iRow - rect.y0) * w * 4, w * 4 * sizeof(float));
+    });
+    break;
+  }
+
+  case ImageStreamFormat::RGB8:
+  case ImageStreamFormat::RGBA8: {
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    const size_t inChannels = format == ImageStreamFormat::RGB8 ? 3 : 4;
+    forEachRow(rect, nChannels, [&](size_t iRow) {
+      const uint8_t* in = src + (iRow - rect.y0) * w * inChannels;
+      float* out = outRow(iRow);
+      for (size_t i = 0; i < w; i++) {
+        out[4 * i + 0] = unorm8(in[inChannels * i + 0]);
+        out[4 * i + 1] = unorm8(in[inChannels * i + 1]);
+        out[4 * i + 2] = unorm8(in[inChannels * i + 2]);
+        out[4 * i + 3] = inChannels == 4 ? unorm8(in[inChannels * i + 3]) : 1.f;
+      }
+    });
+    break;
+  }
+
+  case ImageStreamFormat::NV12:
+  case ImageStreamFormat::I420: {
+    const uint8_t* yPlane = static_cast<const uint8_t*>(data);
+    const uint8_t* chromaPlanes = yPlane + w * h;
+    const size_t cw = w / 2;
+    const size_t ch = h / 2;
+    forEachRow(rect, nChannels, [&](size_t iRow) {
+      size_t iLocalRow = iRow - rect.y0;
+      const uint8_t* yIn = yPlane + iLocalRow * w;
+      float* out = outRow(iRow);
+      for (size_t i = 0; i < w; i++) {
+        size_t iChroma = (iLocalRow / 2) * cw + i / 2;
+        uint8_t u, v;
+        if (format == ImageStreamFormat::NV12) {
+          u = chromaPlanes[2 * iChroma + 0];
+          v = chromaPlanes[2 * iChroma + 1];
+        } else {
+          u = chromaPlanes[iChroma];
+          v = chromaPlanes[cw * ch + iChroma];
+        }
+        yuvToRGBA(yIn[i], u, v, out + 4 * i);
+      }
+    });
+    break;
+  }
+  }
+}
+
+} // namespace polyscope
@@ -10,6 +10,9 @@ uint64_t uniqueID = 42;
 uint64_t getNextUniqueID() { return uniqueID++; }
 
 bool pointCloudEfficiencyWarningReported = false;
+int transparencyPeelPassesLastFrame = 0;
+std::atomic<uint64_t> sceneContentVersion{0};
+std::atomic<uint64_t> sceneGeometryVersion{0};
 FloatingQuantityStructure* globalFloatingQuantityStructure = nullptr;
 
 } // namespace internal
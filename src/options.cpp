@@ -12,13 +12,16 @@ std::string printPrefix = "[polyscope] ";
 bool errorsThrowExceptions = false;
 bool debugDrawPickBuffer = false;
 int maxFPS = 60;
+float frameWorkBudgetMs = 4.;
 bool enableVSync = true;
 bool usePrefsFile = true;
 bool initializeWithDefaultStructures = true;
 bool alwaysRedraw = false;
+bool enableProfiler = false;
 bool autocenterStructures = false;
 bool autoscaleStructures = false;
 bool automaticallyComputeSceneExtents = true;
+int maxParallelThreads = -1;
 bool invokeUserCallbackForNestedShow = false;
 bool giveFocusOnShow = false;
 bool hideWindowAfterShow = true;
@@ -34,14 +37,24 @@ GroundPlaneMode groundPlaneMode = GroundPlaneMode::TileReflection;
 ScaledValue<float> groundPlaneHeightFactor = 0;
 int shadowBlurIters = 2;
 float shadowDarkness = 0.25;
+bool groundPlaneTemporalReuse = true;
+
+// Picking
+PickBackend pickBackend = PickBackend::Render;
 
 // Rendering options
 
 int ssaaFactor = 1;
+bool enableTAA = false;
+int taaMaxSamples = 16;
+float taaBlendFactor = 0.1;
 
 // Transparency
 TransparencyMode transparencyMode = TransparencyMode::None;
 int transparencyRenderPasses = 8;
+float transparencyPeelTimeBudgetMs = 12.;
+bool backgroundShaderCompile = true;
+float shaderCompileBudgetMs = 8.;
 
 // === Advanced ImGui configuration
 
@@ -0,0 +1,85 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/parallel.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+#include "polyscope/options.h"
+
+namespace polyscope {
+
+size_t parallelThreadCount() {
+  if (options::maxParallelThreads > 0) {
+    return static_cast<size_t>(options::maxParallelThreads);
+  }
+  size_t nHardware = std::thread::hardware_concurrency();
+  return std::max(nHardware, static_cast<size_t>(1)); // hardware_concurrency() may return 0 if unknown
+}
+
+std::vector<std::tuple<size_t, size_t>> parallelRanges(size_t N, size_t minRangeSize) {
+
+  std::vector<std::tuple<size_t, size_t>> ranges;
+  if (N == 0) return ranges;
+
+  minRangeSize = std::max(minRangeSize, static_cast<size_t>(1));
+  size_t nRanges = std::min(parallelThreadCount(), (N + minRangeSize - 1) / minRangeSize);
+  nRanges = std::max(nRanges, static_cast<size_t>(1));
+
+  // Spread the remainder over the first ranges, so sizes differ by at most one
+  size_t baseSize = N / nRanges;
+  size_t remainder = N % nRanges;
+  size_t start = 0;
+  for (size_t iRange = 0; iRange < nRanges; iRange++) {
+    size_t end = start + baseSize + (iRange < remainder ? 1 : 0);
+    ranges.emplace_back(start, end);
+    start = end;
+  }
+
+  return ranges;
+}
+
+void parallelInvoke(size_t nTasks, const std::function<void(size_t)>& func) {
+
+  // Quick out for the trivial serial case
+  if (nTasks == 1 || parallelThreadCount() == 1) {
+    for (size_t iTask = 0; iTask < nTasks; iTask++) {
+      func(iTask);
+    }
+    return;
+  }
+
+  // Capture the first exception from any task, to be re-thrown on the calling thread
+  std::vector<std::exception_ptr> taskExceptions(nTasks);
+  auto runTask = [&](size_t iTask) {
+    try {
+      func(iTask);
+    } catch (...) {
+      taskExceptions[iTask] = std::current_exception();
+    }
+  };
+
+  // Run the first task on the calling thread, and the rest on worker threads
+  std::vector<std::thread> workers;
+  workers.reserve(nTasks - 1);
+  for (size_t iTask = 1; iTask < nTasks; iTask++) {
+    workers.emplace_back(runTask, iTask);
+  }
+  runTask(0);
+  for (std::thread& w : workers) {
+    w.join();
+  }
+
+  for (std::exception_ptr& e : taskExceptions) {
+    if (e) std::rethrow_exception(e);
+  }
+}
+
+void parallelForRanges(size_t N, const std::function<void(size_t, size_t)>& func, size_t minRangeSize) {
+  std::vector<std::tuple<size_t, size_t>> ranges = parallelRanges(N, minRangeSize);
+  parallelInvoke(ranges.size(),
+                 [&](size_t iRange) { func(std::get<0>(ranges[iRange]), std::get<1>(ranges[iRange])); });
+}
+
+} // namespace polyscope
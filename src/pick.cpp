@@ -2,8 +2,13 @@
 
 #include "polyscope/pick.h"
 
+#include "polyscope/parallel.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
+#include "polyscope/viewport.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <tuple>
 #include <unordered_map>
@@ -11,6 +16,12 @@
 namespace polyscope {
 namespace pick {
 
+// Rays per parallel task in batch ray casts
+const size_t RAY_CAST_BATCH_RANGE_SIZE = 256;
+
+// Pixels per parallel task when decoding pick buffer regions
+const size_t PICK_DECODE_RANGE_SIZE = 1 << 14;
+
 size_t currLocalPickInd = 0;
 Structure* currPickStructure = nullptr;
 bool haveSelectionVal = false;
@@ -23,6 +34,9 @@ size_t nextPickBufferInd = 1; // 0 reserved for "none"
 // std::vector<std::tuple<size_t, size_t, Structure*>> structureRanges;
 std::unordered_map<Structure*, std::tuple<size_t, size_t>> structureRanges;
 
+// Region selections, for each structure which has one
+std::unordered_map<Structure*, SelectionSet> selectionSets;
+
 
 // == Set up picking
 size_t requestPickBufferRange(Structure* requestingStructure, size_t count) {
@@ -64,6 +78,7 @@ void resetSelectionIfStructure(Structure* s) {
   if (haveSelectionVal && currPickStructure == s) {
     resetSelection();
   }
+  selectionSets.erase(s);
 }
 
 std::pair<Structure*, size_t> getSelection() {
@@ -119,15 +134,13 @@ size_t localIndexToGlobal(std::pair<Structure*, size_t> localPick) {
 }
 
 
-std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos) {
+namespace {
 
-  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render but do not query the value.
-
-  // Be sure not to pick outside of buffer
-  if (xPos < -1 || xPos >= view::bufferWidth || yPos < -1 || yPos >= view::bufferHeight) {
-    return {nullptr, 0};
-  }
+// The pick buffer row holding screen row yPos (screen rows run top to bottom, framebuffer rows bottom to top)
+int pickBufferRow(int yPos) { return view::bufferHeight - 1 - yPos; }
 
+// Draw all of the structures in to the pick buffer. Returns false if it could not be drawn.
+bool renderPickBuffer() {
   render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
 
   render::engine->setDepthMode(DepthMode::Less);
@@ -136,27 +149,333 @@ std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos) {
   pickFramebuffer->resize(view::bufferWidth, view::bufferHeight);
   pickFramebuffer->setViewport(0, 0, view::bufferWidth, view::bufferHeight);
   pickFramebuffer->clearColor = glm::vec3{0., 0., 0.};
-  if (!pickFramebuffer->bindForRendering()) return {nullptr, 0};
+  if (!pickFramebuffer->bindForRendering()) return false;
   pickFramebuffer->clear();
 
   // Render pick buffer
   for (auto& cat : state::structures) {
     for (auto& x : cat.second) {
+      if (!isStructureVisibleInCurrentViewport(x.second.get())) continue;
       x.second->drawPick();
     }
   }
 
+  return true;
+}
+
+// Sort and deduplicate pick indices. A least-significant-digit radix sort, which skips the high digits when they are
+// all zero (as they are unless a scene has very many elements).
+void sortUniquePickIndices(std::vector<uint64_t>& inds) {
+  uint64_t maxInd = 0;
+  for (uint64_t ind : inds) maxInd = std::max(maxInd, ind);
+
+  const int digitBits = 8;
+  const size_t nBuckets = 1 << digitBits;
+  std::vector<uint64_t> sorted(inds.size());
+  for (int shift = 0; shift < 64 && (maxInd >> shift) != 0; shift += digitBits) {
+    std::vector<size_t> bucketStart(nBuckets + 1, 0);
+    for (uint64_t ind : inds) bucketStart[((ind >> shift) & (nBuckets - 1)) + 1]++;
+    for (size_t iB = 0; iB < nBuckets; iB++) bucketStart[iB + 1] += bucketStart[iB];
+    for (uint64_t ind : inds) sorted[bucketStart[(ind >> shift) & (nBuckets - 1)]++] = ind;
+    inds.swap(sorted);
+  }
+
+  inds.erase(std::unique(inds.begin(), inds.end()), inds.end());
+}
+
+} // namespace
+
+std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos) {
+
+  if (options::pickBackend == PickBackend::RayCast) {
+    if (xPos == -1 || yPos == -1) return {nullptr, 0}; // nothing to populate, see below
+    return evaluatePickQueryRayCast(xPos, yPos);
+  }
+
+  profiler::ScopedTimer timer("pick");
+
+  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render but do not query the value.
+
+  // Be sure not to pick outside of buffer
+  if (xPos < -1 || xPos >= view::bufferWidth || yPos < -1 || yPos >= view::bufferHeight) {
+    return {nullptr, 0};
+  }
+
+  if (!renderPickBuffer()) return {nullptr, 0};
+
   if (xPos == -1 || yPos == -1) {
     return {nullptr, 0};
   }
 
   // Read from the pick buffer
-  std::array<float, 4> result = pickFramebuffer->readFloat4(xPos, view::bufferHeight - yPos);
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+  std::array<float, 4> result = pickFramebuffer->readFloat4(xPos, pickBufferRow(yPos));
   size_t globalInd = pick::vecToInd(glm::vec3{result[0], result[1], result[2]});
 
   return pick::globalIndexToLocal(globalInd);
 }
 
+namespace {
+
+// The structures which rays are cast against, after preparing them
+std::vector<Structure*> prepareRayCastTargets() {
+  std::vector<Structure*> targets;
+  for (auto& cat : state::structures) {
+    for (auto& x : cat.second) {
+      Structure* s = x.second.get();
+      if (!s->isEnabled() || !isStructureVisibleInCurrentViewport(s)) continue;
+      s->prepareRayCast();
+      targets.push_back(s);
+    }
+  }
+  return targets;
+}
+
+RayCastResult rayCastTargets(const std::vector<Structure*>& targets, glm::vec3 rayStart, glm::vec3 rayDir) {
+  RayCastResult result;
+  float tMax = std::numeric_limits<float>::infinity();
+  for (Structure* s : targets) {
+    float tHit;
+    size_t localInd;
+    if (s->rayCast(rayStart, rayDir, tMax, tHit, localInd)) {
+      tMax = tHit;
+      result.structure = s;
+      result.localIndex = localInd;
+    }
+  }
+  if (result.structure != nullptr) {
+    result.t = tMax;
+    result.position = rayStart + tMax * rayDir;
+  }
+  return result;
+}
+
+} // namespace
+
+std::pair<Structure*, size_t> evaluatePickQueryRayCast(int xPos, int yPos) {
+
+  profiler::ScopedTimer timer("pick");
+
+  if (xPos < 0 || xPos >= view::bufferWidth || yPos < 0 || yPos >= view::bufferHeight) {
+    return {nullptr, 0};
+  }
+
+  // The ray through the center of the pixel which evaluatePickQuery() would read, from the near plane to the far plane
+  // (this works for both perspective and orthographic projections)
+  glm::mat4 viewMat = view::getCameraViewMatrix();
+  glm::mat4 projMat = view::getCameraPerspectiveMatrix();
+  glm::vec4 viewport{0., 0., view::bufferWidth, view::bufferHeight};
+  glm::vec2 pixelCenter{xPos + 0.5, pickBufferRow(yPos) + 0.5};
+  glm::vec3 nearPos = glm::unProject(glm::vec3{pixelCenter, 0.}, viewMat, projMat, viewport);
+  glm::vec3 farPos = glm::unProject(glm::vec3{pixelCenter, 1.}, viewMat, projMat, viewport);
+
+  RayCastResult result = rayCast(nearPos, glm::normalize(farPos - nearPos));
+  return {result.structure, result.localIndex};
+}
+
+RayCastResult rayCast(glm::vec3 rayStart, glm::vec3 rayDir) {
+  std::vector<Structure*> targets = prepareRayCastTargets();
+  return rayCastTargets(targets, rayStart, rayDir);
+}
+
+std::vector<RayCastResult> rayCast(const std::vector<glm::vec3>& rayStarts, const std::vector<glm::vec3>& rayDirs) {
+  if (rayStarts.size() != rayDirs.size()) {
+    exception("rayCast() got " + std::to_string(rayStarts.size()) + " ray starts but " +
+              std::to_string(rayDirs.size()) + " ray directions");
+  }
+
+  std::vector<Structure*> targets = prepareRayCastTargets();
+  std::vector<RayCastResult> results(rayStarts.size());
+  parallelForRanges(
+      rayStarts.size(),
+      [&](size_t iStart, size_t iEnd) {
+        for (size_t i = iStart; i < iEnd; i++) {
+          results[i] = rayCastTargets(targets, rayStarts[i], rayDirs[i]);
+        }
+      },
+      RAY_CAST_BATCH_RANGE_SIZE);
+  return results;
+}
+
+std::unordered_map<Structure*, std::vector<size_t>> decodePickPixels(const std::vector<float>& pixelsRGBA,
+                                                                     const std::vector<char>& pixelMask) {
+  size_t nPixels = pixelsRGBA.size() / 4;
+  if (!pixelMask.empty() && pixelMask.size() != nPixels) {
+    exception("decodePickPixels() got " + std::to_string(nPixels) + " pixels but a mask of size " +
+              std::to_string(pixelMask.size()));
+  }
+
+  // Decode in parallel. Neighboring pixels usually show the same element, so each range drops repeats as it goes, which
+  // leaves much less to sort.
+  std::vector<std::tuple<size_t, size_t>> ranges = parallelRanges(nPixels, PICK_DECODE_RANGE_SIZE);
+  std::vector<std::vector<uint64_t>> rangeInds(ranges.size());
+  parallelInvoke(ranges.size(), [&](size_t iRange) {
+    std::vector<uint64_t>& inds = rangeInds[iRange];
+    uint64_t prevInd = 0;
+    for (size_t iP = std::get<0>(ranges[iRange]); iP < std::get<1>(ranges[iRange]); iP++) {
+      if (!pixelMask.empty() && !pixelMask[iP]) continue;
+      uint64_t ind = vecToInd(glm::vec3{pixelsRGBA[4 * iP + 0], pixelsRGBA[4 * iP + 1], pixelsRGBA[4 * iP + 2]});
+      if (ind == 0 || ind == prevInd) continue; // 0 is the background
+      inds.push_back(ind);
+      prevInd = ind;
+    }
+  });
+
+  std::vector<uint64_t> globalInds;
+  for (const std::vector<uint64_t>& inds : rangeInds) {
+    globalInds.insert(globalInds.end(), inds.begin(), inds.end());
+  }
+  sortUniquePickIndices(globalInds);
+
+  // Both the indices and the ranges are sorted, so map them to structures in a single sweep
+  std::vector<std::tuple<size_t, size_t, Structure*>> sortedRanges;
+  for (const auto& x : structureRanges) {
+    sortedRanges.emplace_back(std::get<0>(x.second), std::get<1>(x.second), x.first);
+  }
+  std::sort(sortedRanges.begin(), sortedRanges.end());
+
+  std::unordered_map<Structure*, std::vector<size_t>> result;
+  size_t iRange = 0;
+  for (uint64_t ind : globalInds) {
+    while (iRange < sortedRanges.size() && std::get<1>(sortedRanges[iRange]) <= ind) iRange++;
+    if (iRange == sortedRanges.size()) break;
+    size_t rangeStart = std::get<0>(sortedRanges[iRange]);
+    if (ind < rangeStart) continue; // not allocated to any structure, e.g. a garbage value
+    result[std::get<2>(sortedRanges[iRange])].push_back(ind - rangeStart);
+  }
+
+  return result;
+}
+
+std::unordered_map<Structure*, std::vector<size_t>> evaluatePickQueryRect(int xMin, int yMin, int xMax, int yMax) {
+  if (xMin > xMax) std::swap(xMin, xMax);
+  if (yMin > yMax) std::swap(yMin, yMax);
+  std::vector<glm::vec2> rect{{xMin, yMin}, {xMax + 1, yMin}, {xMax + 1, yMax + 1}, {xMin, yMax + 1}};
+  return evaluatePickQueryLasso(rect);
+}
+
+std::unordered_map<Structure*, std::vector<size_t>> evaluatePickQueryLasso(const std::vector<glm::vec2>& lasso) {
+
+  profiler::ScopedTimer timer("pick region");
+
+  if (lasso.size() < 3) return {};
+
+  // Only the pixels in the bounding box of the lasso need to be read back
+  glm::vec2 lassoMin = lasso[0];
+  glm::vec2 lassoMax = lasso[0];
+  for (const glm::vec2& p : lasso) {
+    lassoMin = glm::min(lassoMin, p);
+    lassoMax = glm::max(lassoMax, p);
+  }
+  int xStart = std::max(0, static_cast<int>(std::floor(lassoMin.x)));
+  int yStart = std::max(0, static_cast<int>(std::floor(lassoMin.y)));
+  int xEnd = std::min(view::bufferWidth, static_cast<int>(std::ceil(lassoMax.x)));
+  int yEnd = std::min(view::bufferHeight, static_cast<int>(std::ceil(lassoMax.y)));
+  if (xStart >= xEnd || yStart >= yEnd) return {};
+  int xSize = xEnd - xStart;
+  int ySize = yEnd - yStart;
+
+  if (!renderPickBuffer()) return {};
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+  std::vector<float> pixels = pickFramebuffer->readFloat4Region(xStart, pickBufferRow(yEnd - 1), xSize, ySize);
+
+  // Keep the pixels whose center is inside the lasso (by the even-odd rule). The rows read back run bottom to top.
+  std::vector<char> mask(static_cast<size_t>(xSize) * ySize, 0);
+  parallelForRanges(
+      ySize,
+      [&](size_t iRowStart, size_t iRowEnd) {
+        std::vector<float> crossings;
+        for (size_t iRow = iRowStart; iRow < iRowEnd; iRow++) {
+          float y = yEnd - 1 - static_cast<float>(iRow) + 0.5f; // the screen row read back as pickBufferRow(y)
+
+          // Where the edges of the lasso cross this row of pixel centers
+          crossings.clear();
+          for (size_t iE = 0; iE < lasso.size(); iE++) {
+            glm::vec2 pA = lasso[iE];
+            glm::vec2 pB = lasso[(iE + 1) % lasso.size()];
+            if ((pA.y <= y) == (pB.y <= y)) continue;
+            crossings.push_back(pA.x + (y - pA.y) / (pB.y - pA.y) * (pB.x - pA.x));
+          }
+          std::sort(crossings.begin(), crossings.end());
+
+          for (size_t iC = 0; iC + 1 < crossings.size(); iC += 2) {
+            int xFirst = std::max(xStart, static_cast<int>(std::ceil(crossings[iC] - 0.5f)));
+            int xLast = std::min(xEnd - 1, static_cast<int>(std::floor(crossings[iC + 1] - 0.5f)));
+            for (int x = xFirst; x <= xLast; x++) {
+              mask[iRow * xSize + (x - xStart)] = 1;
+            }
+          }
+        }
+      },
+      16);
+
+  return decodePickPixels(pixels, mask);
+}
+
+void selectRect(int xMin, int yMin, int xMax, int yMax, SelectionMode mode) {
+  applySelection(evaluatePickQueryRect(xMin, yMin, xMax, yMax), mode);
+}
+
+void selectLasso(const std::vector<glm::vec2>& lasso, SelectionMode mode) {
+  applySelection(evaluatePickQueryLasso(lasso), mode);
+}
+
+void applySelection(const std::unordered_map<Structure*, std::vector<size_t>>& elements, SelectionMode mode) {
+
+  // Replacing also clears the selection of structures which have nothing in the new one
+  if (mode == SelectionMode::Replace) {
+    for (auto& x : selectionSets) {
+      if (elements.find(x.first) == elements.end() && !x.second.empty()) {
+        x.second.clear();
+        x.first->updateSelectionQuantities(x.second);
+      }
+    }
+  }
+
+  for (const auto& x : elements) {
+    SelectionSet& selection = selectionSets[x.first];
+    switch (mode) {
+    case SelectionMode::Replace:
+      selection.clear();
+      selection.insert(x.second);
+      break;
+    case SelectionMode::Add:
+      selection.insert(x.second);
+      break;
+    case SelectionMode::Remove:
+      selection.erase(x.second);
+      break;
+    }
+    x.first->updateSelectionQuantities(selection);
+  }
+
+  requestRedraw();
+}
+
+const SelectionSet& getSelectionSet(Structure* s) {
+  static const SelectionSet emptySelection;
+  auto it = selectionSets.find(s);
+  if (it == selectionSets.end()) return emptySelection;
+  return it->second;
+}
+
+void setSelectionSet(Structure* s, const SelectionSet& selection) {
+  selectionSets[s] = selection;
+  s->updateSelectionQuantities(selection);
+  requestRedraw();
+}
+
+void clearSelectionSets() {
+  for (auto& x : selectionSets) {
+    if (!x.second.empty()) {
+      x.second.clear();
+      x.first->updateSelectionQuantities(x.second);
+    }
+  }
+  selectionSets.clear();
+  requestRedraw();
+}
+
 } // namespace pick
 
 
@@ -3,8 +3,10 @@
 #include "polyscope/point_cloud.h"
 
 #include "polyscope/file_helpers.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "polyscope/point_cloud_color_quantity.h"
@@ -13,8 +15,10 @@
 
 #include "imgui.h"
 
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 namespace polyscope {
 
@@ -47,20 +51,23 @@ void PointCloud::setPointCloudUniforms(render::ShaderProgram& p) {
     p.setUniform("u_viewport", render::engine->getCurrentViewport());
   }
 
+  p.setUniform("u_pointRadius", computePointRadiusUniform());
+}
+
+float PointCloud::computePointRadiusUniform() {
   if (pointRadiusQuantityName != "" && !pointRadiusQuantityAutoscale) {
     // special case: ignore radius uniform
-    p.setUniform("u_pointRadius", 1.);
-  } else {
-    // common case
-
-    float scalarQScale = 1.;
-    if (pointRadiusQuantityName != "") {
-      PointCloudScalarQuantity& radQ = resolvePointRadiusQuantity();
-      scalarQScale = std::max(0., radQ.getDataRange().second);
-    }
+    return 1.;
+  }
 
-    p.setUniform("u_pointRadius", pointRadius.get().asAbsolute() / scalarQScale);
+  // common case
+  float scalarQScale = 1.;
+  if (pointRadiusQuantityName != "") {
+    PointCloudScalarQuantity& radQ = resolvePointRadiusQuantity();
+    scalarQScale = std::max(0., radQ.getDataRange().second);
   }
+
+  return pointRadius.get().asAbsolute() / scalarQScale;
 }
 
 void PointCloud::draw() {
@@ -96,9 +103,11 @@ void PointCloud::draw() {
 
   // Draw the quantities
   for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
   for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 }
@@ -232,6 +241,83 @@ PointCloudScalarQuantity& PointCloud::resolvePointRadiusQuantity() {
   return *sizeScalarQ;
 }
 
+void PointCloud::prepareRayCast() {
+
+  points.ensureHostBufferPopulated();
+
+  // Points are cast against as spheres, in object space
+  float radiusScale = computePointRadiusUniform() / objectTransformScale();
+  uint64_t radiusValuesVersion = 0;
+  PointCloudScalarQuantity* radQ = nullptr;
+  if (pointRadiusQuantityName != "") {
+    radQ = &resolvePointRadiusQuantity();
+    radQ->values.ensureHostBufferPopulated();
+    radiusValuesVersion = radQ->values.getDataVersion();
+  }
+
+  size_t nPts = nPoints();
+  bool haveBVH = rayCastBVH.nPrimitives() == nPts && !rayCastBVH.empty();
+  if (haveBVH && rayCastBVHPositionsVersion == points.getDataVersion() &&
+      rayCastBVHRadiusQuantityName == pointRadiusQuantityName &&
+      rayCastBVHRadiusValuesVersion == radiusValuesVersion && rayCastBVHRadiusScale == radiusScale) {
+    return;
+  }
+
+  rayCastRadii.resize(nPts);
+  std::vector<std::array<glm::vec3, 2>> pointBoxes(nPts);
+  parallelForRanges(nPts, [&](size_t iStart, size_t iEnd) {
+    for (size_t iP = iStart; iP < iEnd; iP++) {
+      float r = radiusScale;
+      if (radQ) r *= static_cast<float>(radQ->values.data[iP]);
+      rayCastRadii[iP] = r;
+      glm::vec3 p = points.data[iP];
+      pointBoxes[iP] = {p - glm::vec3{r}, p + glm::vec3{r}};
+    }
+  });
+
+  if (haveBVH) {
+    rayCastBVH.refit(pointBoxes);
+  } else {
+    rayCastBVH.build(pointBoxes);
+  }
+  rayCastBVHPositionsVersion = points.getDataVersion();
+  rayCastBVHRadiusQuantityName = pointRadiusQuantityName;
+  rayCastBVHRadiusValuesVersion = radiusValuesVersion;
+  rayCastBVHRadiusScale = radiusScale;
+}
+
+bool PointCloud::rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) {
+
+  // Intersect in object space. The ray parameter t is the same in both spaces.
+  glm::mat4 invTransform = glm::inverse(objectTransform.get());
+  glm::vec3 objRayStart = glm::vec3(invTransform * glm::vec4(rayStart, 1.));
+  glm::vec3 objRayDir = glm::vec3(invTransform * glm::vec4(rayDir, 0.));
+
+  auto hitPoint = [&](uint32_t iP, float tCurr) {
+    float t = raySphereIntersection(objRayStart, objRayDir, points.data[iP], rayCastRadii[iP]);
+    if (!(t >= 0. && t < tCurr) || isCulledBySlicePlanes(rayStart + t * rayDir)) {
+      return std::numeric_limits<float>::infinity();
+    }
+    return t;
+  };
+
+  std::pair<uint64_t, float> hit = rayCastBVH.closestRayHit(objRayStart, objRayDir, tMax, hitPoint);
+  if (hit.first == INVALID_IND_64) return false;
+
+  tHit = hit.second;
+  localPickInd = hit.first;
+  return true;
+}
+
+void PointCloud::updateSelectionQuantities(const SelectionSet& selection) {
+  // Only add the quantity once something has been selected, but keep it up to date after that
+  std::string qName = selectionQuantityPrefix;
+  bool isNew = getQuantity(qName) == nullptr;
+  if (isNew && selection.count(0, nPoints()) == 0) return;
+  PointCloudScalarQuantity* q = addScalarQuantityImpl(qName, selection.indicator(0, nPoints()), DataType::STANDARD);
+  if (isNew) q->setEnabled(true);
+}
+
 void PointCloud::buildPickUI(size_t localPickID) {
   ImGui::TextUnformatted(("#" + std::to_string(localPickID) + "  ").c_str());
   ImGui::SameLine();
@@ -262,6 +348,7 @@ void PointCloud::buildCustomUI() {
   if (ImGui::SliderFloat("Radius", pointRadius.get().getValuePtr(), 0.0, .1, "%.5f",
                          ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
     pointRadius.manuallyChanged();
+    internal::sceneGeometryVersion++;
     requestRedraw();
   }
   ImGui::PopItemWidth();
@@ -312,24 +399,10 @@ void PointCloud::buildCustomOptionsUI() {
 }
 
 void PointCloud::updateObjectSpaceBounds() {
-  points.ensureHostBufferPopulated();
+  if (applyObjectSpaceBoundsHint()) return;
 
-  // bounding box
-  glm::vec3 min = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  glm::vec3 max = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  for (const glm::vec3& p : points.data) {
-    min = componentwiseMin(min, p);
-    max = componentwiseMax(max, p);
-  }
-  objectSpaceBoundingBox = std::make_tuple(min, max);
-
-  // length scale, as twice the radius from the center of the bounding box
-  glm::vec3 center = 0.5f * (min + max);
-  float lengthScale = 0.0;
-  for (const glm::vec3& p : points.data) {
-    lengthScale = std::max(lengthScale, glm::length2(p - center));
-  }
-  objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  points.ensureHostBufferPopulated();
+  computeObjectSpaceBoundsFromPoints(points.data);
 }
 
 
@@ -374,6 +447,14 @@ void PointCloudQuantity::buildInfoGUI(size_t pointInd) {}
 // === Quantity adders
 
 
+ConnectedComponents PointCloud::computeConnectedComponents(float epsilon) {
+  return computeEpsilonConnectedComponents(points.getPopulatedHostBufferRef(), epsilon);
+}
+
+PointCloudColorQuantity* PointCloud::addConnectedComponentsQuantity(std::string name, float epsilon) {
+  return addColorQuantityImpl(name, computeConnectedComponents(epsilon).colors());
+}
+
 PointCloudColorQuantity* PointCloud::addColorQuantityImpl(std::string name, const std::vector<glm::vec3>& colors) {
   checkForQuantityWithNameAndDeleteOrError(name);
   PointCloudColorQuantity* q = new PointCloudColorQuantity(name, colors, *this);
@@ -456,6 +537,7 @@ std::string PointCloud::getMaterial() { return material.get(); }
 
 PointCloud* PointCloud::setPointRadius(double newVal, bool isRelative) {
   pointRadius = ScaledValue<float>(newVal, isRelative);
+  internal::sceneGeometryVersion++;
   polyscope::requestRedraw();
   return this;
 }
@@ -2,17 +2,24 @@
 
 #include "polyscope/polyscope.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <iostream>
-#include <thread>
+#include <set>
+#include <unordered_map>
 
 #include "imgui.h"
 
 #include "polyscope/options.h"
 #include "polyscope/pick.h"
+#include "polyscope/profiler.h"
+#include "polyscope/scheduler.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/view.h"
+#include "polyscope/viewport.h"
 
 #include "stb_image.h"
 
@@ -39,7 +46,7 @@ struct ContextEntry {
 };
 std::vector<ContextEntry> contextStack;
 
-bool redrawNextFrame = true;
+std::atomic<bool> redrawNextFrame{true}; // atomic so that requestRedraw() may be called from other threads
 bool unshowRequested = false;
 
 // Some state about imgui windows to stack them
@@ -49,7 +56,32 @@ float lastWindowHeightUser = 200;
 float leftWindowsWidth = 305;
 float rightWindowsWidth = 500;
 
-auto lastMainLoopIterTime = std::chrono::steady_clock::now();
+
+// The camera as of the last depth-peeled frame, to tell whether it is moving
+glm::mat4 lastPeelViewMat{0.};
+glm::mat4 lastPeelProjMat{0.};
+
+// GPU timestamps around the depth peeling passes of an earlier frame, which give the GPU time per pass once available
+bool peelTimestampsPending = false;
+uint32_t peelTimestampStart = 0;
+uint32_t peelTimestampEnd = 0;
+int peelTimestampPasses = 0;
+double peelPassGPUTimeMs = 0.; // 0 until measured
+
+void readPeelPassTimestamps() {
+  if (!peelTimestampsPending) return;
+  int64_t startNs, endNs;
+  if (!render::engine->tryGetGPUTimestamp(peelTimestampStart, startNs) ||
+      !render::engine->tryGetGPUTimestamp(peelTimestampEnd, endNs)) {
+    return;
+  }
+  if (peelTimestampPasses > 0) {
+    peelPassGPUTimeMs = 1e-6 * static_cast<double>(endNs - startNs) / peelTimestampPasses;
+  }
+  render::engine->releaseGPUTimestamp(peelTimestampStart);
+  render::engine->releaseGPUTimestamp(peelTimestampEnd);
+  peelTimestampsPending = false;
+}
 
 const std::string prefsFilename = ".polyscope.ini";
 
@@ -204,17 +236,7 @@ void pushContext(std::function<void()> callbackFunction, bool drawDefaultUI) {
   while (contextStack.size() >= currentContextStackSize) {
 
     // The windowing system will let the main loop busy-loop on some platforms. Make sure that doesn't happen.
-    if (options::maxFPS != -1) {
-      auto currTime = std::chrono::steady_clock::now();
-      long microsecPerLoop = 1000000 / options::maxFPS;
-      microsecPerLoop = (95 * microsecPerLoop) / 100; // give a little slack so we actually hit target fps
-      while (std::chrono::duration_cast<std::chrono::microseconds>(currTime - lastMainLoopIterTime).count() <
-             microsecPerLoop) {
-        std::this_thread::yield();
-        currTime = std::chrono::steady_clock::now();
-      }
-    }
-    lastMainLoopIterTime = std::chrono::steady_clock::now();
+    scheduler::waitForNextFrame();
 
     mainLoopIteration();
 
@@ -258,7 +280,11 @@ void frameTick() {
   mainLoopIteration();
 }
 
-void requestRedraw() { redrawNextFrame = true; }
+void requestRedraw() {
+  internal::sceneContentVersion++;
+  redrawNextFrame = true;
+}
+void requestViewRedraw() { redrawNextFrame = true; }
 bool redrawRequested() { return redrawNextFrame; }
 
 void drawStructures() {
@@ -267,21 +293,48 @@ void drawStructures() {
 
   for (auto& catMap : state::structures) {
     for (auto& s : catMap.second) {
+      if (!isStructureVisibleInCurrentViewport(s.second.get())) continue;
+      profiler::ScopedTimer timer("draw: ", s.second->name);
       s.second->draw();
     }
   }
 
   // Also render any slice plane geometry
+  profiler::ScopedTimer timer("slice plane geometry");
   for (std::unique_ptr<SlicePlane>& s : state::slicePlanes) {
     s->drawGeometry();
   }
 }
 
+// Draw only the opaque structures, or only the transparent ones. Used by weighted transparency, which handles the two
+// in separate phases.
+void drawStructuresByTransparency(bool transparent) {
+
+  for (auto& catMap : state::structures) {
+    for (auto& s : catMap.second) {
+      if ((s.second->getTransparency() < 1.) != transparent) continue;
+      if (!isStructureVisibleInCurrentViewport(s.second.get())) continue;
+      profiler::ScopedTimer timer("draw: ", s.second->name);
+      s.second->draw();
+    }
+  }
+
+  // Slice plane geometry is always opaque
+  if (!transparent) {
+    profiler::ScopedTimer timer("slice plane geometry");
+    for (std::unique_ptr<SlicePlane>& s : state::slicePlanes) {
+      s->drawGeometry();
+    }
+  }
+}
+
 void drawStructuresDelayed() {
   // "delayed" drawing allows structures to render things which should be rendered after most of the scene has been
   // drawn
   for (auto& catMap : state::structures) {
     for (auto& s : catMap.second) {
+      if (!isStructureVisibleInCurrentViewport(s.second.get())) continue;
+      profiler::ScopedTimer timer("draw delayed: ", s.second->name);
       s.second->drawDelayed();
     }
   }
@@ -290,13 +343,43 @@ void drawStructuresDelayed() {
 namespace {
 
 float dragDistSinceLastRelease = 0.0;
+std::string inputViewportName = ""; // the viewport which receives mouse input, if any
+
+// Region selection, by dragging with ctrl held: a box, or a lasso if alt is held too
+bool selectionDragActive = false;
+bool selectionDragIsLasso = false;
+glm::vec2 leftPressScreenPos{0., 0.};          // where the left button went down, in window coordinates
+glm::vec2 leftPressLocalPos{0., 0.};           // ... and in the coordinates of the input viewport
+std::vector<glm::vec2> selectionDragScreenPts; // the region, in window coordinates (for a box, the two corners)
+std::vector<glm::vec2> selectionDragLocalPts;  // ... and in the coordinates of the input viewport
 
 void processInputEvents() {
   ImGuiIO& io = ImGui::GetIO();
 
-  // If any mouse button is pressed, trigger a redraw
-  if (ImGui::IsAnyMouseDown()) {
-    requestRedraw();
+  // If any mouse button is pressed over the scene, trigger a redraw. Interacting with the UI doesn't need one: the GUI is
+  // drawn over the last render of the scene every frame, and UI elements request a redraw when they change something.
+  if (ImGui::IsAnyMouseDown() && !io.WantCaptureMouse) {
+    requestViewRedraw();
+    scheduler::markInteraction();
+  }
+
+  // With viewports, the camera under the mouse gets the input. The choice is held for the duration of a drag, so that
+  // dragging across a border doesn't switch cameras.
+  if (!ImGui::IsAnyMouseDown()) {
+    inputViewportName = "";
+    for (std::unique_ptr<Viewport>& vp : state::viewports) {
+      if (vp->containsScreenCoords(glm::vec2{io.MousePos.x, io.MousePos.y})) {
+        inputViewportName = vp->name;
+        break;
+      }
+    }
+  }
+  glm::vec2 mousePos{io.MousePos.x, io.MousePos.y};
+  std::unique_ptr<ViewportScope> inputViewportScope;
+  if (inputViewportName != "" && hasViewport(inputViewportName)) {
+    Viewport* vp = getViewport(inputViewportName);
+    mousePos = vp->toLocalScreenCoords(mousePos);
+    inputViewportScope.reset(new ViewportScope(*vp));
   }
 
   bool widgetCapturedMouse = false;
@@ -317,7 +400,8 @@ void processInputEvents() {
       double yoffset = io.MouseWheel;
 
       if (xoffset != 0 || yoffset != 0) {
-        requestRedraw();
+        requestViewRedraw();
+        scheduler::markInteraction();
 
         // On some setups, shift flips the scroll direction, so take the max
         // scrolling in any direction
@@ -342,9 +426,36 @@ void processInputEvents() {
     // === Mouse inputs
     if (!io.WantCaptureMouse && !widgetCapturedMouse) {
 
+      if (ImGui::IsMouseClicked(0)) {
+        leftPressScreenPos = glm::vec2{io.MousePos.x, io.MousePos.y};
+        leftPressLocalPos = mousePos;
+      }
+
       // Process drags
       bool dragLeft = ImGui::IsMouseDragging(0);
       bool dragRight = !dragLeft && ImGui::IsMouseDragging(1); // left takes priority, so only one can be true
+
+      // Region selection
+      if (dragLeft && (selectionDragActive || (io.KeyCtrl && !io.KeyShift))) {
+        glm::vec2 screenPos{io.MousePos.x, io.MousePos.y};
+        if (!selectionDragActive) {
+          selectionDragActive = true;
+          selectionDragIsLasso = io.KeyAlt;
+          selectionDragScreenPts = {leftPressScreenPos};
+          selectionDragLocalPts = {leftPressLocalPos};
+        }
+        if (selectionDragIsLasso) {
+          if (selectionDragScreenPts.back() != screenPos) {
+            selectionDragScreenPts.push_back(screenPos);
+            selectionDragLocalPts.push_back(mousePos);
+          }
+        } else {
+          selectionDragScreenPts = {selectionDragScreenPts.front(), screenPos};
+          selectionDragLocalPts = {selectionDragLocalPts.front(), mousePos};
+        }
+        dragLeft = false; // not a camera movement
+      }
+
       if (dragLeft || dragRight) {
 
         glm::vec2 dragDelta{io.MouseDelta.x / view::windowWidth, -io.MouseDelta.y / view::windowHeight};
@@ -360,8 +471,7 @@ void processInputEvents() {
           view::processZoom(dragDelta.y * 5);
         }
         if (isRotate) {
-          glm::vec2 currPos{io.MousePos.x / view::windowWidth,
-                            (view::windowHeight - io.MousePos.y) / view::windowHeight};
+          glm::vec2 currPos{mousePos.x / view::windowWidth, (view::windowHeight - mousePos.y) / view::windowHeight};
           currPos = (currPos * 2.0f) - glm::vec2{1.0, 1.0};
           if (std::abs(currPos.x) <= 1.0 && std::abs(currPos.y) <= 1.0) {
             view::processRotate(currPos - 2.0f * dragDelta, currPos);
@@ -376,11 +486,24 @@ void processInputEvents() {
       float dragIgnoreThreshold = 0.01;
       if (ImGui::IsMouseReleased(0)) {
 
+        if (selectionDragActive) {
+          // Finish a region selection, in pick buffer pixels
+          glm::vec2 bufferScale{io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y};
+          std::vector<glm::vec2> bufferPts;
+          for (const glm::vec2& p : selectionDragLocalPts) bufferPts.push_back(bufferScale * p);
+          if (selectionDragIsLasso) {
+            pick::selectLasso(bufferPts);
+          } else if (bufferPts.size() == 2) {
+            pick::selectRect(bufferPts[0].x, bufferPts[0].y, bufferPts[1].x, bufferPts[1].y);
+          }
+          selectionDragActive = false;
+          selectionDragScreenPts.clear();
+          selectionDragLocalPts.clear();
+        }
         // Don't pick at the end of a long drag
-        if (dragDistSinceLastRelease < dragIgnoreThreshold) {
-          ImVec2 p = ImGui::GetMousePos();
-          std::pair<Structure*, size_t> pickResult =
-              pick::evaluatePickQuery(io.DisplayFramebufferScale.x * p.x, io.DisplayFramebufferScale.y * p.y);
+        else if (dragDistSinceLastRelease < dragIgnoreThreshold) {
+          std::pair<Structure*, size_t> pickResult = pick::evaluatePickQuery(io.DisplayFramebufferScale.x * mousePos.x,
+                                                                             io.DisplayFramebufferScale.y * mousePos.y);
           pick::setSelection(pickResult);
         }
 
@@ -410,11 +533,30 @@ void renderSlicePlanes() {
   }
 }
 
+// Compute the lazily-computed buffers which drawing is about to need all at once, concurrently, rather than one at a
+// time as each structure draws. This mostly matters for the first frame after registering many structures.
+void computeBuffersForDraw() {
+  std::vector<render::PendingBufferCompute> computes;
+  for (auto& catMap : state::structures) {
+    for (auto& s : catMap.second) {
+      if (!s.second->isEnabled() || !isStructureVisibleInCurrentViewport(s.second.get())) continue;
+      s.second->gatherBuffersForDraw(computes);
+    }
+  }
+  if (computes.empty()) return;
+
+  profiler::ScopedTimer timer("compute buffers");
+  render::computeBuffersConcurrently(computes);
+}
+
 void renderScene() {
+  profiler::ScopedTimer timer("renderScene");
   processLazyProperties();
+  computeBuffersForDraw();
 
   render::engine->applyTransparencySettings();
 
+  render::engine->ensureSceneBufferSize();
   render::engine->sceneBuffer->clearColor = {0., 0., 0.};
   render::engine->sceneBuffer->clearAlpha = 0.;
   render::engine->sceneBuffer->clear();
@@ -426,6 +568,14 @@ void renderScene() {
 
   if (!options::renderScene) return;
 
+  // Temporal anti-aliasing jitters the camera for the whole frame, and resolves in to the final buffer at the end
+  bool useTAA = options::enableTAA;
+  if (useTAA) {
+    render::engine->beginTemporalAntiAliasing();
+  } else {
+    render::engine->invalidateTemporalHistory();
+  }
+
   if (render::engine->getTransparencyMode() == TransparencyMode::Pretty) {
     // Special depth peeling case: multiple render passes
     // We will perform several "peeled" rounds of rendering in to the usual scene buffer. After each, we will manually
@@ -442,17 +592,57 @@ void renderScene() {
     render::engine->sceneDepthMinFrame->clear();
 
 
-    for (int iPass = 0; iPass < options::transparencyRenderPasses; iPass++) {
+    // Passes stop early once one peels nothing. The occlusion query results are read without waiting on the GPU, so
+    // each pass checks the result of the pass before it, and is dropped if that one was empty (if the result isn't
+    // ready yet, peeling carries on). While the camera is moving, the passes are also capped by a time budget, using
+    // the GPU time per pass measured in earlier frames, and the scene is redrawn at full quality once it stops.
+    glm::mat4 viewMat = view::getCameraViewMatrix();
+    glm::mat4 projMat = view::getUnjitteredCameraPerspectiveMatrix();
+    bool cameraMoving = view::midflight || viewMat != lastPeelViewMat || projMat != lastPeelProjMat;
+    lastPeelViewMat = viewMat;
+    lastPeelProjMat = projMat;
+    internal::transparencyPeelPassesLastFrame = 0;
+
+    readPeelPassTimestamps();
+    int maxPasses = options::transparencyRenderPasses;
+    if (cameraMoving && options::transparencyPeelTimeBudgetMs > 0. && peelPassGPUTimeMs > 0.) {
+      int budgetPasses = static_cast<int>(options::transparencyPeelTimeBudgetMs / peelPassGPUTimeMs);
+      maxPasses = std::min(maxPasses, std::max(budgetPasses, 1));
+    }
+    bool timePasses = !peelTimestampsPending && render::engine->supportsGPUTimestamps();
+    if (timePasses) peelTimestampStart = render::engine->issueGPUTimestamp();
+
+    bool stoppedEmpty = false;
+    bool havePrevPassQuery = false;
+    uint32_t prevPassQuery = 0;
+    for (int iPass = 0; iPass < maxPasses; iPass++) {
 
       render::engine->bindSceneBuffer();
       render::engine->clearSceneBuffer();
 
+      // Only the structures are peeled, the ground plane is opaque and would count as a layer on every pass
       render::engine->applyTransparencySettings();
+      uint32_t passQuery = render::engine->beginAnySamplesQuery();
       drawStructures();
+      render::engine->endAnySamplesQuery();
+
+      // If the previous pass peeled nothing, neither did this one, nor would any further passes
+      if (havePrevPassQuery) {
+        bool prevAnyPeeled = true;
+        stoppedEmpty = render::engine->tryGetAnySamplesResult(prevPassQuery, prevAnyPeeled) && !prevAnyPeeled;
+        render::engine->releaseAnySamplesQuery(prevPassQuery);
+      }
+      prevPassQuery = passQuery;
+      havePrevPassQuery = true;
+      if (stoppedEmpty) break;
 
       // Draw ground plane, slicers, etc
       bool isRedraw = iPass > 0;
-      render::engine->groundPlane.draw(isRedraw);
+      {
+        profiler::ScopedTimer groundTimer("ground plane");
+        render::engine->groundPlane.draw(isRedraw);
+      }
+
       if (!isRedraw) {
         // Only on first pass (kinda weird, but works out, and doesn't really matter)
         renderSlicePlanes();
@@ -468,8 +658,57 @@ void renderScene() {
 
       // Update the minimum depth texture
       render::engine->updateMinDepthTexture();
+      internal::transparencyPeelPassesLastFrame++;
+    }
+    if (havePrevPassQuery) render::engine->releaseAnySamplesQuery(prevPassQuery);
+
+    if (timePasses) {
+      peelTimestampEnd = render::engine->issueGPUTimestamp();
+      peelTimestampPasses = internal::transparencyPeelPassesLastFrame;
+      peelTimestampsPending = true;
+    }
+
+    // Cut short by the budget, draw the remaining layers once the camera is still
+    if (!stoppedEmpty && maxPasses < options::transparencyRenderPasses) {
+      requestViewRedraw();
     }
 
+  } else if (render::engine->getTransparencyMode() == TransparencyMode::Weighted) {
+    // Weighted blended transparency: opaque structures are drawn as usual, then transparent structures are drawn once in
+    // to an accumulation buffer (depth-tested against the opaque ones), which is finally resolved over the scene.
+
+    // Clear the accumulation buffer. It shares the depth texture with the scene buffer, which was just cleared anyway.
+    render::engine->sceneBufferWeighted->clear();
+    render::engine->bindSceneBuffer();
+
+    render::engine->applyTransparencySettings();
+    drawStructuresByTransparency(false);
+
+    {
+      profiler::ScopedTimer groundTimer("ground plane");
+      render::engine->groundPlane.draw();
+    }
+    renderSlicePlanes();
+
+    {
+      profiler::ScopedTimer accumTimer("weighted transparency");
+      render::engine->sceneBufferWeighted->bindForRendering();
+      render::engine->setWeightedTransparencyAccumulate(true);
+      render::engine->applyTransparencySettings();
+      drawStructuresByTransparency(true);
+      render::engine->setWeightedTransparencyAccumulate(false);
+
+      // Resolve the accumulated layers over the opaque scene
+      render::engine->bindSceneBuffer();
+      render::engine->setDepthMode(DepthMode::Disable);
+      render::engine->setBlendMode(BlendMode::AlphaOver);
+      render::engine->compositeWeighted->draw();
+    }
+
+    render::engine->applyTransparencySettings();
+    drawStructuresDelayed();
+
+    render::engine->sceneBuffer->blitTo(render::engine->sceneBufferFinal.get());
 
   } else {
     // Normal case: single render pass
@@ -477,7 +716,10 @@ void renderScene() {
     render::engine->applyTransparencySettings();
     drawStructures();
 
-    render::engine->groundPlane.draw();
+    {
+      profiler::ScopedTimer groundTimer("ground plane");
+      render::engine->groundPlane.draw();
+    }
     renderSlicePlanes();
 
     render::engine->applyTransparencySettings();
@@ -485,11 +727,45 @@ void renderScene() {
 
     render::engine->sceneBuffer->blitTo(render::engine->sceneBufferFinal.get());
   }
+
+  if (useTAA) {
+    profiler::ScopedTimer taaTimer("temporal anti-aliasing");
+    render::engine->resolveTemporalAntiAliasing();
+  }
+}
+
+// Render each viewport in turn, keeping the results for compositing
+void renderViewports() {
+  for (std::unique_ptr<Viewport>& vp : state::viewports) {
+    profiler::ScopedTimer timer("viewport: ", vp->name);
+    ViewportScope scope(*vp);
+    renderScene();
+    vp->storeRenderedScene();
+  }
+}
+
+void renderViewportsToScreen() {
+  render::FrameBuffer& display = render::engine->getDisplayBuffer();
+  int windowBufferHeight = view::bufferHeight;
+  for (std::unique_ptr<Viewport>& vp : state::viewports) {
+    std::shared_ptr<render::TextureBuffer> tex = vp->getColorTexture();
+    if (!tex) continue;
+    glm::ivec4 pixelRegion = vp->getPixelRegion();
+    ViewportScope scope(*vp);
+    display.setViewport(pixelRegion.x, windowBufferHeight - pixelRegion.y - pixelRegion.w, pixelRegion.z,
+                        pixelRegion.w);
+    render::engine->bindDisplay();
+    render::engine->applyLightingTransform(tex);
+  }
+  display.setViewport(0, 0, view::bufferWidth, view::bufferHeight);
 }
 
 void renderSceneToScreen() {
+  profiler::ScopedTimer timer("renderSceneToScreen");
   render::engine->bindDisplay();
-  if (options::debugDrawPickBuffer) {
+  if (!state::viewports.empty()) {
+    renderViewportsToScreen();
+  } else if (options::debugDrawPickBuffer) {
     // special debug draw
     pick::evaluatePickQuery(-1, -1); // populate the buffer
     render::engine->pickFramebuffer->blitTo(render::engine->displayBuffer.get());
@@ -603,6 +879,8 @@ void buildPolyscopeGui() {
 			ImGui::TextUnformatted("   Select elements of a structure with [left click]. Data from");
 			ImGui::TextUnformatted("     that element will be shown on the right. Use [right click]");
 			ImGui::TextUnformatted("     to clear the selection.");
+			ImGui::TextUnformatted("   Select everything in a box with [ctrl] + [left click drag], or");
+			ImGui::TextUnformatted("     in a lasso with [ctrl] + [alt] + [left click drag].");
 		ImGui::End();
     // clang-format on
   }
@@ -632,6 +910,11 @@ void buildPolyscopeGui() {
     ImGui::SameLine();
     ImGui::Checkbox("vsync", &options::enableVSync);
 
+    scheduler::FrameTimeStats frameStats = scheduler::getFrameTimeStats();
+    ImGui::Text("Frame work p50/p90/p99: %.1f / %.1f / %.1f ms", frameStats.p50Ms, frameStats.p90Ms, frameStats.p99Ms);
+    ImGui::Text("Deferred tasks: %d (budget %.1f ms)", static_cast<int>(scheduler::getDeferredTaskCount()),
+                scheduler::getFrameBudgetMs());
+
     ImGui::TreePop();
   }
 
@@ -643,6 +926,7 @@ void buildPolyscopeGui() {
     }
     ImGui::Checkbox("Show pick buffer", &options::debugDrawPickBuffer);
     ImGui::Checkbox("Always redraw", &options::alwaysRedraw);
+    ImGui::Checkbox("Profiler", &options::enableProfiler);
 
     static bool showDebugTextures = false;
     ImGui::Checkbox("Show debug textures", &showDebugTextures);
@@ -731,6 +1015,24 @@ void buildPickGui() {
   }
 }
 
+void buildSelectionDragOverlay() {
+  if (!selectionDragActive || selectionDragScreenPts.size() < 2) return;
+
+  ImDrawList* drawList = ImGui::GetForegroundDrawList();
+  ImU32 color = IM_COL32(255, 255, 255, 200);
+  if (selectionDragIsLasso) {
+    for (size_t i = 0; i < selectionDragScreenPts.size(); i++) {
+      glm::vec2 pA = selectionDragScreenPts[i];
+      glm::vec2 pB = selectionDragScreenPts[(i + 1) % selectionDragScreenPts.size()];
+      drawList->AddLine(ImVec2(pA.x, pA.y), ImVec2(pB.x, pB.y), color);
+    }
+  } else {
+    glm::vec2 pMin = glm::min(selectionDragScreenPts[0], selectionDragScreenPts[1]);
+    glm::vec2 pMax = glm::max(selectionDragScreenPts[0], selectionDragScreenPts[1]);
+    drawList->AddRect(ImVec2(pMin.x, pMin.y), ImVec2(pMax.x, pMax.y), color);
+  }
+}
+
 void buildUserGuiAndInvokeCallback() {
 
   if (!options::invokeUserCallbackForNestedShow && contextStack.size() > 2) {
@@ -775,19 +1077,25 @@ void draw(bool withUI, bool withContextCallback) {
 
   // Build the GUI components
   if (withUI) {
+    profiler::ScopedTimer timer("build UI");
     if (contextStack.back().drawDefaultUI) {
 
       // Note: It is important to build the user GUI first, because it is likely that callbacks there will modify
       // polyscope data. If we do these modifications happen later in the render cycle, they might invalidate data which
       // is necessary when ImGui::Render() happens below.
-      buildUserGuiAndInvokeCallback();
+      {
+        profiler::ScopedTimer userTimer("user callback");
+        buildUserGuiAndInvokeCallback();
+      }
 
       if (options::buildGui) {
         if (options::buildDefaultGuiPanels) {
           buildPolyscopeGui();
           buildStructureGui();
           buildPickGui();
+          if (options::enableProfiler) profiler::buildProfilerUI();
         }
+        buildSelectionDragOverlay();
 
         for (WeakHandle<Widget> wHandle : state::widgets) {
           if (wHandle.isValid()) {
@@ -809,8 +1117,12 @@ void draw(bool withUI, bool withContextCallback) {
 
   // Draw structures in the scene
   if (redrawNextFrame || options::alwaysRedraw) {
-    renderScene();
-    redrawNextFrame = false;
+    redrawNextFrame = false; // cleared first, so that rendering (or another thread) may request the next frame
+    if (state::viewports.empty()) {
+      renderScene();
+    } else {
+      renderViewports();
+    }
   }
   renderSceneToScreen();
 
@@ -825,6 +1137,7 @@ void draw(bool withUI, bool withContextCallback) {
       }
     }
 
+    profiler::ScopedTimer timer("ImGui render");
     render::engine->bindDisplay();
     render::engine->ImGuiRender();
   }
@@ -833,23 +1146,43 @@ void draw(bool withUI, bool withContextCallback) {
 
 void mainLoopIteration() {
 
-  processLazyProperties();
+  profiler::beginFrame();
+  scheduler::beginFrame();
 
   render::engine->makeContextCurrent();
   render::engine->updateWindowSize();
 
+  // Swap in any data published by other threads since the last frame. This uploads to the GPU, so the context must be
+  // current.
+  render::applyStagedBufferUpdates();
+
+  processLazyProperties();
+  render::engine->processPendingPrograms(); // compiles shaders, also needs the context
+
   // Process UI events
-  render::engine->pollEvents();
-  processInputEvents();
-  view::updateFlight();
-  showDelayedWarnings();
+  {
+    profiler::ScopedTimer timer("process events");
+    render::engine->pollEvents();
+    processInputEvents();
+    view::updateFlight();
+    showDelayedWarnings();
+  }
 
   // Housekeeping
   purgeWidgets();
 
   // Rendering
   draw();
-  render::engine->swapDisplayBuffers();
+  {
+    profiler::ScopedTimer timer("swap buffers");
+    render::engine->swapDisplayBuffers();
+  }
+
+  // Deferred work goes after the frame is presented, so that it delays the next frame rather than this one
+  scheduler::runDeferredTasks();
+
+  scheduler::endFrame();
+  profiler::endFrame();
 }
 
 void show(size_t forFrames) {
@@ -1193,6 +1526,8 @@ float shadowDarkness = .4;
 
 void processLazyProperties() {
 
+  profiler::ScopedTimer timer("processLazyProperties");
+
   // Note: This function essentially represents lazy software design, and it's an ugly and error-prone part of the
   // system. The reason for it that some settings require action on a change (e..g re-drawing the scene), but we want to
   // allow variable-set syntax like `polyscope::setting = newVal;` rather than getters and setters like
@@ -1247,34 +1582,86 @@ void processLazyProperties() {
   }
 };
 
-void updateStructureExtents() {
+namespace {
 
-  if (!options::automaticallyComputeSceneExtents) {
+// The extents of each structure which has them, as of the last time the scene extents were computed. The values are
+// also kept sorted, per component, so that replacing one structure's extents and finding the new scene extents is
+// O(log n) in the number of structures.
+struct StructureExtents {
+  glm::vec3 bboxMin;
+  glm::vec3 bboxMax;
+  float lengthScale;
+};
+std::unordered_map<Structure*, StructureExtents> lastStructureExtents;
+std::array<std::multiset<float>, 3> sortedBboxMins, sortedBboxMaxs;
+std::multiset<float> sortedLengthScales;
+size_t nNaNStructureExtents = 0;         // NaNs can't be sorted, these are only counted
+bool structureExtentsAreTracked = false; // false if the above were last cleared with automatic extents off
+
+StructureExtents getStructureExtents(Structure* s) {
+  std::tuple<glm::vec3, glm::vec3> bbox = s->boundingBox();
+  return StructureExtents{std::get<0>(bbox), std::get<1>(bbox), s->lengthScale()};
+}
+
+bool hasNaN(const StructureExtents& ext) {
+  return glm::any(glm::isnan(ext.bboxMin)) || glm::any(glm::isnan(ext.bboxMax)) || std::isnan(ext.lengthScale);
+}
+
+void clearStructureExtents() {
+  lastStructureExtents.clear();
+  for (int i = 0; i < 3; i++) {
+    sortedBboxMins[i].clear();
+    sortedBboxMaxs[i].clear();
+  }
+  sortedLengthScales.clear();
+  nNaNStructureExtents = 0;
+  structureExtentsAreTracked = false;
+}
+
+void insertStructureExtents(Structure* s, const StructureExtents& ext) {
+  lastStructureExtents[s] = ext;
+  if (hasNaN(ext)) {
+    nNaNStructureExtents++;
     return;
   }
+  for (int i = 0; i < 3; i++) {
+    sortedBboxMins[i].insert(ext.bboxMin[i]);
+    sortedBboxMaxs[i].insert(ext.bboxMax[i]);
+  }
+  sortedLengthScales.insert(ext.lengthScale);
+}
 
-  // Note: the cost multiple calls to this function scales only with the number of structures, not the size of the data
-  // in those structures, because structures internally cache the extents of their data.
+void eraseStructureExtents(std::unordered_map<Structure*, StructureExtents>::iterator it) {
+  const StructureExtents& ext = it->second;
+  if (hasNaN(ext)) {
+    nNaNStructureExtents--;
+  } else {
+    // (erase a single entry, others may have the same value)
+    for (int i = 0; i < 3; i++) {
+      sortedBboxMins[i].erase(sortedBboxMins[i].find(ext.bboxMin[i]));
+      sortedBboxMaxs[i].erase(sortedBboxMaxs[i].find(ext.bboxMax[i]));
+    }
+    sortedLengthScales.erase(sortedLengthScales.find(ext.lengthScale));
+  }
+  lastStructureExtents.erase(it);
+}
+
+// Set the scene extents from the union of the sorted structure extents
+void applyStructureExtents() {
 
-  // Compute length scale and bbox as the max of all structures
-  state::lengthScale = 0.0;
   glm::vec3 minBbox = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
   glm::vec3 maxBbox = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-
-  for (auto& cat : state::structures) {
-    for (auto& x : cat.second) {
-      if (!x.second->hasExtents()) {
-        continue;
-      }
-      state::lengthScale = std::max(state::lengthScale, x.second->lengthScale());
-      auto bbox = x.second->boundingBox();
-      minBbox = componentwiseMin(minBbox, std::get<0>(bbox));
-      maxBbox = componentwiseMax(maxBbox, std::get<1>(bbox));
+  state::lengthScale = 0.0;
+  if (!sortedLengthScales.empty()) {
+    for (int i = 0; i < 3; i++) {
+      minBbox[i] = *sortedBboxMins[i].begin();
+      maxBbox[i] = *sortedBboxMaxs[i].rbegin();
     }
+    state::lengthScale = std::max(0.f, *sortedLengthScales.rbegin());
   }
 
   // If we got a non-finite bounding box, fix it
-  if (!isFinite(minBbox) || !isFinite(maxBbox)) {
+  if (nNaNStructureExtents > 0 || !isFinite(minBbox) || !isFinite(maxBbox)) {
     minBbox = -glm::vec3{1, 1, 1};
     maxBbox = glm::vec3{1, 1, 1};
   }
@@ -1297,9 +1684,68 @@ void updateStructureExtents() {
     state::lengthScale = glm::length(maxBbox - minBbox);
   }
 
+  internal::sceneGeometryVersion++; // a structure was moved, added, removed, or updated
   requestRedraw();
 }
 
+} // namespace
+
+void updateStructureExtents() {
+
+  clearStructureExtents();
+
+  if (!options::automaticallyComputeSceneExtents) {
+    return;
+  }
+
+  // Note: the cost multiple calls to this function scales only with the number of structures, not the size of the data
+  // in those structures, because structures internally cache the extents of their data.
+
+  for (auto& cat : state::structures) {
+    for (auto& x : cat.second) {
+      if (!x.second->hasExtents()) {
+        continue;
+      }
+      insertStructureExtents(x.second.get(), getStructureExtents(x.second.get()));
+    }
+  }
+  structureExtentsAreTracked = true;
+
+  applyStructureExtents();
+}
+
+void updateStructureExtents(Structure* structure) {
+
+  if (!options::automaticallyComputeSceneExtents) {
+    clearStructureExtents();
+    return;
+  }
+
+  // Structures which aren't registered yet (e.g. while they are being centered during registration) are picked up
+  // when they are added
+  auto catIt = state::structures.find(structure->typeName());
+  if (catIt == state::structures.end()) return;
+  auto sIt = catIt->second.find(structure->name);
+  if (sIt == catIt->second.end() || sIt->second.get() != structure) return;
+
+  // The extents may be out of sync with the structures if automatic extents were off
+  if (!structureExtentsAreTracked) {
+    updateStructureExtents();
+    return;
+  }
+
+  // Replace the structure's old extents with its new ones
+  auto prevIt = lastStructureExtents.find(structure);
+  if (prevIt != lastStructureExtents.end()) {
+    eraseStructureExtents(prevIt);
+  }
+  if (structure->hasExtents()) {
+    insertStructureExtents(structure, getStructureExtents(structure));
+  }
+
+  applyStructureExtents();
+}
+
 namespace state {
 glm::vec3 center() { return 0.5f * (std::get<0>(state::boundingBox) + std::get<1>(state::boundingBox)); }
 } // namespace state
@@ -0,0 +1,377 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/profiler.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/options.h"
+#include "polyscope/render/engine.h"
+
+#include "imgui.h"
+#include "json/json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+
+using json = nlohmann::json;
+
+namespace polyscope {
+namespace profiler {
+
+namespace detail {
+bool recording = false;
+Counters frameCounters;
+} // namespace detail
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Clock::time_point epoch;
+Clock::time_point frameStart;
+bool haveEpoch = false;
+
+int frameDepth = 0; // frames nest when show() is called from within a callback; only the outermost is recorded
+FrameProfile currFrame;
+std::vector<size_t> openTimers; // indices in to currFrame.events
+std::deque<FrameProfile> history;
+uint64_t nextFrameIndex = 0;
+
+// Give up on GPU results which have not arrived after this many frames
+const uint64_t GPU_RESULT_MAX_LATENCY = 8;
+
+double msSince(Clock::time_point t) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+bool useGPUTimers() { return render::engine != nullptr && render::engine->supportsGPUTimestamps(); }
+
+void releaseGPUQueries(TimerEvent& e) {
+  if (!e.gpuPending) return;
+  render::engine->releaseGPUTimestamp(e.gpuQueryStart);
+  if (e.gpuQueryEnd != e.gpuQueryStart) render::engine->releaseGPUTimestamp(e.gpuQueryEnd);
+  e.gpuPending = false;
+}
+
+void releaseGPUQueries(FrameProfile& f) {
+  if (!f.gpuPending) return;
+  for (TimerEvent& e : f.events) releaseGPUQueries(e);
+  f.gpuPending = false;
+}
+
+// Poll for GPU timer results of previous frames, without blocking
+void resolveGPUResults() {
+  for (FrameProfile& f : history) {
+    if (!f.gpuPending) continue;
+
+    bool tooOld = nextFrameIndex - f.frameIndex > GPU_RESULT_MAX_LATENCY;
+    bool anyPending = false;
+    for (TimerEvent& e : f.events) {
+      if (!e.gpuPending) continue;
+
+      int64_t tStart, tEnd;
+      if (render::engine->tryGetGPUTimestamp(e.gpuQueryStart, tStart) &&
+          render::engine->tryGetGPUTimestamp(e.gpuQueryEnd, tEnd)) {
+        e.gpuMs = 1e-6 * static_cast<double>(tEnd - tStart);
+        releaseGPUQueries(e);
+      } else if (tooOld) {
+        releaseGPUQueries(e);
+      } else {
+        anyPending = true;
+      }
+    }
+    f.gpuPending = anyPending;
+  }
+}
+
+// Mean CPU/GPU time per occurrence of each named timer, over the history
+struct TimerSummary {
+  size_t count = 0;
+  double cpuMsTotal = 0.;
+  size_t gpuCount = 0;
+  double gpuMsTotal = 0.;
+};
+
+std::map<std::string, TimerSummary> summarizeTimers() {
+  std::map<std::string, TimerSummary> summaries;
+  for (const FrameProfile& f : history) {
+    for (const TimerEvent& e : f.events) {
+      TimerSummary& s = summaries[e.name];
+      s.count++;
+      s.cpuMsTotal += e.cpuMs();
+      if (e.gpuMs >= 0.) {
+        s.gpuCount++;
+        s.gpuMsTotal += e.gpuMs;
+      }
+    }
+  }
+  return summaries;
+}
+
+void writeStringToFile(const std::string& filename, const std::string& contents) {
+  std::ofstream outFile(filename);
+  if (!outFile) {
+    exception("could not open profiler output file " + filename);
+  }
+  outFile << contents;
+}
+
+} // namespace
+
+void beginFrame() {
+  frameDepth++;
+  if (frameDepth > 1 || !options::enableProfiler) return;
+
+  if (!haveEpoch) {
+    epoch = Clock::now();
+    haveEpoch = true;
+  }
+
+  if (useGPUTimers()) resolveGPUResults();
+
+  currFrame = FrameProfile();
+  currFrame.frameIndex = nextFrameIndex++;
+  currFrame.startMs = msSince(epoch);
+  frameStart = Clock::now();
+  openTimers.clear();
+  detail::frameCounters = Counters();
+  detail::recording = true;
+}
+
+void endFrame() {
+  frameDepth = std::max(frameDepth - 1, 0);
+  if (frameDepth > 0 || !detail::recording) return;
+
+  while (!openTimers.empty()) {
+    popTimer();
+  }
+
+  currFrame.cpuMs = msSince(frameStart);
+  currFrame.counters = detail::frameCounters;
+  for (const TimerEvent& e : currFrame.events) {
+    if (e.gpuPending) currFrame.gpuPending = true;
+  }
+
+  history.push_back(std::move(currFrame));
+  while (history.size() > HISTORY_LENGTH) {
+    releaseGPUQueries(history.front());
+    history.pop_front();
+  }
+
+  detail::recording = false;
+}
+
+bool isRecording() { return detail::recording; }
+
+void pushTimer(const std::string& name) {
+  if (!detail::recording) return;
+
+  TimerEvent e;
+  e.name = name;
+  e.depth = static_cast<int>(openTimers.size());
+  e.cpuStartMs = msSince(frameStart);
+  if (useGPUTimers()) {
+    e.gpuQueryStart = render::engine->issueGPUTimestamp();
+    e.gpuQueryEnd = e.gpuQueryStart;
+    e.gpuPending = true;
+  }
+
+  openTimers.push_back(currFrame.events.size());
+  currFrame.events.push_back(std::move(e));
+}
+
+void popTimer() {
+  if (!detail::recording || openTimers.empty()) return;
+
+  TimerEvent& e = currFrame.events[openTimers.back()];
+  openTimers.pop_back();
+
+  e.cpuEndMs = msSince(frameStart);
+  if (e.gpuPending) {
+    e.gpuQueryEnd = render::engine->issueGPUTimestamp();
+  }
+}
+
+ScopedTimer::ScopedTimer(const char* name) : active(detail::recording) {
+  if (active) pushTimer(name);
+}
+
+ScopedTimer::ScopedTimer(const char* prefix, const std::string& name) : active(detail::recording) {
+  if (active) pushTimer(prefix + name);
+}
+
+ScopedTimer::~ScopedTimer() {
+  if (active) popTimer();
+}
+
+const std::deque<FrameProfile>& getFrameHistory() { return history; }
+
+void clearHistory() {
+  for (FrameProfile& f : history) {
+    releaseGPUQueries(f);
+  }
+  history.clear();
+}
+
+std::string exportJSON() {
+
+  json j;
+
+  // Summary over the history
+  double cpuMsTotal = 0.;
+  double cpuMsMax = 0.;
+  for (const FrameProfile& f : history) {
+    cpuMsTotal += f.cpuMs;
+    cpuMsMax = std::max(cpuMsMax, f.cpuMs);
+  }
+  j["summary"]["frameCount"] = history.size();
+  j["summary"]["cpuMsMean"] = history.empty() ? 0. : cpuMsTotal / history.size();
+  j["summary"]["cpuMsMax"] = cpuMsMax;
+  for (const auto& entry : summarizeTimers()) {
+    const TimerSummary& s = entry.second;
+    json& jt = j["summary"]["timers"][entry.first];
+    jt["count"] = s.count;
+    jt["cpuMsMean"] = s.cpuMsTotal / s.count;
+    jt["gpuMsMean"] = s.gpuCount > 0 ? s.gpuMsTotal / s.gpuCount : -1.;
+  }
+
+  // Raw frames
+  j["frames"] = json::array();
+  for (const FrameProfile& f : history) {
+    json jf;
+    jf["index"] = f.frameIndex;
+    jf["startMs"] = f.startMs;
+    jf["cpuMs"] = f.cpuMs;
+    jf["drawCalls"] = f.counters.drawCalls;
+    jf["bytesUploaded"] = f.counters.bytesUploaded;
+    jf["shaderCompiles"] = f.counters.shaderCompiles;
+    jf["events"] = json::array();
+    for (const TimerEvent& e : f.events) {
+      jf["events"].push_back(json{{"name", e.name},
+                                  {"depth", e.depth},
+                                  {"cpuStartMs", e.cpuStartMs},
+                                  {"cpuMs", e.cpuMs()},
+                                  {"gpuMs", e.gpuMs}});
+    }
+    j["frames"].push_back(jf);
+  }
+
+  return j.dump(2);
+}
+
+std::string exportChromeTrace() {
+
+  // CPU scopes go on thread 1, GPU scopes on thread 2 (placed at the CPU time they were issued), times in microseconds
+  json events = json::array();
+  events.push_back(json{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 1}, {"args", {{"name", "CPU"}}}});
+  events.push_back(json{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 2}, {"args", {{"name", "GPU"}}}});
+
+  for (const FrameProfile& f : history) {
+    double frameUs = 1e3 * f.startMs;
+    events.push_back(json{{"name", "frame " + std::to_string(f.frameIndex)},
+                          {"cat", "frame"},
+                          {"ph", "X"},
+                          {"ts", frameUs},
+                          {"dur", 1e3 * f.cpuMs},
+                          {"pid", 1},
+                          {"tid", 1}});
+    events.push_back(json{{"name", "counters"},
+                          {"ph", "C"},
+                          {"ts", frameUs},
+                          {"pid", 1},
+                          {"args",
+                           {{"drawCalls", f.counters.drawCalls},
+                            {"bytesUploaded", f.counters.bytesUploaded},
+                            {"shaderCompiles", f.counters.shaderCompiles}}}});
+
+    for (const TimerEvent& e : f.events) {
+      double startUs = frameUs + 1e3 * e.cpuStartMs;
+      events.push_back(json{{"name", e.name},
+                            {"cat", "cpu"},
+                            {"ph", "X"},
+                            {"ts", startUs},
+                            {"dur", 1e3 * e.cpuMs()},
+                            {"pid", 1},
+                            {"tid", 1}});
+      if (e.gpuMs >= 0.) {
+        events.push_back(json{{"name", e.name},
+                              {"cat", "gpu"},
+                              {"ph", "X"},
+                              {"ts", startUs},
+                              {"dur", 1e3 * e.gpuMs},
+                              {"pid", 1},
+                              {"tid", 2}});
+      }
+    }
+  }
+
+  json j;
+  j["traceEvents"] = events;
+  j["displayTimeUnit"] = "ms";
+  return j.dump();
+}
+
+void writeJSON(std::string filename) { writeStringToFile(filename, exportJSON()); }
+
+void writeChromeTrace(std::string filename) { writeStringToFile(filename, exportChromeTrace()); }
+
+void buildProfilerUI() {
+
+  ImGui::SetNextWindowSize(ImVec2(450, 500), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Profiler", &options::enableProfiler)) {
+    ImGui::End();
+    return;
+  }
+
+  if (history.empty()) {
+    ImGui::TextUnformatted("No frames recorded yet.");
+    ImGui::End();
+    return;
+  }
+
+  // Frame time plot
+  std::vector<float> frameTimes;
+  double cpuMsTotal = 0.;
+  double cpuMsMax = 0.;
+  for (const FrameProfile& f : history) {
+    frameTimes.push_back(static_cast<float>(f.cpuMs));
+    cpuMsTotal += f.cpuMs;
+    cpuMsMax = std::max(cpuMsMax, f.cpuMs);
+  }
+  ImGui::PlotLines("##frame times", &frameTimes.front(), static_cast<int>(frameTimes.size()), 0, "frame CPU ms", 0.f,
+                   static_cast<float>(cpuMsMax), ImVec2(ImGui::GetWindowWidth() * 0.9f, 60));
+  ImGui::Text("Frame: %.2f ms mean, %.2f ms max (%zu frames)", cpuMsTotal / history.size(), cpuMsMax,
+              history.size());
+
+  const FrameProfile& last = history.back();
+  ImGui::Text("Draw calls: %llu   Uploaded: %.2f MB   Shader compiles: %llu",
+              static_cast<unsigned long long>(last.counters.drawCalls), last.counters.bytesUploaded / (1024. * 1024.),
+              static_cast<unsigned long long>(last.counters.shaderCompiles));
+
+  if (ImGui::Button("Export JSON")) writeJSON("polyscope_profile.json");
+  ImGui::SameLine();
+  if (ImGui::Button("Export trace")) writeChromeTrace("polyscope_trace.json");
+  ImGui::SameLine();
+  if (ImGui::Button("Clear")) clearHistory();
+
+  ImGui::Separator();
+
+  // Per-timer means over the history, in the nesting order of the last frame
+  std::map<std::string, TimerSummary> summaries = summarizeTimers();
+  ImGui::TextUnformatted("Timer (mean over history)          CPU ms     GPU ms");
+  for (const TimerEvent& e : last.events) {
+    const TimerSummary& s = summaries[e.name];
+    std::string label = std::string(2 * e.depth, ' ') + e.name;
+    if (s.gpuCount > 0) {
+      ImGui::Text("%-32.32s %8.3f   %8.3f", label.c_str(), s.cpuMsTotal / s.count, s.gpuMsTotal / s.gpuCount);
+    } else {
+      ImGui::Text("%-32.32s %8.3f          -", label.c_str(), s.cpuMsTotal / s.count);
+    }
+  }
+
+  ImGui::End();
+}
+
+} // namespace profiler
+} // namespace polyscope
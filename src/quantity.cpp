@@ -31,7 +31,11 @@ void Quantity::buildPickUI(size_t localPickInd) {}
 
 bool Quantity::isEnabled() { return enabled.get(); }
 
-void Quantity::refresh() { requestRedraw(); }
+// Even disabled quantities can contribute to drawing their parent (e.g. a scalar used as the point radius), so only
+// the parent's visibility counts
+bool Quantity::hasVisualImpact() { return parent.hasVisualImpact(); }
+
+void Quantity::refresh() { requestRedrawIfVisible(); }
 
 std::string Quantity::niceName() { return name; }
 
@@ -0,0 +1,41 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/render/buffer_staging.h"
+
+#include "polyscope/profiler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace polyscope {
+namespace render {
+
+namespace {
+
+// Buffers which have a staging slot. Only touched from the render thread.
+std::vector<std::pair<GenericWeakHandle, std::function<void()>>> stagedBuffers;
+
+} // namespace
+
+void registerStagedBuffer(GenericWeakHandle buffer, std::function<void()> apply) {
+  stagedBuffers.emplace_back(buffer, apply);
+}
+
+void applyStagedBufferUpdates() {
+  if (stagedBuffers.empty()) return;
+  profiler::ScopedTimer timer("apply staged buffers");
+
+  // Forget buffers which have been deleted. Their slots are freed once producers release them too.
+  stagedBuffers.erase(std::remove_if(stagedBuffers.begin(), stagedBuffers.end(),
+                                     [](const std::pair<GenericWeakHandle, std::function<void()>>& b) {
+                                       return !b.first.isValid();
+                                     }),
+                      stagedBuffers.end());
+
+  for (size_t i = 0; i < stagedBuffers.size(); i++) {
+    stagedBuffers[i].second();
+  }
+}
+
+} // namespace render
+} // namespace polyscope
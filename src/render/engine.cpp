@@ -6,10 +6,13 @@
 #include "polyscope/polyscope.h"
 #include "polyscope/render/colormap_defs.h"
 #include "polyscope/render/material_defs.h"
+#include "polyscope/scheduler.h"
 
 #include "imgui.h"
 #include "stb_image.h"
 
+#include <chrono>
+
 namespace polyscope {
 
 int dimension(const TextureFormat& x) {
@@ -126,6 +129,8 @@ std::string modeName(const TransparencyMode& m) {
     return "Simple";
   case TransparencyMode::Pretty:
     return "Pretty";
+  case TransparencyMode::Weighted:
+    return "Weighted";
   }
   return "";
 }
@@ -175,6 +180,11 @@ TextureBuffer::~TextureBuffer() {}
 
 void TextureBuffer::setFilterMode(FilterMode newMode) {}
 
+void TextureBuffer::setSubData2D(unsigned int x0, unsigned int y0, unsigned int w, unsigned int h, const float* data,
+                                 unsigned int rowLength) {
+  exception("setSubData2D() not implemented for this texture");
+}
+
 void TextureBuffer::resize(unsigned int newLen) { sizeX = newLen; }
 void TextureBuffer::resize(unsigned int newX, unsigned int newY) {
   sizeX = newX;
@@ -260,12 +270,12 @@ ShaderReplacementRule::ShaderReplacementRule(std::string ruleName_,
 ShaderProgram::ShaderProgram(DrawMode dm) : drawMode(dm), uniqueID(render::engine->getNextUniqueID()) {
 
   drawMode = dm;
-  if (dm == DrawMode::IndexedLines || dm == DrawMode::IndexedLineStrip || dm == DrawMode::IndexedLineStripAdjacency ||
-      dm == DrawMode::IndexedTriangles) {
+  if (dm == DrawMode::IndexedPoints || dm == DrawMode::IndexedLines || dm == DrawMode::IndexedLineStrip ||
+      dm == DrawMode::IndexedLineStripAdjacency || dm == DrawMode::IndexedTriangles) {
     useIndex = true;
   }
 
-  if (dm == DrawMode::IndexedLineStripAdjacency) {
+  if (dm == DrawMode::IndexedLineStrip || dm == DrawMode::IndexedLineStripAdjacency) {
     usePrimitiveRestart = true;
   }
 }
@@ -296,7 +306,8 @@ void Engine::buildEngineGui() {
     if (ImGui::TreeNode("Transparency")) {
 
       if (ImGui::BeginCombo("Mode", modeName(transparencyMode).c_str())) {
-        for (TransparencyMode m : {TransparencyMode::None, TransparencyMode::Simple, TransparencyMode::Pretty}) {
+        for (TransparencyMode m : {TransparencyMode::None, TransparencyMode::Simple, TransparencyMode::Pretty,
+                                   TransparencyMode::Weighted}) {
           std::string mName = modeName(m);
           if (ImGui::Selectable(mName.c_str(), transparencyMode == m)) {
             options::transparencyMode = m;
@@ -305,6 +316,9 @@ void Engine::buildEngineGui() {
         }
         ImGui::EndCombo();
       }
+      if (transparencyModePending) {
+        ImGui::TextUnformatted("(compiling shaders...)");
+      }
 
       switch (transparencyMode) {
       case TransparencyMode::None: {
@@ -322,6 +336,18 @@ void Engine::buildEngineGui() {
         if (ImGui::InputInt("Render Passes", &options::transparencyRenderPasses)) {
           requestRedraw();
         }
+        if (ImGui::InputFloat("Budget (ms)", &options::transparencyPeelTimeBudgetMs)) {
+          requestRedraw();
+        }
+        if (ImGui::IsItemHovered()) {
+          ImGui::SetTooltip("While the camera is moving, stop peeling after this long. <= 0 for no limit.");
+        }
+        ImGui::Text("Passes used: %d", internal::transparencyPeelPassesLastFrame);
+        break;
+      }
+      case TransparencyMode::Weighted: {
+        ImGui::TextWrapped("Fast single-pass transparent rendering. Depth order is approximated, so overlapping "
+                           "transparent surfaces may blend together more than in Pretty mode.");
         break;
       }
       }
@@ -352,6 +378,16 @@ void Engine::buildEngineGui() {
         options::ssaaFactor = ssaaFactor;
         requestRedraw();
       }
+      if (ImGui::Checkbox("TAA (temporal)", &options::enableTAA)) {
+        requestRedraw();
+      }
+      if (options::enableTAA) {
+        if (ImGui::InputInt("TAA samples", &options::taaMaxSamples, 1)) {
+          options::taaMaxSamples = std::max(options::taaMaxSamples, 1);
+          requestRedraw();
+        }
+        ImGui::Text("Accumulated: %d", taaSampleCount);
+      }
       ImGui::TreePop();
     }
 
@@ -434,6 +470,8 @@ void Engine::setCurrentViewport(glm::vec4 val) { currViewport = val; }
 glm::vec4 Engine::getCurrentViewport() { return currViewport; }
 void Engine::setCurrentPixelScaling(float val) { currPixelScale = val; }
 float Engine::getCurrentPixelScaling() { return currPixelScale; }
+DepthMode Engine::getDepthMode() { return currDepthMode; }
+BlendMode Engine::getBlendMode() { return currBlendMode; }
 
 void Engine::bindDisplay() {
   FrameBuffer& targetBuffer = getDisplayBuffer();
@@ -454,9 +492,21 @@ void Engine::resizeScreenBuffers() {
   unsigned int height = view::bufferHeight;
   displayBuffer->resize(width, height);
   displayBufferAlt->resize(width, height);
+  resizeSceneBuffers();
+}
+
+void Engine::resizeSceneBuffers() {
+  unsigned int width = view::bufferWidth;
+  unsigned int height = view::bufferHeight;
+  sceneBufferSize = glm::ivec2{width, height};
   sceneBuffer->resize(ssaaFactor * width, ssaaFactor * height);
   sceneBufferFinal->resize(ssaaFactor * width, ssaaFactor * height);
   sceneDepthMinFrame->resize(ssaaFactor * width, ssaaFactor * height);
+  sceneBufferWeighted->resize(ssaaFactor * width, ssaaFactor * height);
+  for (int i = 0; i < 2; i++) {
+    sceneBufferHistory[i]->resize(ssaaFactor * width, ssaaFactor * height);
+  }
+  invalidateTemporalHistory();
 }
 
 void Engine::setScreenBufferViewports() {
@@ -467,9 +517,29 @@ void Engine::setScreenBufferViewports() {
 
   displayBuffer->setViewport(xStart, yStart, sizeX, sizeY);
   displayBufferAlt->setViewport(xStart, yStart, sizeX, sizeY);
+  setSceneBufferViewports();
+}
+
+void Engine::setSceneBufferViewports() {
+  unsigned int xStart = 0;
+  unsigned int yStart = 0;
+  unsigned int sizeX = view::bufferWidth;
+  unsigned int sizeY = view::bufferHeight;
+
   sceneBuffer->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
   sceneBufferFinal->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
   sceneDepthMinFrame->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
+  sceneBufferWeighted->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
+  for (int i = 0; i < 2; i++) {
+    sceneBufferHistory[i]->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX,
+                                       ssaaFactor * sizeY);
+  }
+}
+
+void Engine::ensureSceneBufferSize() {
+  if (sceneBufferSize == glm::ivec2{view::bufferWidth, view::bufferHeight}) return;
+  resizeSceneBuffers();
+  setSceneBufferViewports();
 }
 
 bool Engine::bindSceneBuffer() {
@@ -518,6 +588,8 @@ void Engine::applyLightingTransform(std::shared_ptr<TextureBuffer>& texture) {
       break;
     case TransparencyMode::Pretty:
       break;
+    case TransparencyMode::Weighted:
+      break;
     }
 
     mapLight = render::engine->requestShader("MAP_LIGHT", resolveRules, render::ShaderReplacementDefaults::Process);
@@ -580,49 +652,134 @@ void Engine::renderBackground() {
 }
 
 
-void Engine::setTransparencyMode(TransparencyMode newMode) {
+std::vector<std::string> Engine::sceneObjectRulesForTransparencyMode(TransparencyMode mode) {
+  std::vector<std::string> rules = defaultRules_sceneObject;
+
   // Remove any old transparency-related rules
   switch (transparencyMode) {
   case TransparencyMode::None: {
     break;
   }
   case TransparencyMode::Simple: {
-    defaultRules_sceneObject.erase(
-        std::remove(defaultRules_sceneObject.begin(), defaultRules_sceneObject.end(), "TRANSPARENCY_STRUCTURE"),
-        defaultRules_sceneObject.end());
+    rules.erase(std::remove(rules.begin(), rules.end(), "TRANSPARENCY_STRUCTURE"), rules.end());
     break;
   }
   case TransparencyMode::Pretty: {
-    defaultRules_sceneObject.erase(
-        std::remove(defaultRules_sceneObject.begin(), defaultRules_sceneObject.end(), "TRANSPARENCY_PEEL_STRUCTURE"),
-        defaultRules_sceneObject.end());
+    rules.erase(std::remove(rules.begin(), rules.end(), "TRANSPARENCY_PEEL_STRUCTURE"), rules.end());
+    break;
+  }
+  case TransparencyMode::Weighted: {
+    rules.erase(std::remove(rules.begin(), rules.end(), "TRANSPARENCY_WEIGHTED_STRUCTURE"), rules.end());
     break;
   }
   }
 
-  transparencyMode = newMode;
-
   // Add a new rule for this setting
-  switch (newMode) {
+  switch (mode) {
   case TransparencyMode::None: {
     break;
   }
   case TransparencyMode::Simple: {
-    defaultRules_sceneObject.push_back("TRANSPARENCY_STRUCTURE");
+    rules.push_back("TRANSPARENCY_STRUCTURE");
     break;
   }
   case TransparencyMode::Pretty: {
-    defaultRules_sceneObject.push_back("TRANSPARENCY_PEEL_STRUCTURE");
+    rules.push_back("TRANSPARENCY_PEEL_STRUCTURE");
     break;
   }
+  case TransparencyMode::Weighted: {
+    rules.push_back("TRANSPARENCY_WEIGHTED_STRUCTURE");
+    break;
+  }
+  }
+
+  return rules;
+}
+
+void Engine::setTransparencyMode(TransparencyMode newMode) {
+
+  pendingTransparencyMode = newMode;
+  transparencyModePending = true;
+
+  // Queue up the new variants of the scene programs in use
+  pendingProgramRequests.clear();
+  if (options::backgroundShaderCompile) {
+    for (const ShaderProgramRequest& request : getLiveShaderRequests()) {
+      if (request.defaults == ShaderReplacementDefaults::SceneObject ||
+          request.defaults == ShaderReplacementDefaults::SceneObjectNoSlice) {
+        pendingProgramRequests.push_back(request);
+      }
+    }
+  }
+
+  if (pendingProgramRequests.empty()) {
+    commitPendingTransparencyMode();
+  }
+}
+
+void Engine::processPendingPrograms() {
+  if (!transparencyModePending) return;
+
+  // Compile with the new rules in place, keeping at least one program of progress per frame. This is deferred work,
+  // so it spends from the frame's budget too.
+  double budgetMs =
+      std::min(static_cast<double>(options::shaderCompileBudgetMs), scheduler::getRemainingFrameBudgetMs());
+  auto startTime = std::chrono::steady_clock::now();
+  std::vector<std::string> currentRules = defaultRules_sceneObject;
+  defaultRules_sceneObject = sceneObjectRulesForTransparencyMode(pendingTransparencyMode);
+  while (!pendingProgramRequests.empty()) {
+    ShaderProgramRequest request = pendingProgramRequests.front();
+    pendingProgramRequests.pop_front();
+    precompileShader(request);
+
+    double elapsedMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    if (elapsedMs > budgetMs) break;
+  }
+  defaultRules_sceneObject = currentRules;
+  scheduler::addDeferredWorkTime(
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+  if (pendingProgramRequests.empty()) {
+    commitPendingTransparencyMode();
   }
+}
+
+void Engine::finishPendingPrograms() {
+  if (!transparencyModePending) return;
+
+  std::vector<std::string> currentRules = defaultRules_sceneObject;
+  defaultRules_sceneObject = sceneObjectRulesForTransparencyMode(pendingTransparencyMode);
+  for (const ShaderProgramRequest& request : pendingProgramRequests) {
+    precompileShader(request);
+  }
+  pendingProgramRequests.clear();
+  defaultRules_sceneObject = currentRules;
+
+  commitPendingTransparencyMode();
+}
+
+bool Engine::hasPendingPrograms() { return transparencyModePending; }
+
+void Engine::commitPendingTransparencyMode() {
+  defaultRules_sceneObject = sceneObjectRulesForTransparencyMode(pendingTransparencyMode);
+  transparencyMode = pendingTransparencyMode;
+  transparencyModePending = false;
 
   // Regenerate _all_ the things
+  // (any programs precompiled above are now cache hits)
   refresh();
 }
 
+bool Engine::precompileShader(const ShaderProgramRequest& request) { return false; }
+
+std::vector<ShaderProgramRequest> Engine::getLiveShaderRequests() { return {}; }
+
 TransparencyMode Engine::getTransparencyMode() { return transparencyMode; }
 
+void Engine::setWeightedTransparencyAccumulate(bool newVal) { weightedTransparencyAccumulate = newVal; }
+bool Engine::getWeightedTransparencyAccumulate() { return weightedTransparencyAccumulate; }
+
 bool Engine::transparencyEnabled() {
   switch (transparencyMode) {
   case TransparencyMode::None:
@@ -631,6 +788,8 @@ bool Engine::transparencyEnabled() {
     return true;
   case TransparencyMode::Pretty:
     return true;
+  case TransparencyMode::Weighted:
+    return true;
   }
   return false;
 }
@@ -645,6 +804,92 @@ bool Engine::getFrontFaceCCW() { return frontFaceCCW; }
 
 int Engine::getSSAAFactor() { return ssaaFactor; }
 
+namespace {
+// Element i of the Halton low-discrepancy sequence with the given base, in [0,1)
+float halton(int i, int base) {
+  float f = 1.;
+  float r = 0.;
+  while (i > 0) {
+    f /= base;
+    r += f * (i % base);
+    i /= base;
+  }
+  return r;
+}
+} // namespace
+
+void Engine::beginTemporalAntiAliasing() {
+
+  // Cycle through as many (2,3) Halton offsets as there are samples to accumulate, so a still view averages all of them
+  int nSamples = std::max(options::taaMaxSamples, 1);
+  taaJitterInd = (taaJitterInd + 1) % nSamples;
+  glm::vec2 offset{halton(taaJitterInd + 1, 2) - 0.5, halton(taaJitterInd + 1, 3) - 0.5};
+
+  // Scene buffer pixels are 2/size across in normalized device coordinates
+  view::projectionJitter = glm::vec2{2. * offset.x / (ssaaFactor * view::bufferWidth),
+                                     2. * offset.y / (ssaaFactor * view::bufferHeight)};
+}
+
+void Engine::resolveTemporalAntiAliasing() {
+
+  view::projectionJitter = glm::vec2{0., 0.};
+  glm::mat4 viewProjMat = view::getCameraPerspectiveMatrix() * view::getCameraViewMatrix();
+
+  // A still view averages every frame equally. Otherwise the history is reprojected and clamped, and decays.
+  bool stillView = taaHistoryValid && viewProjMat == taaPrevViewProjMat &&
+                   internal::sceneContentVersion == taaSceneContentVersion;
+  float blendFactor;
+  bool clampHistory;
+  if (!taaHistoryValid) {
+    taaSampleCount = 1;
+    blendFactor = 1.;
+    clampHistory = false;
+  } else if (stillView) {
+    taaSampleCount = std::min(taaSampleCount + 1, std::max(options::taaMaxSamples, 1));
+    blendFactor = 1. / taaSampleCount;
+    clampHistory = false;
+  } else {
+    taaSampleCount = 1;
+    blendFactor = options::taaBlendFactor;
+    clampHistory = true;
+  }
+
+  // Maps this frame's normalized device coordinates to the previous frame's clip coordinates
+  glm::mat4 reprojectMat = taaPrevViewProjMat * glm::inverse(viewProjMat);
+
+  int readInd = taaHistoryInd;
+  int writeInd = 1 - taaHistoryInd;
+  resolveTAA->setTextureFromBuffer("t_history", sceneColorHistory[readInd].get());
+  resolveTAA->setUniform("u_reprojectMatrix", glm::value_ptr(reprojectMat));
+  resolveTAA->setUniform("u_blendFactor", blendFactor);
+  resolveTAA->setUniform("u_clampHistory", static_cast<int>(clampHistory));
+  glm::vec2 texelSize{1. / sceneColorFinal->getSizeX(), 1. / sceneColorFinal->getSizeY()};
+  resolveTAA->setUniform("u_texelSize", texelSize);
+
+  sceneBufferHistory[writeInd]->bindForRendering();
+  setDepthMode(DepthMode::Disable);
+  setBlendMode(BlendMode::Disable);
+  resolveTAA->draw();
+  sceneBufferHistory[writeInd]->blitTo(sceneBufferFinal.get());
+
+  taaHistoryInd = writeInd;
+  taaHistoryValid = true;
+  taaPrevViewProjMat = viewProjMat;
+  taaSceneContentVersion = internal::sceneContentVersion;
+
+  // Keep drawing until the view converges
+  if (taaSampleCount < options::taaMaxSamples) {
+    requestViewRedraw();
+  }
+}
+
+void Engine::invalidateTemporalHistory() {
+  taaHistoryValid = false;
+  taaSampleCount = 0;
+}
+
+int Engine::getTemporalSampleCount() { return taaSampleCount; }
+
 void Engine::allocateGlobalBuffersAndPrograms() {
 
   // Note: The display frame buffer should be manually wrapped by child classes
@@ -673,6 +918,22 @@ void Engine::allocateGlobalBuffersAndPrograms() {
     sceneDepthMinFrame->clearDepth = 0.0;
   }
 
+  { // Accumulation buffers for weighted blended transparency
+    // The accumulated (premultiplied) color and weight go in one texture and the summed optical depth in the other. It
+    // shares the depth texture with the scene buffer, so transparent surfaces are tested against opaque ones.
+    sceneWeightedAccum = generateTextureBuffer(TextureFormat::RGBA16F, view::bufferWidth, view::bufferHeight);
+    sceneWeightedRevealage = generateTextureBuffer(TextureFormat::R16F, view::bufferWidth, view::bufferHeight);
+
+    sceneBufferWeighted = generateFrameBuffer(view::bufferWidth, view::bufferHeight);
+    sceneBufferWeighted->addColorBuffer(sceneWeightedAccum);
+    sceneBufferWeighted->addColorBuffer(sceneWeightedRevealage);
+    sceneBufferWeighted->addDepthBuffer(sceneDepth);
+    sceneBufferWeighted->setDrawBuffers();
+
+    sceneBufferWeighted->clearColor = glm::vec3{0., 0., 0.};
+    sceneBufferWeighted->clearAlpha = 0.0;
+  }
+
   { // "Final" scene buffer (after resolving)
     sceneColorFinal = generateTextureBuffer(TextureFormat::RGBA16F, view::bufferWidth, view::bufferHeight);
 
@@ -684,6 +945,18 @@ void Engine::allocateGlobalBuffersAndPrograms() {
     sceneBufferFinal->clearAlpha = 0.0;
   }
 
+  { // History buffers for temporal anti-aliasing
+    // The history is sampled at reprojected locations, so it is filtered
+    for (int i = 0; i < 2; i++) {
+      sceneColorHistory[i] = generateTextureBuffer(TextureFormat::RGBA16F, view::bufferWidth, view::bufferHeight);
+      sceneColorHistory[i]->setFilterMode(FilterMode::Linear);
+
+      sceneBufferHistory[i] = generateFrameBuffer(view::bufferWidth, view::bufferHeight);
+      sceneBufferHistory[i]->addColorBuffer(sceneColorHistory[i]);
+      sceneBufferHistory[i]->setDrawBuffers();
+    }
+  }
+
   { // Alternate display buffer
     std::shared_ptr<RenderBuffer> sceneColorAlt =
         generateRenderBuffer(RenderBufferType::ColorAlpha, view::bufferWidth, view::bufferHeight);
@@ -730,9 +1003,19 @@ void Engine::allocateGlobalBuffersAndPrograms() {
     compositePeel->setAttribute("a_position", screenTrianglesCoords());
     compositePeel->setTextureFromBuffer("t_image", sceneColor.get());
 
+    compositeWeighted = render::engine->requestShader("COMPOSITE_WEIGHTED", {}, render::ShaderReplacementDefaults::Process);
+    compositeWeighted->setAttribute("a_position", screenTrianglesCoords());
+    compositeWeighted->setTextureFromBuffer("t_accum", sceneWeightedAccum.get());
+    compositeWeighted->setTextureFromBuffer("t_revealage", sceneWeightedRevealage.get());
+
     copyDepth = render::engine->requestShader("DEPTH_COPY", {}, render::ShaderReplacementDefaults::Process);
     copyDepth->setAttribute("a_position", screenTrianglesCoords());
     copyDepth->setTextureFromBuffer("t_depth", sceneDepth.get());
+
+    resolveTAA = render::engine->requestShader("TAA_RESOLVE", {}, render::ShaderReplacementDefaults::Process);
+    resolveTAA->setAttribute("a_position", screenTrianglesCoords());
+    resolveTAA->setTextureFromBuffer("t_current", sceneColorFinal.get());
+    resolveTAA->setTextureFromBuffer("t_depth", sceneDepth.get());
     // clang-format on
   }
 
@@ -868,6 +1151,91 @@ void Engine::updateMinDepthTexture() {
   copyDepth->draw();
 }
 
+bool Engine::supportsGPUTimestamps() { return false; }
+uint32_t Engine::issueGPUTimestamp() { return 0; }
+bool Engine::tryGetGPUTimestamp(uint32_t handle, int64_t& timeNs) { return false; }
+void Engine::releaseGPUTimestamp(uint32_t handle) {}
+
+uint32_t Engine::beginAnySamplesQuery() { return 0; }
+void Engine::endAnySamplesQuery() {}
+bool Engine::tryGetAnySamplesResult(uint32_t handle, bool& anyPassed) {
+  anyPassed = true;
+  return true;
+}
+void Engine::releaseAnySamplesQuery(uint32_t handle) {}
+
+bool Engine::computeBufferReduction(std::shared_ptr<AttributeBuffer> buffer, BufferReduction& result) {
+
+  std::string valueRule;
+  switch (buffer->getType()) {
+  case RenderDataType::Float:
+    valueRule = "REDUCE_VALUE_FLOAT";
+    break;
+  case RenderDataType::Vector2Float:
+    valueRule = "REDUCE_VALUE_VEC2_LENGTH";
+    break;
+  case RenderDataType::Vector3Float:
+    valueRule = "REDUCE_VALUE_VEC3_LENGTH";
+    break;
+  case RenderDataType::Vector4Float:
+    valueRule = "REDUCE_VALUE_VEC4_LENGTH";
+    break;
+  default:
+    return false;
+  }
+
+  // The non-finite count is accumulated in a float channel, which is only exact up to 2^24
+  size_t nValues = buffer->getDataSize();
+  if (buffer->getArrayCount() != 1 || nValues > (1 << 24)) return false;
+
+  result = BufferReduction();
+  if (nValues == 0) return true;
+
+  if (!reductionFramebuffer) {
+    std::shared_ptr<TextureBuffer> reductionTexture = generateTextureBuffer(TextureFormat::RGBA32F, 1, 1);
+    reductionFramebuffer = generateFrameBuffer(1, 1);
+    reductionFramebuffer->addColorBuffer(reductionTexture);
+    reductionFramebuffer->setDrawBuffers();
+    reductionFramebuffer->setViewport(0, 0, 1, 1);
+    reductionFramebuffer->clearColor = glm::vec3{-std::numeric_limits<float>::max()};
+    reductionFramebuffer->clearAlpha = 0.;
+  }
+
+  std::shared_ptr<ShaderProgram>& program = reductionPrograms[valueRule];
+  if (!program) {
+    program = requestShader("BUFFER_REDUCE", {valueRule}, ShaderReplacementDefaults::Process);
+  }
+  program->setAttribute("a_value", buffer);
+
+  // Draw every value on to the single pixel, see BUFFER_REDUCE_VERT_SHADER
+  bool restoreFramebuffer = currRenderFramebuffer != nullptr;
+  if (restoreFramebuffer) {
+    pushBindFramebufferForRendering(*reductionFramebuffer);
+  } else {
+    reductionFramebuffer->bindForRendering();
+  }
+  reductionFramebuffer->clear();
+  DepthMode prevDepthMode = getDepthMode();
+  BlendMode prevBlendMode = getBlendMode();
+  setDepthMode(DepthMode::Disable);
+  setBlendMode(BlendMode::MaxColorAddAlpha);
+  program->draw();
+  std::array<float, 4> reduced = reductionFramebuffer->readFloat4(0, 0);
+  setBlendMode(prevBlendMode);
+  setDepthMode(prevDepthMode);
+  if (restoreFramebuffer) {
+    popBindFramebufferForRendering();
+  }
+
+  result.nNonFinite = static_cast<size_t>(reduced[3]);
+  result.nFinite = nValues - std::min(nValues, result.nNonFinite);
+  if (result.nFinite > 0) {
+    result.maxVal = reduced[0];
+    result.minVal = -reduced[1];
+  }
+  return true;
+}
+
 
 // Helper (TODO rework to load custom materials)
 void Engine::loadDefaultMaterial(std::string name) {
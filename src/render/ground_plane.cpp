@@ -5,6 +5,7 @@
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/material_defs.h"
+#include "polyscope/viewport.h"
 
 #include "imgui.h"
 #include "stb_image.h"
@@ -39,6 +40,13 @@ std::tuple<int, float> getGroundPlaneAxisAndSign() {
 }
 }; // namespace
 
+bool GroundPlane::EffectCacheKey::operator==(const EffectCacheKey& other) const {
+  return viewport == other.viewport && sceneGeometryVersion == other.sceneGeometryVersion &&
+         sceneContentVersion == other.sceneContentVersion && mode == other.mode && upDir == other.upDir &&
+         groundHeight == other.groundHeight && bufferWidth == other.bufferWidth && bufferHeight == other.bufferHeight &&
+         blurIters == other.blurIters && transparencyEnabled == other.transparencyEnabled;
+}
+
 void GroundPlane::populateGroundPlaneGeometry() {
 
   int iP;
@@ -72,7 +80,7 @@ void GroundPlane::prepare() {
 
   // The program that draws the ground plane
   std::vector<std::string> rules;
-  if (options::transparencyMode == TransparencyMode::Pretty) rules.push_back("TRANSPARENCY_PEEL_GROUND");
+  if (render::engine->getTransparencyMode() == TransparencyMode::Pretty) rules.push_back("TRANSPARENCY_PEEL_GROUND");
   switch (options::groundPlaneMode) {
   case GroundPlaneMode::None:
     break;
@@ -158,11 +166,12 @@ void GroundPlane::prepare() {
   }
 
   // Respect global effects
-  if (options::transparencyMode == TransparencyMode::Pretty) {
+  if (render::engine->getTransparencyMode() == TransparencyMode::Pretty) {
     groundPlaneProgram->setTextureFromBuffer("t_minDepth", render::engine->sceneDepthMin.get());
   }
 
   groundPlanePrepared = true;
+  effectCacheValid = false;
 }
 
 void GroundPlane::draw(bool isRedraw) {
@@ -173,6 +182,9 @@ void GroundPlane::draw(bool isRedraw) {
   // don't draw ground in planar mode
   if (view::style == view::NavigateStyle::Planar) return;
 
+  Viewport* currViewport = polyscope::getCurrentViewport();
+  if (currViewport && !currViewport->getGroundPlaneEnabled()) return;
+
   if (!groundPlanePrepared) {
     prepare();
   }
@@ -220,6 +232,8 @@ void GroundPlane::draw(bool isRedraw) {
 
     if (options::groundPlaneMode == GroundPlaneMode::ShadowOnly) {
       groundPlaneProgram->setUniform("u_shadowDarkness", options::shadowDarkness);
+      glm::mat4 shadowViewProjMat = effectCacheProjMat * effectCacheViewMat;
+      groundPlaneProgram->setUniform("u_shadowViewProjMatrix", glm::value_ptr(shadowViewProjMat));
     }
 
     switch (view::projectionMode) {
@@ -257,8 +271,57 @@ void GroundPlane::draw(bool isRedraw) {
   }
   */
 
+  // Decide whether the shadow or reflection must be re-rendered, or whether the one from a previous frame can be reused
+  glm::mat4 currViewMat = view::getCameraViewMatrix();
+  glm::mat4 currProjMat = view::getUnjitteredCameraPerspectiveMatrix(); // ignore anti-aliasing jitter
+  bool renderEffect = false;
+  if (!isRedraw && (options::groundPlaneMode == GroundPlaneMode::TileReflection ||
+                    options::groundPlaneMode == GroundPlaneMode::ShadowOnly)) {
+
+    EffectCacheKey key;
+    key.viewport = getCurrentViewport();
+    key.sceneGeometryVersion = internal::sceneGeometryVersion;
+    if (options::groundPlaneMode == GroundPlaneMode::TileReflection) {
+      // the reflection also shows the colors and materials of the scene, the shadow depends only on its shape
+      key.sceneContentVersion = internal::sceneContentVersion;
+    }
+    key.mode = options::groundPlaneMode;
+    key.upDir = view::upDir;
+    key.groundHeight = groundHeight;
+    key.bufferWidth = factor * view::bufferWidth;
+    key.bufferHeight = factor * view::bufferHeight;
+    key.blurIters = options::shadowBlurIters;
+    key.transparencyEnabled = render::engine->transparencyEnabled();
+
+    bool cameraMatchesCache = currViewMat == effectCacheViewMat && currProjMat == effectCacheProjMat;
+    bool cameraMoving = currViewMat != prevDrawViewMat || currProjMat != prevDrawProjMat;
+
+    if (!effectCacheValid || !(key == effectCacheKey)) {
+      renderEffect = true;
+    } else if (!cameraMatchesCache) {
+      // The reflection is a view of the scene from a mirrored camera, and cannot be reused from a different viewpoint.
+      // The shadow lies on the ground plane, so it can be reprojected from the camera it was rendered with.
+      bool canReproject = options::groundPlaneMode == GroundPlaneMode::ShadowOnly && options::groundPlaneTemporalReuse;
+      if (canReproject && cameraMoving) {
+        requestViewRedraw(); // re-render once the camera is still
+      } else {
+        renderEffect = true;
+      }
+    }
+
+    if (renderEffect) {
+      effectCacheValid = true;
+      effectCacheKey = key;
+      effectCacheViewMat = currViewMat;
+      effectCacheProjMat = currProjMat;
+      effectRenderCount++;
+    }
+    prevDrawViewMat = currViewMat;
+    prevDrawProjMat = currProjMat;
+  }
+
   // Render the scene to implement the mirror effect
-  if (!isRedraw && options::groundPlaneMode == GroundPlaneMode::TileReflection) {
+  if (renderEffect && options::groundPlaneMode == GroundPlaneMode::TileReflection) {
 
     // Prepare the alternate scene buffers
     // (use a texture 1/4 the area of the view buffer, it's supposed to be blurry anyway and this saves perf)
@@ -296,17 +359,22 @@ void GroundPlane::draw(bool isRedraw) {
 
     // Restore original values
     render::engine->setFrontFaceCCW(!render::engine->getFrontFaceCCW());
+    render::engine->setCurrentPixelScaling(factor);
     view::viewMat = origViewMat;
   }
 
   // Render the scene to implement the shadow effect
-  if (!isRedraw && options::groundPlaneMode == GroundPlaneMode::ShadowOnly) {
+  if (renderEffect && options::groundPlaneMode == GroundPlaneMode::ShadowOnly) {
 
     // Prepare the alternate scene buffers
+    // (the shadow is blurred, so like the reflection it is rendered at 1/4 the area of the view buffer)
+    int shadowWidth = factor * view::bufferWidth / 2;
+    int shadowHeight = factor * view::bufferHeight / 2;
     render::engine->setBlendMode(BlendMode::AlphaOver);
     render::engine->setDepthMode(DepthMode::Less);
-    sceneAltFrameBuffer->resize(factor * view::bufferWidth, factor * view::bufferHeight);
-    sceneAltFrameBuffer->setViewport(0, 0, factor * view::bufferWidth, factor * view::bufferHeight);
+    sceneAltFrameBuffer->resize(shadowWidth, shadowHeight);
+    sceneAltFrameBuffer->setViewport(0, 0, shadowWidth, shadowHeight);
+    render::engine->setCurrentPixelScaling(factor / 2.);
 
     sceneAltFrameBuffer->bindForRendering();
     sceneAltFrameBuffer->clearColor = {view::bgColor[0], view::bgColor[1], view::bgColor[2]};
@@ -314,8 +382,8 @@ void GroundPlane::draw(bool isRedraw) {
 
     // Make sure all framebuffers are the right shape
     for (int i = 0; i < 2; i++) {
-      blurFrameBuffers[i]->resize(factor * view::bufferWidth / 2, factor * view::bufferHeight / 2);
-      blurFrameBuffers[i]->setViewport(0, 0, factor * view::bufferWidth / 2, factor * view::bufferHeight / 2);
+      blurFrameBuffers[i]->resize(shadowWidth, shadowHeight);
+      blurFrameBuffers[i]->setViewport(0, 0, shadowWidth, shadowHeight);
       blurFrameBuffers[i]->clear();
     }
 
@@ -334,16 +402,15 @@ void GroundPlane::draw(bool isRedraw) {
     render::engine->setBlendMode(BlendMode::Disable);
     drawStructures();
 
-    // Copy the depth buffer to a texture (while upsampling)
+    // Copy the depth buffer to a texture
     render::engine->setBlendMode(BlendMode::Disable);
     blurFrameBuffers[0]->bindForRendering();
     copyTexProgram->draw();
 
     // == Blur
 
-    // Do some blur iterations (ends in same buffer it started in)
+    // Do some separable blur iterations (ends in same buffer it started in)
     int nBlur = options::shadowBlurIters * render::engine->getSSAAFactor();
-    // int nBlur = 0;
     for (int i = 0; i < nBlur; i++) {
       // horizontal blur
       blurFrameBuffers[1]->bindForRendering();
@@ -358,7 +425,8 @@ void GroundPlane::draw(bool isRedraw) {
       blurProgram->draw();
     }
 
-    // Restore original view matrix
+    // Restore original values
+    render::engine->setCurrentPixelScaling(factor);
     view::viewMat = origViewMat;
   }
 
@@ -1,12 +1,16 @@
 // Copyright 2018-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
 
 
+#include <atomic>
+#include <cmath>
+#include <unordered_set>
 #include <vector>
 
 #include "polyscope/render/managed_buffer.h"
 
 #include "polyscope/internal.h"
 #include "polyscope/messages.h"
+#include "polyscope/parallel.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/templated_buffers.h"
@@ -14,6 +18,59 @@
 namespace polyscope {
 namespace render {
 
+namespace {
+
+// The quantity which gets reduced for each entry in a buffer: scalars by value, vectors by length
+// clang-format off
+double reductionValue(float x)             { return x; }
+double reductionValue(double x)            { return x; }
+double reductionValue(uint32_t x)          { return x; }
+double reductionValue(int32_t x)           { return x; }
+double reductionValue(const glm::vec2& x)  { return glm::length(x); }
+double reductionValue(const glm::vec3& x)  { return glm::length(x); }
+double reductionValue(const glm::vec4& x)  { return glm::length(x); }
+double reductionValue(const glm::uvec2& x) { return glm::length(glm::vec2(x)); }
+double reductionValue(const glm::uvec3& x) { return glm::length(glm::vec3(x)); }
+double reductionValue(const glm::uvec4& x) { return glm::length(glm::vec4(x)); }
+// clang-format on
+template <size_t N>
+double reductionValue(const std::array<glm::vec3, N>& x) {
+  exception("buffer reductions are not supported for array-valued data");
+  return 0.;
+}
+
+BufferReduction combineReductions(const BufferReduction& a, const BufferReduction& b) {
+  BufferReduction r;
+  r.minVal = std::min(a.minVal, b.minVal);
+  r.maxVal = std::max(a.maxVal, b.maxVal);
+  r.nFinite = a.nFinite + b.nFinite;
+  r.nNonFinite = a.nNonFinite + b.nNonFinite;
+  return r;
+}
+
+template <typename T>
+BufferReduction computeHostReduction(const std::vector<T>& data) {
+  return parallelReduce<BufferReduction>(
+      data.size(), BufferReduction(),
+      [&](size_t iStart, size_t iEnd) {
+        BufferReduction r;
+        for (size_t i = iStart; i < iEnd; i++) {
+          double v = reductionValue(data[i]);
+          if (std::isfinite(v)) {
+            r.minVal = std::min(r.minVal, v);
+            r.maxVal = std::max(r.maxVal, v);
+            r.nFinite++;
+          } else {
+            r.nNonFinite++;
+          }
+        }
+        return r;
+      },
+      combineReductions);
+}
+
+} // namespace
+
 template <typename T>
 ManagedBuffer<T>::ManagedBuffer(ManagedBufferRegistry* registry_, const std::string& name_, std::vector<T>& data_)
     : name(name_), uniqueID(internal::getNextUniqueID()), registry(registry_), data(data_), dataGetsComputed(false),
@@ -121,21 +178,22 @@ std::vector<T>& ManagedBuffer<T>::getPopulatedHostBufferRef() {
 template <typename T>
 void ManagedBuffer<T>::markHostBufferUpdated() {
   hostBufferIsPopulated = true;
+  dataVersion++;
 
-  // If the data is stored in the device-side buffers, update it as needed
+  // If the data is stored in the device-side buffers, update it as needed. If it isn't, nothing has drawn it yet, and
+  // there is no need to redraw.
   if (renderAttributeBuffer) {
     renderAttributeBuffer->setData(data);
-    requestRedraw();
+    requestRedrawForUpdate();
   }
 
   if (renderTextureBuffer) {
     renderTextureBuffer->setData(data);
-    requestRedraw();
+    requestRedrawForUpdate();
   }
 
   if (deviceBufferType == DeviceBufferType::Attribute) {
     updateIndexedViews();
-    requestRedraw();
   }
 }
 
@@ -277,6 +335,28 @@ std::string ManagedBuffer<T>::summaryString() {
 }
 
 
+template <typename T>
+bool ManagedBuffer<T>::gatherPendingCompute(std::vector<PendingBufferCompute>& computes) {
+  if (currentCanonicalDataSource() != CanonicalDataSource::NeedsCompute) return false;
+
+  for (const PendingBufferCompute& c : computes) {
+    if (c.bufferID == uniqueID) return true;
+  }
+
+  PendingBufferCompute pending;
+  pending.bufferID = uniqueID;
+  for (auto& gatherDependency : computeDependencies) {
+    gatherDependency(computes, pending.dependencyIDs);
+  }
+  pending.compute = [this]() {
+    // the check guards against a compute function which fills in other buffers as a side effect
+    if (currentCanonicalDataSource() == CanonicalDataSource::NeedsCompute) computeFunc();
+  };
+  computes.push_back(std::move(pending));
+
+  return true;
+}
+
 template <typename T>
 void ManagedBuffer<T>::recomputeIfPopulated() {
   if (!dataGetsComputed) { // sanity check
@@ -293,6 +373,29 @@ void ManagedBuffer<T>::recomputeIfPopulated() {
   markHostBufferUpdated();
 }
 
+template <typename T>
+BufferReduction ManagedBuffer<T>::getReduction() {
+  if (reductionIsCached && cachedReductionVersion == dataVersion) {
+    return cachedReduction;
+  }
+
+  bool reducedOnDevice = false;
+  if (currentCanonicalDataSource() == CanonicalDataSource::RenderBuffer &&
+      deviceBufferType == DeviceBufferType::Attribute) {
+    reducedOnDevice = render::engine->computeBufferReduction(renderAttributeBuffer, cachedReduction);
+  }
+
+  if (!reducedOnDevice) {
+    ensureHostBufferPopulated();
+    cachedReduction = computeHostReduction(data);
+  }
+
+  // note: populating the host buffer above may have computed the data and bumped the version, so read it after
+  reductionIsCached = true;
+  cachedReductionVersion = dataVersion;
+  return cachedReduction;
+}
+
 template <typename T>
 std::shared_ptr<render::AttributeBuffer> ManagedBuffer<T>::getRenderAttributeBuffer() {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
@@ -340,8 +443,9 @@ void ManagedBuffer<T>::markRenderAttributeBufferUpdated() {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
 
   invalidateHostBuffer();
+  dataVersion++;
   updateIndexedViews();
-  requestRedraw();
+  requestRedrawForUpdate();
 }
 
 template <typename T>
@@ -349,7 +453,8 @@ void ManagedBuffer<T>::markRenderTextureBufferUpdated() {
   checkDeviceBufferTypeIsTexture();
 
   invalidateHostBuffer();
-  requestRedraw();
+  dataVersion++;
+  requestRedrawForUpdate();
 }
 
 template <typename T>
@@ -391,6 +496,7 @@ void ManagedBuffer<T>::updateIndexedViews() {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
 
   removeDeletedIndexedViews(); // periodic filtering
+  if (existingIndexedViews.empty()) return;
 
   for (std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>& existingViewTup :
        existingIndexedViews) {
@@ -412,7 +518,39 @@ void ManagedBuffer<T>::updateIndexedViews() {
     // below.
   }
 
-  requestRedraw();
+  requestRedrawForUpdate();
+}
+
+template <typename T>
+std::shared_ptr<BufferStagingSlot<T>> ManagedBuffer<T>::getStagingSlot() {
+  if (dataGetsComputed) {
+    exception("managed buffer " + name + " is computed, it cannot be updated through a staging slot");
+  }
+
+  if (!stagingSlot) {
+    stagingSlot = std::make_shared<BufferStagingSlot<T>>(size());
+    registerStagedBuffer(getGenericWeakHandle(), [this]() { applyStagedData(); });
+  }
+  return stagingSlot;
+}
+
+template <typename T>
+void ManagedBuffer<T>::applyStagedData() {
+  // The slot checked the size, so the new data replaces the whole buffer, wherever the current data lives. The old host
+  // data goes back to the slot for reuse.
+  if (!stagingSlot->consume(data)) return;
+  markHostBufferUpdated();
+  if (stagedDataFunc) stagedDataFunc();
+}
+
+template <typename T>
+void ManagedBuffer<T>::requestRedrawForUpdate() {
+  if (registry) {
+    registry->requestRedrawIfVisible();
+  } else {
+    internal::sceneGeometryVersion++;
+    requestRedraw();
+  }
 }
 
 template <typename T>
@@ -499,6 +637,18 @@ void ManagedBuffer<T>::invokeBufferIndexCopyProgram() {
 
 // === Interact with the buffer registry
 
+bool ManagedBufferRegistry::hasVisualImpact() { return true; }
+
+void ManagedBufferRegistry::requestRedrawIfVisible() {
+  internal::sceneGeometryVersion++;
+  if (hasVisualImpact()) {
+    requestRedraw();
+  } else {
+    // Nothing on screen changed, but renders cached across frames might still depend on this data
+    internal::sceneContentVersion++;
+  }
+}
+
 std::tuple<bool, ManagedBufferType> ManagedBufferRegistry::hasManagedBufferType(std::string name) {
 
   // clang-format off
@@ -587,6 +737,49 @@ template<> ManagedBufferMap<glm::uvec4>&               ManagedBufferMap<glm::uve
 
 // clang-format on
 
+void computeBuffersConcurrently(const std::vector<PendingBufferCompute>& computes) {
+
+  std::unordered_set<uint64_t> unfinished;
+  for (const PendingBufferCompute& c : computes) {
+    unfinished.insert(c.bufferID);
+  }
+
+  // Compute in waves, each of which is every buffer whose dependencies are done. Dependency chains between buffers are
+  // short, so there are only ever a few waves.
+  std::vector<const PendingBufferCompute*> remaining;
+  for (const PendingBufferCompute& c : computes) {
+    remaining.push_back(&c);
+  }
+  while (!remaining.empty()) {
+
+    std::vector<const PendingBufferCompute*> wave;
+    std::vector<const PendingBufferCompute*> later;
+    for (const PendingBufferCompute* c : remaining) {
+      bool ready = true;
+      for (uint64_t depID : c->dependencyIDs) {
+        if (unfinished.find(depID) != unfinished.end()) ready = false;
+      }
+      (ready ? wave : later).push_back(c);
+    }
+    if (wave.empty()) exception("computed buffers have a cyclic dependency");
+
+    // Buffers vary widely in cost, so rather than splitting the wave up front, each thread takes the next buffer as it
+    // finishes its last one
+    std::atomic<size_t> nextInd{0};
+    size_t nThreads = std::min(parallelThreadCount(), wave.size());
+    parallelInvoke(nThreads, [&](size_t iThread) {
+      for (size_t i = nextInd++; i < wave.size(); i = nextInd++) {
+        wave[i]->compute();
+      }
+    });
+
+    for (const PendingBufferCompute* c : wave) {
+      unfinished.erase(c->bufferID);
+    }
+    remaining = later;
+  }
+}
+
 } // namespace render
 
 std::string typeName(ManagedBufferType type) {
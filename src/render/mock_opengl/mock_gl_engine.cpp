@@ -6,6 +6,7 @@
 #include "polyscope/messages.h"
 #include "polyscope/options.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/utilities.h"
 
 #include "polyscope/render/shader_builder.h"
@@ -18,6 +19,7 @@
 #include "polyscope/render/opengl/shaders/ground_plane_shaders.h"
 #include "polyscope/render/opengl/shaders/histogram_shaders.h"
 #include "polyscope/render/opengl/shaders/lighting_shaders.h"
+#include "polyscope/render/opengl/shaders/reduction_shaders.h"
 #include "polyscope/render/opengl/shaders/ribbon_shaders.h"
 #include "polyscope/render/opengl/shaders/rules.h"
 #include "polyscope/render/opengl/shaders/sphere_shaders.h"
@@ -29,6 +31,9 @@
 
 #include "stb_image.h"
 
+#include <chrono>
+#include <thread>
+
 namespace polyscope {
 namespace render {
 namespace backend_openGL_mock {
@@ -87,6 +92,7 @@ void GLAttributeBuffer::setData_helper(const std::vector<T>& data) {
 
   // do the actual copy
   dataSize = data.size();
+  profiler::countBytesUploaded(dataSize * sizeof(T));
 
   checkGLError();
 }
@@ -382,6 +388,7 @@ void GLTextureBuffer::setData(const std::vector<glm::vec3>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -402,6 +409,7 @@ void GLTextureBuffer::setData(const std::vector<glm::vec4>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -421,6 +429,7 @@ void GLTextureBuffer::setData(const std::vector<float>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -440,6 +449,7 @@ void GLTextureBuffer::setData(const std::vector<double>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -461,6 +471,18 @@ void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data)
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) { exception("not implemented"); };
 
+void GLTextureBuffer::setSubData2D(unsigned int x0, unsigned int y0, unsigned int w, unsigned int h,
+                                   const float* data, unsigned int rowLength) {
+  if (dim != 2 || x0 + w > sizeX || y0 + h > sizeY || rowLength < w) {
+    exception("OpenGL error: texture sub-region is out of bounds.");
+  }
+  if (w == 0 || h == 0) return;
+  profiler::countBytesUploaded(static_cast<size_t>(w) * h * sizeInBytes(format));
+
+  bind();
+  checkGLError();
+}
+
 void GLTextureBuffer::setFilterMode(FilterMode newMode) {
 
   bind();
@@ -652,6 +674,12 @@ std::array<float, 4> GLFrameBuffer::readFloat4(int xPos, int yPos) {
   return result;
 }
 
+std::vector<float> GLFrameBuffer::readFloat4Region(int xStart, int yStart, int xSize, int ySize) {
+  // Read from the buffer (which is always empty)
+  std::vector<float> result(4 * static_cast<size_t>(xSize) * ySize, 0.);
+  return result;
+}
+
 float GLFrameBuffer::readDepth(int xPos, int yPos) {
   // Read from the buffer
   float result = 0.5;
@@ -690,6 +718,8 @@ uint32_t GLFrameBuffer::getNativeBufferID() { return 0; }
 
 GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm) : drawMode(dm) {
 
+  profiler::countShaderCompile();
+
   // Collect attributes and uniforms from all of the shaders
   for (const ShaderStageSpecification& s : stages) {
     for (ShaderSpecUniform u : s.uniforms) {
@@ -1515,6 +1545,8 @@ void GLShaderProgram::activateTextures() {
 
 void GLShaderProgram::draw() {
   validateData();
+  profiler::countDrawCall();
+  glEngine->drawCallCount++;
 
   if (usePrimitiveRestart) {
   }
@@ -1524,6 +1556,8 @@ void GLShaderProgram::draw() {
   switch (drawMode) {
   case DrawMode::Points:
     break;
+  case DrawMode::IndexedPoints:
+    break;
   case DrawMode::Triangles:
     break;
   case DrawMode::Lines:
@@ -1661,9 +1695,9 @@ void MockGLEngine::ImGuiNewFrame() {
 
 void MockGLEngine::ImGuiRender() { ImGui::Render(); }
 
-void MockGLEngine::setDepthMode(DepthMode newMode) {}
+void MockGLEngine::setDepthMode(DepthMode newMode) { currDepthMode = newMode; }
 
-void MockGLEngine::setBlendMode(BlendMode newMode) {}
+void MockGLEngine::setBlendMode(BlendMode newMode) { currBlendMode = newMode; }
 
 void MockGLEngine::setColorMask(std::array<bool, 4> mask) {}
 
@@ -1678,6 +1712,58 @@ void MockGLEngine::setClipboardText(std::string text) {}
 
 void MockGLEngine::applyTransparencySettings() {}
 
+bool MockGLEngine::computeBufferReduction(std::shared_ptr<AttributeBuffer> buffer, BufferReduction& result) {
+  return false; // the mock backend does not actually hold data on the device, always reduce on the host
+}
+
+bool MockGLEngine::supportsGPUTimestamps() { return true; }
+
+uint32_t MockGLEngine::issueGPUTimestamp() {
+  int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  if (!freeTimestampHandles.empty()) {
+    uint32_t handle = freeTimestampHandles.back();
+    freeTimestampHandles.pop_back();
+    emulatedTimestamps[handle] = now;
+    return handle;
+  }
+  emulatedTimestamps.push_back(now);
+  return static_cast<uint32_t>(emulatedTimestamps.size() - 1);
+}
+
+bool MockGLEngine::tryGetGPUTimestamp(uint32_t handle, int64_t& timeNs) {
+  if (handle >= emulatedTimestamps.size()) return false;
+  timeNs = emulatedTimestamps[handle];
+  return true;
+}
+
+void MockGLEngine::releaseGPUTimestamp(uint32_t handle) { freeTimestampHandles.push_back(handle); }
+
+uint32_t MockGLEngine::beginAnySamplesQuery() {
+  if (freeAnySamplesHandles.empty()) {
+    emulatedAnySamplesResults.push_back(false);
+    currAnySamplesHandle = static_cast<uint32_t>(emulatedAnySamplesResults.size() - 1);
+  } else {
+    currAnySamplesHandle = freeAnySamplesHandles.back();
+    freeAnySamplesHandles.pop_back();
+  }
+  anySamplesQueryStartCount = drawCallCount;
+  return currAnySamplesHandle;
+}
+
+void MockGLEngine::endAnySamplesQuery() {
+  emulatedAnySamplesResults[currAnySamplesHandle] = drawCallCount > anySamplesQueryStartCount;
+}
+
+bool MockGLEngine::tryGetAnySamplesResult(uint32_t handle, bool& anyPassed) {
+  if (handle >= emulatedAnySamplesResults.size()) return false;
+  anyPassed = emulatedAnySamplesResults[handle];
+  return true;
+}
+
+void MockGLEngine::releaseAnySamplesQuery(uint32_t handle) { freeAnySamplesHandles.push_back(handle); }
+
 void MockGLEngine::setFrontFaceCCW(bool newVal) {
   if (newVal == frontFaceCCW) return;
   frontFaceCCW = newVal;
@@ -1858,7 +1944,11 @@ std::shared_ptr<GLCompiledProgram> MockGLEngine::getCompiledProgram(const std::s
     std::vector<ShaderStageSpecification> updatedStages = applyShaderReplacements(stages, rules);
 
     // Create a new compiled program (GL work happens in the constructor)
+    if (simulatedCompileLatencyMs > 0.) {
+      std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(simulatedCompileLatencyMs));
+    }
     compiledProgamCache[progKey] = std::shared_ptr<GLCompiledProgram>(new GLCompiledProgram(updatedStages, dm));
+    compiledProgramRequests[progKey] = ShaderProgramRequest{programName, customRules, defaults};
   }
 
   // Now that the cache must contain the compiled program, just return it
@@ -1872,6 +1962,23 @@ std::shared_ptr<ShaderProgram> MockGLEngine::requestShader(const std::string& pr
   return std::shared_ptr<ShaderProgram>(newP);
 }
 
+bool MockGLEngine::precompileShader(const ShaderProgramRequest& request) {
+  std::string progKey = programKeyFromRules(request.programName, request.customRules, request.defaults);
+  if (compiledProgamCache.find(progKey) != compiledProgamCache.end()) return false;
+  getCompiledProgram(request.programName, request.customRules, request.defaults);
+  return true;
+}
+
+std::vector<ShaderProgramRequest> MockGLEngine::getLiveShaderRequests() {
+  std::vector<ShaderProgramRequest> requests;
+  for (auto& entry : compiledProgamCache) {
+    if (entry.second.use_count() > 1) { // referenced by some program, not just the cache
+      requests.push_back(compiledProgramRequests[entry.first]);
+    }
+  }
+  return requests;
+}
+
 void MockGLEngine::registerShaderProgram(const std::string& name, const std::vector<ShaderStageSpecification>& spec,
                                          const DrawMode& dm) {
   registeredShaderPrograms.insert({name, {spec, dm}});
@@ -1894,13 +2001,18 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("INDEXED_MESH", {FLEX_MESH_VERT_SHADER, FLEX_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SIMPLE_MESH", {SIMPLE_MESH_VERT_SHADER, SIMPLE_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SLICE_TETS", {SLICE_TETS_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::Points);
+  registerShaderProgram("SLICE_TETS_INDEXED", {SLICE_TETS_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::IndexedPoints);
   registerShaderProgram("RAYCAST_SPHERE", {FLEX_SPHERE_VERT_SHADER, FLEX_SPHERE_GEOM_SHADER, FLEX_SPHERE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("POINT_QUAD", {FLEX_POINTQUAD_VERT_SHADER, FLEX_POINTQUAD_GEOM_SHADER, FLEX_POINTQUAD_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE", {FLEX_GRIDCUBE_VERT_SHADER, FLEX_GRIDCUBE_GEOM_SHADER, FLEX_GRIDCUBE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE_PLANE", {FLEX_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::Triangles);
+  registerShaderProgram("SPARSE_GRIDCUBE_PLANE", {FLEX_SPARSE_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::TrianglesInstanced);
+  registerShaderProgram("GRID_VOLUME_RAYMARCH", {FLEX_GRID_VOLUME_RAYMARCH_VERT_SHADER, FLEX_GRID_VOLUME_RAYMARCH_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("RAYCAST_VECTOR", {FLEX_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_TANGENT_VECTOR", {FLEX_TANGENT_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_CYLINDER", {FLEX_CYLINDER_VERT_SHADER, FLEX_CYLINDER_GEOM_SHADER, FLEX_CYLINDER_FRAG_SHADER}, DrawMode::Points);
+  registerShaderProgram("RAYCAST_CYLINDER_STRIP", {FLEX_CYLINDER_STRIP_VERT_SHADER, FLEX_CYLINDER_STRIP_GEOM_SHADER, FLEX_CYLINDER_FRAG_SHADER}, DrawMode::IndexedLineStrip);
+  registerShaderProgram("BUFFER_REDUCE", {BUFFER_REDUCE_VERT_SHADER, BUFFER_REDUCE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("HISTOGRAM", {HISTOGRAM_VERT_SHADER, HISTOGRAM_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("GROUND_PLANE_TILE", {GROUND_PLANE_VERT_SHADER, GROUND_PLANE_TILE_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("GROUND_PLANE_TILE_REFLECT", {GROUND_PLANE_VERT_SHADER, GROUND_PLANE_TILE_REFLECT_FRAG_SHADER}, DrawMode::Triangles);
@@ -1916,6 +2028,8 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("TEXTURE_DRAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("TEXTURE_DRAW_RAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RAW_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("COMPOSITE_PEEL", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_PEEL}, DrawMode::Triangles);
+  registerShaderProgram("COMPOSITE_WEIGHTED", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_WEIGHTED}, DrawMode::Triangles);
+  registerShaderProgram("TAA_RESOLVE", {TEXTURE_DRAW_VERT_SHADER, TAA_RESOLVE}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_COPY", {TEXTURE_DRAW_VERT_SHADER, DEPTH_COPY}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_TO_MASK", {TEXTURE_DRAW_VERT_SHADER, DEPTH_TO_MASK}, DrawMode::Triangles);
   registerShaderProgram("SCALAR_TEXTURE_COLORMAP", {TEXTURE_DRAW_VERT_SHADER, SCALAR_TEXTURE_COLORMAP}, DrawMode::Triangles);
@@ -1936,6 +2050,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("TRANSPARENCY_RESOLVE_SIMPLE", TRANSPARENCY_RESOLVE_SIMPLE);
   registerShaderRule("TRANSPARENCY_PEEL_STRUCTURE", TRANSPARENCY_PEEL_STRUCTURE);
   registerShaderRule("TRANSPARENCY_PEEL_GROUND", TRANSPARENCY_PEEL_GROUND);
+  registerShaderRule("TRANSPARENCY_WEIGHTED_STRUCTURE", TRANSPARENCY_WEIGHTED_STRUCTURE);
   
   registerShaderRule("GENERATE_VIEW_POS", GENERATE_VIEW_POS);
   registerShaderRule("COMPUTE_SHADE_NORMAL_FROM_POSITION", COMPUTE_SHADE_NORMAL_FROM_POSITION);
@@ -1994,6 +2109,9 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("GRIDCUBE_WIREFRAME", GRIDCUBE_WIREFRAME);
   registerShaderRule("GRIDCUBE_CONSTANT_PICK", GRIDCUBE_CONSTANT_PICK);
   registerShaderRule("GRIDCUBE_CULLPOS_FROM_CENTER", GRIDCUBE_CULLPOS_FROM_CENTER);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE", SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE", SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE);
+  registerShaderRule("SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER", SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER);
 
   // sphere things
   registerShaderRule("SPHERE_PROPAGATE_VALUE", SPHERE_PROPAGATE_VALUE);
@@ -2013,15 +2131,25 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_VALUE", CYLINDER_PROPAGATE_BLEND_VALUE);
   registerShaderRule("CYLINDER_PROPAGATE_COLOR", CYLINDER_PROPAGATE_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_COLOR", CYLINDER_PROPAGATE_BLEND_COLOR);
+  registerShaderRule("CYLINDER_STRIP_PROPAGATE_BLEND_VALUE", CYLINDER_STRIP_PROPAGATE_BLEND_VALUE);
+  registerShaderRule("CYLINDER_STRIP_PROPAGATE_BLEND_COLOR", CYLINDER_STRIP_PROPAGATE_BLEND_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_PICK", CYLINDER_PROPAGATE_PICK);
+  registerShaderRule("CYLINDER_STRIP_PROPAGATE_PICK", CYLINDER_STRIP_PROPAGATE_PICK);
   registerShaderRule("CYLINDER_CULLPOS_FROM_MID", CYLINDER_CULLPOS_FROM_MID);
   registerShaderRule("CYLINDER_VARIABLE_SIZE", CYLINDER_VARIABLE_SIZE);
 
+  // Buffer reductions
+  registerShaderRule("REDUCE_VALUE_FLOAT", REDUCE_VALUE_FLOAT);
+  registerShaderRule("REDUCE_VALUE_VEC2_LENGTH", REDUCE_VALUE_VEC2_LENGTH);
+  registerShaderRule("REDUCE_VALUE_VEC3_LENGTH", REDUCE_VALUE_VEC3_LENGTH);
+  registerShaderRule("REDUCE_VALUE_VEC4_LENGTH", REDUCE_VALUE_VEC4_LENGTH);
+
   // marching tets things
   registerShaderRule("SLICE_TETS_BASECOLOR_SHADE", SLICE_TETS_BASECOLOR_SHADE);
   registerShaderRule("SLICE_TETS_PROPAGATE_VALUE", SLICE_TETS_PROPAGATE_VALUE);
   registerShaderRule("SLICE_TETS_PROPAGATE_VECTOR", SLICE_TETS_PROPAGATE_VECTOR);
   registerShaderRule("SLICE_TETS_VECTOR_COLOR", SLICE_TETS_VECTOR_COLOR);
+  registerShaderRule("SLICE_TETS_LEVEL_SET", SLICE_TETS_LEVEL_SET);
   registerShaderRule("SLICE_TETS_MESH_WIREFRAME", SLICE_TETS_MESH_WIREFRAME);
 
   // clang-format on
@@ -9,6 +9,7 @@
 #include "polyscope/messages.h"
 #include "polyscope/options.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/utilities.h"
 
 #include "polyscope/render/shader_builder.h"
@@ -21,6 +22,7 @@
 #include "polyscope/render/opengl/shaders/ground_plane_shaders.h"
 #include "polyscope/render/opengl/shaders/histogram_shaders.h"
 #include "polyscope/render/opengl/shaders/lighting_shaders.h"
+#include "polyscope/render/opengl/shaders/reduction_shaders.h"
 #include "polyscope/render/opengl/shaders/ribbon_shaders.h"
 #include "polyscope/render/opengl/shaders/rules.h"
 #include "polyscope/render/opengl/shaders/sphere_shaders.h"
@@ -269,6 +271,7 @@ void GLAttributeBuffer::setData_helper(const std::vector<T>& data) {
 
   // do the actual copy
   dataSize = data.size();
+  profiler::countBytesUploaded(dataSize * sizeof(T));
   glBufferSubData(getTarget(), 0, dataSize * sizeof(T), &data[0]);
 
   checkGLError();
@@ -591,6 +594,7 @@ void GLTextureBuffer::setData(const std::vector<glm::vec3>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -614,6 +618,7 @@ void GLTextureBuffer::setData(const std::vector<glm::vec4>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -636,6 +641,7 @@ void GLTextureBuffer::setData(const std::vector<float>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -666,6 +672,7 @@ void GLTextureBuffer::setData(const std::vector<double>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  profiler::countBytesUploaded(getSizeInBytes());
 
   switch (dim) {
   case 1:
@@ -690,6 +697,21 @@ void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data)
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) { exception("not implemented"); };
 
+void GLTextureBuffer::setSubData2D(unsigned int x0, unsigned int y0, unsigned int w, unsigned int h,
+                                   const float* data, unsigned int rowLength) {
+  if (dim != 2 || x0 + w > sizeX || y0 + h > sizeY || rowLength < w) {
+    exception("OpenGL error: texture sub-region is out of bounds.");
+  }
+  if (w == 0 || h == 0) return;
+  profiler::countBytesUploaded(static_cast<size_t>(w) * h * sizeInBytes(format));
+
+  bind();
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, w, h, formatF(format), GL_FLOAT, data);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  checkGLError();
+}
+
 
 void GLTextureBuffer::setFilterMode(FilterMode newMode) {
 
@@ -975,6 +997,21 @@ std::array<float, 4> GLFrameBuffer::readFloat4(int xPos, int yPos) {
   return result;
 }
 
+std::vector<float> GLFrameBuffer::readFloat4Region(int xStart, int yStart, int xSize, int ySize) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  // Read from the buffer
+  std::vector<float> result(4 * static_cast<size_t>(xSize) * ySize);
+  if (result.empty()) return result;
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(xStart, yStart, xSize, ySize, GL_RGBA, GL_FLOAT, &result.front());
+
+  return result;
+}
+
 float GLFrameBuffer::readDepth(int xPos, int yPos) {
 
   // TODO does no error checking for the case where no depth buffer is attached
@@ -1032,6 +1069,8 @@ uint32_t GLFrameBuffer::getNativeBufferID() { return handle; }
 
 GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm) : drawMode(dm) {
 
+  profiler::countShaderCompile();
+
   // Collect attributes and uniforms from all of the shaders
   for (const ShaderStageSpecification& s : stages) {
     for (ShaderSpecUniform u : s.uniforms) {
@@ -1296,6 +1335,7 @@ void GLShaderProgram::assignBufferToVAO(GLShaderAttribute& a) {
   checkGLError();
 
   // Choose the correct type for the buffer
+  // (integer types use the I variant, so they arrive in the shader as integers rather than converted to floats)
   for (int iArrInd = 0; iArrInd < a.arrayCount; iArrInd++) {
 
     glEnableVertexAttribArray(a.location + iArrInd);
@@ -1306,12 +1346,12 @@ void GLShaderProgram::assignBufferToVAO(GLShaderAttribute& a) {
                             reinterpret_cast<void*>(sizeof(float) * 1 * iArrInd));
       break;
     case RenderDataType::Int:
-      glVertexAttribPointer(a.location + iArrInd, 1, GL_INT, GL_FALSE, sizeof(int) * 1 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(int) * 1 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 1, GL_INT, sizeof(int) * 1 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(int) * 1 * iArrInd));
       break;
     case RenderDataType::UInt:
-      glVertexAttribPointer(a.location + iArrInd, 1, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 1 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 1 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 1, GL_UNSIGNED_INT, sizeof(uint32_t) * 1 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 1 * iArrInd));
       break;
     case RenderDataType::Vector2Float:
       glVertexAttribPointer(a.location + iArrInd, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2 * a.arrayCount,
@@ -1326,16 +1366,16 @@ void GLShaderProgram::assignBufferToVAO(GLShaderAttribute& a) {
                             reinterpret_cast<void*>(sizeof(float) * 4 * iArrInd));
       break;
     case RenderDataType::Vector2UInt:
-      glVertexAttribPointer(a.location + iArrInd, 2, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 2 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 2 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 2, GL_UNSIGNED_INT, sizeof(uint32_t) * 2 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 2 * iArrInd));
       break;
     case RenderDataType::Vector3UInt:
-      glVertexAttribPointer(a.location + iArrInd, 3, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 3 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 3 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 3, GL_UNSIGNED_INT, sizeof(uint32_t) * 3 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 3 * iArrInd));
       break;
     case RenderDataType::Vector4UInt:
-      glVertexAttribPointer(a.location + iArrInd, 4, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 4 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 4 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 4, GL_UNSIGNED_INT, sizeof(uint32_t) * 4 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 4 * iArrInd));
       break;
     default:
       throw std::invalid_argument("Unrecognized GLShaderAttribute type");
@@ -2051,6 +2091,7 @@ void GLShaderProgram::activateTextures() {
 
 void GLShaderProgram::draw() {
   validateData();
+  profiler::countDrawCall();
 
   glUseProgram(compiledProgram->getHandle());
   glBindVertexArray(vaoHandle);
@@ -2066,6 +2107,9 @@ void GLShaderProgram::draw() {
   case DrawMode::Points:
     glDrawArrays(GL_POINTS, 0, drawDataLength);
     break;
+  case DrawMode::IndexedPoints:
+    glDrawElements(GL_POINTS, drawDataLength, GL_UNSIGNED_INT, 0);
+    break;
   case DrawMode::Triangles:
     glDrawArrays(GL_TRIANGLES, 0, drawDataLength);
     break;
@@ -2337,6 +2381,7 @@ void GLEngine::ImGuiRender() {
 }
 
 void GLEngine::setDepthMode(DepthMode newMode) {
+  currDepthMode = newMode;
   switch (newMode) {
   case DepthMode::Less:
     glEnable(GL_DEPTH_TEST);
@@ -2371,6 +2416,8 @@ void GLEngine::setDepthMode(DepthMode newMode) {
 }
 
 void GLEngine::setBlendMode(BlendMode newMode) {
+  currBlendMode = newMode;
+  glBlendEquation(GL_FUNC_ADD); // all modes but one use the default equation
   switch (newMode) {
   case BlendMode::AlphaOver:
     glEnable(GL_BLEND);
@@ -2400,6 +2447,11 @@ void GLEngine::setBlendMode(BlendMode newMode) {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ZERO);
     break;
+  case BlendMode::MaxColorAddAlpha:
+    glEnable(GL_BLEND);
+    glBlendEquationSeparate(GL_MAX, GL_FUNC_ADD);
+    glBlendFunc(GL_ONE, GL_ONE);
+    break;
   case BlendMode::Disable:
     glDisable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // doesn't actually matter
@@ -2443,9 +2495,79 @@ void GLEngine::applyTransparencySettings() {
     setDepthMode(DepthMode::Less);
     break;
   }
+  case TransparencyMode::Weighted: {
+    if (weightedTransparencyAccumulate) {
+      // sum in to both accumulation targets, testing against (but not writing) the opaque depth
+      setBlendMode(BlendMode::Add);
+      setDepthMode(DepthMode::LEqualReadOnly);
+    } else {
+      setBlendMode(BlendMode::AlphaOver);
+      setDepthMode(DepthMode::Less);
+    }
+    break;
+  }
   }
 }
 
+bool GLEngine::supportsGPUTimestamps() { return true; }
+
+uint32_t GLEngine::issueGPUTimestamp() {
+  GLuint query;
+  if (freeTimestampQueries.empty()) {
+    glGenQueries(1, &query);
+  } else {
+    query = freeTimestampQueries.back();
+    freeTimestampQueries.pop_back();
+  }
+  glQueryCounter(query, GL_TIMESTAMP);
+  checkGLError();
+  return query;
+}
+
+bool GLEngine::tryGetGPUTimestamp(uint32_t handle, int64_t& timeNs) {
+  GLint available = 0;
+  glGetQueryObjectiv(handle, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) return false;
+
+  GLuint64 result = 0;
+  glGetQueryObjectui64v(handle, GL_QUERY_RESULT, &result);
+  timeNs = static_cast<int64_t>(result);
+  return true;
+}
+
+void GLEngine::releaseGPUTimestamp(uint32_t handle) { freeTimestampQueries.push_back(handle); }
+
+uint32_t GLEngine::beginAnySamplesQuery() {
+  GLuint query;
+  if (freeAnySamplesQueries.empty()) {
+    glGenQueries(1, &query);
+  } else {
+    query = freeAnySamplesQueries.back();
+    freeAnySamplesQueries.pop_back();
+  }
+  glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+  checkGLError();
+  return query;
+}
+
+void GLEngine::endAnySamplesQuery() {
+  glEndQuery(GL_ANY_SAMPLES_PASSED);
+  checkGLError();
+}
+
+bool GLEngine::tryGetAnySamplesResult(uint32_t handle, bool& anyPassed) {
+  GLint available = 0;
+  glGetQueryObjectiv(handle, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) return false;
+
+  GLuint result = 0;
+  glGetQueryObjectuiv(handle, GL_QUERY_RESULT, &result);
+  anyPassed = result != 0;
+  return true;
+}
+
+void GLEngine::releaseAnySamplesQuery(uint32_t handle) { freeAnySamplesQueries.push_back(handle); }
+
 void GLEngine::setFrontFaceCCW(bool newVal) {
   if (newVal == frontFaceCCW) return;
   frontFaceCCW = newVal;
@@ -2631,6 +2753,7 @@ std::shared_ptr<GLCompiledProgram> GLEngine::getCompiledProgram(const std::strin
 
     // Create a new compiled program (GL work happens in the constructor)
     compiledProgamCache[progKey] = std::shared_ptr<GLCompiledProgram>(new GLCompiledProgram(updatedStages, dm));
+    compiledProgramRequests[progKey] = ShaderProgramRequest{programName, customRules, defaults};
   }
 
   // Now that the cache must contain the compiled program, just return it
@@ -2644,6 +2767,23 @@ std::shared_ptr<ShaderProgram> GLEngine::requestShader(const std::string& progra
   return std::shared_ptr<ShaderProgram>(newP);
 }
 
+bool GLEngine::precompileShader(const ShaderProgramRequest& request) {
+  std::string progKey = programKeyFromRules(request.programName, request.customRules, request.defaults);
+  if (compiledProgamCache.find(progKey) != compiledProgamCache.end()) return false;
+  getCompiledProgram(request.programName, request.customRules, request.defaults);
+  return true;
+}
+
+std::vector<ShaderProgramRequest> GLEngine::getLiveShaderRequests() {
+  std::vector<ShaderProgramRequest> requests;
+  for (auto& entry : compiledProgamCache) {
+    if (entry.second.use_count() > 1) { // referenced by some program, not just the cache
+      requests.push_back(compiledProgramRequests[entry.first]);
+    }
+  }
+  return requests;
+}
+
 
 void GLEngine::registerShaderProgram(const std::string& name, const std::vector<ShaderStageSpecification>& spec,
                                      const DrawMode& dm) {
@@ -2662,13 +2802,18 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("INDEXED_MESH", {FLEX_MESH_VERT_SHADER, FLEX_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SIMPLE_MESH", {SIMPLE_MESH_VERT_SHADER, SIMPLE_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SLICE_TETS", {SLICE_TETS_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::Points);
+  registerShaderProgram("SLICE_TETS_INDEXED", {SLICE_TETS_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::IndexedPoints);
   registerShaderProgram("RAYCAST_SPHERE", {FLEX_SPHERE_VERT_SHADER, FLEX_SPHERE_GEOM_SHADER, FLEX_SPHERE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("POINT_QUAD", {FLEX_POINTQUAD_VERT_SHADER, FLEX_POINTQUAD_GEOM_SHADER, FLEX_POINTQUAD_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE", {FLEX_GRIDCUBE_VERT_SHADER, FLEX_GRIDCUBE_GEOM_SHADER, FLEX_GRIDCUBE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE_PLANE", {FLEX_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::Triangles);
+  registerShaderProgram("SPARSE_GRIDCUBE_PLANE", {FLEX_SPARSE_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::TrianglesInstanced);
+  registerShaderProgram("GRID_VOLUME_RAYMARCH", {FLEX_GRID_VOLUME_RAYMARCH_VERT_SHADER, FLEX_GRID_VOLUME_RAYMARCH_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("RAYCAST_VECTOR", {FLEX_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_TANGENT_VECTOR", {FLEX_TANGENT_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_CYLINDER", {FLEX_CYLINDER_VERT_SHADER, FLEX_CYLINDER_GEOM_SHADER, FLEX_CYLINDER_FRAG_SHADER}, DrawMode::Points);
+  registerShaderProgram("RAYCAST_CYLINDER_STRIP", {FLEX_CYLINDER_STRIP_VERT_SHADER, FLEX_CYLINDER_STRIP_GEOM_SHADER, FLEX_CYLINDER_FRAG_SHADER}, DrawMode::IndexedLineStrip);
+  registerShaderProgram("BUFFER_REDUCE", {BUFFER_REDUCE_VERT_SHADER, BUFFER_REDUCE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("HISTOGRAM", {HISTOGRAM_VERT_SHADER, HISTOGRAM_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("GROUND_PLANE_TILE", {GROUND_PLANE_VERT_SHADER, GROUND_PLANE_TILE_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("GROUND_PLANE_TILE_REFLECT", {GROUND_PLANE_VERT_SHADER, GROUND_PLANE_TILE_REFLECT_FRAG_SHADER}, DrawMode::Triangles);
@@ -2684,6 +2829,8 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("TEXTURE_DRAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("TEXTURE_DRAW_RAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RAW_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("COMPOSITE_PEEL", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_PEEL}, DrawMode::Triangles);
+  registerShaderProgram("COMPOSITE_WEIGHTED", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_WEIGHTED}, DrawMode::Triangles);
+  registerShaderProgram("TAA_RESOLVE", {TEXTURE_DRAW_VERT_SHADER, TAA_RESOLVE}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_COPY", {TEXTURE_DRAW_VERT_SHADER, DEPTH_COPY}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_TO_MASK", {TEXTURE_DRAW_VERT_SHADER, DEPTH_TO_MASK}, DrawMode::Triangles);
   registerShaderProgram("SCALAR_TEXTURE_COLORMAP", {TEXTURE_DRAW_VERT_SHADER, SCALAR_TEXTURE_COLORMAP}, DrawMode::Triangles);
@@ -2704,6 +2851,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("TRANSPARENCY_RESOLVE_SIMPLE", TRANSPARENCY_RESOLVE_SIMPLE);
   registerShaderRule("TRANSPARENCY_PEEL_STRUCTURE", TRANSPARENCY_PEEL_STRUCTURE);
   registerShaderRule("TRANSPARENCY_PEEL_GROUND", TRANSPARENCY_PEEL_GROUND);
+  registerShaderRule("TRANSPARENCY_WEIGHTED_STRUCTURE", TRANSPARENCY_WEIGHTED_STRUCTURE);
   
   registerShaderRule("GENERATE_VIEW_POS", GENERATE_VIEW_POS);
   registerShaderRule("COMPUTE_SHADE_NORMAL_FROM_POSITION", COMPUTE_SHADE_NORMAL_FROM_POSITION);
@@ -2762,6 +2910,9 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("GRIDCUBE_WIREFRAME", GRIDCUBE_WIREFRAME);
   registerShaderRule("GRIDCUBE_CONSTANT_PICK", GRIDCUBE_CONSTANT_PICK);
   registerShaderRule("GRIDCUBE_CULLPOS_FROM_CENTER", GRIDCUBE_CULLPOS_FROM_CENTER);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE", SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE", SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE);
+  registerShaderRule("SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER", SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER);
 
   // sphere things
   registerShaderRule("SPHERE_PROPAGATE_VALUE", SPHERE_PROPAGATE_VALUE);
@@ -2781,15 +2932,25 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_VALUE", CYLINDER_PROPAGATE_BLEND_VALUE);
   registerShaderRule("CYLINDER_PROPAGATE_COLOR", CYLINDER_PROPAGATE_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_COLOR", CYLINDER_PROPAGATE_BLEND_COLOR);
+  registerShaderRule("CYLINDER_STRIP_PROPAGATE_BLEND_VALUE", CYLINDER_STRIP_PROPAGATE_BLEND_VALUE);
+  registerShaderRule("CYLINDER_STRIP_PROPAGATE_BLEND_COLOR", CYLINDER_STRIP_PROPAGATE_BLEND_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_PICK", CYLINDER_PROPAGATE_PICK);
+  registerShaderRule("CYLINDER_STRIP_PROPAGATE_PICK", CYLINDER_STRIP_PROPAGATE_PICK);
   registerShaderRule("CYLINDER_CULLPOS_FROM_MID", CYLINDER_CULLPOS_FROM_MID);
   registerShaderRule("CYLINDER_VARIABLE_SIZE", CYLINDER_VARIABLE_SIZE);
 
+  // Buffer reductions
+  registerShaderRule("REDUCE_VALUE_FLOAT", REDUCE_VALUE_FLOAT);
+  registerShaderRule("REDUCE_VALUE_VEC2_LENGTH", REDUCE_VALUE_VEC2_LENGTH);
+  registerShaderRule("REDUCE_VALUE_VEC3_LENGTH", REDUCE_VALUE_VEC3_LENGTH);
+  registerShaderRule("REDUCE_VALUE_VEC4_LENGTH", REDUCE_VALUE_VEC4_LENGTH);
+
   // marching tets things
   registerShaderRule("SLICE_TETS_BASECOLOR_SHADE", SLICE_TETS_BASECOLOR_SHADE);
   registerShaderRule("SLICE_TETS_PROPAGATE_VALUE", SLICE_TETS_PROPAGATE_VALUE);
   registerShaderRule("SLICE_TETS_PROPAGATE_VECTOR", SLICE_TETS_PROPAGATE_VECTOR);
   registerShaderRule("SLICE_TETS_VECTOR_COLOR", SLICE_TETS_VECTOR_COLOR);
+  registerShaderRule("SLICE_TETS_LEVEL_SET", SLICE_TETS_LEVEL_SET);
   registerShaderRule("SLICE_TETS_MESH_WIREFRAME", SLICE_TETS_MESH_WIREFRAME);
 
   // clang-format on
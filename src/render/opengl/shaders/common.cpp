@@ -34,6 +34,15 @@ void buildTangentBasis(vec3 unitNormal, out vec3 basisX, out vec3 basisY) {
     basisY = normalize(cross(unitNormal, basisX));
 }
 
+// The pick color of the global index (start + ind), matching pick::indToVec(). The start is given by its digits, see
+// pick::indToDigits().
+vec3 pickIndToColor(uvec3 startDigits, uint ind) {
+    uint low = startDigits.x + (ind & 4194303u);
+    uint med = startDigits.y + (ind >> 22) + (low >> 22);
+    uint high = startDigits.z + (med >> 22);
+    return vec3(float(low & 4194303u), float(med & 4194303u), float(high)) / 4194304.;
+}
+
 float orenNayarDiffuse(
   vec3 lightDirection,
   vec3 viewDirection,
@@ -47,29 +47,11 @@ R"(
 )"
 };
 
-const ShaderStageSpecification FLEX_CYLINDER_GEOM_SHADER = {
-    
-    ShaderStageType::Geometry,
-    
-    // uniforms
-    {
-        {"u_projMatrix", RenderDataType::Matrix44Float},
-        {"u_radius", RenderDataType::Float},
-    }, 
-
-    // attributes
-    {
-    },
-
-    {}, // textures
-
-    // source
-R"(
-        ${ GLSL_VERSION }$
-
-        layout(points) in;
+// The part of the cylinder geometry shader shared by both pipelines below, which differ only in where the endpoints of
+// each cylinder come from. Each pipeline prepends the input layout and defines cylinderTailView() / cylinderTipView(),
+// which return the view-space endpoints.
+const char* const FLEX_CYLINDER_GEOM_BODY = R"(
         layout(triangle_strip, max_vertices=14) out;
-        in vec4 position_tip[];
         uniform mat4 u_projMatrix;
         uniform float u_radius;
         out vec3 tipView;
@@ -85,14 +67,16 @@ R"(
             ${ CYLINDER_SET_RADIUS_GEOM }$
 
             // Build an orthogonal basis
-            vec3 tailViewVal = gl_in[0].gl_Position.xyz / gl_in[0].gl_Position.w;
-            vec3 tipViewVal = position_tip[0].xyz / position_tip[0].w;
+            vec4 tailViewHomog = cylinderTailView();
+            vec4 tipViewHomog = cylinderTipView();
+            vec3 tailViewVal = tailViewHomog.xyz / tailViewHomog.w;
+            vec3 tipViewVal = tipViewHomog.xyz / tipViewHomog.w;
             vec3 cylDir = normalize(tipViewVal - tailViewVal);
             vec3 basisX; vec3 basisY; buildTangentBasis(cylDir, basisX, basisY);
   
             // Compute corners of cube
-            vec4 tailProj = u_projMatrix * gl_in[0].gl_Position;
-            vec4 tipProj = u_projMatrix * position_tip[0];
+            vec4 tailProj = u_projMatrix * tailViewHomog;
+            vec4 tipProj = u_projMatrix * tipViewHomog;
             vec4 dxTip = u_projMatrix * vec4(basisX * tipRadius, 0.);
             vec4 dyTip = u_projMatrix * vec4(basisY * tipRadius, 0.);
             vec4 dxTail = u_projMatrix * vec4(basisX * tailRadius, 0.);
@@ -107,8 +91,6 @@ R"(
             vec4 p7 = tipProj - dxTip + dyTip;
             vec4 p8 = tipProj + dxTip + dyTip;
             
-            // Other data to emit   
-    
             // Emit the vertices as a triangle strip
             ${ GEOM_PER_EMIT }$ tailView = tailViewVal; tipView = tipViewVal; gl_Position = p7; EmitVertex(); 
             ${ GEOM_PER_EMIT }$ tailView = tailViewVal; tipView = tipViewVal; gl_Position = p8; EmitVertex(); 
@@ -129,9 +111,96 @@ R"(
 
         }
 
+)";
+
+const ShaderStageSpecification FLEX_CYLINDER_GEOM_SHADER = {
+    
+    ShaderStageType::Geometry,
+    
+    // uniforms
+    {
+        {"u_projMatrix", RenderDataType::Matrix44Float},
+        {"u_radius", RenderDataType::Float},
+    }, 
+
+    // attributes
+    {
+    },
+
+    {}, // textures
+
+    // source
+std::string(R"(
+        ${ GLSL_VERSION }$
+
+        layout(points) in;
+        in vec4 position_tip[];
+        vec4 cylinderTailView() { return gl_in[0].gl_Position; }
+        vec4 cylinderTipView() { return position_tip[0]; }
+)") + FLEX_CYLINDER_GEOM_BODY
+};
+
+// Variant of the cylinder pipeline which consumes a (possibly indexed) line strip over shared node positions, rather
+// than separate tail/tip positions for each cylinder. Each line segment of the strip becomes one cylinder.
+const ShaderStageSpecification FLEX_CYLINDER_STRIP_VERT_SHADER = {
+
+    ShaderStageType::Vertex,
+
+    // uniforms
+    {
+        {"u_modelView", RenderDataType::Matrix44Float},
+    }, 
+
+    // attributes
+    {
+        {"a_position", RenderDataType::Vector3Float},
+    },
+
+    {}, // textures
+
+    // source
+R"(
+        ${ GLSL_VERSION }$
+
+        in vec3 a_position;
+        uniform mat4 u_modelView;
+        
+        ${ VERT_DECLARATIONS }$
+        
+        void main()
+        {
+            gl_Position = u_modelView * vec4(a_position, 1.0);
+
+            ${ VERT_ASSIGNMENTS }$
+        }
 )"
 };
 
+const ShaderStageSpecification FLEX_CYLINDER_STRIP_GEOM_SHADER = {
+    
+    ShaderStageType::Geometry,
+    
+    // uniforms
+    {
+        {"u_projMatrix", RenderDataType::Matrix44Float},
+        {"u_radius", RenderDataType::Float},
+    }, 
+
+    // attributes
+    {
+    },
+
+    {}, // textures
+
+    // source
+std::string(R"(
+        ${ GLSL_VERSION }$
+
+        layout(lines) in;
+        vec4 cylinderTailView() { return gl_in[0].gl_Position; }
+        vec4 cylinderTipView() { return gl_in[1].gl_Position; }
+)") + FLEX_CYLINDER_GEOM_BODY
+};
 
 const ShaderStageSpecification FLEX_CYLINDER_FRAG_SHADER = {
     
@@ -290,6 +359,43 @@ const ShaderReplacementRule CYLINDER_PROPAGATE_BLEND_VALUE (
     /* textures */ {}
 );
 
+// blend value for a line strip: the tail and tip values are the values at the two strip vertices of each segment
+const ShaderReplacementRule CYLINDER_STRIP_PROPAGATE_BLEND_VALUE (
+    /* rule name */ "CYLINDER_STRIP_PROPAGATE_BLEND_VALUE",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in float a_value;
+          out float a_valueToGeom;
+        )"},
+      {"VERT_ASSIGNMENTS", R"(
+          a_valueToGeom = a_value;
+        )"},
+      {"GEOM_DECLARATIONS", R"(
+          in float a_valueToGeom[];
+          out float a_valueTailToFrag;
+          out float a_valueTipToFrag;
+        )"},
+      {"GEOM_PER_EMIT", R"(
+          a_valueTailToFrag = a_valueToGeom[0]; 
+          a_valueTipToFrag = a_valueToGeom[1]; 
+        )"},
+      {"FRAG_DECLARATIONS", R"(
+          in float a_valueTailToFrag;
+          in float a_valueTipToFrag;
+          float length2(vec3 x);
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          float tEdge = dot(pHit - tailView, tipView - tailView) / length2(tipView - tailView);
+          float shadeValue = mix(a_valueTailToFrag, a_valueTipToFrag, tEdge);
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_value", RenderDataType::Float},
+    },
+    /* textures */ {}
+);
+
 const ShaderReplacementRule CYLINDER_PROPAGATE_COLOR (
     /* rule name */ "CYLINDER_PROPAGATE_COLOR",
     { /* replacement sources */
@@ -363,6 +469,43 @@ const ShaderReplacementRule CYLINDER_PROPAGATE_BLEND_COLOR (
     /* textures */ {}
 );
 
+// blend color for a line strip, like CYLINDER_STRIP_PROPAGATE_BLEND_VALUE
+const ShaderReplacementRule CYLINDER_STRIP_PROPAGATE_BLEND_COLOR (
+    /* rule name */ "CYLINDER_STRIP_PROPAGATE_BLEND_COLOR",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec3 a_color;
+          out vec3 a_colorToGeom;
+        )"},
+      {"VERT_ASSIGNMENTS", R"(
+          a_colorToGeom = a_color;
+        )"},
+      {"GEOM_DECLARATIONS", R"(
+          in vec3 a_colorToGeom[];
+          out vec3 a_colorTailToFrag;
+          out vec3 a_colorTipToFrag;
+        )"},
+      {"GEOM_PER_EMIT", R"(
+          a_colorTailToFrag = a_colorToGeom[0]; 
+          a_colorTipToFrag = a_colorToGeom[1]; 
+        )"},
+      {"FRAG_DECLARATIONS", R"(
+          in vec3 a_colorTailToFrag;
+          in vec3 a_colorTipToFrag;
+          float length2(vec3 x);
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          float tEdge = dot(pHit - tailView, tipView - tailView) / length2(tipView - tailView);
+          vec3 shadeColor = mix(a_colorTailToFrag, a_colorTipToFrag, tEdge);
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_color", RenderDataType::Vector3Float},
+    },
+    /* textures */ {}
+);
+
 const ShaderReplacementRule CYLINDER_CULLPOS_FROM_MID (
     /* rule name */ "CYLINDER_CULLPOS_FROM_MID",
     { /* replacement sources */
@@ -433,6 +576,59 @@ const ShaderReplacementRule CYLINDER_PROPAGATE_PICK (
     /* textures */ {}
 );
 
+// data for picking from a line strip: node indices come from the strip vertices, and the edge index is computed from
+// the primitive ID (the i'th segment of the strip draw gets pick index u_edgePickStart + i)
+const ShaderReplacementRule CYLINDER_STRIP_PROPAGATE_PICK (
+    /* rule name */ "CYLINDER_STRIP_PROPAGATE_PICK",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec3 a_color;
+          out vec3 a_colorToGeom;
+        )"},
+      {"VERT_ASSIGNMENTS", R"(
+          a_colorToGeom = a_color;
+        )"},
+      {"GEOM_DECLARATIONS", R"(
+          uniform uvec3 u_edgePickStart; // digits of pick::indToDigits()
+          in vec3 a_colorToGeom[];
+          flat out vec3 a_colorTailToFrag;
+          flat out vec3 a_colorTipToFrag;
+          flat out vec3 a_colorEdgeToFrag;
+          vec3 pickIndToColor(uvec3 startDigits, uint ind);
+        )"},
+      {"GEOM_PER_EMIT", R"(
+          a_colorTailToFrag = a_colorToGeom[0]; 
+          a_colorTipToFrag = a_colorToGeom[1]; 
+          a_colorEdgeToFrag = pickIndToColor(u_edgePickStart, uint(gl_PrimitiveIDIn)); 
+        )"},
+      {"FRAG_DECLARATIONS", R"(
+          flat in vec3 a_colorTailToFrag;
+          flat in vec3 a_colorTipToFrag;
+          flat in vec3 a_colorEdgeToFrag;
+          float length2(vec3 x);
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          float tEdge = dot(pHit - tailView, tipView - tailView) / length2(tipView - tailView);
+          float endWidth = 0.2;
+          vec3 shadeColor;
+          if(tEdge < endWidth) {
+            shadeColor = a_colorTailToFrag;
+          } else if (tEdge < (1.0f - endWidth)) {
+            shadeColor = a_colorEdgeToFrag;
+          } else {
+            shadeColor = a_colorTipToFrag;
+          }
+        )"},
+    },
+    /* uniforms */ {
+      {"u_edgePickStart", RenderDataType::Vector3UInt},
+    },
+    /* attributes */ {
+      {"a_color", RenderDataType::Vector3Float},
+    },
+    /* textures */ {}
+);
+
 const ShaderReplacementRule CYLINDER_VARIABLE_SIZE (
     /* rule name */ "CYLINDER_VARIABLE_SIZE",
     { /* replacement sources */
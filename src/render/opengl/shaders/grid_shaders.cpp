@@ -261,6 +261,84 @@ R"(
 )"
 };
 
+const ShaderStageSpecification FLEX_SPARSE_GRIDCUBE_PLANE_VERT_SHADER = {
+
+    ShaderStageType::Vertex,
+
+    // uniforms
+    {
+        {"u_modelView", RenderDataType::Matrix44Float},
+        {"u_projMatrix", RenderDataType::Matrix44Float},
+        {"u_cubeSizeFactor", RenderDataType::Float},
+        {"u_gridSpacingReference", RenderDataType::Vector3Float},
+        {"u_gridSpacing", RenderDataType::Vector3Float},
+        {"u_atlasBrickDim", RenderDataType::Vector3UInt},
+    }, 
+
+    // attributes
+    {
+        {"a_referencePosition", RenderDataType::Vector3Float},
+        {"a_referenceNormal", RenderDataType::Vector3Float},
+        {"a_axisInd", RenderDataType::Int},
+    },
+
+    // textures
+    {
+        {"t_brickOrigin", 2},
+    },
+
+    // source
+R"(
+        ${ GLSL_VERSION }$
+        
+        uniform mat4 u_modelView;
+        uniform mat4 u_projMatrix;
+        uniform float u_cubeSizeFactor;
+        uniform vec3 u_gridSpacingReference;
+        uniform vec3 u_gridSpacing;
+        uniform uvec3 u_atlasBrickDim;
+        uniform sampler2D t_brickOrigin;
+
+        in vec3 a_referencePosition;
+        in vec3 a_referenceNormal;
+        in int a_axisInd;
+        
+        out vec3 a_coordToFrag;
+        out vec3 a_normalToFrag;
+        out vec3 a_refNormalToFrag;
+        flat out int a_axisIndToFrag;
+        flat out vec3 a_brickOriginToFrag;
+        flat out uvec3 a_atlasTileToFrag;
+        
+        ${ VERT_DECLARATIONS }$
+        
+        void main()
+        {
+            // each instance is one brick, look up where it is
+            int brickTableWidth = textureSize(t_brickOrigin, 0).x;
+            vec3 brickOrigin = texelFetch(t_brickOrigin, ivec2(gl_InstanceID % brickTableWidth, gl_InstanceID / brickTableWidth), 0).xyz;
+            uint iBrick = uint(gl_InstanceID);
+            uvec3 atlasTile = uvec3(iBrick % u_atlasBrickDim.x, (iBrick / u_atlasBrickDim.x) % u_atlasBrickDim.y, iBrick / (u_atlasBrickDim.x * u_atlasBrickDim.y));
+
+            // first apply any scale shrinking 
+            vec3 adjPosition = a_referencePosition - a_referenceNormal * (1.f - (0.5 + u_cubeSizeFactor/2.)) * u_gridSpacingReference;
+
+            // apply brick shift (the reference geometry spans one brick)
+            vec3 boxPos = brickOrigin + adjPosition * (u_gridSpacing / u_gridSpacingReference);
+
+            a_coordToFrag = adjPosition;
+            a_normalToFrag = mat3(u_modelView) * a_referenceNormal;
+            a_refNormalToFrag = a_referenceNormal;
+            a_axisIndToFrag = a_axisInd;
+            a_brickOriginToFrag = brickOrigin;
+            a_atlasTileToFrag = atlasTile;
+            gl_Position = u_projMatrix * u_modelView * vec4(boxPos,1.);
+
+            ${ VERT_ASSIGNMENTS }$
+        }
+)"
+};
+
 const ShaderStageSpecification FLEX_GRIDCUBE_PLANE_FRAG_SHADER = {
     
     ShaderStageType::Fragment,
@@ -362,6 +440,247 @@ R"(
 };
 
 
+const ShaderStageSpecification FLEX_GRID_VOLUME_RAYMARCH_VERT_SHADER = {
+
+    ShaderStageType::Vertex,
+
+    // uniforms
+    {
+        {"u_modelView", RenderDataType::Matrix44Float},
+        {"u_projMatrix", RenderDataType::Matrix44Float},
+        {"u_boundMin", RenderDataType::Vector3Float},
+        {"u_boundMax", RenderDataType::Vector3Float},
+    }, 
+
+    // attributes
+    {
+        {"a_referencePosition", RenderDataType::Vector3Float},
+    },
+
+    {}, // textures
+
+    // source
+R"(
+        ${ GLSL_VERSION }$
+        
+        uniform mat4 u_modelView;
+        uniform mat4 u_projMatrix;
+        uniform vec3 u_boundMin;
+        uniform vec3 u_boundMax;
+
+        in vec3 a_referencePosition;
+        
+        ${ VERT_DECLARATIONS }$
+        
+        void main()
+        {
+            vec3 boxPos = mix(u_boundMin, u_boundMax, a_referencePosition);
+            gl_Position = u_projMatrix * u_modelView * vec4(boxPos,1.);
+
+            ${ VERT_ASSIGNMENTS }$
+        }
+)"
+};
+
+// Emission-absorption ray marching through the node values of a volume grid, drawn on the back faces of its bounding
+// box. NOTE: this logic is mirrored on the CPU by VolumeGridNodeScalarQuantity::marchVolumeRay(), keep them in sync.
+const ShaderStageSpecification FLEX_GRID_VOLUME_RAYMARCH_FRAG_SHADER = {
+    
+    ShaderStageType::Fragment,
+    
+    // uniforms
+    {
+        {"u_modelView", RenderDataType::Matrix44Float},
+        {"u_invModelView", RenderDataType::Matrix44Float},
+        {"u_projMatrix", RenderDataType::Matrix44Float},
+        {"u_invProjMatrix", RenderDataType::Matrix44Float},
+        {"u_viewport", RenderDataType::Vector4Float},
+        {"u_boundMin", RenderDataType::Vector3Float},
+        {"u_boundMax", RenderDataType::Vector3Float},
+        {"u_rangeLow", RenderDataType::Float},
+        {"u_rangeHigh", RenderDataType::Float},
+        {"u_opacityStart", RenderDataType::Float},
+        {"u_opacityEnd", RenderDataType::Float},
+        {"u_density", RenderDataType::Float},
+        {"u_stepSize", RenderDataType::Float},
+        {"u_isoEnabled", RenderDataType::Int},
+        {"u_isoLevel", RenderDataType::Float},
+        {"u_isoColor", RenderDataType::Vector3Float},
+    }, 
+
+    { }, // attributes
+    
+    // textures 
+    {
+        {"t_value", 3},
+        {"t_blockMin", 3},
+        {"t_blockMax", 3},
+        {"t_colormap", 1},
+    },
+ 
+    // source
+R"(
+        ${ GLSL_VERSION }$
+        
+        uniform mat4 u_modelView;
+        uniform mat4 u_invModelView;
+        uniform mat4 u_projMatrix;
+        uniform mat4 u_invProjMatrix;
+        uniform vec4 u_viewport;
+        uniform vec3 u_boundMin;
+        uniform vec3 u_boundMax;
+        uniform float u_rangeLow;
+        uniform float u_rangeHigh;
+        uniform float u_opacityStart;
+        uniform float u_opacityEnd;
+        uniform float u_density;
+        uniform float u_stepSize;
+        uniform int u_isoEnabled;
+        uniform float u_isoLevel;
+        uniform vec3 u_isoColor;
+        uniform sampler3D t_value;
+        uniform sampler3D t_blockMin;
+        uniform sampler3D t_blockMax;
+        uniform sampler1D t_colormap;
+
+        layout(location = 0) out vec4 outputF;
+
+        vec3 fragmentViewPosition(vec4 viewport, vec2 depthRange, mat4 invProjMat, vec4 fragCoord);
+        float fragDepthFromView(mat4 projMat, vec2 depthRange, vec3 viewPoint);
+
+        ${ FRAG_DECLARATIONS }$
+
+        // must match VolumeGridNodeScalarQuantity::VOLUME_BLOCK_SIZE and VOLUME_MAX_STEPS
+        const float BLOCK_SIZE = 8.;
+        const int MAX_STEPS = 8192;
+        const float TERMINATION_ALPHA = 0.99;
+
+        // the values are stored with z changing fastest, so texture axes are (z,y,x)
+        float sampleValue(vec3 nodeCoord, vec3 nodeDim) {
+          return texture(t_value, ((nodeCoord + 0.5) / nodeDim).zyx).r;
+        }
+
+        float volumeOpacity(float val) {
+          float width = u_opacityEnd - u_opacityStart;
+          if(width == 0.) return val >= u_opacityStart ? 1. : 0.;
+          return clamp((val - u_opacityStart) / width, 0., 1.);
+        }
+
+        void main()
+        {
+           // Only the back faces of the box are drawn, so there is a fragment for every ray through the volume, even
+           // when the camera is inside it
+           if(gl_FrontFacing) discard;
+           
+           // Build the ray through this fragment, from the near plane to the back face, in object space
+           vec2 depthRange = vec2(gl_DepthRange.near, gl_DepthRange.far);
+           vec3 viewBack = fragmentViewPosition(u_viewport, depthRange, u_invProjMatrix, gl_FragCoord);
+           vec3 viewNear = fragmentViewPosition(u_viewport, depthRange, u_invProjMatrix, vec4(gl_FragCoord.xy, depthRange.x, 1.));
+           vec3 rayStart = (u_invModelView * vec4(viewNear, 1.)).xyz;
+           vec3 rayDir = normalize(mat3(u_invModelView) * (viewBack - viewNear));
+
+           // March in node index coordinates, where node (i,j,k) is at (i,j,k)
+           vec3 nodeDim = vec3(textureSize(t_value, 0).zyx);
+           vec3 spacing = (u_boundMax - u_boundMin) / (nodeDim - 1.);
+           vec3 startN = (rayStart - u_boundMin) / spacing;
+           vec3 dirN = rayDir / spacing;
+           vec3 dirNSafe = mix(dirN, vec3(1e-20), lessThan(abs(dirN), vec3(1e-20)));
+           vec3 invDirN = 1. / dirNSafe;
+
+           // Clip the ray to the box
+           vec3 tA = (vec3(0.) - startN) * invDirN;
+           vec3 tB = (nodeDim - 1. - startN) * invDirN;
+           vec3 tNear = min(tA, tB);
+           vec3 tFar = max(tA, tB);
+           float tEnter = max(max(max(tNear.x, tNear.y), tNear.z), 0.);
+           float tExit = min(min(tFar.x, tFar.y), tFar.z);
+           if(tExit <= tEnter) discard;
+
+           float minSpacing = min(min(spacing.x, spacing.y), spacing.z);
+           float ds = u_stepSize * minSpacing;
+           float stepExtinction = u_density * u_stepSize; // optical depth per step at full opacity
+           int nSteps = min(int(ceil((tExit - tEnter) / ds)), MAX_STEPS);
+           vec3 blockDim = vec3(textureSize(t_blockMin, 0).zyx);
+
+           vec4 accum = vec4(0.);
+           float prevVal = 0.;
+           bool hitIso = false;
+           vec3 isoCoord = vec3(0.);
+
+           int iStep = 0;
+           while(iStep < nSteps) {
+             float t = tEnter + float(iStep) * ds;
+             vec3 nodeCoord = startN + t * dirN;
+             float val = sampleValue(nodeCoord, nodeDim);
+
+             // stop at the first crossing of the isovalue
+             if(u_isoEnabled != 0 && iStep > 0 && ((prevVal < u_isoLevel) != (val < u_isoLevel))) {
+               float tHit = t - ds * (val - u_isoLevel) / (val - prevVal);
+               isoCoord = startN + tHit * dirN;
+               hitIso = true;
+               break;
+             }
+             prevVal = val;
+
+             float alpha = 1. - exp(-stepExtinction * volumeOpacity(val));
+             if(alpha > 0.) {
+               float rangeTVal = clamp((val - u_rangeLow) / (u_rangeHigh - u_rangeLow), 0., 1.);
+               vec3 color = texture(t_colormap, rangeTVal).rgb;
+               accum += (1. - accum.a) * vec4(alpha * color, alpha);
+               if(accum.a > TERMINATION_ALPHA) break;
+               iStep++;
+               continue;
+             }
+
+             // Empty space skipping: if nothing in this block can be visible, jump to the last sample inside it
+             int stepInc = 1;
+             ivec3 block = clamp(ivec3(floor(nodeCoord / BLOCK_SIZE)), ivec3(0), ivec3(blockDim) - 1);
+             float blockMin = texelFetch(t_blockMin, block.zyx, 0).r;
+             float blockMax = texelFetch(t_blockMax, block.zyx, 0).r;
+             bool blockHasIso = u_isoEnabled != 0 && blockMin <= u_isoLevel && u_isoLevel <= blockMax;
+             if(max(volumeOpacity(blockMin), volumeOpacity(blockMax)) == 0. && !blockHasIso) {
+               vec3 blockLow = vec3(block) * BLOCK_SIZE;
+               vec3 tBlockFar = max((blockLow - startN) * invDirN, (blockLow + BLOCK_SIZE - startN) * invDirN);
+               float tBlockExit = min(min(tBlockFar.x, tBlockFar.y), tBlockFar.z);
+               stepInc = max(int(floor((tBlockExit - t) / ds)), 1);
+             }
+             iStep += stepInc;
+           }
+
+           // Shade the isosurface as an opaque surface behind whatever has been accumulated
+           if(hitIso) {
+             vec3 h = vec3(0.5);
+             vec3 gradN = vec3(
+                 sampleValue(isoCoord + vec3(h.x, 0., 0.), nodeDim) - sampleValue(isoCoord - vec3(h.x, 0., 0.), nodeDim),
+                 sampleValue(isoCoord + vec3(0., h.y, 0.), nodeDim) - sampleValue(isoCoord - vec3(0., h.y, 0.), nodeDim),
+                 sampleValue(isoCoord + vec3(0., 0., h.z), nodeDim) - sampleValue(isoCoord - vec3(0., 0., h.z), nodeDim)
+               ) / (2. * h * spacing);
+             vec3 viewRayDir = normalize(viewBack - viewNear);
+             vec3 shadeNormal = transpose(mat3(u_invModelView)) * gradN;
+             if(length(shadeNormal) < 1e-12) {
+               shadeNormal = -viewRayDir;
+             }
+             shadeNormal = normalize(shadeNormal);
+             if(dot(shadeNormal, viewRayDir) > 0.) shadeNormal = -shadeNormal;
+
+             vec3 albedoColor = u_isoColor;
+             ${ GENERATE_LIT_COLOR }$
+             accum += (1. - accum.a) * vec4(litColor, 1.);
+           }
+
+           if(accum.a == 0.) discard;
+
+           // Depth is that of the point where the ray enters the volume
+           vec3 entryView = (u_modelView * vec4(u_boundMin + (startN + tEnter * dirN) * spacing, 1.)).xyz;
+           gl_FragDepth = fragDepthFromView(u_projMatrix, depthRange, entryView);
+
+           // Write output (already premultiplied)
+           outputF = accum;
+        }
+)"
+};
+
+
 const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE (
     /* rule name */ "GRIDCUBE_PROPAGATE_NODE_VALUE",
     { /* replacement sources */
@@ -369,7 +688,7 @@ const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE (
           uniform sampler3D t_value;
         )"},
       {"GENERATE_SHADE_VALUE", R"(
-          float shadeValue = texture(t_value, a_coordToFrag).r;
+          float shadeValue = texture(t_value, a_coordToFrag.zyx).r; // values are z-fastest, so texture axes are (z,y,x)
         )"},
     },
     /* uniforms */ {},
@@ -386,7 +705,7 @@ const ShaderReplacementRule GRIDCUBE_PROPAGATE_CELL_VALUE (
           uniform sampler3D t_value;
         )"},
       {"GENERATE_SHADE_VALUE", R"(
-          float shadeValue = texelFetch(t_value, ivec3(cellInd), 0).r;
+          float shadeValue = texelFetch(t_value, ivec3(cellInd).zyx, 0).r;
         )"},
     },
     /* uniforms */ {},
@@ -461,6 +780,71 @@ const ShaderReplacementRule GRIDCUBE_CULLPOS_FROM_CENTER(
     /* textures */ {}
 );
 
+const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE (
+    /* rule name */ "SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform sampler3D t_value;
+          flat in uvec3 a_atlasTileToFrag;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          // node tiles are one texel larger than the brick, and nodes are at texel centers
+          vec3 atlasTexel = vec3(a_atlasTileToFrag) * (round(1.f / u_gridSpacingReference) + 1.f) + 0.5f + coordUnit;
+          float shadeValue = texture(t_value, atlasTexel / vec3(textureSize(t_value, 0))).r;
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ { },
+    /* textures */ {
+      {"t_value", 3},
+    }
+);
+
+const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE (
+    /* rule name */ "SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform sampler3D t_value;
+          flat in uvec3 a_atlasTileToFrag;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          uvec3 brickCells = uvec3(round(1.f / u_gridSpacingReference));
+          ivec3 atlasCell = ivec3(a_atlasTileToFrag * brickCells + min(cellInd, brickCells - 1u));
+          float shadeValue = texelFetch(t_value, atlasCell, 0).r;
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ { },
+    /* textures */ {
+      {"t_value", 3},
+    }
+);
+
+const ShaderReplacementRule SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER(
+    /* rule name */ "SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform mat4 u_modelView;
+          uniform vec3 u_gridSpacing;
+          flat in vec3 a_brickOriginToFrag;
+        )"},
+      {"GLOBAL_FRAGMENT_FILTER_PREP", R"(
+          // same as GRIDCUBE_CULLPOS_FROM_CENTER, but relative to the brick (see the note there about the constant)
+          vec3 cullPosWorld = a_brickOriginToFrag + (0.667f + cellInd3f) * u_gridSpacing;
+          vec3 cullPos = (u_modelView * vec4(cullPosWorld, 1.f)).xyz;
+         
+          vec3 neighCullPosWorld = a_brickOriginToFrag + (0.5f + cellInd3f + a_refNormalToFrag) * u_gridSpacing;
+          vec3 neighCullPos = (u_modelView * vec4(neighCullPosWorld, 1.f)).xyz;
+        )"},
+    },
+    /* uniforms */ {
+      {"u_modelView", RenderDataType::Matrix44Float},
+      {"u_gridSpacing", RenderDataType::Vector3Float},
+    },
+    /* attributes */ {},
+    /* textures */ {}
+);
+
 }
 }
 }
@@ -264,7 +264,8 @@ const ShaderStageSpecification GROUND_PLANE_SHADOW_FRAG_SHADER = {
       {"u_shadowDarkness", RenderDataType::Float},
       {"u_cameraHeight", RenderDataType::Float},
       {"u_groundHeight", RenderDataType::Float},
-      {"u_upSign", RenderDataType::Float}
+      {"u_upSign", RenderDataType::Float},
+      {"u_shadowViewProjMatrix", RenderDataType::Matrix44Float}
     }, 
 
     // attributes
@@ -288,6 +289,7 @@ R"(
       uniform float u_cameraHeight;
       uniform float u_groundHeight;
       uniform float u_upSign;
+      uniform mat4 u_shadowViewProjMatrix;
       in vec4 PositionWorldHomog;
       layout(location = 0) out vec4 outputF;
       
@@ -298,8 +300,16 @@ R"(
         float depth = gl_FragCoord.z;
         ${ GLOBAL_FRAGMENT_FILTER }$
 
-        vec2 screenCoords = vec2(gl_FragCoord.x / u_viewportDim.x, gl_FragCoord.y / u_viewportDim.y);
-        float shadowVal = texture(t_shadow, screenCoords).r;
+        // The shadow texture may have been rendered from an earlier camera, look up this point on the ground as seen
+        // from that camera. Points it did not see are unshadowed.
+        vec4 shadowClip = u_shadowViewProjMatrix * PositionWorldHomog;
+        float shadowVal = 0.;
+        if(shadowClip.w > 0.) {
+          vec2 shadowCoords = 0.5 * shadowClip.xy / shadowClip.w + 0.5;
+          if(all(greaterThanEqual(shadowCoords, vec2(0., 0.))) && all(lessThanEqual(shadowCoords, vec2(1., 1.)))) {
+            shadowVal = texture(t_shadow, shadowCoords).r;
+          }
+        }
         shadowVal = pow(clamp(shadowVal, 0., 1.), 0.25);
 
         float shadowMax = u_shadowDarkness + 0. * PositionWorldHomog.x;  // use PositionWorldHomog to prevent silly optimizing out
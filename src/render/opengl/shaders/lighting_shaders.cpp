@@ -302,6 +302,34 @@ const ShaderReplacementRule TRANSPARENCY_PEEL_GROUND (
     }
 );
 
+const ShaderReplacementRule TRANSPARENCY_WEIGHTED_STRUCTURE (
+    /* rule name */ "TRANSPARENCY_WEIGHTED_STRUCTURE",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform float u_transparency;
+          layout(location = 1) out vec4 outputRevealage;
+        )"},
+      {"GENERATE_ALPHA", R"(
+          alphaOut = u_transparency;
+
+          // Optical depth -log(1-a) sums additively, so the blended total gives the product of (1-a) over all layers
+          outputRevealage = vec4(-log(1. - clamp(alphaOut, 0., 0.999)), 0., 0., 0.);
+
+          // Weight transparent structures toward the viewer (McGuire & Bavoil 2013, eq. 10), scaled down so that many
+          // layers still fit in a half-float target. Opaque structures are drawn normally and keep unit weight.
+          // (as with peeling, assumes "float depth" is already set)
+          if(u_transparency < 1.) {
+            alphaOut *= clamp(3e2 * pow(1. - depth, 3.), 1e-2, 3e2);
+          }
+        )"},
+    },
+    /* uniforms */ {
+        {"u_transparency", RenderDataType::Float},
+    },
+    /* attributes */ {},
+    /* textures */ {}
+);
+
 // clang-format on
 
 } // namespace backend_openGL3_glfw
@@ -0,0 +1,157 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+
+#include "polyscope/render/opengl/shaders/reduction_shaders.h"
+
+namespace polyscope {
+namespace render {
+namespace backend_openGL3_glfw {
+
+// clang-format off
+
+// Reduces an attribute buffer to a single pixel. Every entry is drawn as a point on to the same pixel of a 1x1 float
+// target, which is blended with max() on the RGB channels and addition on the alpha channel. The output is:
+//   R: max of the finite values
+//   G: max of the negated finite values (i.e., -min)
+//   A: count of non-finite values
+// The target must be cleared to -FLT_MAX in RGB and 0 in alpha beforehand.
+
+const ShaderStageSpecification BUFFER_REDUCE_VERT_SHADER =  {
+    
+    ShaderStageType::Vertex,
+    
+    {}, // uniforms
+
+    // attributes
+    {
+    },
+
+    {}, // textures
+
+    // source
+R"(
+      ${ GLSL_VERSION }$
+
+      ${ VERT_DECLARATIONS }$
+
+      flat out float a_valueToFrag;
+      flat out float a_isFiniteToFrag;
+
+      void main()
+      {
+          float value = 0.;
+          ${ REDUCE_GET_VALUE }$
+
+          a_valueToFrag = value;
+          a_isFiniteToFrag = (isnan(value) || isinf(value)) ? 0. : 1.;
+          gl_Position = vec4(0., 0., 0., 1.);
+      }
+)"
+};
+
+const ShaderStageSpecification BUFFER_REDUCE_FRAG_SHADER = {
+    
+    ShaderStageType::Fragment,
+    
+    {}, // uniforms
+
+    // attributes
+    {
+    },
+    
+    {}, // textures 
+    
+    // source 
+R"(
+      ${ GLSL_VERSION }$
+
+      flat in float a_valueToFrag;
+      flat in float a_isFiniteToFrag;
+
+      layout(location = 0) out vec4 outputF;
+
+      void main()
+      {
+        const float lowestFloat = -3.402823e38;
+        if(a_isFiniteToFrag > 0.5) {
+          outputF = vec4(a_valueToFrag, -a_valueToFrag, lowestFloat, 0.);
+        } else {
+          outputF = vec4(lowestFloat, lowestFloat, lowestFloat, 1.);
+        }
+      }
+)"
+};
+
+const ShaderReplacementRule REDUCE_VALUE_FLOAT (
+    /* rule name */ "REDUCE_VALUE_FLOAT",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in float a_value;
+        )"},
+      {"REDUCE_GET_VALUE", R"(
+          value = a_value;
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_value", RenderDataType::Float},
+    },
+    /* textures */ {}
+);
+
+const ShaderReplacementRule REDUCE_VALUE_VEC2_LENGTH (
+    /* rule name */ "REDUCE_VALUE_VEC2_LENGTH",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec2 a_value;
+        )"},
+      {"REDUCE_GET_VALUE", R"(
+          value = length(a_value);
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_value", RenderDataType::Vector2Float},
+    },
+    /* textures */ {}
+);
+
+const ShaderReplacementRule REDUCE_VALUE_VEC3_LENGTH (
+    /* rule name */ "REDUCE_VALUE_VEC3_LENGTH",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec3 a_value;
+        )"},
+      {"REDUCE_GET_VALUE", R"(
+          value = length(a_value);
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_value", RenderDataType::Vector3Float},
+    },
+    /* textures */ {}
+);
+
+const ShaderReplacementRule REDUCE_VALUE_VEC4_LENGTH (
+    /* rule name */ "REDUCE_VALUE_VEC4_LENGTH",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec4 a_value;
+        )"},
+      {"REDUCE_GET_VALUE", R"(
+          value = length(a_value);
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_value", RenderDataType::Vector4Float},
+    },
+    /* textures */ {}
+);
+
+// clang-format on
+
+} // namespace backend_openGL3_glfw
+} // namespace render
+} // namespace polyscope
@@ -508,32 +508,38 @@ const ShaderReplacementRule MESH_BACKFACE_DIFFERENT (
 
 
 // data for picking
+// The pick colors are computed here from the element indices of each triangle, offset by the start of each element
+// type's range of global pick indices. The starts are given as the digits of pick::indToDigits(), so that the global
+// index may be up to 64 bits. Encodes the same way as pick::indToVec().
 const ShaderReplacementRule MESH_PROPAGATE_PICK (
     /* rule name */ "MESH_PROPAGATE_PICK",
     { /* replacement sources */
       {"VERT_DECLARATIONS", R"(
-          in vec3 a_vertexColors[3];
-          in vec3 a_halfedgeColors[3];
-          in vec3 a_cornerColors[3];
-          in vec3 a_faceColor;
-          flat out vec3 vertexColors[3];
-          flat out vec3 halfedgeColors[3];
-          flat out vec3 cornerColors[3];
-          flat out vec3 faceColor;
+          in uvec3 a_vertexInds;
+          in uvec3 a_halfedgeInds;
+          in uvec3 a_cornerInds;
+          in uint a_faceInd;
+          flat out uvec3 pickVertexInds;
+          flat out uvec3 pickHalfedgeInds;
+          flat out uvec3 pickCornerInds;
+          flat out uint pickFaceInd;
         )"},
       {"VERT_ASSIGNMENTS", R"(
-          for(int i = 0; i < 3; i++) {
-              vertexColors[i] = a_vertexColors[i];
-              halfedgeColors[i] = a_halfedgeColors[i];
-              cornerColors[i] = a_cornerColors[i];
-          }
-          faceColor = a_faceColor;
+          pickVertexInds = a_vertexInds;
+          pickHalfedgeInds = a_halfedgeInds;
+          pickCornerInds = a_cornerInds;
+          pickFaceInd = a_faceInd;
         )"},
       {"FRAG_DECLARATIONS", R"(
-          flat in vec3 vertexColors[3];
-          flat in vec3 halfedgeColors[3];
-          flat in vec3 cornerColors[3];
-          flat in vec3 faceColor;
+          flat in uvec3 pickVertexInds;
+          flat in uvec3 pickHalfedgeInds;
+          flat in uvec3 pickCornerInds;
+          flat in uint pickFaceInd;
+          uniform uvec3 u_vertexPickStart;
+          uniform uvec3 u_facePickStart;
+          uniform uvec3 u_halfedgePickStart;
+          uniform uvec3 u_cornerPickStart;
+          vec3 pickIndToColor(uvec3 startDigits, uint ind);
         )"},
       {"GENERATE_SHADE_VALUE", R"(
           // Parameters defining the pick shape (in barycentric 0-1 units)
@@ -541,39 +547,46 @@ const ShaderReplacementRule MESH_PROPAGATE_PICK (
           float cornerRadius = 0.25;
           float halfedgeRadius = 0.15;
           
-          vec3 shadeColor = faceColor;
+          vec3 shadeColor = pickIndToColor(u_facePickStart, pickFaceInd);
           bool colorSet = false;
 
           // Test vertices and corners
           for(int i = 0; i < 3; i++) {
               if(a_barycoordToFrag[i] > 1.0-vertRadius) {
-                shadeColor = vertexColors[i];
+                shadeColor = pickIndToColor(u_vertexPickStart, pickVertexInds[i]);
                 colorSet = true;
                 continue;
               }
               if(a_barycoordToFrag[i] > 1.0-cornerRadius) {
-                shadeColor = cornerColors[i];
+                shadeColor = pickIndToColor(u_cornerPickStart, pickCornerInds[i]);
                 colorSet = true;
               }
           }
 
-          // Test halfedges
+          // Test halfedges (the index is all ones for sides of the triangle which are interior to the face)
           for(int i = 0; i < 3; i++) {
               if(colorSet) continue;
               float eDist = a_barycoordToFrag[(i+2)%3];
               if(eDist < halfedgeRadius) {
-                shadeColor = halfedgeColors[i];
+                if(pickHalfedgeInds[i] != 4294967295u) {
+                  shadeColor = pickIndToColor(u_halfedgePickStart, pickHalfedgeInds[i]);
+                }
                 colorSet = true;
               }
           }
         )"},
     },
-    /* uniforms */ {},
+    /* uniforms */ {
+      {"u_vertexPickStart", RenderDataType::Vector3UInt},
+      {"u_facePickStart", RenderDataType::Vector3UInt},
+      {"u_halfedgePickStart", RenderDataType::Vector3UInt},
+      {"u_cornerPickStart", RenderDataType::Vector3UInt},
+    },
     /* attributes */ {
-      {"a_vertexColors", RenderDataType::Vector3Float, 3},
-      {"a_halfedgeColors", RenderDataType::Vector3Float, 3},
-      {"a_cornerColors", RenderDataType::Vector3Float, 3},
-      {"a_faceColor", RenderDataType::Vector3Float},
+      {"a_vertexInds", RenderDataType::Vector3UInt},
+      {"a_halfedgeInds", RenderDataType::Vector3UInt},
+      {"a_cornerInds", RenderDataType::Vector3UInt},
+      {"a_faceInd", RenderDataType::UInt},
     },
     /* textures */ {}
 );
@@ -582,39 +595,43 @@ const ShaderReplacementRule MESH_PROPAGATE_PICK_SIMPLE ( // this one does faces
     /* rule name */ "MESH_PROPAGATE_PICK_SIMPLE",
     { /* replacement sources */
       {"VERT_DECLARATIONS", R"(
-          in vec3 a_vertexColors[3];
-          in vec3 a_faceColor;
-          flat out vec3 vertexColors[3];
-          flat out vec3 faceColor;
+          in uvec3 a_vertexInds;
+          in uint a_faceInd;
+          flat out uvec3 pickVertexInds;
+          flat out uint pickFaceInd;
         )"},
       {"VERT_ASSIGNMENTS", R"(
-          for(int i = 0; i < 3; i++) {
-              vertexColors[i] = a_vertexColors[i];
-          }
-          faceColor = a_faceColor;
+          pickVertexInds = a_vertexInds;
+          pickFaceInd = a_faceInd;
         )"},
       {"FRAG_DECLARATIONS", R"(
-          flat in vec3 vertexColors[3];
-          flat in vec3 faceColor;
+          flat in uvec3 pickVertexInds;
+          flat in uint pickFaceInd;
+          uniform uvec3 u_vertexPickStart;
+          uniform uvec3 u_facePickStart;
+          vec3 pickIndToColor(uvec3 startDigits, uint ind);
         )"},
       {"GENERATE_SHADE_VALUE", R"(
           // Parameters defining the pick shape (in barycentric 0-1 units)
           float vertRadius = 0.2;
           
-          vec3 shadeColor = faceColor;
+          vec3 shadeColor = pickIndToColor(u_facePickStart, pickFaceInd);
 
           // Test vertices and corners
           for(int i = 0; i < 3; i++) {
               if(a_barycoordToFrag[i] > 1.0-vertRadius) {
-                shadeColor = vertexColors[i];
+                shadeColor = pickIndToColor(u_vertexPickStart, pickVertexInds[i]);
               }
           }
         )"},
     },
-    /* uniforms */ {},
+    /* uniforms */ {
+      {"u_vertexPickStart", RenderDataType::Vector3UInt},
+      {"u_facePickStart", RenderDataType::Vector3UInt},
+    },
     /* attributes */ {
-      {"a_vertexColors", RenderDataType::Vector3Float, 3},
-      {"a_faceColor", RenderDataType::Vector3Float},
+      {"a_vertexInds", RenderDataType::Vector3UInt},
+      {"a_faceInd", RenderDataType::UInt},
     },
     /* textures */ {}
 );
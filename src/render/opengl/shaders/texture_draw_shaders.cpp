@@ -422,6 +422,110 @@ R"(
 )"
 };
 
+const ShaderStageSpecification COMPOSITE_WEIGHTED = {
+    
+    // stage
+    ShaderStageType::Fragment,
+    
+    // uniforms
+    { }, 
+
+    // attributes
+    { },
+    
+    // textures 
+    { {"t_accum", 2}, {"t_revealage", 2} },
+    
+    // source 
+R"(
+      ${ GLSL_VERSION }$
+
+      in vec2 tCoord;
+      uniform sampler2D t_accum;
+      uniform sampler2D t_revealage;
+      layout(location = 0) out vec4 outputF;
+
+      void main()
+      {
+        float coverage = 1. - exp(-texture(t_revealage, tCoord).r);
+        if(coverage < 1e-5) {
+          discard;
+        }
+
+        // weighted average of the layer colors, composited with the total coverage (premultiplied)
+        vec4 accum = texture(t_accum, tCoord);
+        vec3 avgColor = accum.rgb / max(accum.a, 1e-5);
+        outputF = vec4(avgColor * coverage, coverage);
+      }
+)"
+};
+
+const ShaderStageSpecification TAA_RESOLVE = {
+    
+    // stage
+    ShaderStageType::Fragment,
+    
+    // uniforms
+    { 
+      {"u_reprojectMatrix", RenderDataType::Matrix44Float},
+      {"u_blendFactor", RenderDataType::Float},
+      {"u_clampHistory", RenderDataType::Int},
+      {"u_texelSize", RenderDataType::Vector2Float},
+    }, 
+
+    // attributes
+    { },
+    
+    // textures 
+    { {"t_current", 2}, {"t_history", 2}, {"t_depth", 2} },
+    
+    // source 
+R"(
+      ${ GLSL_VERSION }$
+
+      in vec2 tCoord;
+      uniform sampler2D t_current;
+      uniform sampler2D t_history;
+      uniform sampler2D t_depth;
+      uniform mat4 u_reprojectMatrix;
+      uniform float u_blendFactor;
+      uniform int u_clampHistory;
+      uniform vec2 u_texelSize;
+      layout(location = 0) out vec4 outputF;
+
+      void main()
+      {
+        vec4 current = texture(t_current, tCoord);
+
+        // Where was this point in the previous frame?
+        float depth = texture(t_depth, tCoord).r;
+        vec4 prevClip = u_reprojectMatrix * vec4(2. * tCoord - 1., 2. * depth - 1., 1.);
+        vec2 prevCoord = 0.5 * prevClip.xy / prevClip.w + 0.5;
+        if(prevClip.w <= 0. || any(lessThan(prevCoord, vec2(0., 0.))) || any(greaterThan(prevCoord, vec2(1., 1.)))) {
+          outputF = current;
+          return;
+        }
+        vec4 history = texture(t_history, prevCoord);
+
+        // Reject history which doesn't resemble anything nearby in the current frame
+        if(u_clampHistory == 1) {
+          vec4 minColor = current;
+          vec4 maxColor = current;
+          for(int i = -1; i <= 1; i++) {
+            for(int j = -1; j <= 1; j++) {
+              vec4 neighbor = texture(t_current, tCoord + vec2(i, j) * u_texelSize);
+              minColor = min(minColor, neighbor);
+              maxColor = max(maxColor, neighbor);
+            }
+          }
+          history = clamp(history, minColor, maxColor);
+        }
+
+        outputF = mix(history, current, u_blendFactor);
+      }
+)"
+};
+
 const ShaderStageSpecification DEPTH_COPY = {
     
     // stage
@@ -16,13 +16,9 @@ const ShaderStageSpecification SLICE_TETS_VERT_SHADER = {
     // attributes
     {
         {"a_point_1", RenderDataType::Vector3Float},
-        {"a_slice_1", RenderDataType::Vector3Float},
         {"a_point_2", RenderDataType::Vector3Float},
-        {"a_slice_2", RenderDataType::Vector3Float},
         {"a_point_3", RenderDataType::Vector3Float},
-        {"a_slice_3", RenderDataType::Vector3Float},
         {"a_point_4", RenderDataType::Vector3Float},
-        {"a_slice_4", RenderDataType::Vector3Float},
     },
 
     {}, // textures
@@ -36,10 +32,6 @@ const ShaderStageSpecification SLICE_TETS_VERT_SHADER = {
         in vec3 a_point_2;
         in vec3 a_point_3;
         in vec3 a_point_4;
-        in vec3 a_slice_1;
-        in vec3 a_slice_2;
-        in vec3 a_slice_3;
-        in vec3 a_slice_4;
         out vec3 point_1;
         out vec3 point_2;
         out vec3 point_3;
@@ -55,10 +47,11 @@ const ShaderStageSpecification SLICE_TETS_VERT_SHADER = {
             point_2 = a_point_2;
             point_3 = a_point_3;
             point_4 = a_point_4;
-            slice_1 = a_slice_1;
-            slice_2 = a_slice_2;
-            slice_3 = a_slice_3;
-            slice_4 = a_slice_4;
+            // slice along the positions, unless a rule replaces the coordinates below
+            slice_1 = a_point_1;
+            slice_2 = a_point_2;
+            slice_3 = a_point_3;
+            slice_4 = a_point_4;
             ${ VERT_ASSIGNMENTS }$
         }
 )"};
@@ -391,6 +384,35 @@ const ShaderReplacementRule SLICE_TETS_PROPAGATE_VALUE(
     },
     /* textures */ {});
 
+// Slice along the values of a scalar function at the tet corners, rather than along their positions. With u_sliceVector
+// = (1, 0, 0), the slice is the level set where the value is u_slicePoint.
+const ShaderReplacementRule SLICE_TETS_LEVEL_SET(
+    /* rule name */ "SLICE_TETS_LEVEL_SET",
+    {
+        /* replacement sources */
+        {"VERT_DECLARATIONS", R"(
+          in float a_levelSetValue_1;
+          in float a_levelSetValue_2;
+          in float a_levelSetValue_3;
+          in float a_levelSetValue_4;
+        )"},
+        {"VERT_ASSIGNMENTS", R"(
+          slice_1 = vec3(a_levelSetValue_1, 0., 0.);
+          slice_2 = vec3(a_levelSetValue_2, 0., 0.);
+          slice_3 = vec3(a_levelSetValue_3, 0., 0.);
+          slice_4 = vec3(a_levelSetValue_4, 0., 0.);
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */
+    {
+        {"a_levelSetValue_1", RenderDataType::Float},
+        {"a_levelSetValue_2", RenderDataType::Float},
+        {"a_levelSetValue_3", RenderDataType::Float},
+        {"a_levelSetValue_4", RenderDataType::Float},
+    },
+    /* textures */ {});
+
 } // namespace backend_openGL3_glfw
 } // namespace render
 }; // namespace polyscope
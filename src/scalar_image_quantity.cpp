@@ -52,7 +52,7 @@ void ScalarImageQuantity::prepareFullscreen() {
       this->addScalarRules({getImageOriginRule(imageOrigin), "TEXTURE_SET_TRANSPARENCY", "TEXTURE_PREMULTIPLY_OUT"}),
       render::ShaderReplacementDefaults::Process);
   fullscreenProgram->setAttribute("a_position", render::engine->screenTrianglesCoords());
-  fullscreenProgram->setTextureFromBuffer("t_scalar", values.getRenderTextureBuffer().get());
+  fullscreenProgram->setTextureFromBuffer("t_scalar", &imageTexture());
   fullscreenProgram->setTextureFromColormap("t_colormap", this->cMap.get());
 }
 
@@ -65,7 +65,7 @@ void ScalarImageQuantity::prepareBillboard() {
                                                           "TEXTURE_BILLBOARD_FROM_UNIFORMS"}),
                                     render::ShaderReplacementDefaults::Process);
   billboardProgram->setAttribute("a_position", render::engine->screenTrianglesCoords());
-  billboardProgram->setTextureFromBuffer("t_scalar", values.getRenderTextureBuffer().get());
+  billboardProgram->setTextureFromBuffer("t_scalar", &imageTexture());
   billboardProgram->setTextureFromColormap("t_colormap", this->cMap.get());
 }
 
@@ -78,6 +78,7 @@ void ScalarImageQuantity::showFullscreen() {
   // Set uniforms
   this->setScalarUniforms(*fullscreenProgram);
   fullscreenProgram->setUniform("u_transparency", getTransparency());
+  fullscreenProgram->setTextureFromBuffer("t_scalar", &imageTexture());
 
   fullscreenProgram->draw();
 
@@ -91,6 +92,7 @@ void ScalarImageQuantity::renderIntermediate() {
   // Set uniforms
   this->setScalarUniforms(*fullscreenProgram);
   fullscreenProgram->setUniform("u_transparency", getTransparency());
+  fullscreenProgram->setTextureFromBuffer("t_scalar", &imageTexture());
 
   // render to the intermediate texture
   render::engine->pushBindFramebufferForRendering(*framebufferIntermediate);
@@ -135,6 +137,7 @@ void ScalarImageQuantity::showInBillboard(glm::vec3 center, glm::vec3 upVec, glm
   billboardProgram->setUniform("u_billboardCenter", center);
   billboardProgram->setUniform("u_billboardUp", upVec);
   billboardProgram->setUniform("u_billboardRight", rightVec);
+  billboardProgram->setTextureFromBuffer("t_scalar", &imageTexture());
   this->setScalarUniforms(*billboardProgram);
 
   render::engine->setBackfaceCull(false);
@@ -142,6 +145,8 @@ void ScalarImageQuantity::showInBillboard(glm::vec3 center, glm::vec3 upVec, glm
   render::engine->setBackfaceCull(); // return to default setting
 }
 
+render::TextureBuffer& ScalarImageQuantity::imageTexture() { return *values.getRenderTextureBuffer(); }
+
 void ScalarImageQuantity::refresh() {
   fullscreenProgram.reset();
   billboardProgram.reset();
@@ -0,0 +1,215 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/scheduler.h"
+
+#include "polyscope/options.h"
+#include "polyscope/profiler.h"
+#include "polyscope/view.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace polyscope {
+namespace scheduler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Task {
+  bool hasOwner;
+  GenericWeakHandle owner;
+  std::function<void()> func;
+};
+std::deque<Task> highPriorityTasks;
+std::deque<Task> lowPriorityTasks;
+
+// The current frame
+Clock::time_point frameStart = Clock::now();
+double frameBudgetMs = 0.;
+double deferredWorkMs = 0.; // spent so far this frame
+
+// Smoothed cost of a frame's own work, not counting deferred work. Negative until the first frame.
+double frameCostEstimateMs = -1.;
+const double FRAME_COST_SMOOTHING = 0.1;
+
+// Interaction holds for a little while after the last input, so that it doesn't flicker between events
+Clock::time_point lastInteractionTime;
+bool haveInteracted = false;
+const double INTERACTION_HOLD_MS = 150.;
+
+// While the user keeps interacting, low-priority tasks still run one at a time at this interval, so they can't starve
+Clock::time_point lastLowPriorityTaskTime = Clock::now();
+const double LOW_PRIORITY_STARVATION_MS = 500.;
+
+// Frame pacing
+Clock::time_point nextFrameTime;
+bool pacingStarted = false;
+
+std::deque<double> frameTimeHistory;
+
+double msSince(Clock::time_point t) { return std::chrono::duration<double, std::milli>(Clock::now() - t).count(); }
+
+double targetFrameMs() { return options::maxFPS > 0 ? 1000. / options::maxFPS : 1000. / 60.; }
+
+// Run the front task of a queue. Returns the time taken.
+double runFrontTask(std::deque<Task>& queue) {
+  // Pop before running, the task might defer more tasks
+  Task task = std::move(queue.front());
+  queue.pop_front();
+  if (task.hasOwner && !task.owner.isValid()) return 0.;
+
+  Clock::time_point start = Clock::now();
+  task.func();
+  return msSince(start);
+}
+
+} // namespace
+
+void deferTask(std::function<void()> task, TaskPriority priority) {
+  Task t{false, GenericWeakHandle(), task};
+  (priority == TaskPriority::High ? highPriorityTasks : lowPriorityTasks).push_back(std::move(t));
+}
+
+void deferTask(GenericWeakHandle owner, std::function<void()> task, TaskPriority priority) {
+  Task t{true, owner, task};
+  (priority == TaskPriority::High ? highPriorityTasks : lowPriorityTasks).push_back(std::move(t));
+}
+
+void finishDeferredTasks() {
+  while (!highPriorityTasks.empty() || !lowPriorityTasks.empty()) {
+    runFrontTask(highPriorityTasks.empty() ? lowPriorityTasks : highPriorityTasks);
+  }
+}
+
+size_t getDeferredTaskCount() { return highPriorityTasks.size() + lowPriorityTasks.size(); }
+
+double getFrameBudgetMs() { return frameBudgetMs; }
+
+double getRemainingFrameBudgetMs() { return std::max(frameBudgetMs - deferredWorkMs, 0.); }
+
+void addDeferredWorkTime(double ms) { deferredWorkMs += ms; }
+
+void markInteraction() {
+  lastInteractionTime = Clock::now();
+  haveInteracted = true;
+}
+
+bool isInteracting() {
+  if (view::midflight) return true;
+  return haveInteracted && msSince(lastInteractionTime) < INTERACTION_HOLD_MS;
+}
+
+FrameTimeStats getFrameTimeStats() {
+  FrameTimeStats stats;
+  stats.nFrames = frameTimeHistory.size();
+  if (stats.nFrames == 0) return stats;
+
+  std::vector<double> sorted(frameTimeHistory.begin(), frameTimeHistory.end());
+  std::sort(sorted.begin(), sorted.end());
+  auto percentile = [&](double p) {
+    size_t ind = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(std::max(ind, static_cast<size_t>(1)), sorted.size()) - 1];
+  };
+
+  double sum = 0.;
+  for (double t : sorted) sum += t;
+  stats.meanMs = sum / sorted.size();
+  stats.p50Ms = percentile(0.5);
+  stats.p90Ms = percentile(0.9);
+  stats.p99Ms = percentile(0.99);
+  stats.maxMs = sorted.back();
+  return stats;
+}
+
+void clearFrameTimeStats() { frameTimeHistory.clear(); }
+
+void beginFrame() {
+  frameStart = Clock::now();
+  deferredWorkMs = 0.;
+
+  // Deferred work gets whatever the frame's own work is expected to leave of the target frame time
+  double expectedCostMs = std::max(frameCostEstimateMs, 0.);
+  frameBudgetMs = std::max(targetFrameMs() - expectedCostMs, 0.);
+  frameBudgetMs = std::min(frameBudgetMs, static_cast<double>(options::frameWorkBudgetMs));
+}
+
+void runDeferredTasks() {
+
+  // Update the estimate of the frame's own cost
+  double frameCostMs = msSince(frameStart) - deferredWorkMs;
+  if (frameCostEstimateMs < 0.) {
+    frameCostEstimateMs = frameCostMs;
+  } else {
+    frameCostEstimateMs += FRAME_COST_SMOOTHING * (frameCostMs - frameCostEstimateMs);
+  }
+
+  if (highPriorityTasks.empty() && lowPriorityTasks.empty()) return;
+  profiler::ScopedTimer timer("deferred tasks");
+
+  bool interacting = isInteracting();
+  bool ranAny = false;
+  bool ranLowPriority = false;
+  while (true) {
+    if (ranAny && getRemainingFrameBudgetMs() <= 0.) break;
+
+    if (!highPriorityTasks.empty()) {
+      deferredWorkMs += runFrontTask(highPriorityTasks);
+    } else if (!lowPriorityTasks.empty()) {
+      bool starved = msSince(lastLowPriorityTaskTime) > LOW_PRIORITY_STARVATION_MS;
+      if (interacting && (ranLowPriority || !starved)) break;
+      deferredWorkMs += runFrontTask(lowPriorityTasks);
+      lastLowPriorityTaskTime = Clock::now();
+      ranLowPriority = true;
+    } else {
+      break;
+    }
+    ranAny = true;
+  }
+
+  if (lowPriorityTasks.empty()) {
+    lastLowPriorityTaskTime = Clock::now();
+  }
+}
+
+void endFrame() {
+  frameTimeHistory.push_back(msSince(frameStart));
+  while (frameTimeHistory.size() > FRAME_TIME_HISTORY_LENGTH) {
+    frameTimeHistory.pop_front();
+  }
+}
+
+void waitForNextFrame() {
+  if (options::maxFPS < 1) {
+    pacingStarted = false;
+    return;
+  }
+
+  // Frames are paced against a fixed timeline, so that the error in any one wait doesn't accumulate. After falling
+  // behind by more than a frame, the timeline restarts, rather than rushing frames to catch up.
+  Clock::duration period =
+      std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1. / options::maxFPS));
+  Clock::time_point now = Clock::now();
+  if (!pacingStarted || now > nextFrameTime + period) {
+    nextFrameTime = now;
+    pacingStarted = true;
+  }
+
+  // Sleep for most of the wait, which is imprecise, then yield for the rest
+  const Clock::duration sleepSlack = std::chrono::milliseconds(2);
+  if (nextFrameTime - now > sleepSlack) {
+    std::this_thread::sleep_for(nextFrameTime - now - sleepSlack);
+  }
+  while (Clock::now() < nextFrameTime) {
+    std::this_thread::yield();
+  }
+
+  nextFrameTime += period;
+}
+
+} // namespace scheduler
+} // namespace polyscope
@@ -3,6 +3,7 @@
 #include "polyscope/screenshot.h"
 
 #include "polyscope/polyscope.h"
+#include "polyscope/viewport.h"
 
 #include "stb_image_write.h"
 
@@ -70,12 +71,24 @@ void screenshot(std::string filename, bool transparentBG) {
 
   // == Make sure we render first
   processLazyProperties();
+  render::engine->finishPendingPrograms(); // don't capture a render mode switch half-way through
 
   // save the redraw requested bit and restore it below
   bool requestedAlready = redrawRequested();
   requestRedraw();
 
+  // With temporal anti-aliasing, render the still view until all of its samples have accumulated. The history is
+  // discarded first, so that the result is an exact average of the samples. (Viewports don't use it.)
+  bool convergeTAA = options::enableTAA && state::viewports.empty();
+  if (convergeTAA) render::engine->invalidateTemporalHistory();
   draw(false, false);
+  if (convergeTAA) {
+    for (int i = 1; i < options::taaMaxSamples && render::engine->getTemporalSampleCount() < options::taaMaxSamples;
+         i++) {
+      requestViewRedraw();
+      draw(false, false);
+    }
+  }
 
   if (requestedAlready) {
     requestRedraw();
@@ -0,0 +1,116 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/selection_set.h"
+
+#include <algorithm>
+#include <bitset>
+
+namespace polyscope {
+
+const std::string selectionQuantityPrefix = "#selection";
+
+namespace {
+const size_t BITS_PER_WORD = 64;
+
+size_t popCount(uint64_t w) { return std::bitset<64>(w).count(); }
+} // namespace
+
+bool SelectionSet::contains(size_t ind) const {
+  size_t iWord = ind / BITS_PER_WORD;
+  if (iWord >= words.size()) return false;
+  return (words[iWord] >> (ind % BITS_PER_WORD)) & 1;
+}
+
+void SelectionSet::insert(size_t ind) {
+  size_t iWord = ind / BITS_PER_WORD;
+  if (iWord >= words.size()) words.resize(iWord + 1, 0);
+  words[iWord] |= uint64_t(1) << (ind % BITS_PER_WORD);
+}
+
+void SelectionSet::erase(size_t ind) {
+  size_t iWord = ind / BITS_PER_WORD;
+  if (iWord >= words.size()) return;
+  words[iWord] &= ~(uint64_t(1) << (ind % BITS_PER_WORD));
+}
+
+void SelectionSet::insert(const std::vector<size_t>& inds) {
+  if (inds.empty()) return;
+  size_t maxInd = *std::max_element(inds.begin(), inds.end());
+  if (maxInd / BITS_PER_WORD >= words.size()) words.resize(maxInd / BITS_PER_WORD + 1, 0);
+  for (size_t ind : inds) {
+    words[ind / BITS_PER_WORD] |= uint64_t(1) << (ind % BITS_PER_WORD);
+  }
+}
+
+void SelectionSet::erase(const std::vector<size_t>& inds) {
+  for (size_t ind : inds) {
+    erase(ind);
+  }
+}
+
+void SelectionSet::clear() { words.clear(); }
+
+bool SelectionSet::empty() const {
+  for (uint64_t w : words) {
+    if (w != 0) return false;
+  }
+  return true;
+}
+
+size_t SelectionSet::count() const {
+  size_t total = 0;
+  for (uint64_t w : words) {
+    total += popCount(w);
+  }
+  return total;
+}
+
+size_t SelectionSet::count(size_t start, size_t end) const {
+  end = std::min(end, BITS_PER_WORD * words.size());
+  if (start >= end) return 0;
+
+  size_t startWord = start / BITS_PER_WORD;
+  size_t endWord = (end - 1) / BITS_PER_WORD;
+  uint64_t startMask = ~uint64_t(0) << (start % BITS_PER_WORD);
+  uint64_t endMask = ~uint64_t(0) >> (BITS_PER_WORD - 1 - (end - 1) % BITS_PER_WORD);
+
+  if (startWord == endWord) return popCount(words[startWord] & startMask & endMask);
+
+  size_t total = popCount(words[startWord] & startMask) + popCount(words[endWord] & endMask);
+  for (size_t iWord = startWord + 1; iWord < endWord; iWord++) {
+    total += popCount(words[iWord]);
+  }
+  return total;
+}
+
+std::vector<size_t> SelectionSet::indices() const {
+  std::vector<size_t> inds;
+  inds.reserve(count());
+  for (size_t iWord = 0; iWord < words.size(); iWord++) {
+    uint64_t w = words[iWord];
+    for (size_t iBit = 0; w != 0; iBit++, w >>= 1) {
+      if (w & 1) inds.push_back(BITS_PER_WORD * iWord + iBit);
+    }
+  }
+  return inds;
+}
+
+std::vector<double> SelectionSet::indicator(size_t start, size_t count) const {
+  std::vector<double> vals(count, 0.);
+  for (size_t i = 0; i < count; i++) {
+    if (contains(start + i)) vals[i] = 1.;
+  }
+  return vals;
+}
+
+bool SelectionSet::operator==(const SelectionSet& other) const {
+  // trailing zero words do not change the set
+  const std::vector<uint64_t>& shorter = words.size() < other.words.size() ? words : other.words;
+  const std::vector<uint64_t>& longer = words.size() < other.words.size() ? other.words : words;
+  if (!std::equal(shorter.begin(), shorter.end(), longer.begin())) return false;
+  return std::all_of(longer.begin() + shorter.size(), longer.end(), [](uint64_t w) { return w == 0; });
+}
+
+bool SelectionSet::operator!=(const SelectionSet& other) const { return !(*this == other); }
+
+} // namespace polyscope
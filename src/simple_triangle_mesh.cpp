@@ -4,6 +4,7 @@
 
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "imgui.h"
@@ -106,9 +107,11 @@ void SimpleTriangleMesh::draw() {
 
   // Draw the quantities
   for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
   for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 }
@@ -251,25 +254,10 @@ void SimpleTriangleMesh::refresh() {
 }
 
 void SimpleTriangleMesh::updateObjectSpaceBounds() {
+  if (applyObjectSpaceBoundsHint()) return;
 
   vertices.ensureHostBufferPopulated();
-
-  // bounding box
-  glm::vec3 min = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  glm::vec3 max = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  for (const glm::vec3& p : vertices.data) {
-    min = componentwiseMin(min, p);
-    max = componentwiseMax(max, p);
-  }
-  objectSpaceBoundingBox = std::make_tuple(min, max);
-
-  // length scale, as twice the radius from the center of the bounding box
-  glm::vec3 center = 0.5f * (min + max);
-  float lengthScale = 0.0;
-  for (const glm::vec3& p : vertices.data) {
-    lengthScale = std::max(lengthScale, glm::length2(p - center));
-  }
-  objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  computeObjectSpaceBoundsFromPoints(vertices.data);
 }
 
 std::string SimpleTriangleMesh::typeName() { return structureTypeName; }
@@ -13,6 +13,10 @@ namespace polyscope {
 // Storage for global options
 bool openSlicePlaneMenu = false;
 
+// Half-width of the slab of candidate tets gathered around a plane which inspects a volume mesh, relative to the length
+// scale of the mesh
+const float SLICE_CANDIDATE_SLAB_WIDTH = 0.01;
+
 SlicePlane* addSceneSlicePlane(bool initiallyVisible) {
   size_t nPlanes = state::slicePlanes.size();
   std::string newName = "Scene Slice Plane " + std::to_string(nPlanes);
@@ -68,11 +72,7 @@ SlicePlane::SlicePlane(std::string name_)
       color(uniquePrefix() + "#color", getNextUniqueColor()),
       gridLineColor(uniquePrefix() + "#gridLineColor", glm::vec3{.97, .97, .97}),
       transparency(uniquePrefix() + "#transparency", 0.5), shouldInspectMesh(false), inspectedMeshName(""),
-      transformGizmo(uniquePrefix() + "#transformGizmo", objectTransform.get(), &objectTransform),
-      sliceBufferArr{{{nullptr, uniquePrefix() + "#slice1", sliceBufferDataArr[0]},
-                      {nullptr, uniquePrefix() + "#slice2", sliceBufferDataArr[1]},
-                      {nullptr, uniquePrefix() + "#slice3", sliceBufferDataArr[2]},
-                      {nullptr, uniquePrefix() + "#slice4", sliceBufferDataArr[3]}}}
+      transformGizmo(uniquePrefix() + "#transformGizmo", objectTransform.get(), &objectTransform)
 
 {
   render::engine->addSlicePlane(postfix);
@@ -111,12 +111,67 @@ void SlicePlane::prepare() {
   planeProgram->setAttribute("a_position", positions);
 }
 
+bool SlicePlane::cullsPoint(glm::vec3 worldPos) {
+  if (!active.get()) return false;
+  glm::vec3 normal = getNormal();
+  return glm::dot(worldPos, normal) < glm::dot(getCenter(), normal);
+}
+
 void SlicePlane::setSliceGeomUniforms(render::ShaderProgram& p) {
   glm::vec3 norm = getNormal();
   p.setUniform("u_sliceVector", norm);
   p.setUniform("u_slicePoint", glm::dot(getCenter(), norm));
 }
 
+void SlicePlane::ensureSliceCandidatesUpdated() {
+  VolumeMesh* meshToInspect = polyscope::getVolumeMesh(inspectedMeshName);
+  if (meshToInspect == nullptr) return;
+
+  glm::vec3 normal = getNormal();
+  float planePoint = glm::dot(getCenter(), normal);
+
+  // The cached candidates are still valid as long as the plane stays inside the slab they were gathered for
+  if (sliceCandidateTets && normal == sliceCandidateNormal && planePoint >= sliceCandidateSlabMin &&
+      planePoint <= sliceCandidateSlabMax &&
+      sliceCandidatePositionsVersion == meshToInspect->vertexPositions.getDataVersion()) {
+    return;
+  }
+
+  // Gather for a slab a bit wider than the plane, so that small motions of the plane (e.g. dragging it) can reuse the
+  // result
+  float slabHalfWidth = SLICE_CANDIDATE_SLAB_WIDTH * meshToInspect->lengthScale();
+  sliceCandidateNormal = normal;
+  sliceCandidateSlabMin = planePoint - slabHalfWidth;
+  sliceCandidateSlabMax = planePoint + slabHalfWidth;
+  meshToInspect->gatherTetsInSlab(normal, sliceCandidateSlabMin, sliceCandidateSlabMax, sliceCandidateTetsData);
+  sliceCandidatePositionsVersion = meshToInspect->vertexPositions.getDataVersion();
+
+  if (!sliceCandidateTets) {
+    sliceCandidateTets = render::engine->generateAttributeBuffer(RenderDataType::UInt);
+  }
+  if (!sliceCandidateTetsData.empty()) {
+    sliceCandidateTets->setData(sliceCandidateTetsData);
+  }
+}
+
+void SlicePlane::clearSliceCandidates() {
+  sliceCandidateTets.reset();
+  sliceCandidateTetsData.clear();
+}
+
+bool SlicePlane::setSliceGeomIndex(render::ShaderProgram& p) {
+  ensureSliceCandidatesUpdated();
+  if (!sliceCandidateTets || sliceCandidateTetsData.empty()) return false;
+  p.setIndex(sliceCandidateTets);
+  return true;
+}
+
+size_t SlicePlane::getSliceCandidateTetCount() {
+  if (!shouldInspectMesh || !active.get()) return 0;
+  ensureSliceCandidatesUpdated();
+  return sliceCandidateTetsData.size();
+}
+
 
 void SlicePlane::setVolumeMeshToInspect(std::string meshname) {
   VolumeMesh* oldMeshToInspect = polyscope::getVolumeMesh(inspectedMeshName);
@@ -124,6 +179,7 @@ void SlicePlane::setVolumeMeshToInspect(std::string meshname) {
     oldMeshToInspect->removeSlicePlaneListener(this);
   }
   inspectedMeshName = meshname;
+  clearSliceCandidates();
   VolumeMesh* meshToInspect = polyscope::getVolumeMesh(inspectedMeshName);
   if (meshToInspect == nullptr) {
     inspectedMeshName = "";
@@ -151,6 +207,7 @@ void SlicePlane::ensureVolumeInspectValid() {
     inspectedMeshName = "";
     shouldInspectMesh = false;
     volumeInspectProgram = nullptr;
+    clearSliceCandidates();
   }
 }
 
@@ -158,7 +215,7 @@ void SlicePlane::createVolumeSliceProgram() {
   VolumeMesh* meshToInspect = polyscope::getVolumeMesh(inspectedMeshName);
 
   // clang-format off
-  volumeInspectProgram = render::engine->requestShader( "SLICE_TETS", 
+  volumeInspectProgram = render::engine->requestShader( "SLICE_TETS_INDEXED", 
       render::engine->addMaterialRules(meshToInspect->getMaterial(),
         meshToInspect->addVolumeMeshRules(
           {"SLICE_TETS_BASECOLOR_SHADE"}, 
@@ -173,31 +230,6 @@ void SlicePlane::createVolumeSliceProgram() {
 
 void SlicePlane::resetVolumeSliceProgram() { volumeInspectProgram.reset(); }
 
-void SlicePlane::setSliceAttributes(render::ShaderProgram& p) {
-  VolumeMesh* meshToInspect = polyscope::getVolumeMesh(inspectedMeshName);
-
-
-  size_t cellCount = meshToInspect->nCells();
-  for (int i = 0; i < 4; i++) {
-    sliceBufferDataArr[i].resize(cellCount);
-  }
-  for (size_t iC = 0; iC < cellCount; iC++) {
-    const std::array<uint32_t, 8>& cell = meshToInspect->cells[iC];
-    for (int i = 0; i < 4; i++) {
-      sliceBufferDataArr[i][iC] = cell[i];
-    }
-  }
-
-  for (int i = 0; i < 4; i++) {
-    sliceBufferArr[i].markHostBufferUpdated();
-  }
-
-  p.setAttribute("a_slice_1", meshToInspect->vertexPositions.getIndexedRenderAttributeBuffer(sliceBufferArr[0]));
-  p.setAttribute("a_slice_2", meshToInspect->vertexPositions.getIndexedRenderAttributeBuffer(sliceBufferArr[1]));
-  p.setAttribute("a_slice_3", meshToInspect->vertexPositions.getIndexedRenderAttributeBuffer(sliceBufferArr[2]));
-  p.setAttribute("a_slice_4", meshToInspect->vertexPositions.getIndexedRenderAttributeBuffer(sliceBufferArr[3]));
-}
-
 void SlicePlane::drawGeometry() {
   if (!active.get()) return;
 
@@ -226,7 +258,9 @@ void SlicePlane::drawGeometry() {
       vMesh->setVolumeMeshUniforms(*volumeInspectProgram);
       volumeInspectProgram->setUniform("u_baseColor1", vMesh->getColor());
       render::engine->setMaterialUniforms(*volumeInspectProgram, vMesh->getMaterial());
-      volumeInspectProgram->draw();
+      if (setSliceGeomIndex(*volumeInspectProgram)) {
+        volumeInspectProgram->draw();
+      }
     }
 
     for (auto it = vMesh->quantities.begin(); it != vMesh->quantities.end(); it++) {
@@ -397,6 +431,7 @@ void SlicePlane::setPose(glm::vec3 planePosition, glm::vec3 planeNormal) {
   for (int i = 0; i < 3; i++) newTransform[3][i] = planePosition[i];
 
   objectTransform = newTransform;
+  internal::sceneGeometryVersion++;
   polyscope::requestRedraw();
 }
 
@@ -404,6 +439,7 @@ bool SlicePlane::getActive() { return active.get(); }
 void SlicePlane::setActive(bool newVal) {
   active = newVal;
   updateWidgetEnabled();
+  internal::sceneGeometryVersion++;
   polyscope::requestRedraw();
 }
 
@@ -423,6 +459,7 @@ void SlicePlane::setDrawWidget(bool newVal) {
 glm::mat4 SlicePlane::getTransform() { return objectTransform.get(); }
 void SlicePlane::setTransform(glm::mat4 newTransform) {
   objectTransform = newTransform;
+  internal::sceneGeometryVersion++;
   polyscope::requestRedraw();
 }
 
@@ -0,0 +1,702 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/sparse_volume_grid.h"
+
+#include "polyscope/pick.h"
+#include "polyscope/profiler.h"
+
+#include "imgui.h"
+
+#include <limits>
+
+namespace polyscope {
+
+// Initialize statics
+const std::string SparseVolumeGrid::structureTypeName = "Sparse Volume Grid";
+const uint32_t SparseVolumeGrid::BRICK_SIZE;
+const uint32_t SparseVolumeGrid::BRICK_TABLE_WIDTH;
+const size_t SparseVolumeGrid::CALLABLE_SAMPLE_CHUNK_SIZE;
+
+namespace {
+
+// Integer grid coordinates are packed in to a single 64 bit key, with 21 bits per axis, so they must lie in
+// [-COORD_LIMIT, COORD_LIMIT). Bricks are limited such that all of their nodes are in this range.
+const int32_t COORD_LIMIT = 1 << 20;
+const int32_t BRICK_COORD_LIMIT = COORD_LIMIT / static_cast<int32_t>(SparseVolumeGrid::BRICK_SIZE) - 1;
+
+bool coordInRange(glm::ivec3 c, int32_t limit) {
+  return c.x >= -limit && c.y >= -limit && c.z >= -limit && c.x < limit && c.y < limit && c.z < limit;
+}
+
+uint64_t packCoord(glm::ivec3 c) {
+  return (static_cast<uint64_t>(c.x + COORD_LIMIT) << 42) | (static_cast<uint64_t>(c.y + COORD_LIMIT) << 21) |
+         static_cast<uint64_t>(c.z + COORD_LIMIT);
+}
+
+// Rounds towards negative infinity, unlike integer division
+glm::ivec3 floorDiv(glm::ivec3 c, int32_t d) {
+  glm::ivec3 q = c / d;
+  for (int a = 0; a < 3; a++) {
+    if (c[a] % d != 0 && c[a] < 0) q[a]--;
+  }
+  return q;
+}
+
+std::string coordString(glm::ivec3 c) {
+  return "(" + std::to_string(c.x) + "," + std::to_string(c.y) + "," + std::to_string(c.z) + ")";
+}
+
+// Copy values in to the tiles of an atlas. sourceInd(iBrick, localInds) gives the index in `values` for each texel.
+template <class SourceInd>
+void fillAtlasTiles(const SparseVolumeGrid& grid, uint32_t tileSize, glm::uvec3 atlasSize,
+                    const std::vector<double>& values, SourceInd sourceInd, std::vector<float>& atlas) {
+
+  atlas.assign(static_cast<size_t>(atlasSize.x) * atlasSize.y * atlasSize.z, 0.f);
+
+  // Each brick writes only its own tile, so bricks can be filled in parallel
+  auto fillRange = [&](size_t iStart, size_t iEnd) {
+    for (size_t iBrick = iStart; iBrick < iEnd; iBrick++) {
+      glm::uvec3 tileStart = grid.atlasTileOfBrick(iBrick) * tileSize;
+      for (uint32_t k = 0; k < tileSize; k++) {
+        for (uint32_t j = 0; j < tileSize; j++) {
+          size_t rowStart = tileStart.x + atlasSize.x * (static_cast<size_t>(tileStart.y + j) +
+                                                         atlasSize.y * static_cast<size_t>(tileStart.z + k));
+          for (uint32_t i = 0; i < tileSize; i++) {
+            atlas[rowStart + i] = static_cast<float>(values[sourceInd(iBrick, glm::uvec3{i, j, k})]);
+          }
+        }
+      }
+    }
+  };
+  parallelForRanges(grid.nBricks(), fillRange, 64);
+}
+
+} // namespace
+
+SparseVolumeGrid::SparseVolumeGrid(std::string name, glm::vec3 origin_, glm::vec3 gridSpacing_,
+                                   std::vector<glm::ivec3> brickCoords_)
+    : QuantityStructure<SparseVolumeGrid>(name, typeName()),
+
+      // clang-format off
+      // == managed quantities
+      brickPlaneReferencePositions(this, uniquePrefix() + "#brickPlaneReferencePositions",   brickPlaneReferencePositionsData,   std::bind(&SparseVolumeGrid::computeBrickPlaneReferenceGeometry, this)),
+      brickPlaneReferenceNormals(this, uniquePrefix() +   "#brickPlaneReferenceNormals",     brickPlaneReferenceNormalsData,     [](){/* do nothing, gets handled by position func */} ),
+      brickPlaneAxisInds(this, uniquePrefix() +           "#brickPlaneAxisInds",             brickPlaneAxisIndsData,             [](){/* do nothing, gets handled by position func */} ),
+      brickOrigins(this, uniquePrefix() +                 "#brickOrigins",                   brickOriginsData,                   std::bind(&SparseVolumeGrid::computeBrickOrigins, this)),
+
+      origin(origin_), gridSpacing(gridSpacing_), brickCoords(std::move(brickCoords_)),
+
+      // == persistent options
+      color(                  uniquePrefix() + "color",             getNextUniqueColor()),
+      edgeColor(              uniquePrefix() + "edgeColor",         glm::vec3{0., 0., 0.}),
+      material(               uniquePrefix() + "material",          "clay"),
+      edgeWidth(              uniquePrefix() + "edgeWidth",         0.f),
+      cubeSizeFactor(         uniquePrefix() + "cubeSizeFactor",    0.f)
+// clang-format on
+{
+
+  // Node indices are 32 bit, and each brick has (BRICK_SIZE+1)^3 nodes
+  const uint64_t nodesPerBrick = (BRICK_SIZE + 1) * (BRICK_SIZE + 1) * (BRICK_SIZE + 1);
+  if (nBricks() * nodesPerBrick >= std::numeric_limits<uint32_t>::max()) {
+    exception("sparse volume grid " + name + " has too many bricks (" + std::to_string(nBricks()) + ")");
+  }
+
+  // Build the occupancy index
+  brickIndexMap.reserve(nBricks());
+  for (size_t iB = 0; iB < nBricks(); iB++) {
+    glm::ivec3 b = brickCoords[iB];
+    if (!coordInRange(b, BRICK_COORD_LIMIT)) {
+      exception("sparse volume grid " + name + " brick coordinate " + coordString(b) + " is out of range");
+    }
+    bool inserted = brickIndexMap.emplace(packCoord(b), static_cast<uint32_t>(iB)).second;
+    if (!inserted) {
+      exception("sparse volume grid " + name + " has a duplicate brick at " + coordString(b));
+    }
+  }
+
+  buildNodeIndex();
+
+  // Lay out the atlas tiles in a roughly cubical block
+  uint32_t nTiles = std::max(static_cast<uint32_t>(nBricks()), 1u);
+  atlasBrickDim = glm::uvec3{1, 1, 1};
+  while (atlasBrickDim.x * atlasBrickDim.x * atlasBrickDim.x < nTiles) atlasBrickDim.x++;
+  while (atlasBrickDim.x * atlasBrickDim.y * atlasBrickDim.y < nTiles) atlasBrickDim.y++;
+  atlasBrickDim.z = (nTiles + atlasBrickDim.x * atlasBrickDim.y - 1) / (atlasBrickDim.x * atlasBrickDim.y);
+
+  uint32_t nBrickTableRows = std::max((nTiles + BRICK_TABLE_WIDTH - 1) / BRICK_TABLE_WIDTH, 1u);
+  brickOrigins.setTextureSize(BRICK_TABLE_WIDTH, nBrickTableRows);
+
+  cullWholeElements.setPassive(true);
+  updateObjectSpaceBounds();
+}
+
+void SparseVolumeGrid::buildNodeIndex() {
+
+  const uint32_t T = BRICK_SIZE + 1;
+  brickNodeInds.resize(nBricks() * T * T * T);
+  nodeCoords.clear();
+
+  // Nodes on the boundary of a brick may be shared with neighboring bricks, so they are deduplicated by their
+  // coordinates. Nodes inside a brick can only belong to that brick.
+  std::unordered_map<uint64_t, uint32_t> boundaryNodeInds;
+
+  for (size_t iB = 0; iB < nBricks(); iB++) {
+    glm::ivec3 brickStart = brickCoords[iB] * static_cast<int32_t>(BRICK_SIZE);
+    uint32_t* brickNodes = &brickNodeInds[iB * T * T * T];
+
+    for (uint32_t i = 0; i < T; i++) {
+      for (uint32_t j = 0; j < T; j++) {
+        for (uint32_t k = 0; k < T; k++) {
+          glm::uvec3 local{i, j, k};
+          glm::ivec3 coord = brickStart + glm::ivec3(local);
+          bool onBoundary = i == 0 || j == 0 || k == 0 || i == BRICK_SIZE || j == BRICK_SIZE || k == BRICK_SIZE;
+
+          uint32_t nodeInd = static_cast<uint32_t>(nodeCoords.size());
+          if (onBoundary) {
+            auto result = boundaryNodeInds.emplace(packCoord(coord), nodeInd);
+            nodeInd = result.first->second;
+          }
+          if (nodeInd == nodeCoords.size()) {
+            nodeCoords.push_back(coord);
+          }
+
+          brickNodes[flattenBrickNode(local)] = nodeInd;
+        }
+      }
+    }
+  }
+}
+
+uint64_t SparseVolumeGrid::brickIndexOf(glm::ivec3 brickCoord) const {
+  if (!coordInRange(brickCoord, BRICK_COORD_LIMIT)) return INVALID_IND_64;
+  auto it = brickIndexMap.find(packCoord(brickCoord));
+  if (it == brickIndexMap.end()) return INVALID_IND_64;
+  return it->second;
+}
+
+uint64_t SparseVolumeGrid::cellIndexOf(glm::ivec3 cellCoord) const {
+  glm::ivec3 brickCoord = floorDiv(cellCoord, BRICK_SIZE);
+  uint64_t iBrick = brickIndexOf(brickCoord);
+  if (iBrick == INVALID_IND_64) return INVALID_IND_64;
+
+  glm::uvec3 local(cellCoord - brickCoord * static_cast<int32_t>(BRICK_SIZE));
+  return iBrick * BRICK_SIZE * BRICK_SIZE * BRICK_SIZE + flattenBrickCell(local);
+}
+
+uint64_t SparseVolumeGrid::nodeIndexOf(glm::ivec3 nodeCoord) const {
+  glm::ivec3 brickCoord = floorDiv(nodeCoord, BRICK_SIZE);
+  glm::ivec3 local = nodeCoord - brickCoord * static_cast<int32_t>(BRICK_SIZE);
+
+  // The node is in the brick which contains it, or, if it is on the lower boundary of that brick, possibly on the
+  // upper boundary of one of the lower neighbors
+  for (int iNeigh = 0; iNeigh < 8; iNeigh++) {
+    glm::ivec3 offset{iNeigh & 1, (iNeigh >> 1) & 1, (iNeigh >> 2) & 1};
+    if ((offset.x && local.x != 0) || (offset.y && local.y != 0) || (offset.z && local.z != 0)) continue;
+
+    uint64_t iBrick = brickIndexOf(brickCoord - offset);
+    if (iBrick == INVALID_IND_64) continue;
+
+    glm::uvec3 neighLocal(local + offset * static_cast<int32_t>(BRICK_SIZE));
+    const uint32_t T = BRICK_SIZE + 1;
+    return brickNodeInds[iBrick * T * T * T + flattenBrickNode(neighLocal)];
+  }
+
+  return INVALID_IND_64;
+}
+
+void SparseVolumeGrid::fillNodeAtlas(const std::vector<double>& nodeValues, std::vector<float>& atlas) const {
+  const uint32_t T = BRICK_SIZE + 1;
+  auto sourceInd = [&](size_t iBrick, glm::uvec3 local) {
+    return brickNodeInds[iBrick * T * T * T + flattenBrickNode(local)];
+  };
+  fillAtlasTiles(*this, T, getNodeAtlasSize(), nodeValues, sourceInd, atlas);
+}
+
+void SparseVolumeGrid::fillCellAtlas(const std::vector<double>& cellValues, std::vector<float>& atlas) const {
+  auto sourceInd = [&](size_t iBrick, glm::uvec3 local) {
+    return iBrick * BRICK_SIZE * BRICK_SIZE * BRICK_SIZE + flattenBrickCell(local);
+  };
+  fillAtlasTiles(*this, BRICK_SIZE, getCellAtlasSize(), cellValues, sourceInd, atlas);
+}
+
+
+void SparseVolumeGrid::buildCustomUI() {
+  ImGui::Text("bricks: %lld  cells: %lld", static_cast<long long int>(nBricks()),
+              static_cast<long long int>(nCells()));
+
+  { // Colors
+    if (ImGui::ColorEdit3("Color", &color.get()[0], ImGuiColorEditFlags_NoInputs)) setColor(color.get());
+    ImGui::SameLine();
+  }
+
+
+  { // Edge options
+    ImGui::SameLine();
+    ImGui::PushItemWidth(100);
+    if (edgeWidth.get() == 0.) {
+      bool showEdges = false;
+      if (ImGui::Checkbox("Edges", &showEdges)) {
+        setEdgeWidth(1.);
+      }
+    } else {
+      bool showEdges = true;
+      if (ImGui::Checkbox("Edges", &showEdges)) {
+        setEdgeWidth(0.);
+      }
+
+      // Edge color
+      ImGui::PushItemWidth(100);
+      if (ImGui::ColorEdit3("Edge Color", &edgeColor.get()[0], ImGuiColorEditFlags_NoInputs))
+        setEdgeColor(edgeColor.get());
+      ImGui::PopItemWidth();
+
+      // Edge width
+      ImGui::SameLine();
+      ImGui::PushItemWidth(75);
+      if (ImGui::SliderFloat("Width", &edgeWidth.get(), 0.001, 2.)) {
+        // NOTE: circumvents the setter, as in VolumeGrid
+        edgeWidth.manuallyChanged();
+        requestRedraw();
+      }
+      ImGui::PopItemWidth();
+    }
+    ImGui::PopItemWidth();
+  }
+}
+
+
+void SparseVolumeGrid::buildCustomOptionsUI() {
+  if (render::buildMaterialOptionsGui(material.get())) {
+    material.manuallyChanged();
+    setMaterial(material.get()); // trigger the other updates that happen on set()
+  }
+
+  // Shrinky effect
+  if (ImGui::SliderFloat("Cell Shrink", &cubeSizeFactor.get(), 0.0, 1., "%.3f", ImGuiSliderFlags_Logarithmic)) {
+    cubeSizeFactor.manuallyChanged();
+    requestRedraw();
+  }
+}
+
+void SparseVolumeGrid::draw() {
+  if (!enabled.get() || nBricks() == 0) return;
+
+  // Right now none of this class supports cullWholeElements = false, so just always force it to true
+  if (!getCullWholeElements()) {
+    setCullWholeElements(true);
+  }
+
+  // If there is no dominant quantity, then this class is responsible for the grid
+  if (dominantQuantity == nullptr) {
+
+    // Ensure we have prepared buffers
+    ensureGridCubeRenderProgramPrepared();
+
+    // Set program uniforms
+    setStructureUniforms(*program);
+    setGridCubeUniforms(*program);
+    program->setUniform("u_baseColor", color.get());
+    render::engine->setMaterialUniforms(*program, material.get());
+
+    // Draw the actual grid
+    render::engine->setBackfaceCull(true);
+    program->draw();
+  }
+
+  // Draw the quantities
+  for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
+    x.second->draw();
+  }
+  for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
+    x.second->draw();
+  }
+}
+
+void SparseVolumeGrid::drawDelayed() {
+  // For now, do nothing for the actual grid
+  if (!enabled.get()) return;
+
+  // Draw the quantities
+  for (auto& x : quantities) {
+    x.second->drawDelayed();
+  }
+  for (auto& x : floatingQuantities) {
+    x.second->drawDelayed();
+  }
+}
+
+void SparseVolumeGrid::drawPick() {
+  if (!isEnabled() || nBricks() == 0) {
+    return;
+  }
+
+  // only draw pick if the grid is actually being draw
+  if (dominantQuantity != nullptr) {
+    SparseVolumeGridQuantity* g = dynamic_cast<SparseVolumeGridQuantity*>(dominantQuantity);
+    if (g && !g->isDrawingGridcubes()) {
+      return;
+    }
+  }
+
+  ensureGridCubePickProgramPrepared();
+
+  // Set program uniforms
+  setStructureUniforms(*pickProgram);
+  setGridCubeUniforms(*pickProgram, false);
+  pickProgram->setUniform("u_pickColor", pickColor);
+
+  // Draw the actual grid
+  render::engine->setBackfaceCull(true);
+  pickProgram->draw();
+}
+
+std::vector<std::string> SparseVolumeGrid::addGridCubeRules(std::vector<std::string> initRules, bool withShade) {
+  initRules = addStructureRules(initRules);
+
+  if (withShade) {
+    if (getEdgeWidth() > 0) {
+      initRules.push_back("GRIDCUBE_WIREFRAME");
+      initRules.push_back("MESH_WIREFRAME");
+    }
+  }
+
+  if (wantsCullPosition()) {
+    initRules.push_back("SPARSE_GRIDCUBE_CULLPOS_FROM_CENTER");
+  }
+
+  return initRules;
+}
+
+void SparseVolumeGrid::setGridCubeUniforms(render::ShaderProgram& p, bool withShade) {
+
+  p.setUniform("u_cubeSizeFactor", 1.f - cubeSizeFactor.get());
+  p.setUniform("u_gridSpacingReference", glm::vec3(1.f / BRICK_SIZE));
+  p.setUniform("u_gridSpacing", gridSpacing);
+  p.setUniform("u_atlasBrickDim", atlasBrickDim);
+
+  if (withShade) {
+
+    if (getEdgeWidth() > 0) {
+      p.setUniform("u_edgeWidth", getEdgeWidth() * render::engine->getCurrentPixelScaling());
+      p.setUniform("u_edgeColor", getEdgeColor());
+    }
+  }
+}
+
+void SparseVolumeGrid::setGridCubeAttributes(render::ShaderProgram& p) {
+  p.setAttribute("a_referencePosition", brickPlaneReferencePositions.getRenderAttributeBuffer());
+  p.setAttribute("a_referenceNormal", brickPlaneReferenceNormals.getRenderAttributeBuffer());
+  p.setAttribute("a_axisInd", brickPlaneAxisInds.getRenderAttributeBuffer());
+  p.setTextureFromBuffer("t_brickOrigin", brickOrigins.getRenderTextureBuffer().get());
+  p.setInstanceCount(static_cast<uint32_t>(nBricks()));
+}
+
+void SparseVolumeGrid::ensureGridCubeRenderProgramPrepared() {
+  // If already prepared, do nothing
+  if (program) return;
+
+  // clang-format off
+  program = render::engine->requestShader( "SPARSE_GRIDCUBE_PLANE",
+      render::engine->addMaterialRules(material.get(),
+        addGridCubeRules(
+          {"SHADE_BASECOLOR"},
+        true)
+      )
+  );
+  // clang-format on
+
+  setGridCubeAttributes(*program);
+
+  render::engine->setMaterial(*program, material.get());
+}
+
+void SparseVolumeGrid::ensureGridCubePickProgramPrepared() {
+
+  // If already prepared, do nothing
+  if (pickProgram) return;
+
+  // clang-format off
+  pickProgram = render::engine->requestShader(
+      "SPARSE_GRIDCUBE_PLANE",
+      addGridCubeRules({"GRIDCUBE_CONSTANT_PICK"}, false),
+      render::ShaderReplacementDefaults::Pick
+  );
+  // clang-format on
+
+  setGridCubeAttributes(*pickProgram);
+
+  if (globalPickConstant == INVALID_IND_64) {
+    // See the note in VolumeGrid: the whole grid gets a single pick index, and the element which was clicked is
+    // computed CPU-side afterwards
+    globalPickConstant = pick::requestPickBufferRange(this, 1);
+    pickColor = pick::indToVec(static_cast<size_t>(globalPickConstant));
+  }
+}
+
+
+void SparseVolumeGrid::updateObjectSpaceBounds() {
+  if (applyObjectSpaceBoundsHint()) return;
+
+  if (nBricks() == 0) {
+    objectSpaceBoundingBox = std::make_tuple(origin, origin);
+    objectSpaceLengthScale = 0.;
+    return;
+  }
+
+  glm::ivec3 brickMin = brickCoords[0];
+  glm::ivec3 brickMax = brickCoords[0];
+  for (const glm::ivec3& b : brickCoords) {
+    brickMin = glm::min(brickMin, b);
+    brickMax = glm::max(brickMax, b);
+  }
+  glm::vec3 boundMin = origin + glm::vec3(brickMin * static_cast<int32_t>(BRICK_SIZE)) * gridSpacing;
+  glm::vec3 boundMax = origin + glm::vec3((brickMax + 1) * static_cast<int32_t>(BRICK_SIZE)) * gridSpacing;
+
+  objectSpaceBoundingBox = std::make_tuple(boundMin, boundMax);
+  objectSpaceLengthScale = glm::length(boundMax - boundMin);
+}
+
+std::string SparseVolumeGrid::typeName() { return structureTypeName; }
+
+void SparseVolumeGrid::refresh() {
+  QuantityStructure<SparseVolumeGrid>::refresh(); // call base class version, which refreshes quantities
+
+  program.reset();
+  pickProgram.reset();
+}
+
+
+void SparseVolumeGrid::computeBrickPlaneReferenceGeometry() {
+
+  // NOTE: as in VolumeGrid, this computes the data for all three buffers at once. The geometry is that of a
+  // BRICK_SIZE^3 grid in the reference [0,1] cube.
+
+  brickPlaneReferencePositions.data.clear();
+  brickPlaneReferenceNormals.data.clear();
+  brickPlaneAxisInds.data.clear();
+
+  auto addPlane = [&](std::array<glm::vec3, 4> corners, glm::vec3 normal, uint32_t axInd) {
+    // first triangle
+    brickPlaneReferencePositions.data.push_back(corners[0]);
+    brickPlaneReferencePositions.data.push_back(corners[1]);
+    brickPlaneReferencePositions.data.push_back(corners[2]);
+    for (int32_t j = 0; j < 3; j++) brickPlaneReferenceNormals.data.push_back(normal);
+    for (int32_t j = 0; j < 3; j++) brickPlaneAxisInds.data.push_back(axInd);
+
+    // second triangle
+    brickPlaneReferencePositions.data.push_back(corners[1]);
+    brickPlaneReferencePositions.data.push_back(corners[3]);
+    brickPlaneReferencePositions.data.push_back(corners[2]);
+    for (int32_t j = 0; j < 3; j++) brickPlaneReferenceNormals.data.push_back(normal);
+    for (int32_t j = 0; j < 3; j++) brickPlaneAxisInds.data.push_back(axInd);
+  };
+
+  for (int32_t side = 0; side < 2; side++) { // forward facing, then backward facing planes
+    for (uint32_t d = 0; d < 3; d++) {       // x/y/z dimension (plane is perpendicular)
+      for (uint32_t iPlane = 0; iPlane < BRICK_SIZE; iPlane++) {
+
+        // outermost planes first, like VolumeGrid
+        int32_t i = side == 0 ? BRICK_SIZE - 1 - iPlane : iPlane;
+        float t = (static_cast<float>(i) + (side == 0 ? 1.f : 0.f)) / BRICK_SIZE;
+
+        // clang-format off
+        glm::vec3 ll{0.f, 0.f, 0.f}; ll[(d+1)%3] = 0.f; ll[(d+2)%3] = 0.f; ll[d] = t;
+        glm::vec3 lu{0.f, 0.f, 0.f}; lu[(d+1)%3] = 1.f; lu[(d+2)%3] = 0.f; lu[d] = t;
+        glm::vec3 ul{0.f, 0.f, 0.f}; ul[(d+1)%3] = 0.f; ul[(d+2)%3] = 1.f; ul[d] = t;
+        glm::vec3 uu{0.f, 0.f, 0.f}; uu[(d+1)%3] = 1.f; uu[(d+2)%3] = 1.f; uu[d] = t;
+
+        glm::vec3 n{0.f, 0.f, 0.f}; n[d] = side == 0 ? 1.f : -1.f;
+        // clang-format on
+
+        if (side == 0) {
+          addPlane({ll, lu, ul, uu}, n, i);
+        } else {
+          addPlane({ul, uu, ll, lu}, n, i); // winding is opposite here
+        }
+      }
+    }
+  }
+
+  brickPlaneReferencePositions.markHostBufferUpdated();
+  brickPlaneReferenceNormals.markHostBufferUpdated();
+  brickPlaneAxisInds.markHostBufferUpdated();
+}
+
+void SparseVolumeGrid::computeBrickOrigins() {
+  std::array<uint32_t, 3> tableSize = brickOrigins.getTextureSize();
+  brickOrigins.data.assign(static_cast<size_t>(tableSize[0]) * tableSize[1], glm::vec3{0.f, 0.f, 0.f});
+  for (size_t iB = 0; iB < nBricks(); iB++) {
+    brickOrigins.data[iB] = positionOfBrickIndex(iB);
+  }
+  brickOrigins.markHostBufferUpdated();
+}
+
+// === Option getters and setters
+
+SparseVolumeGrid* SparseVolumeGrid::setColor(glm::vec3 val) {
+  color = val;
+  requestRedraw();
+  return this;
+}
+glm::vec3 SparseVolumeGrid::getColor() { return color.get(); }
+
+SparseVolumeGrid* SparseVolumeGrid::setEdgeColor(glm::vec3 val) {
+  edgeColor = val;
+  requestRedraw();
+  return this;
+}
+glm::vec3 SparseVolumeGrid::getEdgeColor() { return edgeColor.get(); }
+
+SparseVolumeGrid* SparseVolumeGrid::setMaterial(std::string m) {
+  material = m;
+  refresh();
+  requestRedraw();
+  return this;
+}
+std::string SparseVolumeGrid::getMaterial() { return material.get(); }
+
+SparseVolumeGrid* SparseVolumeGrid::setEdgeWidth(double newVal) {
+  edgeWidth = newVal;
+  refresh();
+  requestRedraw();
+  return this;
+}
+double SparseVolumeGrid::getEdgeWidth() { return edgeWidth.get(); }
+
+
+// === Register functions
+
+
+SparseVolumeGridQuantity::SparseVolumeGridQuantity(std::string name_, SparseVolumeGrid& grid_, bool dominates_)
+    : QuantityS<SparseVolumeGrid>(name_, grid_, dominates_) {}
+
+
+SparseVolumeGridNodeScalarQuantity*
+SparseVolumeGrid::addNodeScalarQuantityImpl(std::string name, std::vector<double> data, DataType dataType_) {
+
+  checkForQuantityWithNameAndDeleteOrError(name);
+  SparseVolumeGridNodeScalarQuantity* q =
+      new SparseVolumeGridNodeScalarQuantity(name, *this, std::move(data), dataType_);
+  addQuantity(q);
+  markNodesAsUsed();
+  return q;
+}
+
+SparseVolumeGridCellScalarQuantity*
+SparseVolumeGrid::addCellScalarQuantityImpl(std::string name, std::vector<double> data, DataType dataType_) {
+
+  checkForQuantityWithNameAndDeleteOrError(name);
+  SparseVolumeGridCellScalarQuantity* q =
+      new SparseVolumeGridCellScalarQuantity(name, *this, std::move(data), dataType_);
+  addQuantity(q);
+  markCellsAsUsed();
+  return q;
+}
+
+void SparseVolumeGrid::markNodesAsUsed() { nodesHaveBeenUsed = true; }
+
+void SparseVolumeGrid::markCellsAsUsed() { cellsHaveBeenUsed = true; }
+
+
+void SparseVolumeGrid::buildPickUI(size_t localPickID) {
+
+  // As with VolumeGrid, which element was clicked is found from the depth of the click
+
+  float nodePickRad = 0.8; // measured in a [-1,1] cube
+
+  ImGuiIO& io = ImGui::GetIO();
+  glm::vec2 screenCoords{io.MousePos.x, io.MousePos.y};
+  glm::mat4 worldToObject = glm::inverse(objectTransform.get());
+  glm::vec3 pickPos = glm::vec3(worldToObject * glm::vec4(view::screenCoordsToWorldPosition(screenCoords), 1.f));
+  glm::vec3 pickDir = glm::vec3(worldToObject * glm::vec4(view::screenCoordsToWorldRay(screenCoords), 0.f));
+
+  // The click is on the surface of a cube, nudge it inside so it is unambiguous which cell it is in
+  pickPos += 1e-3f * minGridSpacing() * glm::normalize(pickDir);
+
+  glm::vec3 coordUnit = (pickPos - origin) / gridSpacing;
+  glm::ivec3 cellCoord{std::floor(coordUnit.x), std::floor(coordUnit.y), std::floor(coordUnit.z)};
+  uint64_t cellInd = cellIndexOf(cellCoord);
+  if (cellInd == INVALID_IND_64) {
+    // can only happen due to imprecision in the depth buffer
+    return;
+  }
+
+  // NOTE: this logic is duplicated with shader
+  glm::vec3 coordMod = coordUnit - glm::vec3(cellCoord);               // [0,1] within the cell
+  glm::vec3 coordLocal = (2.f * coordMod - 1.f) / (1.f - cubeSizeFactor.get()); // [-1,1] within each scaled cell
+  float distFromCorner = glm::length(1.f - abs(coordLocal));
+
+  // logic to only allow picking nodes/cells (e.g. if no cell data is registered, only pick nodes)
+  // if neither has been used, allow picking both
+  bool doPickNodes;
+  if (nodesHaveBeenUsed == cellsHaveBeenUsed) {
+    // both or neither used (choose based on radius)
+    doPickNodes = distFromCorner < nodePickRad;
+  } else if (nodesHaveBeenUsed) {
+    doPickNodes = true;
+  } else /* cellsHaveBeenUsed == true */ {
+    doPickNodes = false;
+  }
+
+  if (doPickNodes) {
+    // Pick the nearest corner of the cell, which always exists
+    glm::ivec3 nodeCoord = cellCoord + glm::ivec3(glm::greaterThan(coordMod, glm::vec3(0.5f)));
+    buildNodeInfoGUI(nodeIndexOf(nodeCoord));
+  } else {
+    buildCellInfoGUI(cellInd);
+  }
+}
+
+
+void SparseVolumeGrid::buildNodeInfoGUI(size_t nInd) {
+
+  ImGui::TextUnformatted(("Node #" + std::to_string(nInd)).c_str());
+  ImGui::TextUnformatted(("Node coord: " + coordString(nodeCoordOfIndex(nInd))).c_str());
+
+  std::stringstream buffer;
+  buffer << positionOfNodeIndex(nInd);
+  ImGui::TextUnformatted(("Position: " + buffer.str()).c_str());
+
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Indent(20.);
+
+  // Build GUI to show the quantities
+  ImGui::Columns(2);
+  ImGui::SetColumnWidth(0, ImGui::GetWindowWidth() / 3);
+  for (auto& x : quantities) {
+    x.second->buildNodeInfoGUI(nInd);
+  }
+
+  ImGui::Indent(-20.);
+}
+
+void SparseVolumeGrid::buildCellInfoGUI(size_t cellInd) {
+
+  ImGui::TextUnformatted(("Cell #" + std::to_string(cellInd)).c_str());
+  ImGui::TextUnformatted(("Cell coord: " + coordString(cellCoordOfIndex(cellInd))).c_str());
+
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Indent(20.);
+
+  // Build GUI to show the quantities
+  ImGui::Columns(2);
+  ImGui::SetColumnWidth(0, ImGui::GetWindowWidth() / 3);
+  for (auto& x : quantities) {
+    x.second->buildCellInfoGUI(cellInd);
+  }
+
+  ImGui::Indent(-20.);
+}
+
+
+// Default implementations
+void SparseVolumeGridQuantity::buildNodeInfoGUI(size_t vInd) {}
+void SparseVolumeGridQuantity::buildCellInfoGUI(size_t vInd) {}
+
+} // namespace polyscope
@@ -0,0 +1,458 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/sparse_volume_grid_scalar_quantity.h"
+
+#define MC_CPP_USE_DOUBLE_PRECISION
+#include "MarchingCube/MC.h"
+
+namespace polyscope {
+
+// ========================================================
+// ==========            Node Scalar             ==========
+// ========================================================
+
+SparseVolumeGridNodeScalarQuantity::SparseVolumeGridNodeScalarQuantity(std::string name, SparseVolumeGrid& grid_,
+                                                                       std::vector<double> values_,
+                                                                       DataType dataType_)
+    : SparseVolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, std::move(values_), dataType_),
+      atlasValues(this, uniquePrefix() + "#atlasValues", atlasValuesData,
+                  std::bind(&SparseVolumeGridNodeScalarQuantity::computeAtlasValues, this)),
+      gridcubeVizEnabled(uniquePrefix() + "gridcubeVizEnabled", true),
+      isosurfaceVizEnabled(uniquePrefix() + "isosurfaceVizEnabled", false),
+      isosurfaceLevel(uniquePrefix() + "isosurfaceLevel", 0.f),
+      isosurfaceColor(uniquePrefix() + "isosurfaceColor", getNextUniqueColor()),
+      slicePlanesAffectIsosurface(uniquePrefix() + "slicePlanesAffectIsosurface", false) {
+
+  glm::uvec3 atlasSize = parent.getNodeAtlasSize();
+  atlasValues.setTextureSize(atlasSize.x, atlasSize.y, atlasSize.z);
+  atlasValues.addComputeDependency(values);
+}
+
+void SparseVolumeGridNodeScalarQuantity::computeAtlasValues() {
+  values.ensureHostBufferPopulated();
+  parent.fillNodeAtlas(values.data, atlasValues.data);
+  atlasValuesSourceVersion = values.getDataVersion();
+  atlasValues.markHostBufferUpdated();
+}
+
+
+void SparseVolumeGridNodeScalarQuantity::buildCustomUI() {
+
+  // Select which viz to use
+  ImGui::SameLine();
+  if (ImGui::Button("Mode")) {
+    ImGui::OpenPopup("ModePopup");
+  }
+  if (ImGui::BeginPopup("ModePopup")) {
+    if (ImGui::MenuItem("Gridcube", NULL, &gridcubeVizEnabled.get())) setGridcubeVizEnabled(getGridcubeVizEnabled());
+    if (ImGui::MenuItem("Isosurface", NULL, &isosurfaceVizEnabled.get()))
+      setIsosurfaceVizEnabled(getIsosurfaceVizEnabled());
+    ImGui::EndPopup();
+  }
+
+
+  // == Options popup
+  ImGui::SameLine();
+  if (ImGui::Button("Options")) {
+    ImGui::OpenPopup("OptionsPopup");
+  }
+  if (ImGui::BeginPopup("OptionsPopup")) {
+    buildScalarOptionsUI();
+
+    if (ImGui::MenuItem("Slice plane affects isosurface", NULL, &slicePlanesAffectIsosurface.get()))
+      setSlicePlanesAffectIsosurface(getSlicePlanesAffectIsosurface());
+
+    if (ImGui::MenuItem("Register isosurface as mesh")) registerIsosurfaceAsMesh();
+
+    ImGui::EndPopup();
+  }
+
+  if (gridcubeVizEnabled.get()) {
+    buildScalarUI();
+  }
+
+  if (isosurfaceVizEnabled.get()) {
+    ImGui::TextUnformatted("Isosurface:");
+    // Color picker
+    if (ImGui::ColorEdit3("##Color", &isosurfaceColor.get()[0], ImGuiColorEditFlags_NoInputs)) {
+      setIsosurfaceColor(getIsosurfaceColor());
+    }
+    ImGui::SameLine();
+
+    // Set isovalue
+    ImGui::PushItemWidth(120);
+    if (ImGui::SliderFloat("##Radius", &isosurfaceLevel.get(), vizRange.first, vizRange.second, "%.4e")) {
+      // Note: we intentionally do this rather than calling setIsosurfaceLevel(), because that function immediately
+      // recomputes the level set mesh, which is too expensive during user interaction
+      isosurfaceLevel.manuallyChanged();
+    }
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (ImGui::Button("Refresh")) {
+      refresh();
+    }
+  }
+}
+
+std::string SparseVolumeGridNodeScalarQuantity::niceName() { return name + " (node scalar)"; }
+
+bool SparseVolumeGridNodeScalarQuantity::isDrawingGridcubes() { return isEnabled() && getGridcubeVizEnabled(); }
+
+void SparseVolumeGridNodeScalarQuantity::refresh() {
+  gridcubeProgram.reset();
+  isosurfaceProgram.reset();
+}
+
+void SparseVolumeGridNodeScalarQuantity::draw() {
+  if (!isEnabled()) return;
+
+  // Draw the point viz
+  if (gridcubeVizEnabled.get()) {
+    if (gridcubeProgram == nullptr) {
+      createGridcubeProgram();
+    }
+
+    // Pick up any updates to the values
+    if (atlasValuesSourceVersion != values.getDataVersion()) {
+      atlasValues.recomputeIfPopulated();
+    }
+
+    // Set program uniforms
+    parent.setStructureUniforms(*gridcubeProgram);
+    parent.setGridCubeUniforms(*gridcubeProgram);
+    setScalarUniforms(*gridcubeProgram);
+    render::engine->setMaterialUniforms(*gridcubeProgram, parent.getMaterial());
+
+    // Draw the actual grid
+    render::engine->setBackfaceCull(true);
+    gridcubeProgram->draw();
+  }
+
+  // Draw the isosurface program
+  if (isosurfaceVizEnabled.get()) {
+    if (isosurfaceProgram == nullptr) {
+      createIsosurfaceProgram();
+    }
+    parent.setStructureUniforms(*isosurfaceProgram);
+    render::engine->setMaterialUniforms(*isosurfaceProgram, parent.getMaterial());
+    isosurfaceProgram->setUniform("u_baseColor", getIsosurfaceColor());
+
+    glm::mat4 P = view::getCameraPerspectiveMatrix();
+    glm::mat4 Pinv = glm::inverse(P);
+    isosurfaceProgram->setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
+    isosurfaceProgram->setUniform("u_viewport", render::engine->getCurrentViewport());
+
+    render::engine->setBackfaceCull(false);
+    isosurfaceProgram->draw();
+  }
+}
+
+void SparseVolumeGridNodeScalarQuantity::createGridcubeProgram() {
+
+  // clang-format off
+  gridcubeProgram = render::engine->requestShader( "SPARSE_GRIDCUBE_PLANE",
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addGridCubeRules(
+          addScalarRules(
+            {"SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE"}
+          ),
+        true)
+      )
+    );
+  // clang-format on
+
+  parent.setGridCubeAttributes(*gridcubeProgram);
+
+  gridcubeProgram->setTextureFromColormap("t_colormap", cMap.get());
+  render::engine->setMaterial(*gridcubeProgram, parent.getMaterial());
+
+  gridcubeProgram->setTextureFromBuffer("t_value", atlasValues.getRenderTextureBuffer().get());
+  atlasValues.getRenderTextureBuffer().get()->setFilterMode(FilterMode::Linear);
+}
+
+void SparseVolumeGridNodeScalarQuantity::extractIsosurface(std::vector<glm::vec3>& vertices,
+                                                           std::vector<uint32_t>& indices) {
+
+  values.ensureHostBufferPopulated();
+  const std::vector<double>& nodeValues = values.data;
+  const std::vector<uint32_t>& brickNodeInds = parent.getBrickNodeIndices();
+  const uint32_t T = SparseVolumeGrid::BRICK_SIZE + 1;
+  const double isoLevel = isosurfaceLevel.get();
+
+  // Bricks are extracted independently (so vertices on the boundary between two bricks are duplicated), in parallel
+  // ranges which each accumulate their own mesh
+  std::vector<std::tuple<size_t, size_t>> ranges = parallelRanges(parent.nBricks(), 64);
+  std::vector<MC::mcMesh> rangeMeshes(ranges.size());
+
+  auto extractRange = [&](size_t iRange) {
+    MC::mcMesh& mesh = rangeMeshes[iRange];
+    std::vector<double> brickValues(T * T * T);
+
+    for (size_t iBrick = std::get<0>(ranges[iRange]); iBrick < std::get<1>(ranges[iRange]); iBrick++) {
+
+      // Gather the brick's nodes, in the same order that marching_cube() expects
+      const uint32_t* brickNodes = &brickNodeInds[iBrick * T * T * T];
+      double minVal = std::numeric_limits<double>::infinity();
+      double maxVal = -std::numeric_limits<double>::infinity();
+      for (uint32_t i = 0; i < T * T * T; i++) {
+        brickValues[i] = nodeValues[brickNodes[i]];
+        minVal = std::fmin(minVal, brickValues[i]);
+        maxVal = std::fmax(maxVal, brickValues[i]);
+      }
+
+      // Skip bricks which the level set does not pass through
+      if (!(minVal <= isoLevel && isoLevel <= maxVal)) continue;
+
+      // marching_cube() appends to the mesh, so only the new vertices need to be moved in to place
+      size_t vertStart = mesh.vertices.size();
+      MC::marching_cube(&brickValues.front(), isoLevel, T, T, T, mesh);
+      glm::vec3 brickOrigin = parent.positionOfBrickIndex(iBrick);
+      for (size_t iV = vertStart; iV < mesh.vertices.size(); iV++) {
+        mesh.vertices[iV] = mesh.vertices[iV] * parent.getGridSpacing() + brickOrigin;
+      }
+    }
+  };
+  parallelInvoke(ranges.size(), extractRange);
+
+  // Concatenate the meshes from each range
+  vertices.clear();
+  indices.clear();
+  for (MC::mcMesh& mesh : rangeMeshes) {
+    uint32_t indexOffset = static_cast<uint32_t>(vertices.size());
+    vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+    for (uint32_t ind : mesh.indices) {
+      indices.push_back(ind + indexOffset);
+    }
+  }
+}
+
+void SparseVolumeGridNodeScalarQuantity::createIsosurfaceProgram() {
+
+  // Extract the isosurface from the level set of the scalar field
+  std::vector<glm::vec3> isoVertices;
+  std::vector<uint32_t> isoIndices;
+  extractIsosurface(isoVertices, isoIndices);
+
+  std::vector<std::string> isoProgramRules{"SHADE_BASECOLOR", "PROJ_AND_INV_PROJ_MAT",
+                                           "COMPUTE_SHADE_NORMAL_FROM_POSITION"};
+  if (getSlicePlanesAffectIsosurface() && render::engine->slicePlanesEnabled()) {
+    isoProgramRules.push_back("GENERATE_VIEW_POS");
+    isoProgramRules.push_back("CULL_POS_FROM_VIEW");
+  }
+
+  // Create a render program to draw it
+  // clang-format off
+  isosurfaceProgram = render::engine->requestShader("SIMPLE_MESH",
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addStructureRules(
+          isoProgramRules
+        )
+      ),
+    getSlicePlanesAffectIsosurface() ?
+     render::ShaderReplacementDefaults::SceneObject :
+     render::ShaderReplacementDefaults::SceneObjectNoSlice
+    );
+  // clang-format on
+
+  // Populate the program buffers with the extracted mesh
+  isosurfaceProgram->setAttribute("a_vertexPositions", isoVertices);
+  std::shared_ptr<render::AttributeBuffer> indexBuff = render::engine->generateAttributeBuffer(RenderDataType::UInt);
+  indexBuff->setData(isoIndices);
+  isosurfaceProgram->setIndex(indexBuff);
+
+
+  render::engine->setMaterial(*isosurfaceProgram, parent.getMaterial());
+}
+
+SurfaceMesh* SparseVolumeGridNodeScalarQuantity::registerIsosurfaceAsMesh(std::string structureName) {
+
+  // set the name to default
+  if (structureName == "") {
+    structureName = parent.name + " - " + name + " - isosurface";
+  }
+
+  // extract the mesh
+  std::vector<glm::vec3> isoVertices;
+  std::vector<uint32_t> isoIndices;
+  extractIsosurface(isoVertices, isoIndices);
+
+  return registerSurfaceMesh(structureName, isoVertices,
+                             std::make_tuple(isoIndices.data(), isoIndices.size() / 3, 3));
+}
+
+void SparseVolumeGridNodeScalarQuantity::buildNodeInfoGUI(size_t ind) {
+  ImGui::TextUnformatted(name.c_str());
+  ImGui::NextColumn();
+  ImGui::Text("%g", values.getValue(ind));
+  ImGui::NextColumn();
+}
+
+// === Getters and setters
+
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGridNodeScalarQuantity::setGridcubeVizEnabled(bool val) {
+  gridcubeVizEnabled = val;
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+  return this;
+}
+bool SparseVolumeGridNodeScalarQuantity::getGridcubeVizEnabled() { return gridcubeVizEnabled.get(); }
+
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGridNodeScalarQuantity::setIsosurfaceVizEnabled(bool val) {
+  isosurfaceVizEnabled = val;
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+  return this;
+}
+bool SparseVolumeGridNodeScalarQuantity::getIsosurfaceVizEnabled() { return isosurfaceVizEnabled.get(); }
+
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGridNodeScalarQuantity::setIsosurfaceLevel(float val) {
+  isosurfaceLevel = val;
+  isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+  return this;
+}
+float SparseVolumeGridNodeScalarQuantity::getIsosurfaceLevel() { return isosurfaceLevel.get(); }
+
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGridNodeScalarQuantity::setIsosurfaceColor(glm::vec3 val) {
+  isosurfaceColor = val;
+  requestRedraw();
+  return this;
+}
+glm::vec3 SparseVolumeGridNodeScalarQuantity::getIsosurfaceColor() { return isosurfaceColor.get(); }
+
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGridNodeScalarQuantity::setSlicePlanesAffectIsosurface(bool val) {
+  slicePlanesAffectIsosurface = val;
+  isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+  return this;
+}
+bool SparseVolumeGridNodeScalarQuantity::getSlicePlanesAffectIsosurface() { return slicePlanesAffectIsosurface.get(); }
+
+// ========================================================
+// ==========            Cell Scalar             ==========
+// ========================================================
+
+SparseVolumeGridCellScalarQuantity::SparseVolumeGridCellScalarQuantity(std::string name, SparseVolumeGrid& grid_,
+                                                                       std::vector<double> values_,
+                                                                       DataType dataType_)
+    : SparseVolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, std::move(values_), dataType_),
+      atlasValues(this, uniquePrefix() + "#atlasValues", atlasValuesData,
+                  std::bind(&SparseVolumeGridCellScalarQuantity::computeAtlasValues, this)),
+      gridcubeVizEnabled(uniquePrefix() + "gridcubeVizEnabled", true) {
+
+  glm::uvec3 atlasSize = parent.getCellAtlasSize();
+  atlasValues.setTextureSize(atlasSize.x, atlasSize.y, atlasSize.z);
+  atlasValues.addComputeDependency(values);
+}
+
+void SparseVolumeGridCellScalarQuantity::computeAtlasValues() {
+  values.ensureHostBufferPopulated();
+  parent.fillCellAtlas(values.data, atlasValues.data);
+  atlasValuesSourceVersion = values.getDataVersion();
+  atlasValues.markHostBufferUpdated();
+}
+
+
+void SparseVolumeGridCellScalarQuantity::buildCustomUI() {
+
+  // Select which viz to use
+  ImGui::SameLine();
+  if (ImGui::Button("Mode")) {
+    ImGui::OpenPopup("ModePopup");
+  }
+  if (ImGui::BeginPopup("ModePopup")) {
+    if (ImGui::MenuItem("Gridcube", NULL, &gridcubeVizEnabled.get())) setGridcubeVizEnabled(getGridcubeVizEnabled());
+    ImGui::EndPopup();
+  }
+
+
+  // == Options popup
+  ImGui::SameLine();
+  if (ImGui::Button("Options")) {
+    ImGui::OpenPopup("OptionsPopup");
+  }
+  if (ImGui::BeginPopup("OptionsPopup")) {
+    buildScalarOptionsUI();
+    ImGui::EndPopup();
+  }
+
+  if (gridcubeVizEnabled.get()) {
+    buildScalarUI();
+  }
+}
+
+std::string SparseVolumeGridCellScalarQuantity::niceName() { return name + " (cell scalar)"; }
+
+bool SparseVolumeGridCellScalarQuantity::isDrawingGridcubes() { return isEnabled() && getGridcubeVizEnabled(); }
+
+void SparseVolumeGridCellScalarQuantity::refresh() { gridcubeProgram.reset(); }
+
+void SparseVolumeGridCellScalarQuantity::draw() {
+  if (!isEnabled()) return;
+
+  // Draw the point viz
+  if (gridcubeVizEnabled.get()) {
+    if (gridcubeProgram == nullptr) {
+      createGridcubeProgram();
+    }
+
+    // Pick up any updates to the values
+    if (atlasValuesSourceVersion != values.getDataVersion()) {
+      atlasValues.recomputeIfPopulated();
+    }
+
+    // Set program uniforms
+    parent.setStructureUniforms(*gridcubeProgram);
+    parent.setGridCubeUniforms(*gridcubeProgram);
+    setScalarUniforms(*gridcubeProgram);
+    render::engine->setMaterialUniforms(*gridcubeProgram, parent.getMaterial());
+
+    // Draw the actual grid
+    render::engine->setBackfaceCull(true);
+    gridcubeProgram->draw();
+  }
+}
+
+void SparseVolumeGridCellScalarQuantity::createGridcubeProgram() {
+
+  // clang-format off
+  gridcubeProgram = render::engine->requestShader("SPARSE_GRIDCUBE_PLANE",
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addGridCubeRules(
+          addScalarRules(
+            {"SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE"}
+          ),
+        true)
+      )
+  );
+  // clang-format on
+
+  parent.setGridCubeAttributes(*gridcubeProgram);
+
+  gridcubeProgram->setTextureFromColormap("t_colormap", cMap.get());
+  render::engine->setMaterial(*gridcubeProgram, parent.getMaterial());
+
+  gridcubeProgram->setTextureFromBuffer("t_value", atlasValues.getRenderTextureBuffer().get());
+}
+
+void SparseVolumeGridCellScalarQuantity::buildCellInfoGUI(size_t ind) {
+  ImGui::TextUnformatted(name.c_str());
+  ImGui::NextColumn();
+  ImGui::Text("%g", values.getValue(ind));
+  ImGui::NextColumn();
+}
+
+// === Getters and setters
+
+SparseVolumeGridCellScalarQuantity* SparseVolumeGridCellScalarQuantity::setGridcubeVizEnabled(bool val) {
+  gridcubeVizEnabled = val;
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+  return this;
+}
+bool SparseVolumeGridCellScalarQuantity::getGridcubeVizEnabled() { return gridcubeVizEnabled.get(); }
+
+
+} // namespace polyscope
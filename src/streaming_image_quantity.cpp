@@ -0,0 +1,299 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+
+#include "polyscope/polyscope.h"
+
+#include "polyscope/streaming_image_quantity.h"
+
+#include "polyscope/parallel.h"
+#include "polyscope/render/engine.h"
+
+#include "imgui.h"
+
+#include <cmath>
+#include <limits>
+
+namespace polyscope {
+
+// =============================================
+// ============ Streaming base
+// =============================================
+
+StreamingImage::StreamingImage(size_t dimX, size_t dimY, size_t nChannels)
+    : stream(std::make_shared<ImageStream>(dimX, dimY, nChannels)) {}
+
+StreamingImage::~StreamingImage() {}
+
+std::shared_ptr<ImageStream> StreamingImage::getStream() { return stream; }
+
+void StreamingImage::pushFrame(ImageStreamFormat format, const void* data) { stream->pushFrame(format, data); }
+
+void StreamingImage::pushSubRect(ImageStreamFormat format, size_t x0, size_t y0, size_t width, size_t height,
+                                         const void* data) {
+  stream->pushSubRect(format, x0, y0, width, height, data);
+}
+
+bool StreamingImage::updateFromStream() {
+  if (!stream->acquireLatest()) return false;
+
+  ImageStreamRect changed = stream->currentChangedRect();
+  for (ImageStreamRect& stale : textureRingStaleRects) {
+    stale.expand(changed);
+  }
+
+  // Upload in to the next texture of the ring, bringing it up to date with everything it missed
+  if (textureRing[0]) {
+    currTextureInd = (currTextureInd + 1) % TEXTURE_RING_SIZE;
+    ImageStreamRect& stale = textureRingStaleRects[currTextureInd];
+    if (!stale.isEmpty()) {
+      size_t dimX = stream->getDimX();
+      const float* pixels = &stream->currentPixels()[(stale.y0 * dimX + stale.x0) * stream->getNChannels()];
+      textureRing[currTextureInd]->setSubData2D(stale.x0, stale.y0, stale.width(), stale.height(), pixels, dimX);
+    }
+    stale = ImageStreamRect();
+  }
+
+  // (no redraw request needed, publishing the frame already made one)
+  frameAcquired(changed);
+  return true;
+}
+
+void StreamingImage::ensureTextureRing() {
+  if (textureRing[0]) return;
+
+  // All textures start out holding the current frame
+  const float* pixels = &stream->currentPixels().front();
+  for (size_t i = 0; i < TEXTURE_RING_SIZE; i++) {
+    textureRing[i] =
+        render::engine->generateTextureBuffer(streamTextureFormat(), stream->getDimX(), stream->getDimY(), pixels);
+    textureRingStaleRects[i] = ImageStreamRect();
+  }
+  currTextureInd = 0;
+}
+
+render::TextureBuffer& StreamingImage::currentTexture() {
+  ensureTextureRing();
+  return *textureRing[currTextureInd];
+}
+
+void StreamingImage::frameAcquired(const ImageStreamRect& changedRect) {
+  // nothing by default, subclasses override
+}
+
+void StreamingImage::buildStreamUI() {
+  ImGui::Text("Frames: %llu received, %llu dropped", static_cast<unsigned long long>(stream->getPushedFrameCount()),
+              static_cast<unsigned long long>(stream->getDroppedFrameCount()));
+}
+
+// =============================================
+// ============ Scalar
+// =============================================
+
+StreamingScalarImageQuantity::StreamingScalarImageQuantity(Structure& parent_, std::string name, size_t dimX,
+                                                           size_t dimY, ImageOrigin imageOrigin_, DataType dataType_)
+    : ScalarImageQuantity(parent_, name, dimX, dimY, std::vector<double>(), imageOrigin_, dataType_),
+      StreamingImage(dimX, dimY, 1), autoRange(uniquePrefix() + "autoRange", true),
+      autoRangeRate(uniquePrefix() + "autoRangeRate", 1.f),
+      nRangeTilesX((dimX + RANGE_TILE_SIZE - 1) / RANGE_TILE_SIZE),
+      nRangeTilesY((dimY + RANGE_TILE_SIZE - 1) / RANGE_TILE_SIZE),
+      rangeTiles(nRangeTilesX * nRangeTilesY, std::make_pair(0.f, 0.f)), frameRange(0., 0.) {}
+
+void StreamingScalarImageQuantity::draw() {
+  if (!isEnabled()) return;
+  updateFromStream();
+  ScalarImageQuantity::draw();
+}
+
+void StreamingScalarImageQuantity::buildCustomUI() {
+  ImGui::SameLine();
+
+  // == Options popup
+  if (ImGui::Button("Options")) {
+    ImGui::OpenPopup("OptionsPopup");
+  }
+  if (ImGui::BeginPopup("OptionsPopup")) {
+
+    buildScalarOptionsUI();
+    if (ImGui::MenuItem("Auto range", NULL, getAutoRange())) setAutoRange(!getAutoRange());
+    buildImageOptionsUI();
+
+    ImGui::EndPopup();
+  }
+
+  buildScalarUI();
+  buildStreamUI();
+  buildImageUI();
+}
+
+render::TextureBuffer& StreamingScalarImageQuantity::imageTexture() { return currentTexture(); }
+
+TextureFormat StreamingScalarImageQuantity::streamTextureFormat() { return TextureFormat::R32F; }
+
+void StreamingScalarImageQuantity::frameAcquired(const ImageStreamRect& changedRect) {
+
+  updateRangeTiles(changedRect);
+
+  bool anyFinite = frameRange.first <= frameRange.second;
+  dataRange = robustMinMax(frameRange.first, frameRange.second, anyFinite, 1e-5);
+
+  if (getAutoRange()) {
+    // move the map range towards the new frame's range (this frame is being drawn, so no redraw is needed)
+    std::pair<float, float> oldVizRange = vizRange;
+    vizRange = fullMapRange();
+    if (haveAcquiredFrame) {
+      float rate = glm::clamp(getAutoRangeRate(), 0.f, 1.f);
+      vizRange.first = oldVizRange.first + rate * (vizRange.first - oldVizRange.first);
+      vizRange.second = oldVizRange.second + rate * (vizRange.second - oldVizRange.second);
+    }
+  }
+
+  if (!haveAcquiredFrame || framesSinceHistogram + 1 >= HISTOGRAM_FRAME_PERIOD) {
+    rebuildHistogram();
+  } else {
+    framesSinceHistogram++;
+  }
+
+  haveAcquiredFrame = true;
+}
+
+void StreamingScalarImageQuantity::updateRangeTiles(const ImageStreamRect& changedRect) {
+
+  const std::vector<float>& pixels = stream->currentPixels();
+
+  // Rescan the tiles which overlap the changed region
+  if (!changedRect.isEmpty()) {
+    size_t tx0 = changedRect.x0 / RANGE_TILE_SIZE;
+    size_t ty0 = changedRect.y0 / RANGE_TILE_SIZE;
+    size_t tx1 = (changedRect.x1 - 1) / RANGE_TILE_SIZE + 1;
+    size_t ty1 = (changedRect.y1 - 1) / RANGE_TILE_SIZE + 1;
+    size_t nTilesWide = tx1 - tx0;
+
+    parallelForRanges(
+        nTilesWide * (ty1 - ty0),
+        [&](size_t iStart, size_t iEnd) {
+          for (size_t i = iStart; i < iEnd; i++) {
+            size_t tx = tx0 + i % nTilesWide;
+            size_t ty = ty0 + i / nTilesWide;
+            float minVal = std::numeric_limits<float>::infinity();
+            float maxVal = -std::numeric_limits<float>::infinity();
+            size_t yEnd = std::min((ty + 1) * RANGE_TILE_SIZE, dimY);
+            size_t xEnd = std::min((tx + 1) * RANGE_TILE_SIZE, dimX);
+            for (size_t y = ty * RANGE_TILE_SIZE; y < yEnd; y++) {
+              for (size_t x = tx * RANGE_TILE_SIZE; x < xEnd; x++) {
+                float v = pixels[y * dimX + x];
+                if (!std::isfinite(v)) continue;
+                minVal = std::min(minVal, v);
+                maxVal = std::max(maxVal, v);
+              }
+            }
+            rangeTiles[ty * nRangeTilesX + tx] = std::make_pair(minVal, maxVal);
+          }
+        },
+        4);
+  }
+
+  // Merge all tiles
+  float minVal = std::numeric_limits<float>::infinity();
+  float maxVal = -std::numeric_limits<float>::infinity();
+  for (const std::pair<float, float>& t : rangeTiles) {
+    minVal = std::min(minVal, t.first);
+    maxVal = std::max(maxVal, t.second);
+  }
+  frameRange = std::make_pair(minVal, maxVal);
+}
+
+void StreamingScalarImageQuantity::rebuildHistogram() {
+  const std::vector<float>& pixels = stream->currentPixels();
+  size_t stride = std::max(pixels.size() / HISTOGRAM_MAX_SAMPLES, static_cast<size_t>(1));
+  std::vector<double> samples;
+  samples.reserve(pixels.size() / stride + 1);
+  for (size_t i = 0; i < pixels.size(); i += stride) {
+    samples.push_back(pixels[i]);
+  }
+  hist.buildHistogram(samples);
+  framesSinceHistogram = 0;
+}
+
+std::pair<double, double> StreamingScalarImageQuantity::getFrameRange() { return frameRange; }
+
+StreamingScalarImageQuantity* StreamingScalarImageQuantity::setAutoRange(bool newVal) {
+  autoRange = newVal;
+  if (newVal) resetMapRange();
+  requestRedraw();
+  return this;
+}
+bool StreamingScalarImageQuantity::getAutoRange() { return autoRange.get(); }
+
+StreamingScalarImageQuantity* StreamingScalarImageQuantity::setAutoRangeRate(float newVal) {
+  autoRangeRate = newVal;
+  requestRedraw();
+  return this;
+}
+float StreamingScalarImageQuantity::getAutoRangeRate() { return autoRangeRate.get(); }
+
+std::string StreamingScalarImageQuantity::niceName() { return name + " (streaming scalar image)"; }
+
+StreamingScalarImageQuantity* StreamingScalarImageQuantity::setEnabled(bool newEnabled) {
+  ScalarImageQuantity::setEnabled(newEnabled);
+  return this;
+}
+
+// =============================================
+// ============ Color
+// =============================================
+
+StreamingColorImageQuantity::StreamingColorImageQuantity(Structure& parent_, std::string name, size_t dimX,
+                                                         size_t dimY, ImageOrigin imageOrigin_)
+    : ColorImageQuantity(parent_, name, dimX, dimY, std::vector<glm::vec4>(), imageOrigin_),
+      StreamingImage(dimX, dimY, 4) {}
+
+void StreamingColorImageQuantity::draw() {
+  if (!isEnabled()) return;
+  updateFromStream();
+  ColorImageQuantity::draw();
+}
+
+void StreamingColorImageQuantity::buildCustomUI() {
+  ImGui::SameLine();
+
+  // == Options popup
+  if (ImGui::Button("Options")) {
+    ImGui::OpenPopup("OptionsPopup");
+  }
+  if (ImGui::BeginPopup("OptionsPopup")) {
+
+    buildImageOptionsUI();
+
+    ImGui::EndPopup();
+  }
+
+  buildStreamUI();
+  buildImageUI();
+}
+
+TextureFormat StreamingColorImageQuantity::streamTextureFormat() { return TextureFormat::RGBA32F; }
+
+std::string StreamingColorImageQuantity::niceName() { return name + " (streaming color image)"; }
+
+render::TextureBuffer& StreamingColorImageQuantity::imageTexture() { return currentTexture(); }
+
+StreamingColorImageQuantity* StreamingColorImageQuantity::setEnabled(bool newEnabled) {
+  ColorImageQuantity::setEnabled(newEnabled);
+  return this;
+}
+
+
+// Instantiate a construction helper which is used to avoid header dependencies. See forward declaration and note in
+// structure.ipp.
+StreamingScalarImageQuantity* createStreamingScalarImageQuantity(Structure& parent, std::string name, size_t dimX,
+                                                                 size_t dimY, ImageOrigin imageOrigin,
+                                                                 DataType dataType) {
+  return new StreamingScalarImageQuantity(parent, name, dimX, dimY, imageOrigin, dataType);
+}
+
+StreamingColorImageQuantity* createStreamingColorImageQuantity(Structure& parent, std::string name, size_t dimX,
+                                                               size_t dimY, ImageOrigin imageOrigin) {
+  return new StreamingColorImageQuantity(parent, name, dimX, dimY, imageOrigin);
+}
+
+} // namespace polyscope
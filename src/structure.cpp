@@ -2,10 +2,14 @@
 
 #include "polyscope/structure.h"
 
+#include "polyscope/parallel.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/viewport.h"
 
 #include "imgui.h"
 
+#include <cmath>
+
 namespace polyscope {
 
 Structure::Structure(std::string name_, std::string subtypeName)
@@ -26,10 +30,25 @@ Structure::~Structure(){};
 Structure* Structure::setEnabled(bool newEnabled) {
   if (newEnabled == isEnabled()) return this;
   enabled = newEnabled;
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return this;
 };
 
+bool Structure::hasVisualImpact() {
+  if (!isEnabled()) return false;
+
+  // With viewports, it must be shown in at least one of them
+  if (!state::viewports.empty()) {
+    for (std::unique_ptr<Viewport>& vp : state::viewports) {
+      if (vp->isStructureVisible(this)) return true;
+    }
+    return false;
+  }
+
+  return true;
+}
+
 bool Structure::isEnabled() { return enabled.get(); };
 
 void Structure::enableIsolate() {
@@ -45,6 +64,8 @@ void Structure::setEnabledAllOfType(bool newEnabled) {
   }
 }
 
+void Structure::gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes) {}
+
 void Structure::buildUI() {
   ImGui::PushID(name.c_str()); // ensure there are no conflicts with
                                // identically-named labels
@@ -154,6 +175,7 @@ void Structure::buildCustomOptionsUI() {}
 
 void Structure::refresh() {
   updateObjectSpaceBounds();
+  internal::sceneGeometryVersion++;
   requestRedraw();
 }
 
@@ -175,19 +197,19 @@ float Structure::lengthScale() {
 
 void Structure::setTransform(glm::mat4x4 transform) {
   objectTransform = transform;
-  updateStructureExtents();
+  updateStructureExtents(this);
 }
 
 void Structure::setPosition(glm::vec3 vec) {
   objectTransform.get()[3][0] = vec.x;
   objectTransform.get()[3][1] = vec.y;
   objectTransform.get()[3][2] = vec.z;
-  updateStructureExtents();
+  updateStructureExtents(this);
 }
 
 void Structure::translate(glm::vec3 vec) {
   objectTransform = glm::translate(objectTransform.get(), vec);
-  updateStructureExtents();
+  updateStructureExtents(this);
 }
 
 glm::mat4x4 Structure::getTransform() { return objectTransform.get(); }
@@ -198,7 +220,7 @@ glm::vec3 Structure::getPosition() {
 
 void Structure::resetTransform() {
   objectTransform = glm::mat4(1.0);
-  updateStructureExtents();
+  updateStructureExtents(this);
 }
 
 void Structure::centerBoundingBox() {
@@ -206,7 +228,7 @@ void Structure::centerBoundingBox() {
   glm::vec3 center = (std::get<1>(bbox) + std::get<0>(bbox)) / 2.0f;
   glm::mat4x4 newTrans = glm::translate(glm::mat4x4(1.0), -glm::vec3(center.x, center.y, center.z));
   objectTransform = newTrans * objectTransform.get();
-  updateStructureExtents();
+  updateStructureExtents(this);
 }
 
 void Structure::rescaleToUnit() {
@@ -214,11 +236,72 @@ void Structure::rescaleToUnit() {
   float s = static_cast<float>(1.0 / currScale);
   glm::mat4x4 newTrans = glm::scale(glm::mat4x4(1.0), glm::vec3{s, s, s});
   objectTransform = newTrans * objectTransform.get();
-  updateStructureExtents();
+  updateStructureExtents(this);
 }
 
 bool Structure::hasExtents() { return true; }
 
+Structure* Structure::setObjectSpaceBoundsHint(glm::vec3 bboxMin, glm::vec3 bboxMax) {
+  haveObjectSpaceBoundsHint = true;
+  objectSpaceBoundsHint = std::make_tuple(bboxMin, bboxMax);
+  updateObjectSpaceBounds();
+  updateStructureExtents(this);
+  return this;
+}
+
+void Structure::clearObjectSpaceBoundsHint() {
+  if (!haveObjectSpaceBoundsHint) return;
+  haveObjectSpaceBoundsHint = false;
+  updateObjectSpaceBounds();
+  updateStructureExtents(this);
+}
+
+bool Structure::hasObjectSpaceBoundsHint() { return haveObjectSpaceBoundsHint; }
+
+bool Structure::applyObjectSpaceBoundsHint() {
+  if (!haveObjectSpaceBoundsHint) return false;
+
+  objectSpaceBoundingBox = objectSpaceBoundsHint;
+  objectSpaceLengthScale = glm::length(std::get<1>(objectSpaceBoundsHint) - std::get<0>(objectSpaceBoundsHint));
+  return true;
+}
+
+void Structure::computeObjectSpaceBoundsFromPoints(const std::vector<glm::vec3>& points) {
+
+  // bounding box
+  typedef std::tuple<glm::vec3, glm::vec3> Bbox;
+  glm::vec3 inf = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
+  Bbox bbox = parallelReduce<Bbox>(
+      points.size(), Bbox{inf, -inf},
+      [&](size_t iStart, size_t iEnd) {
+        glm::vec3 min = inf;
+        glm::vec3 max = -inf;
+        for (size_t i = iStart; i < iEnd; i++) {
+          min = componentwiseMin(min, points[i]);
+          max = componentwiseMax(max, points[i]);
+        }
+        return Bbox{min, max};
+      },
+      [](const Bbox& a, const Bbox& b) {
+        return Bbox{componentwiseMin(std::get<0>(a), std::get<0>(b)), componentwiseMax(std::get<1>(a), std::get<1>(b))};
+      });
+  objectSpaceBoundingBox = bbox;
+
+  // length scale, as twice the radius from the center of the bounding box
+  glm::vec3 center = 0.5f * (std::get<0>(bbox) + std::get<1>(bbox));
+  float lengthScale = parallelReduce<float>(
+      points.size(), 0.f,
+      [&](size_t iStart, size_t iEnd) {
+        float maxDist2 = 0.;
+        for (size_t i = iStart; i < iEnd; i++) {
+          maxDist2 = std::max(maxDist2, glm::length2(points[i] - center));
+        }
+        return maxDist2;
+      },
+      [](const float& a, const float& b) { return std::max(a, b); });
+  objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+}
+
 glm::mat4 Structure::getModelView() { return view::getCameraViewMatrix() * objectTransform.get(); }
 
 std::vector<std::string> Structure::addStructureRules(std::vector<std::string> initRules) {
@@ -336,4 +419,24 @@ bool Structure::getIgnoreSlicePlane(std::string name) {
   return ignoreThisPlane;
 }
 
+void Structure::prepareRayCast() {}
+
+void Structure::updateSelectionQuantities(const SelectionSet& selection) {} // nothing to show by default
+
+bool Structure::rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) {
+  return false; // not supported, nothing is ever hit
+}
+
+bool Structure::isCulledBySlicePlanes(glm::vec3 worldPos) {
+  for (std::unique_ptr<SlicePlane>& s : state::slicePlanes) {
+    if (getIgnoreSlicePlane(s->name)) continue;
+    if (s->cullsPoint(worldPos)) return true;
+  }
+  return false;
+}
+
+float Structure::objectTransformScale() {
+  return std::cbrt(std::abs(glm::determinant(glm::mat3(objectTransform.get()))));
+}
+
 } // namespace polyscope
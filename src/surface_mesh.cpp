@@ -4,14 +4,18 @@
 
 #include "glm/fwd.hpp"
 #include "polyscope/combining_hash_functions.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "imgui.h"
 #include "polyscope/types.h"
 #include "polyscope/utilities.h"
 
+#include <array>
+#include <limits>
 #include <unordered_map>
 #include <utility>
 
@@ -63,7 +67,23 @@ backFaceColor(          uniquePrefix() + "backFaceColor",   glm::vec3(1.f - surf
 shadeStyle(             uniquePrefix() + "shadeStyle",      MeshShadeStyle::Flat)
 
 // clang-format on
-{}
+{
+  // the buffers which each compute function reads
+  triangleAllEdgeInds.addComputeDependency(triangleVertexInds);
+  faceNormals.addComputeDependency(vertexPositions);
+  faceCenters.addComputeDependency(vertexPositions);
+  faceAreas.addComputeDependency(vertexPositions);
+  vertexNormals.addComputeDependency(faceNormals);
+  vertexNormals.addComputeDependency(faceAreas);
+  vertexAreas.addComputeDependency(faceAreas);
+  defaultFaceTangentBasisX.addComputeDependency(vertexPositions);
+  defaultFaceTangentBasisX.addComputeDependency(faceNormals);
+  defaultFaceTangentBasisY.addComputeDependency(vertexPositions);
+  defaultFaceTangentBasisY.addComputeDependency(faceNormals);
+
+  // staged positions need the same follow-up as updateVertexPositions()
+  vertexPositions.stagedDataFunc = std::bind(&SurfaceMesh::recomputeGeometryIfPopulated, this);
+}
 
 SurfaceMesh::SurfaceMesh(std::string name_, const std::vector<glm::vec3>& vertexPositions_,
                          const std::vector<uint32_t>& faceIndsEntries_, const std::vector<uint32_t>& faceIndsStart_)
@@ -691,6 +711,17 @@ void SurfaceMesh::ensureHaveManifoldConnectivity() {
   }
 }
 
+void SurfaceMesh::gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes) {
+  // the geometry buffers used by setMeshGeometryAttributes()
+  faceNormals.gatherPendingCompute(computes);
+  if (getShadeStyle() == MeshShadeStyle::Smooth) {
+    vertexNormals.gatherPendingCompute(computes);
+  }
+  if (wantsCullPosition()) {
+    faceCenters.gatherPendingCompute(computes);
+  }
+}
+
 void SurfaceMesh::draw() {
   if (!isEnabled()) {
     return;
@@ -720,12 +751,14 @@ void SurfaceMesh::draw() {
 
   // Draw the quantities
   for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 
   render::engine->setBackfaceCull(); // return to default setting
 
   for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 }
@@ -828,157 +861,241 @@ void SurfaceMesh::setMeshGeometryAttributes(render::ShaderProgram& p) {
   }
 }
 
-void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
-
-  // TODO in principle all of the data this shader needs is already available on the GPU via the [...]Inds attribute
-  // buffers. We could move the encoding / offsetting logic to happen in a shader with some uniforms, and avoid any
-  // CPU-side processing. Maybe the solution is to directly render ints?
-
-  // make sure we have the relevant indexing data
-  bool simplePick = !(edgesHaveBeenUsed || halfedgesHaveBeenUsed || cornersHaveBeenUsed);
-  triangleVertexInds.ensureHostBufferPopulated();
-  triangleFaceInds.ensureHostBufferPopulated();
-  if (edgesHaveBeenUsed) triangleAllEdgeInds.ensureHostBufferPopulated();
-  if (halfedgesHaveBeenUsed) triangleAllHalfedgeInds.ensureHostBufferPopulated();
-  if (cornersHaveBeenUsed) triangleCornerInds.ensureHostBufferPopulated();
+size_t SurfaceMesh::computePickIndStarts() {
 
   // nEdges() requires computing number of edges, which is expensive and might not even be implemented for polygonal
   // meshes. This way we only call it if actually needed, and use 0 otherwise.
   size_t nEdgesSafe = edgesHaveBeenUsed ? nEdges() : 0;
 
-  // Get element indices
-  size_t totalPickElements = nVertices() + nFaces() + nEdgesSafe + nHalfedges() + nCorners();
-
-  // In "local" indices, indexing elements only within this mesh, used for reading later
   facePickIndStart = nVertices();
   edgePickIndStart = facePickIndStart + nFaces();
   halfedgePickIndStart = edgePickIndStart + nEdgesSafe;
   cornerPickIndStart = halfedgePickIndStart + nHalfedges();
+  return cornerPickIndStart + nCorners();
+}
 
-  // In "global" indices, indexing all elements in the scene, used to fill buffers for drawing here
-  size_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
-  size_t vertexGlobalPickIndStart = pickStart;
-  size_t faceGlobalPickIndStart = pickStart + facePickIndStart;
-  size_t edgeGlobalPickIndStart = pickStart + edgePickIndStart;
-  size_t halfedgeGlobalPickIndStart = pickStart + halfedgePickIndStart;
-  size_t cornerGlobalPickIndStart = pickStart + cornerPickIndStart;
-
-  // == Fill buffers
-  std::vector<std::array<glm::vec3, 3>> vertexColors, halfedgeColors, cornerColors;
-  std::vector<glm::vec3> faceColor;
-
-  // Reserve space
-  vertexColors.reserve(3 * nFacesTriangulation());
-  faceColor.reserve(3 * nFacesTriangulation());
-  if (!simplePick) {
-    halfedgeColors.reserve(3 * nFacesTriangulation());
-    cornerColors.reserve(3 * nFacesTriangulation());
-  }
+void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
 
+  // The shader computes the pick colors itself, from the local element indices of each triangle plus the global start
+  // of each element type's pick range. This way the only data we build here are a few index arrays, rather than three
+  // encoded colors for every element of every triangle corner.
+  //
+  // The index arrays do not depend on where this mesh's range lands in the global pick indices, so they are cached
+  // and reused by later pick programs, as long as the connectivity they came from has not changed. Only the element
+  // types which have been used get an array of their own.
 
-  // Build all quantities in each face
-  size_t iFTri = 0;
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
+  // make sure we have the relevant indexing data (first, since lazily computing it bumps the versions used below)
+  bool simplePick = !(edgesHaveBeenUsed || halfedgesHaveBeenUsed || cornersHaveBeenUsed);
+  triangleVertexInds.ensureHostBufferPopulated();
+  if (edgesHaveBeenUsed) triangleAllEdgeInds.ensureHostBufferPopulated();
+  if (halfedgesHaveBeenUsed) triangleAllHalfedgeInds.ensureHostBufferPopulated();
+  if (cornersHaveBeenUsed) triangleCornerInds.ensureHostBufferPopulated();
+  size_t nTri = nFacesTriangulation();
+  uint64_t triVersion = triangleVertexInds.getDataVersion();
 
-    glm::vec3 fColor = pick::indToVec(iF + faceGlobalPickIndStart);
+  // Get element indices
+  // In "local" indices, indexing elements only within this mesh, used for reading later
+  size_t totalPickElements = computePickIndStarts();
+
+  // In "global" indices, indexing all elements in the scene, used to offset indices in the shader
+  uint64_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
+  p.setUniform("u_vertexPickStart", pick::indToDigits(pickStart));
+  p.setUniform("u_facePickStart", pick::indToDigits(pickStart + facePickIndStart));
+
+  // The face index is the same for every vertex of the triangle, which is exactly the existing face index buffer
+  p.setAttribute("a_faceInd", triangleFaceInds.getRenderAttributeBuffer());
+
+  // == Vertex indices
+  // (each vertex of the triangle gets all three of its indices, to be passed through as flat varyings)
+  std::array<uint64_t, 3> vertexKey{triVersion, 0, 0};
+  if (!pickVertexIndsBuffer || pickVertexIndsKey != vertexKey) {
+    const std::vector<uint32_t>& triVerts = triangleVertexInds.getPopulatedHostBufferRef();
+    std::vector<glm::uvec3> vertexInds(3 * nTri);
+    parallelForRanges(nTri, [&](size_t iStart, size_t iEnd) {
+      for (size_t iTri = iStart; iTri < iEnd; iTri++) {
+        glm::uvec3 inds{triVerts[3 * iTri + 0], triVerts[3 * iTri + 1], triVerts[3 * iTri + 2]};
+        for (size_t k = 0; k < 3; k++) vertexInds[3 * iTri + k] = inds;
+      }
+    });
 
-    for (size_t j = 1; (j + 1) < D; j++) {
+    pickVertexIndsBuffer = render::engine->generateAttributeBuffer(RenderDataType::Vector3UInt);
+    pickVertexIndsBuffer->setData(vertexInds);
+    pickVertexIndsKey = vertexKey;
+  }
+  p.setAttribute("a_vertexInds", pickVertexIndsBuffer);
+
+  // Second half does halfedges/edges/corners, not used for simple mode
+  if (simplePick) return;
+
+  // == Halfedge indices
+  // Fill the halfedge buffer with edge or halfedge data, depending on which are in use
+  // In the pick function we will use the halfedge to look up the edge if needed
+  // (this is an optimization to use one less array of values, because we hit implementation limits in the shader)
+  // Sides of the triangle which are interior to a polygon get an all-ones index, meaning "pick the face".
+  bool useEdges = edgesHaveBeenUsed && !halfedgesHaveBeenUsed;
+  render::ManagedBuffer<uint32_t>* eIndsSource = nullptr;
+  if (useEdges) eIndsSource = &triangleAllEdgeInds;
+  if (halfedgesHaveBeenUsed) eIndsSource = &triangleAllHalfedgeInds;
+  uint64_t eSourceType = halfedgesHaveBeenUsed ? 2 : (useEdges ? 1 : 0);
+
+  std::array<uint64_t, 3> halfedgeKey{triVersion, eIndsSource ? eIndsSource->getDataVersion() : 0, eSourceType};
+  if (!pickHalfedgeIndsBuffer || pickHalfedgeIndsKey != halfedgeKey) {
+    const uint32_t notAnEdge = std::numeric_limits<uint32_t>::max();
+    std::vector<glm::uvec3> halfedgeInds(3 * nTri, glm::uvec3{notAnEdge});
+    if (eIndsSource) {
+      const std::vector<uint32_t>& eDataVec = eIndsSource->getPopulatedHostBufferRef();
+      const std::vector<glm::vec3>& isRealVec = edgeIsReal.getPopulatedHostBufferRef();
+      parallelForRanges(nTri, [&](size_t iStart, size_t iEnd) {
+        for (size_t iTri = iStart; iTri < iEnd; iTri++) {
+          glm::vec3 isReal = isRealVec[3 * iTri];
+          glm::uvec3 inds{notAnEdge};
+          for (int i = 0; i < 3; i++) {
+            if (isReal[i] > 0.5) inds[i] = eDataVec[9 * iTri + i];
+          }
+          for (size_t k = 0; k < 3; k++) halfedgeInds[3 * iTri + k] = inds;
+        }
+      });
+    }
 
-      // == Build face & vertex index data
+    pickHalfedgeIndsBuffer = render::engine->generateAttributeBuffer(RenderDataType::Vector3UInt);
+    pickHalfedgeIndsBuffer->setData(halfedgeInds);
+    pickHalfedgeIndsKey = halfedgeKey;
+  }
+  p.setAttribute("a_halfedgeInds", pickHalfedgeIndsBuffer);
+  size_t eStart = halfedgesHaveBeenUsed ? halfedgePickIndStart : (useEdges ? edgePickIndStart : 0);
+  p.setUniform("u_halfedgePickStart", pick::indToDigits(pickStart + eStart));
+
+  // == Corner indices, if needed
+  // (if not, the corner region picks the vertex, so just reuse the vertex data)
+  if (!cornersHaveBeenUsed) {
+    p.setAttribute("a_cornerInds", pickVertexIndsBuffer);
+    p.setUniform("u_cornerPickStart", pick::indToDigits(pickStart));
+    return;
+  }
 
-      // clang-format off
-      std::array<glm::vec3, 3> vColor = {
-        pick::indToVec(triangleVertexInds.data[3*iFTri + 0] + vertexGlobalPickIndStart),
-        pick::indToVec(triangleVertexInds.data[3*iFTri + 1] + vertexGlobalPickIndStart),
-        pick::indToVec(triangleVertexInds.data[3*iFTri + 2] + vertexGlobalPickIndStart),
-      };
-      // clang-format on
-
-      for (int j = 0; j < 3; j++) {
-        faceColor.push_back(fColor);
-        vertexColors.push_back(vColor);
+  std::array<uint64_t, 3> cornerKey{triVersion, triangleCornerInds.getDataVersion(), 0};
+  if (!pickCornerIndsBuffer || pickCornerIndsKey != cornerKey) {
+    const std::vector<uint32_t>& triCorners = triangleCornerInds.getPopulatedHostBufferRef();
+    std::vector<glm::uvec3> cornerInds(3 * nTri);
+    parallelForRanges(nTri, [&](size_t iStart, size_t iEnd) {
+      for (size_t iTri = iStart; iTri < iEnd; iTri++) {
+        glm::uvec3 inds{triCorners[3 * iTri + 0], triCorners[3 * iTri + 1], triCorners[3 * iTri + 2]};
+        for (size_t k = 0; k < 3; k++) cornerInds[3 * iTri + k] = inds;
       }
+    });
 
-      // Second half does halfedges/edges/corners, not used for simple mode
-      if (simplePick) {
-        iFTri++;
-        continue;
-      }
+    pickCornerIndsBuffer = render::engine->generateAttributeBuffer(RenderDataType::Vector3UInt);
+    pickCornerIndsBuffer->setData(cornerInds);
+    pickCornerIndsKey = cornerKey;
+  }
+  p.setAttribute("a_cornerInds", pickCornerIndsBuffer);
+  p.setUniform("u_cornerPickStart", pick::indToDigits(pickStart + cornerPickIndStart));
+}
+
+void SurfaceMesh::prepareRayCast() {
 
+  // Make sure everything rayCast() reads is on the host
+  vertexPositions.ensureHostBufferPopulated();
+  triangleVertexInds.ensureHostBufferPopulated();
+  triangleFaceInds.ensureHostBufferPopulated();
+  if (edgesHaveBeenUsed) triangleAllEdgeInds.ensureHostBufferPopulated();
+  if (halfedgesHaveBeenUsed) triangleAllHalfedgeInds.ensureHostBufferPopulated();
+  if (cornersHaveBeenUsed) triangleCornerInds.ensureHostBufferPopulated();
+  computePickIndStarts();
+
+  // The connectivity never changes, so if the hierarchy exists it only needs to be refit for new positions
+  size_t nTri = nFacesTriangulation();
+  bool haveBVH = rayCastBVH.nPrimitives() == nTri && !rayCastBVH.empty();
+  if (haveBVH && rayCastBVHPositionsVersion == vertexPositions.getDataVersion()) return;
+
+  const std::vector<glm::vec3>& pos = vertexPositions.data;
+  const std::vector<uint32_t>& triVerts = triangleVertexInds.data;
+  std::vector<std::array<glm::vec3, 2>> triBoxes(nTri);
+  parallelForRanges(nTri, [&](size_t iStart, size_t iEnd) {
+    for (size_t iTri = iStart; iTri < iEnd; iTri++) {
+      glm::vec3 pA = pos[triVerts[3 * iTri + 0]];
+      glm::vec3 pB = pos[triVerts[3 * iTri + 1]];
+      glm::vec3 pC = pos[triVerts[3 * iTri + 2]];
+      triBoxes[iTri] = {glm::min(glm::min(pA, pB), pC), glm::max(glm::max(pA, pB), pC)};
+    }
+  });
 
-      // Fill the halfedge buffer with edge or halfedge data, depending on which are in use
-      // In the pick function we will use the halfedge to look up the edge if needed
-      // (this is an optimization to use one less array of values, because we hit implementation limits in the shader)
+  if (haveBVH) {
+    rayCastBVH.refit(triBoxes);
+  } else {
+    rayCastBVH.build(triBoxes);
+  }
+  rayCastBVHPositionsVersion = vertexPositions.getDataVersion();
+}
 
-      // == Build edge index data, if needed
+bool SurfaceMesh::rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) {
 
+  // Intersect in object space. The ray parameter t is the same in both spaces.
+  glm::mat4 invTransform = glm::inverse(objectTransform.get());
+  glm::vec3 objRayStart = glm::vec3(invTransform * glm::vec4(rayStart, 1.));
+  glm::vec3 objRayDir = glm::vec3(invTransform * glm::vec4(rayDir, 0.));
 
-      if (edgesHaveBeenUsed || halfedgesHaveBeenUsed) {
+  const std::vector<glm::vec3>& pos = vertexPositions.data;
+  const std::vector<uint32_t>& triVerts = triangleVertexInds.data;
+  glm::vec3 hitBaryCoord;
+  auto hitTriangle = [&](uint32_t iTri, float tCurr) {
+    glm::vec3 baryCoord;
+    float t = rayTriangleIntersection(objRayStart, objRayDir, pos[triVerts[3 * iTri + 0]], pos[triVerts[3 * iTri + 1]],
+                                      pos[triVerts[3 * iTri + 2]], baryCoord);
+    if (!(t >= 0. && t < tCurr) || isCulledBySlicePlanes(rayStart + t * rayDir)) {
+      return std::numeric_limits<float>::infinity();
+    }
+    hitBaryCoord = baryCoord;
+    return t;
+  };
 
-        const std::vector<uint32_t>& eDataVec =
-            (edgesHaveBeenUsed && !halfedgesHaveBeenUsed) ? triangleAllEdgeInds.data : triangleAllHalfedgeInds.data;
-        size_t offset =
-            (edgesHaveBeenUsed && !halfedgesHaveBeenUsed) ? edgeGlobalPickIndStart : halfedgeGlobalPickIndStart;
+  std::pair<uint64_t, float> hit = rayCastBVH.closestRayHit(objRayStart, objRayDir, tMax, hitTriangle);
+  if (hit.first == INVALID_IND_64) return false;
 
-        // clang-format off
-        std::array<glm::vec3, 3> eColor = { 
-          fColor, 
-          pick::indToVec(eDataVec[9*iFTri + 1] + offset), 
-          fColor
-        };
-        // clang-format on
-        if (j == 1) eColor[0] = pick::indToVec(eDataVec[9 * iFTri + 0] + offset);
-        if (j + 2 == D) eColor[2] = pick::indToVec(eDataVec[9 * iFTri + 2] + offset);
+  tHit = hit.second;
+  localPickInd = pickIndOfTriangleHit(hit.first, hitBaryCoord);
+  return true;
+}
 
-        for (int j = 0; j < 3; j++) halfedgeColors.push_back(eColor);
-      } else {
-        for (int j = 0; j < 3; j++) halfedgeColors.push_back({fColor, fColor, fColor});
-      }
+size_t SurfaceMesh::pickIndOfTriangleHit(size_t iTri, glm::vec3 baryCoord) {
+  // This follows the MESH_PROPAGATE_PICK and MESH_PROPAGATE_PICK_SIMPLE shader rules, see setMeshPickAttributes()
 
-      // == Build corner index data, if needed
-
-      if (cornersHaveBeenUsed) {
-        // clang-format off
-        std::array<glm::vec3, 3> cColor = { 
-          pick::indToVec(triangleCornerInds.data[3*iFTri + 0] + cornerGlobalPickIndStart), 
-          pick::indToVec(triangleCornerInds.data[3*iFTri + 1] + cornerGlobalPickIndStart), 
-          pick::indToVec(triangleCornerInds.data[3*iFTri + 2] + cornerGlobalPickIndStart), 
-        };
-        // clang-format on
-        for (int j = 0; j < 3; j++) cornerColors.push_back(cColor);
-      } else {
-        for (int j = 0; j < 3; j++) cornerColors.push_back({vColor[0], vColor[1], vColor[2]});
-      }
+  bool simplePick = !(edgesHaveBeenUsed || halfedgesHaveBeenUsed || cornersHaveBeenUsed);
+  size_t iF = triangleFaceInds.data[3 * iTri];
 
-      iFTri++;
+  if (simplePick) {
+    for (int i = 0; i < 3; i++) {
+      if (baryCoord[i] > 1. - 0.2) return triangleVertexInds.data[3 * iTri + i];
     }
+    return facePickIndStart + iF;
   }
 
-  // == Store data in buffers
-
-  std::shared_ptr<render::AttributeBuffer> vertexColorsBuff =
-      render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-  vertexColorsBuff->setData(vertexColors);
-  pickProgram->setAttribute("a_vertexColors", vertexColorsBuff);
-
-  std::shared_ptr<render::AttributeBuffer> faceColorsBuff =
-      render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
-  faceColorsBuff->setData(faceColor);
-  pickProgram->setAttribute("a_faceColor", faceColorsBuff);
-
-  if (!simplePick) {
-
-    std::shared_ptr<render::AttributeBuffer> halfedgeColorsBuff =
-        render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-    halfedgeColorsBuff->setData(halfedgeColors);
-    pickProgram->setAttribute("a_halfedgeColors", halfedgeColorsBuff);
+  // Test vertices and corners
+  for (int i = 0; i < 3; i++) {
+    if (baryCoord[i] > 1. - 0.15) return triangleVertexInds.data[3 * iTri + i];
+    if (baryCoord[i] > 1. - 0.25) {
+      if (cornersHaveBeenUsed) return cornerPickIndStart + triangleCornerInds.data[3 * iTri + i];
+      return triangleVertexInds.data[3 * iTri + i];
+    }
+  }
 
-    std::shared_ptr<render::AttributeBuffer> cornerColorsBuff =
-        render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-    cornerColorsBuff->setData(cornerColors);
-    pickProgram->setAttribute("a_cornerColors", cornerColorsBuff);
+  // Test halfedges (or edges). Only the sides of the triangle which are edges of the original face count; the others
+  // are internal to the face.
+  if (edgesHaveBeenUsed || halfedgesHaveBeenUsed) {
+    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
+    size_t j = iTri - (faceIndsStart[iF] - 2 * iF) + 1; // this is the triangle (0, j, j+1) in the fan of the face
+    for (int i = 0; i < 3; i++) {
+      if (baryCoord[(i + 2) % 3] >= 0.15) continue;
+      bool isFaceEdge = (i == 1) || (i == 0 && j == 1) || (i == 2 && j + 2 == D);
+      if (!isFaceEdge) break;
+      if (edgesHaveBeenUsed && !halfedgesHaveBeenUsed) {
+        return edgePickIndStart + triangleAllEdgeInds.data[9 * iTri + i];
+      }
+      return halfedgePickIndStart + triangleAllHalfedgeInds.data[9 * iTri + i];
+    }
   }
+
+  return facePickIndStart + iF;
 }
 
 
@@ -1044,6 +1161,28 @@ void SurfaceMesh::setSurfaceMeshUniforms(render::ShaderProgram& p) {
 }
 
 
+void SurfaceMesh::updateSelectionQuantities(const SelectionSet& selection) {
+  // Show the selected vertices and faces. Each quantity is only added once something has been selected, but is kept up
+  // to date after that.
+  computePickIndStarts();
+
+  std::string vertexQName = selectionQuantityPrefix + " vertices";
+  bool vertexIsNew = getQuantity(vertexQName) == nullptr;
+  if (!vertexIsNew || selection.count(0, nVertices()) > 0) {
+    SurfaceVertexScalarQuantity* q =
+        addVertexScalarQuantityImpl(vertexQName, selection.indicator(0, nVertices()), DataType::STANDARD);
+    if (vertexIsNew) q->setEnabled(true);
+  }
+
+  std::string faceQName = selectionQuantityPrefix + " faces";
+  bool faceIsNew = getQuantity(faceQName) == nullptr;
+  if (!faceIsNew || selection.count(facePickIndStart, facePickIndStart + nFaces()) > 0) {
+    SurfaceFaceScalarQuantity* q =
+        addFaceScalarQuantityImpl(faceQName, selection.indicator(facePickIndStart, nFaces()), DataType::STANDARD);
+    if (faceIsNew) q->setEnabled(true);
+  }
+}
+
 void SurfaceMesh::buildPickUI(size_t localPickID) {
 
   // Selection type
@@ -1321,25 +1460,10 @@ void SurfaceMesh::refresh() {
 }
 
 void SurfaceMesh::updateObjectSpaceBounds() {
+  if (applyObjectSpaceBoundsHint()) return;
 
   vertexPositions.ensureHostBufferPopulated();
-
-  // bounding box
-  glm::vec3 min = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  glm::vec3 max = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  for (const glm::vec3& p : vertexPositions.data) {
-    min = componentwiseMin(min, p);
-    max = componentwiseMax(max, p);
-  }
-  objectSpaceBoundingBox = std::make_tuple(min, max);
-
-  // length scale, as twice the radius from the center of the bounding box
-  glm::vec3 center = 0.5f * (min + max);
-  float lengthScale = 0.0;
-  for (const glm::vec3& p : vertexPositions.data) {
-    lengthScale = std::max(lengthScale, glm::length2(p - center));
-  }
-  objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  computeObjectSpaceBoundsFromPoints(vertexPositions.data);
 }
 
 std::string SurfaceMesh::typeName() { return structureTypeName; }
@@ -1706,6 +1830,23 @@ SurfaceParameterizationQuantity* SurfaceMesh::getParameterization(std::string na
   return param;
 }
 
+ConnectedComponents SurfaceMesh::computeConnectedComponents() {
+  ParallelDisjointSets sets(nVertices());
+  parallelForRanges(nFaces(), [&](size_t iStart, size_t iEnd) {
+    for (size_t iF = iStart; iF < iEnd; iF++) {
+      uint32_t vRoot = faceIndsEntries[faceIndsStart[iF]];
+      for (size_t j = faceIndsStart[iF] + 1; j < faceIndsStart[iF + 1]; j++) {
+        sets.merge(vRoot, faceIndsEntries[j]);
+      }
+    }
+  });
+  return labelConnectedComponents(sets);
+}
+
+SurfaceVertexColorQuantity* SurfaceMesh::addConnectedComponentsQuantity(std::string name) {
+  return addVertexColorQuantityImpl(name, computeConnectedComponents().colors());
+}
+
 
 SurfaceMeshQuantity::SurfaceMeshQuantity(std::string name, SurfaceMesh& parentStructure, bool dominates)
     : QuantityS<SurfaceMesh>(name, parentStructure, dominates) {}
@@ -65,7 +65,7 @@ SurfaceVertexScalarQuantity::SurfaceVertexScalarQuantity(std::string name, const
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
+  hist.buildHistogramDeferred(values);
 }
 
 void SurfaceVertexScalarQuantity::createProgram() {
@@ -108,7 +108,7 @@ SurfaceFaceScalarQuantity::SurfaceFaceScalarQuantity(std::string name, const std
 {
   values.ensureHostBufferPopulated();
   parent.faceAreas.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
+  hist.buildHistogramDeferred(values);
 }
 
 void SurfaceFaceScalarQuantity::createProgram() {
@@ -153,7 +153,7 @@ SurfaceEdgeScalarQuantity::SurfaceEdgeScalarQuantity(std::string name, const std
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
+  hist.buildHistogramDeferred(values);
 }
 
 void SurfaceEdgeScalarQuantity::createProgram() {
@@ -195,7 +195,7 @@ SurfaceHalfedgeScalarQuantity::SurfaceHalfedgeScalarQuantity(std::string name, c
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
+  hist.buildHistogramDeferred(values);
 }
 
 void SurfaceHalfedgeScalarQuantity::createProgram() {
@@ -236,7 +236,7 @@ SurfaceCornerScalarQuantity::SurfaceCornerScalarQuantity(std::string name, const
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
+  hist.buildHistogramDeferred(values);
 }
 
 void SurfaceCornerScalarQuantity::createProgram() {
@@ -279,7 +279,7 @@ SurfaceTextureScalarQuantity::SurfaceTextureScalarQuantity(std::string name, Sur
       imageOrigin(origin_) {
   values.setTextureSize(dimX, dimY);
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
+  hist.buildHistogramDeferred(values);
 }
 
 void SurfaceTextureScalarQuantity::createProgram() {
@@ -214,6 +214,7 @@ bool TransformationGizmo::interact() {
         T = glm::rotate(angle, normal) * T;
         T[3] = trans;
         markUpdated();
+        internal::sceneGeometryVersion++;
         polyscope::requestRedraw();
 
         dragPrevVec = nearestDir; // store this dir for the next time around
@@ -237,6 +238,7 @@ bool TransformationGizmo::interact() {
         T[3][1] += trans.y;
         T[3][2] += trans.z;
         markUpdated();
+        internal::sceneGeometryVersion++;
         polyscope::requestRedraw();
 
         dragPrevVec = nearestPoint; // store this dir for the next time around
@@ -263,6 +265,7 @@ bool TransformationGizmo::interact() {
         T *= scaleRatio;
         T[3] = trans;
         markUpdated();
+        internal::sceneGeometryVersion++;
         polyscope::requestRedraw();
 
         dragPrevVec = nearestPoint; // store this dir for the next time around
@@ -9,6 +9,7 @@
 #include "imgui.h"
 
 #include "polyscope/messages.h"
+#include "polyscope/selection_set.h"
 
 
 namespace polyscope {
@@ -44,7 +45,11 @@ std::string guessNiceNameFromPath(std::string fullname) {
 
 void validateName(const std::string& name) {
   if (name == "") exception("name must not be the empty string");
-  if (name.find("#") != std::string::npos) exception("name must not contain '#' characters");
+  // (other than in the reserved prefix of the quantities showing the selection)
+  size_t searchStart = name.compare(0, selectionQuantityPrefix.size(), selectionQuantityPrefix) == 0
+                           ? selectionQuantityPrefix.size()
+                           : 0;
+  if (name.find("#", searchStart) != std::string::npos) exception("name must not contain '#' characters");
 }
 
 std::tuple<std::string, std::string> splitExt(std::string f) {
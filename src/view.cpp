@@ -34,6 +34,7 @@ double fov = defaultFov;
 double nearClipRatio = defaultNearClipRatio;
 double farClipRatio = defaultFarClipRatio;
 ProjectionMode projectionMode = ProjectionMode::Perspective;
+glm::vec2 projectionJitter{0., 0.};
 std::array<float, 4> bgColor{{1.0, 1.0, 1.0, 0.0}};
 
 glm::mat4x4 viewMat;
@@ -196,7 +197,7 @@ void processRotate(glm::vec2 startP, glm::vec2 endP) {
   }
   }
 
-  requestRedraw();
+  requestViewRedraw();
   immediatelyEndFlight();
 }
 
@@ -212,7 +213,7 @@ void processTranslate(glm::vec2 delta) {
   glm::mat4x4 camSpaceT = glm::translate(glm::mat4x4(1.0), movementScale * glm::vec3(delta.x, delta.y, 0.0));
   viewMat = camSpaceT * viewMat;
 
-  requestRedraw();
+  requestViewRedraw();
   immediatelyEndFlight();
 }
 
@@ -220,7 +221,7 @@ void processClipPlaneShift(double amount) {
   if (amount == 0.0) return;
   // Adjust the near clipping plane
   nearClipRatio += .03 * amount * nearClipRatio;
-  requestRedraw();
+  requestViewRedraw();
 }
 
 void processZoom(double amount) {
@@ -248,7 +249,7 @@ void processZoom(double amount) {
 
 
   immediatelyEndFlight();
-  requestRedraw();
+  requestViewRedraw();
 }
 
 void processKeyboardNavigation(ImGuiIO& io) {
@@ -296,7 +297,7 @@ void processKeyboardNavigation(ImGuiIO& io) {
 
   if (hasMovement) {
     immediatelyEndFlight();
-    requestRedraw();
+    requestViewRedraw();
   }
 }
 
@@ -357,7 +358,7 @@ void resetCameraToHomeView() {
   nearClipRatio = defaultNearClipRatio;
   farClipRatio = defaultFarClipRatio;
 
-  requestRedraw();
+  requestViewRedraw();
 }
 
 void flyToHomeView() {
@@ -400,7 +401,7 @@ void lookAt(glm::vec3 cameraLocation, glm::vec3 target, glm::vec3 upDir, bool fl
     startFlightTo(targetView, fov);
   } else {
     viewMat = targetView;
-    requestRedraw();
+    requestViewRedraw();
   }
 }
 
@@ -436,6 +437,15 @@ void setCameraViewMatrix(glm::mat4 mat) { viewMat = mat; }
 glm::mat4 getCameraViewMatrix() { return viewMat; }
 
 glm::mat4 getCameraPerspectiveMatrix() {
+  glm::mat4 projMat = getUnjitteredCameraPerspectiveMatrix();
+  if (projectionJitter != glm::vec2{0., 0.}) {
+    // shift the image after the perspective divide
+    projMat = glm::translate(glm::mat4(1.0), glm::vec3(projectionJitter, 0.)) * projMat;
+  }
+  return projMat;
+}
+
+glm::mat4 getUnjitteredCameraPerspectiveMatrix() {
   double farClip = farClipRatio * state::lengthScale;
   double nearClip = nearClipRatio * state::lengthScale;
   double fovRad = glm::radians(fov);
@@ -590,7 +600,7 @@ void updateFlight() {
       // linear spline
       fov = (1.0f - t) * flightInitialFov + t * flightTargetFov;
     }
-    requestRedraw(); // flight is still happening, draw again next frame
+    requestViewRedraw(); // flight is still happening, draw again next frame
   }
 }
 
@@ -692,7 +702,7 @@ void setViewFromJson(std::string jsonData, bool flyTo) {
   } else {
     viewMat = newViewMat;
     fov = newFov;
-    requestRedraw();
+    requestViewRedraw();
   }
 }
 void setCameraFromJson(std::string jsonData, bool flyTo) { setViewFromJson(jsonData, flyTo); }
@@ -896,7 +906,7 @@ void buildViewGui() {
       float fovF = fov;
       if (ImGui::SliderFloat(" Field of View", &fovF, minFov, maxFov, "%.2f deg")) {
         fov = fovF;
-        requestRedraw();
+        requestViewRedraw();
       };
 
       // Clip planes
@@ -905,12 +915,12 @@ void buildViewGui() {
       if (ImGui::SliderFloat(" Clip Near", &nearClipRatioF, 0., 10., "%.5f",
                              ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
         nearClipRatio = nearClipRatioF;
-        requestRedraw();
+        requestViewRedraw();
       }
       if (ImGui::SliderFloat(" Clip Far", &farClipRatioF, 1., 1000., "%.2f",
                              ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
         farClipRatio = farClipRatioF;
-        requestRedraw();
+        requestViewRedraw();
       }
 
 
@@ -918,12 +928,12 @@ void buildViewGui() {
       if (ImGui::BeginCombo("##ProjectionMode", projectionModeStr.c_str())) {
         if (ImGui::Selectable("Perspective", view::projectionMode == ProjectionMode::Perspective)) {
           view::projectionMode = ProjectionMode::Perspective;
-          requestRedraw();
+          requestViewRedraw();
           ImGui::SetItemDefaultFocus();
         }
         if (ImGui::Selectable("Orthographic", view::projectionMode == ProjectionMode::Orthographic)) {
           view::projectionMode = ProjectionMode::Orthographic;
-          requestRedraw();
+          requestViewRedraw();
           ImGui::SetItemDefaultFocus();
         }
         ImGui::EndCombo();
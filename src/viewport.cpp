@@ -0,0 +1,305 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/viewport.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/pick.h"
+#include "polyscope/polyscope.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace polyscope {
+
+namespace state {
+std::vector<std::unique_ptr<Viewport>> viewports;
+}
+
+namespace {
+
+Viewport* currentViewport = nullptr;
+
+// The size of the window, which the view state holds outside of any viewport scope
+int outerBufferWidth = 0;
+int outerBufferHeight = 0;
+int outerWindowWidth = 0;
+int outerWindowHeight = 0;
+
+int currWindowBufferWidth() { return currentViewport ? outerBufferWidth : view::bufferWidth; }
+int currWindowBufferHeight() { return currentViewport ? outerBufferHeight : view::bufferHeight; }
+int currWindowWidth() { return currentViewport ? outerWindowWidth : view::windowWidth; }
+int currWindowHeight() { return currentViewport ? outerWindowHeight : view::windowHeight; }
+
+} // namespace
+
+// =============================================================
+// ========================  Viewport  =========================
+// =============================================================
+
+Viewport::Viewport(std::string name_, glm::vec4 region_)
+    : name(name_), region(region_), viewMat(view::viewMat), fov(view::fov), projectionMode(view::projectionMode),
+      nearClipRatio(view::nearClipRatio), farClipRatio(view::farClipRatio), bgColor(view::bgColor) {}
+
+Viewport::~Viewport() {}
+
+void Viewport::setRegion(glm::vec4 newRegion) {
+  region = newRegion;
+  requestRedraw();
+}
+glm::vec4 Viewport::getRegion() { return region; }
+
+glm::ivec4 Viewport::getPixelRegion() {
+  int w = currWindowBufferWidth();
+  int h = currWindowBufferHeight();
+  int x0 = static_cast<int>(std::round(region.x * w));
+  int y0 = static_cast<int>(std::round(region.y * h));
+  int x1 = static_cast<int>(std::round((region.x + region.z) * w));
+  int y1 = static_cast<int>(std::round((region.y + region.w) * h));
+  return glm::ivec4{x0, y0, std::max(x1 - x0, 1), std::max(y1 - y0, 1)};
+}
+
+bool Viewport::containsScreenCoords(glm::vec2 screenCoords) {
+  glm::vec2 local = toLocalScreenCoords(screenCoords);
+  return local.x >= 0 && local.y >= 0 && local.x < region.z * currWindowWidth() && local.y < region.w * currWindowHeight();
+}
+
+glm::vec2 Viewport::toLocalScreenCoords(glm::vec2 screenCoords) {
+  return screenCoords - glm::vec2{region.x * currWindowWidth(), region.y * currWindowHeight()};
+}
+
+void Viewport::setViewMatrix(glm::mat4 newViewMat) {
+  viewMat = newViewMat;
+  requestViewRedraw();
+}
+glm::mat4 Viewport::getViewMatrix() { return viewMat; }
+
+void Viewport::setFieldOfView(double newFov) {
+  fov = newFov;
+  requestViewRedraw();
+}
+double Viewport::getFieldOfView() { return fov; }
+
+void Viewport::setProjectionMode(ProjectionMode newMode) {
+  projectionMode = newMode;
+  requestViewRedraw();
+}
+ProjectionMode Viewport::getProjectionMode() { return projectionMode; }
+
+void Viewport::lookAt(glm::vec3 cameraLocation, glm::vec3 target) {
+  ViewportScope scope(*this);
+  view::lookAt(cameraLocation, target, false);
+}
+
+void Viewport::resetCameraToHomeView() {
+  ViewportScope scope(*this);
+  view::resetCameraToHomeView();
+}
+
+void Viewport::setBackgroundColor(std::array<float, 4> newColor) {
+  bgColor = newColor;
+  requestRedraw();
+}
+std::array<float, 4> Viewport::getBackgroundColor() { return bgColor; }
+
+void Viewport::setGroundPlaneEnabled(bool newVal) {
+  groundPlaneEnabled = newVal;
+  requestRedraw();
+}
+bool Viewport::getGroundPlaneEnabled() { return groundPlaneEnabled; }
+
+void Viewport::setStructureVisible(Structure* s, bool visible) {
+  std::pair<std::string, std::string> key{s->typeName(), s->name};
+  if (visible) {
+    hiddenStructures.erase(key);
+  } else {
+    hiddenStructures.insert(key);
+  }
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+}
+
+bool Viewport::isStructureVisible(Structure* s) {
+  if (hiddenStructures.empty()) return true;
+  return hiddenStructures.find(std::make_pair(s->typeName(), s->name)) == hiddenStructures.end();
+}
+
+void Viewport::setAllStructuresVisible() {
+  hiddenStructures.clear();
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+}
+
+std::pair<Structure*, size_t> Viewport::pick(glm::ivec2 pixelCoords) {
+  ViewportScope scope(*this);
+  return pick::evaluatePickQuery(pixelCoords.x, pixelCoords.y);
+}
+
+std::shared_ptr<render::TextureBuffer> Viewport::getColorTexture() { return colorTexture; }
+
+void Viewport::storeRenderedScene() {
+  render::TextureBuffer& source = *render::engine->sceneColorFinal;
+  unsigned int w = source.getSizeX();
+  unsigned int h = source.getSizeY();
+
+  if (!colorTexture) {
+    colorTexture = render::engine->generateTextureBuffer(TextureFormat::RGBA16F, w, h);
+    frameBuffer = render::engine->generateFrameBuffer(w, h);
+    frameBuffer->addColorBuffer(colorTexture);
+    frameBuffer->setDrawBuffers();
+  } else if (colorTexture->getSizeX() != w || colorTexture->getSizeY() != h) {
+    frameBuffer->resize(w, h);
+  }
+  frameBuffer->setViewport(0, 0, w, h);
+
+  render::engine->sceneBufferFinal->blitTo(frameBuffer.get());
+}
+
+// =============================================================
+// =====================  Viewport Scope  ======================
+// =============================================================
+
+ViewportScope::ViewportScope(Viewport& viewport_) : viewport(viewport_), prevViewport(currentViewport) {
+
+  // Compute the viewport's size while the view state still holds the window's
+  glm::ivec4 pixelRegion = viewport.getPixelRegion();
+  int regionWindowWidth = std::max(static_cast<int>(std::round(viewport.region.z * currWindowWidth())), 1);
+  int regionWindowHeight = std::max(static_cast<int>(std::round(viewport.region.w * currWindowHeight())), 1);
+
+  // Save the global state
+  viewMat = view::viewMat;
+  fov = view::fov;
+  projectionMode = view::projectionMode;
+  nearClipRatio = view::nearClipRatio;
+  farClipRatio = view::farClipRatio;
+  bgColor = view::bgColor;
+  bufferWidth = view::bufferWidth;
+  bufferHeight = view::bufferHeight;
+  windowWidth = view::windowWidth;
+  windowHeight = view::windowHeight;
+  enableTAA = options::enableTAA;
+  groundPlaneTemporalReuse = options::groundPlaneTemporalReuse;
+  transparencyPeelTimeBudgetMs = options::transparencyPeelTimeBudgetMs;
+
+  if (currentViewport == nullptr) {
+    outerBufferWidth = view::bufferWidth;
+    outerBufferHeight = view::bufferHeight;
+    outerWindowWidth = view::windowWidth;
+    outerWindowHeight = view::windowHeight;
+  }
+
+  // Load the viewport's state
+  view::viewMat = viewport.viewMat;
+  view::fov = viewport.fov;
+  view::projectionMode = viewport.projectionMode;
+  view::nearClipRatio = viewport.nearClipRatio;
+  view::farClipRatio = viewport.farClipRatio;
+  view::bgColor = viewport.bgColor;
+  view::bufferWidth = pixelRegion.z;
+  view::bufferHeight = pixelRegion.w;
+  view::windowWidth = regionWindowWidth;
+  view::windowHeight = regionWindowHeight;
+
+  // These caches compare against the previous frame, which was most likely rendered from a different viewport
+  options::enableTAA = false;
+  options::groundPlaneTemporalReuse = false;
+  options::transparencyPeelTimeBudgetMs = 0.;
+
+  currentViewport = &viewport;
+}
+
+ViewportScope::~ViewportScope() {
+
+  // Keep any changes to the camera
+  viewport.viewMat = view::viewMat;
+  viewport.fov = view::fov;
+  viewport.projectionMode = view::projectionMode;
+  viewport.nearClipRatio = view::nearClipRatio;
+  viewport.farClipRatio = view::farClipRatio;
+
+  // Restore the global state
+  view::viewMat = viewMat;
+  view::fov = fov;
+  view::projectionMode = projectionMode;
+  view::nearClipRatio = nearClipRatio;
+  view::farClipRatio = farClipRatio;
+  view::bgColor = bgColor;
+  view::bufferWidth = bufferWidth;
+  view::bufferHeight = bufferHeight;
+  view::windowWidth = windowWidth;
+  view::windowHeight = windowHeight;
+  options::enableTAA = enableTAA;
+  options::groundPlaneTemporalReuse = groundPlaneTemporalReuse;
+  options::transparencyPeelTimeBudgetMs = transparencyPeelTimeBudgetMs;
+
+  currentViewport = prevViewport;
+}
+
+// =============================================================
+// ===================  Manage Viewports  ======================
+// =============================================================
+
+Viewport* addViewport(std::string name, glm::vec4 region) {
+  if (hasViewport(name)) {
+    exception("Attempted to add viewport with name " + name + ", but a viewport with that name already exists");
+    return nullptr;
+  }
+  state::viewports.emplace_back(new Viewport(name, region));
+  requestRedraw();
+  return state::viewports.back().get();
+}
+
+Viewport* getViewport(std::string name) {
+  for (std::unique_ptr<Viewport>& vp : state::viewports) {
+    if (vp->name == name) return vp.get();
+  }
+  exception("No viewport with name " + name);
+  return nullptr;
+}
+
+bool hasViewport(std::string name) {
+  for (std::unique_ptr<Viewport>& vp : state::viewports) {
+    if (vp->name == name) return true;
+  }
+  return false;
+}
+
+void removeViewport(std::string name, bool errorIfAbsent) {
+  for (size_t i = 0; i < state::viewports.size(); i++) {
+    if (state::viewports[i]->name == name) {
+      state::viewports.erase(state::viewports.begin() + i);
+      requestRedraw();
+      return;
+    }
+  }
+  if (errorIfAbsent) {
+    exception("No viewport with name " + name);
+  }
+}
+
+void removeAllViewports() {
+  state::viewports.clear();
+  requestRedraw();
+}
+
+void arrangeViewportsInGrid(int nColumns) {
+  int n = static_cast<int>(state::viewports.size());
+  if (n == 0) return;
+  if (nColumns <= 0) {
+    nColumns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n))));
+  }
+  int nRows = (n + nColumns - 1) / nColumns;
+  for (int i = 0; i < n; i++) {
+    int iRow = i / nColumns;
+    int iCol = i % nColumns;
+    state::viewports[i]->setRegion(glm::vec4{static_cast<float>(iCol) / nColumns, static_cast<float>(iRow) / nRows,
+                                             1.f / nColumns, 1.f / nRows});
+  }
+}
+
+Viewport* getCurrentViewport() { return currentViewport; }
+
+bool isStructureVisibleInCurrentViewport(Structure* s) {
+  return currentViewport == nullptr || currentViewport->isStructureVisible(s);
+}
+
+} // namespace polyscope
@@ -3,6 +3,7 @@
 #include "polyscope/volume_grid.h"
 
 #include "polyscope/pick.h"
+#include "polyscope/profiler.h"
 
 #include "imgui.h"
 
@@ -10,6 +11,7 @@ namespace polyscope {
 
 // Initialize statics
 const std::string VolumeGrid::structureTypeName = "Volume Grid";
+const size_t VolumeGrid::CALLABLE_SAMPLE_CHUNK_SIZE;
 
 VolumeGrid::VolumeGrid(std::string name, glm::uvec3 gridNodeDim_, glm::vec3 boundMin_, glm::vec3 boundMax_)
     : QuantityStructure<VolumeGrid>(name, typeName()),
@@ -127,9 +129,11 @@ void VolumeGrid::draw() {
 
   // Draw the quantities
   for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
   for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 }
@@ -266,6 +270,8 @@ void VolumeGrid::ensureGridCubePickProgramPrepared() {
 
 
 void VolumeGrid::updateObjectSpaceBounds() {
+  if (applyObjectSpaceBoundsHint()) return;
+
   objectSpaceBoundingBox = std::make_tuple(boundMin, boundMax);
   objectSpaceLengthScale = glm::length(boundMax - boundMin);
 }
@@ -397,21 +403,21 @@ VolumeGridQuantity::VolumeGridQuantity(std::string name_, VolumeGrid& curveNetwo
     : QuantityS<VolumeGrid>(name_, curveNetwork_, dominates_) {}
 
 
-VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityImpl(std::string name, const std::vector<double>& data,
+VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityImpl(std::string name, std::vector<double> data,
                                                                     DataType dataType_) {
 
   checkForQuantityWithNameAndDeleteOrError(name);
-  VolumeGridNodeScalarQuantity* q = new VolumeGridNodeScalarQuantity(name, *this, data, dataType_);
+  VolumeGridNodeScalarQuantity* q = new VolumeGridNodeScalarQuantity(name, *this, std::move(data), dataType_);
   addQuantity(q);
   markNodesAsUsed();
   return q;
 }
 
-VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityImpl(std::string name, const std::vector<double>& data,
+VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityImpl(std::string name, std::vector<double> data,
                                                                     DataType dataType_) {
 
   checkForQuantityWithNameAndDeleteOrError(name);
-  VolumeGridCellScalarQuantity* q = new VolumeGridCellScalarQuantity(name, *this, data, dataType_);
+  VolumeGridCellScalarQuantity* q = new VolumeGridCellScalarQuantity(name, *this, std::move(data), dataType_);
   addQuantity(q);
   markCellsAsUsed();
   return q;
@@ -5,22 +5,94 @@
 #define MC_CPP_USE_DOUBLE_PRECISION
 #include "MarchingCube/MC.h"
 
+#include <array>
+#include <limits>
+
 namespace polyscope {
 
 // ========================================================
 // ==========            Node Scalar             ==========
 // ========================================================
 
+const uint32_t VolumeGridNodeScalarQuantity::VOLUME_BLOCK_SIZE;
+const int VolumeGridNodeScalarQuantity::VOLUME_MAX_STEPS;
+
 VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_,
-                                                           const std::vector<double>& values_, DataType dataType_)
-    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, values_, dataType_),
+                                                           std::vector<double> values_, DataType dataType_)
+    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, std::move(values_), dataType_),
+      blockMinValues(this, uniquePrefix() + "#blockMinValues", blockMinValuesData,
+                     std::bind(&VolumeGridNodeScalarQuantity::computeBlockValues, this)),
+      blockMaxValues(this, uniquePrefix() + "#blockMaxValues", blockMaxValuesData,
+                     []() { /* do nothing, gets handled by the min func */ }),
       gridcubeVizEnabled(uniquePrefix() + "gridcubeVizEnabled", true),
       isosurfaceVizEnabled(uniquePrefix() + "isosurfaceVizEnabled", false),
       isosurfaceLevel(uniquePrefix() + "isosurfaceLevel", 0.f),
       isosurfaceColor(uniquePrefix() + "isosurfaceColor", getNextUniqueColor()),
-      slicePlanesAffectIsosurface(uniquePrefix() + "slicePlanesAffectIsosurface", false) {
+      slicePlanesAffectIsosurface(uniquePrefix() + "slicePlanesAffectIsosurface", false),
+      volumeVizEnabled(uniquePrefix() + "volumeVizEnabled", false),
+      volumeOpacityStart(uniquePrefix() + "volumeOpacityStart", vizRange.first),
+      volumeOpacityEnd(uniquePrefix() + "volumeOpacityEnd", vizRange.second),
+      volumeDensity(uniquePrefix() + "volumeDensity", 0.2f),
+      volumeStepSize(uniquePrefix() + "volumeStepSize", 0.5f),
+      volumeIsosurfaceEnabled(uniquePrefix() + "volumeIsosurfaceEnabled", false) {
+
+  // GL textures have x changing fastest, but the values have z changing fastest, so the texture axes are (z,y,x)
+  glm::uvec3 nodeDim = parent.getGridNodeDim();
+  values.setTextureSize(nodeDim.z, nodeDim.y, nodeDim.x);
+
+  glm::uvec3 blockDim = getVolumeBlockDim();
+  blockMinValues.setTextureSize(blockDim.z, blockDim.y, blockDim.x);
+  blockMaxValues.setTextureSize(blockDim.z, blockDim.y, blockDim.x);
+  blockMinValues.addComputeDependency(values);
+}
+
+glm::uvec3 VolumeGridNodeScalarQuantity::getVolumeBlockDim() {
+  glm::uvec3 cellDim = parent.getGridCellDim();
+  return (cellDim + (VOLUME_BLOCK_SIZE - 1)) / VOLUME_BLOCK_SIZE;
+}
 
-  values.setTextureSize(parent.getGridNodeDim().x, parent.getGridNodeDim().y, parent.getGridNodeDim().z);
+void VolumeGridNodeScalarQuantity::computeBlockValues() {
+  values.ensureHostBufferPopulated();
+
+  glm::uvec3 nodeDim = parent.getGridNodeDim();
+  glm::uvec3 blockDim = getVolumeBlockDim();
+  size_t nBlocks = static_cast<size_t>(blockDim.x) * blockDim.y * blockDim.z;
+  blockMinValues.data.resize(nBlocks);
+  blockMaxValues.data.resize(nBlocks);
+
+  // Block b covers nodes B*b through B*(b+1) (inclusive), which are all of the nodes that a sample inside it can
+  // interpolate from. Each x-slab of blocks is independent.
+  auto computeRange = [&](size_t iStart, size_t iEnd) {
+    for (uint32_t bx = iStart; bx < iEnd; bx++) {
+      for (uint32_t by = 0; by < blockDim.y; by++) {
+        for (uint32_t bz = 0; bz < blockDim.z; bz++) {
+          glm::uvec3 low = glm::uvec3{bx, by, bz} * VOLUME_BLOCK_SIZE;
+          glm::uvec3 high = glm::min(low + VOLUME_BLOCK_SIZE, nodeDim - 1u);
+
+          float minVal = std::numeric_limits<float>::infinity();
+          float maxVal = -std::numeric_limits<float>::infinity();
+          for (uint32_t i = low.x; i <= high.x; i++) {
+            for (uint32_t j = low.y; j <= high.y; j++) {
+              for (uint32_t k = low.z; k <= high.z; k++) {
+                float val = static_cast<float>(values.data[parent.flattenNodeIndex(glm::uvec3{i, j, k})]);
+                minVal = std::fmin(minVal, val);
+                maxVal = std::fmax(maxVal, val);
+              }
+            }
+          }
+
+          size_t iBlock = (static_cast<size_t>(bx) * blockDim.y + by) * blockDim.z + bz;
+          blockMinValues.data[iBlock] = minVal;
+          blockMaxValues.data[iBlock] = maxVal;
+        }
+      }
+    }
+  };
+  parallelForRanges(blockDim.x, computeRange, 1);
+
+  blockValuesSourceVersion = values.getDataVersion();
+  blockMinValues.markHostBufferUpdated();
+  blockMaxValues.markHostBufferUpdated();
 }
 
 
@@ -37,6 +109,7 @@ void VolumeGridNodeScalarQuantity::buildCustomUI() {
     if (ImGui::MenuItem("Gridcube", NULL, &gridcubeVizEnabled.get())) setGridcubeVizEnabled(getGridcubeVizEnabled());
     if (ImGui::MenuItem("Isosurface", NULL, &isosurfaceVizEnabled.get()))
       setIsosurfaceVizEnabled(getIsosurfaceVizEnabled());
+    if (ImGui::MenuItem("Volume", NULL, &volumeVizEnabled.get())) setVolumeVizEnabled(getVolumeVizEnabled());
     // ImGui::Indent(-20);
     ImGui::EndPopup();
   }
@@ -83,6 +156,49 @@ void VolumeGridNodeScalarQuantity::buildCustomUI() {
       refresh();
     }
   }
+
+  if (volumeVizEnabled.get()) {
+    if (!gridcubeVizEnabled.get()) {
+      buildScalarUI(); // the colormap is also used for the volume
+    }
+    ImGui::TextUnformatted("Volume:");
+
+    ImGui::PushItemWidth(200);
+    bool rampChanged = false;
+    rampChanged |= ImGui::SliderFloat("transparent at", &volumeOpacityStart.get(), vizRange.first, vizRange.second, "%.4e");
+    rampChanged |= ImGui::SliderFloat("opaque at", &volumeOpacityEnd.get(), vizRange.first, vizRange.second, "%.4e");
+    if (rampChanged) {
+      setVolumeOpacityRamp(getVolumeOpacityRamp().first, getVolumeOpacityRamp().second);
+    }
+    if (ImGui::SliderFloat("density", &volumeDensity.get(), 0.001f, 10.f, "%.3f",
+                           ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
+      setVolumeDensity(getVolumeDensity());
+    }
+    if (ImGui::SliderFloat("step size", &volumeStepSize.get(), 0.05f, 2.f, "%.3f",
+                           ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
+      setVolumeStepSize(getVolumeStepSize());
+    }
+    ImGui::PopItemWidth();
+
+    if (ImGui::Checkbox("isosurface", &volumeIsosurfaceEnabled.get())) {
+      setVolumeIsosurfaceEnabled(getVolumeIsosurfaceEnabled());
+    }
+    if (volumeIsosurfaceEnabled.get() && !isosurfaceVizEnabled.get()) {
+      ImGui::SameLine();
+      if (ImGui::ColorEdit3("##VolumeIsoColor", &isosurfaceColor.get()[0], ImGuiColorEditFlags_NoInputs)) {
+        setIsosurfaceColor(getIsosurfaceColor());
+      }
+      ImGui::SameLine();
+      ImGui::PushItemWidth(120);
+      // the level is only a uniform for the volume, so it can be set directly while dragging
+      if (ImGui::SliderFloat("##VolumeIsoLevel", &isosurfaceLevel.get(), vizRange.first, vizRange.second, "%.4e")) {
+        isosurfaceLevel.manuallyChanged();
+        internal::sceneGeometryVersion++;
+        requestRedraw();
+      }
+      ImGui::PopItemWidth();
+    }
+  }
 }
 
 std::string VolumeGridNodeScalarQuantity::niceName() { return name + " (node scalar)"; }
@@ -92,6 +208,7 @@ bool VolumeGridNodeScalarQuantity::isDrawingGridcubes() { return isEnabled() &&
 void VolumeGridNodeScalarQuantity::refresh() {
   gridcubeProgram.reset();
   isosurfaceProgram.reset();
+  volumeProgram.reset();
 }
 
 void VolumeGridNodeScalarQuantity::draw() {
@@ -134,6 +251,50 @@ void VolumeGridNodeScalarQuantity::draw() {
   }
 }
 
+void VolumeGridNodeScalarQuantity::drawDelayed() {
+  if (!isEnabled()) return;
+
+  // The volume is blended over everything else, so it is drawn after the rest of the scene
+  if (volumeVizEnabled.get()) {
+    if (volumeProgram == nullptr) {
+      createVolumeProgram();
+    }
+
+    // Pick up any updates to the values
+    if (blockValuesSourceVersion != values.getDataVersion()) {
+      blockMinValues.recomputeIfPopulated();
+    }
+
+    parent.setStructureUniforms(*volumeProgram);
+    render::engine->setMaterialUniforms(*volumeProgram, parent.getMaterial());
+    glm::mat4 invModelView = glm::inverse(parent.getModelView());
+    glm::mat4 P = view::getCameraPerspectiveMatrix();
+    glm::mat4 Pinv = glm::inverse(P);
+    volumeProgram->setUniform("u_invModelView", glm::value_ptr(invModelView));
+    volumeProgram->setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
+    volumeProgram->setUniform("u_viewport", render::engine->getCurrentViewport());
+    volumeProgram->setUniform("u_boundMin", parent.getBoundMin());
+    volumeProgram->setUniform("u_boundMax", parent.getBoundMax());
+    volumeProgram->setUniform("u_rangeLow", vizRange.first);
+    volumeProgram->setUniform("u_rangeHigh", vizRange.second);
+    volumeProgram->setUniform("u_opacityStart", volumeOpacityStart.get());
+    volumeProgram->setUniform("u_opacityEnd", volumeOpacityEnd.get());
+    volumeProgram->setUniform("u_density", volumeDensity.get());
+    volumeProgram->setUniform("u_stepSize", volumeStepSize.get());
+    volumeProgram->setUniform("u_isoEnabled", static_cast<int>(volumeIsosurfaceEnabled.get()));
+    volumeProgram->setUniform("u_isoLevel", isosurfaceLevel.get());
+    volumeProgram->setUniform("u_isoColor", getIsosurfaceColor());
+
+    // Test against (but do not write) the depth of the scene, and blend the premultiplied result over it
+    render::engine->setBackfaceCull(false);
+    render::engine->setDepthMode(DepthMode::LEqualReadOnly);
+    render::engine->setBlendMode(BlendMode::AlphaOver);
+    volumeProgram->draw();
+    render::engine->setBackfaceCull(); // return to default setting
+    render::engine->applyTransparencySettings();
+  }
+}
+
 void VolumeGridNodeScalarQuantity::createGridcubeProgram() {
 
 
@@ -206,6 +367,161 @@ void VolumeGridNodeScalarQuantity::createIsosurfaceProgram() {
   render::engine->setMaterial(*isosurfaceProgram, parent.getMaterial());
 }
 
+void VolumeGridNodeScalarQuantity::createVolumeProgram() {
+
+  // clang-format off
+  volumeProgram = render::engine->requestShader("GRID_VOLUME_RAYMARCH",
+      render::engine->addMaterialRules(parent.getMaterial(), {}),
+      render::ShaderReplacementDefaults::Process
+    );
+  // clang-format on
+
+  // The bounding box, as triangles which are counter-clockwise when seen from outside
+  std::vector<glm::vec3> boxPositions;
+  for (int iAxis = 0; iAxis < 3; iAxis++) {
+    for (int iSide = 0; iSide < 2; iSide++) {
+      glm::vec3 normal{0., 0., 0.};
+      normal[iAxis] = iSide == 0 ? -1.f : 1.f;
+
+      std::array<glm::vec3, 4> corners;
+      for (int iCorner = 0; iCorner < 4; iCorner++) {
+        glm::vec3 corner;
+        corner[iAxis] = static_cast<float>(iSide);
+        corner[(iAxis + 1) % 3] = static_cast<float>(iCorner == 1 || iCorner == 2);
+        corner[(iAxis + 2) % 3] = static_cast<float>(iCorner >= 2);
+        corners[iCorner] = corner;
+      }
+      if (glm::dot(glm::cross(corners[1] - corners[0], corners[2] - corners[0]), normal) < 0.) {
+        std::swap(corners[1], corners[3]);
+      }
+
+      for (int iCorner : {0, 1, 2, 0, 2, 3}) {
+        boxPositions.push_back(corners[iCorner]);
+      }
+    }
+  }
+  volumeProgram->setAttribute("a_referencePosition", boxPositions);
+
+  volumeProgram->setTextureFromColormap("t_colormap", cMap.get());
+  volumeProgram->setTextureFromBuffer("t_value", values.getRenderTextureBuffer().get());
+  values.getRenderTextureBuffer().get()->setFilterMode(FilterMode::Linear);
+  volumeProgram->setTextureFromBuffer("t_blockMin", blockMinValues.getRenderTextureBuffer().get());
+  volumeProgram->setTextureFromBuffer("t_blockMax", blockMaxValues.getRenderTextureBuffer().get());
+  render::engine->setMaterial(*volumeProgram, parent.getMaterial());
+}
+
+glm::vec4 VolumeGridNodeScalarQuantity::marchVolumeRay(glm::vec3 rayStart, glm::vec3 rayDir, bool skipEmptySpace) {
+  // NOTE: this mirrors FLEX_GRID_VOLUME_RAYMARCH_FRAG_SHADER, keep them in sync
+
+  values.ensureHostBufferPopulated();
+  blockMinValues.ensureHostBufferPopulated();
+  if (blockValuesSourceVersion != values.getDataVersion()) {
+    blockMinValues.recomputeIfPopulated();
+  }
+  const std::vector<double>& vals = values.data;
+  const render::ValueColorMap& cmap = render::engine->getColorMap(cMap.get());
+
+  const glm::uvec3 nodeDimU = parent.getGridNodeDim();
+  const glm::vec3 nodeDim(nodeDimU);
+  const glm::vec3 spacing = parent.gridSpacing();
+  const glm::uvec3 blockDim = getVolumeBlockDim();
+  const float rangeLow = vizRange.first;
+  const float rangeHigh = vizRange.second;
+  const float opacityStart = volumeOpacityStart.get();
+  const float opacityEnd = volumeOpacityEnd.get();
+  const bool isoEnabled = volumeIsosurfaceEnabled.get();
+  const float isoLevel = isosurfaceLevel.get();
+  const float blockSize = static_cast<float>(VOLUME_BLOCK_SIZE);
+
+  // trilinear interpolation of the node values, clamped to the grid like the texture
+  auto sampleValue = [&](glm::vec3 nodeCoord) {
+    glm::vec3 c = glm::clamp(nodeCoord, glm::vec3(0.f), nodeDim - 1.f);
+    glm::uvec3 i0 = glm::min(glm::uvec3(glm::floor(c)), nodeDimU - 2u);
+    glm::vec3 f = c - glm::vec3(i0);
+    float result = 0.f;
+    for (uint32_t d = 0; d < 8; d++) {
+      glm::uvec3 offset{d >> 2, (d >> 1) & 1u, d & 1u};
+      float w = (offset.x ? f.x : 1.f - f.x) * (offset.y ? f.y : 1.f - f.y) * (offset.z ? f.z : 1.f - f.z);
+      result += w * static_cast<float>(vals[parent.flattenNodeIndex(i0 + offset)]);
+    }
+    return result;
+  };
+
+  auto volumeOpacity = [&](float val) {
+    float width = opacityEnd - opacityStart;
+    if (width == 0.f) return val >= opacityStart ? 1.f : 0.f;
+    return glm::clamp((val - opacityStart) / width, 0.f, 1.f);
+  };
+
+  // March in node index coordinates, where node (i,j,k) is at (i,j,k)
+  rayDir = glm::normalize(rayDir);
+  glm::vec3 startN = (rayStart - parent.getBoundMin()) / spacing;
+  glm::vec3 dirN = rayDir / spacing;
+  glm::vec3 invDirN;
+  for (int i = 0; i < 3; i++) {
+    invDirN[i] = 1.f / (std::abs(dirN[i]) < 1e-20f ? 1e-20f : dirN[i]);
+  }
+
+  // Clip the ray to the box
+  glm::vec3 tA = (glm::vec3(0.f) - startN) * invDirN;
+  glm::vec3 tB = (nodeDim - 1.f - startN) * invDirN;
+  glm::vec3 tNear = glm::min(tA, tB);
+  glm::vec3 tFar = glm::max(tA, tB);
+  float tEnter = std::fmax(std::fmax(std::fmax(tNear.x, tNear.y), tNear.z), 0.f);
+  float tExit = std::fmin(std::fmin(tFar.x, tFar.y), tFar.z);
+  glm::vec4 accum{0.f, 0.f, 0.f, 0.f};
+  if (tExit <= tEnter) return accum;
+
+  float ds = volumeStepSize.get() * parent.minGridSpacing();
+  float stepExtinction = volumeDensity.get() * volumeStepSize.get();
+  int nSteps = std::min(static_cast<int>(std::ceil((tExit - tEnter) / ds)), VOLUME_MAX_STEPS);
+
+  float prevVal = 0.f;
+  int iStep = 0;
+  while (iStep < nSteps) {
+    float t = tEnter + static_cast<float>(iStep) * ds;
+    glm::vec3 nodeCoord = startN + t * dirN;
+    float val = sampleValue(nodeCoord);
+
+    // stop at the first crossing of the isovalue
+    if (isoEnabled && iStep > 0 && ((prevVal < isoLevel) != (val < isoLevel))) {
+      accum += (1.f - accum.a) * glm::vec4(getIsosurfaceColor(), 1.f);
+      break;
+    }
+    prevVal = val;
+
+    float alpha = 1.f - std::exp(-stepExtinction * volumeOpacity(val));
+    if (alpha > 0.f) {
+      float rangeTVal = glm::clamp((val - rangeLow) / (rangeHigh - rangeLow), 0.f, 1.f);
+      glm::vec3 color = cmap.getValue(rangeTVal);
+      accum += (1.f - accum.a) * glm::vec4(alpha * color, alpha);
+      if (accum.a > 0.99f) break;
+      iStep++;
+      continue;
+    }
+
+    // Empty space skipping: if nothing in this block can be visible, jump to the last sample inside it
+    int stepInc = 1;
+    if (skipEmptySpace) {
+      glm::ivec3 block = glm::clamp(glm::ivec3(glm::floor(nodeCoord / blockSize)), glm::ivec3(0),
+                                    glm::ivec3(blockDim) - 1);
+      size_t iBlock = (static_cast<size_t>(block.x) * blockDim.y + block.y) * blockDim.z + block.z;
+      float blockMin = blockMinValues.data[iBlock];
+      float blockMax = blockMaxValues.data[iBlock];
+      bool blockHasIso = isoEnabled && blockMin <= isoLevel && isoLevel <= blockMax;
+      if (std::fmax(volumeOpacity(blockMin), volumeOpacity(blockMax)) == 0.f && !blockHasIso) {
+        glm::vec3 blockLow = glm::vec3(block) * blockSize;
+        glm::vec3 tBlockFar = glm::max((blockLow - startN) * invDirN, (blockLow + blockSize - startN) * invDirN);
+        float tBlockExit = std::fmin(std::fmin(tBlockFar.x, tBlockFar.y), tBlockFar.z);
+        stepInc = std::max(static_cast<int>(std::floor((tBlockExit - t) / ds)), 1);
+      }
+    }
+    iStep += stepInc;
+  }
+
+  return accum;
+}
+
 SurfaceMesh* VolumeGridNodeScalarQuantity::registerIsosurfaceAsMesh(std::string structureName) {
 
   // set the name to default
@@ -237,6 +553,7 @@ void VolumeGridNodeScalarQuantity::buildNodeInfoGUI(size_t ind) {
 
 VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setGridcubeVizEnabled(bool val) {
   gridcubeVizEnabled = val;
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return this;
 }
@@ -244,6 +561,7 @@ bool VolumeGridNodeScalarQuantity::getGridcubeVizEnabled() { return gridcubeVizE
 
 VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setIsosurfaceVizEnabled(bool val) {
   isosurfaceVizEnabled = val;
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return this;
 }
@@ -252,6 +570,7 @@ bool VolumeGridNodeScalarQuantity::getIsosurfaceVizEnabled() { return isosurface
 VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setIsosurfaceLevel(float val) {
   isosurfaceLevel = val;
   isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return this;
 }
@@ -267,21 +586,68 @@ glm::vec3 VolumeGridNodeScalarQuantity::getIsosurfaceColor() { return isosurface
 VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setSlicePlanesAffectIsosurface(bool val) {
   slicePlanesAffectIsosurface = val;
   isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return this;
 }
 bool VolumeGridNodeScalarQuantity::getSlicePlanesAffectIsosurface() { return slicePlanesAffectIsosurface.get(); }
 
+VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setVolumeVizEnabled(bool val) {
+  volumeVizEnabled = val;
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+  return this;
+}
+bool VolumeGridNodeScalarQuantity::getVolumeVizEnabled() { return volumeVizEnabled.get(); }
+
+VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setVolumeOpacityRamp(float start, float end) {
+  volumeOpacityStart = start;
+  volumeOpacityEnd = end;
+  requestRedraw();
+  return this;
+}
+std::pair<float, float> VolumeGridNodeScalarQuantity::getVolumeOpacityRamp() {
+  return std::make_pair(volumeOpacityStart.get(), volumeOpacityEnd.get());
+}
+
+VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setVolumeDensity(float val) {
+  volumeDensity = val;
+  requestRedraw();
+  return this;
+}
+float VolumeGridNodeScalarQuantity::getVolumeDensity() { return volumeDensity.get(); }
+
+VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setVolumeStepSize(float val) {
+  if (!(val > 0.f)) {
+    exception("volume step size must be positive");
+    return this;
+  }
+  volumeStepSize = val;
+  requestRedraw();
+  return this;
+}
+float VolumeGridNodeScalarQuantity::getVolumeStepSize() { return volumeStepSize.get(); }
+
+VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setVolumeIsosurfaceEnabled(bool val) {
+  volumeIsosurfaceEnabled = val;
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+  return this;
+}
+bool VolumeGridNodeScalarQuantity::getVolumeIsosurfaceEnabled() { return volumeIsosurfaceEnabled.get(); }
+
 // ========================================================
 // ==========            Cell Scalar             ==========
 // ========================================================
 
 VolumeGridCellScalarQuantity::VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_,
-                                                           const std::vector<double>& values_, DataType dataType_)
-    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, values_, dataType_),
+                                                           std::vector<double> values_, DataType dataType_)
+    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, std::move(values_), dataType_),
       gridcubeVizEnabled(parent.uniquePrefix() + "#" + name + "#gridcubeVizEnabled", true) {
 
-  values.setTextureSize(parent.getGridCellDim().x, parent.getGridCellDim().y, parent.getGridCellDim().z);
+  // GL textures have x changing fastest, but the values have z changing fastest, so the texture axes are (z,y,x)
+  glm::uvec3 cellDim = parent.getGridCellDim();
+  values.setTextureSize(cellDim.z, cellDim.y, cellDim.x);
 }
 
 
@@ -380,6 +746,7 @@ void VolumeGridCellScalarQuantity::buildCellInfoGUI(size_t ind) {
 
 VolumeGridCellScalarQuantity* VolumeGridCellScalarQuantity::setGridcubeVizEnabled(bool val) {
   gridcubeVizEnabled = val;
+  internal::sceneGeometryVersion++;
   requestRedraw();
   return this;
 }
@@ -4,8 +4,10 @@
 
 #include "polyscope/color_management.h"
 #include "polyscope/combining_hash_functions.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/utilities.h"
 #include "polyscope/volume_mesh_quantity.h"
@@ -13,6 +15,7 @@
 #include "imgui.h"
 
 #include <algorithm>
+#include <limits>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -118,6 +121,11 @@ faceType(               this, uniquePrefix() + "faceType",            faceTypeDa
 // other internally-computed geometry
 faceNormals(            this, uniquePrefix() + "faceNormals",         faceNormalsData,        std::bind(&VolumeMesh::computeFaceNormals, this)),
 cellCenters(            this, uniquePrefix() + "cellCenters",         cellCentersData,        std::bind(&VolumeMesh::computeCellCenters, this)),         
+tetCornerVertexInds{{
+  {this, uniquePrefix() + "tetCornerVertexInds1", tetCornerVertexIndsData[0], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 0)},
+  {this, uniquePrefix() + "tetCornerVertexInds2", tetCornerVertexIndsData[1], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 1)},
+  {this, uniquePrefix() + "tetCornerVertexInds3", tetCornerVertexIndsData[2], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 2)},
+  {this, uniquePrefix() + "tetCornerVertexInds4", tetCornerVertexIndsData[3], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 3)}}},
 
 
 // == core input data
@@ -143,6 +151,13 @@ activeLevelSetQuantity(nullptr)
   desatColorHSV.y *= 0.3;
   interiorColor.setPassive(HSVtoRGB(desatColorHSV));
 
+  // the buffers which each compute function reads
+  faceNormals.addComputeDependency(vertexPositions);
+  cellCenters.addComputeDependency(vertexPositions);
+
+  // staged positions need the same follow-up as updateVertexPositions()
+  vertexPositions.stagedDataFunc = std::bind(&VolumeMesh::geometryChanged, this);
+
   computeCounts();
   computeConnectivityData();
   updateObjectSpaceBounds();
@@ -367,38 +382,10 @@ void VolumeMesh::removeSlicePlaneListener(polyscope::SlicePlane* sp) {
 }
 
 void VolumeMesh::fillSliceGeometryBuffers(render::ShaderProgram& program) {
-
-  // TODO update this to use new standalone buffers
-
-  ensureHaveTets();
-  vertexPositions.ensureHostBufferPopulated();
-
-  // TODO port this to managed buffers
-
-  std::vector<glm::vec3> point1;
-  std::vector<glm::vec3> point2;
-  std::vector<glm::vec3> point3;
-  std::vector<glm::vec3> point4;
-  size_t tetCount = tets.size();
-  point1.resize(tetCount);
-  point2.resize(tetCount);
-  point3.resize(tetCount);
-  point4.resize(tetCount);
-  for (size_t tetIdx = 0; tetIdx < tets.size(); tetIdx++) {
-    point1[tetIdx] = vertexPositions.data[tets[tetIdx][0]];
-    point2[tetIdx] = vertexPositions.data[tets[tetIdx][1]];
-    point3[tetIdx] = vertexPositions.data[tets[tetIdx][2]];
-    point4[tetIdx] = vertexPositions.data[tets[tetIdx][3]];
+  for (int i = 0; i < 4; i++) {
+    program.setAttribute("a_point_" + std::to_string(i + 1),
+                         vertexPositions.getIndexedRenderAttributeBuffer(tetCornerVertexInds[i]));
   }
-
-  program.setAttribute("a_point_1", point1);
-  program.setAttribute("a_point_2", point2);
-  program.setAttribute("a_point_3", point3);
-  program.setAttribute("a_point_4", point4);
-  program.setAttribute("a_slice_1", point1);
-  program.setAttribute("a_slice_2", point2);
-  program.setAttribute("a_slice_3", point3);
-  program.setAttribute("a_slice_4", point4);
 }
 
 
@@ -412,6 +399,14 @@ void VolumeMesh::setLevelSetQuantity(VolumeMeshVertexScalarQuantity* quantity) {
 }
 
 
+void VolumeMesh::gatherBuffersForDraw(std::vector<render::PendingBufferCompute>& computes) {
+  // the geometry buffers used by fillGeometryBuffers()
+  faceNormals.gatherPendingCompute(computes);
+  if (wantsCullPosition()) {
+    cellCenters.gatherPendingCompute(computes);
+  }
+}
+
 void VolumeMesh::draw() {
   if (!isEnabled()) {
     return;
@@ -450,9 +445,11 @@ void VolumeMesh::draw() {
 
   // Draw the quantities
   for (auto& x : quantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
   for (auto& x : floatingQuantities) {
+    profiler::ScopedTimer timer("draw quantity: ", x.second->name);
     x.second->draw();
   }
 }
@@ -509,6 +506,7 @@ void VolumeMesh::preparePick() {
                                               render::ShaderReplacementDefaults::Pick);
 
   fillGeometryBuffers(*pickProgram);
+  triangleVertexInds.ensureHostBufferPopulated();
 
   // == Sort out element counts and index ranges
 
@@ -520,70 +518,33 @@ void VolumeMesh::preparePick() {
   // In "local" indices, indexing elements only within this mesh, used for reading later
   cellPickIndStart = nVertices();
 
-  // In "global" indices, indexing all elements in the scene, used to fill buffers for drawing here
-  size_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
-  size_t cellGlobalPickIndStart = pickStart + nVertices();
+  // In "global" indices, indexing all elements in the scene, used to offset indices in the shader
+  uint64_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
+  pickProgram->setUniform("u_vertexPickStart", pick::indToDigits(pickStart));
+  pickProgram->setUniform("u_facePickStart", pick::indToDigits(pickStart + cellPickIndStart));
 
   // == Fill buffers
-
-  std::vector<std::array<glm::vec3, 3>> vertexColors, edgeColors, halfedgeColors, cornerColors;
-  std::vector<glm::vec3> faceColor;
-
-  // Reserve space
-  vertexColors.resize(3 * nFacesTriangulation());
-  edgeColors.resize(3 * nFacesTriangulation());
-  halfedgeColors.resize(3 * nFacesTriangulation());
-  cornerColors.resize(3 * nFacesTriangulation());
-  faceColor.resize(3 * nFacesTriangulation());
-
-  size_t iFront = 0;
-  size_t iBack = nFacesTriangulation() - 1;
-  size_t iF = 0;
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    const std::array<uint32_t, 8>& cell = cells[iC];
-    VolumeCellType cellT = cellType(iC);
-
-    glm::vec3 cellColor = pick::indToVec(cellGlobalPickIndStart + iC);
-    std::array<glm::vec3, 3> cellColorArr{cellColor, cellColor, cellColor};
-
-    for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
-
-      // Emit the actual face in the triangulation
-      for (size_t j = 0; j < face.size(); j++) {
-        const std::array<size_t, 3>& tri = face[j];
-
-        std::array<glm::vec3, 3> vColor;
-        for (int k = 0; k < 3; k++) {
-          vColor[k] = pick::indToVec(static_cast<size_t>(cell[tri[k]]) + pickStart);
-        }
-
-        // Push exterior faces to the front of the draw buffer, and interior faces to the back.
-        // (see note above)
-        size_t iData;
-        if (faceIsInterior[iF]) {
-          iData = iBack;
-          iBack--;
-        } else {
-          iData = iFront;
-          iFront++;
-        }
-
-        for (int k = 0; k < 3; k++) faceColor[3 * iData + k] = cellColor;
-        for (int k = 0; k < 3; k++) vertexColors[3 * iData + k] = vColor;
-      }
-
-      iF++;
+  // The shader computes the pick colors from the indices. The cell index of each triangle is already in the right
+  // (front/back sorted) order, and the vertex indices just need to be gathered per-triangle.
+
+  pickProgram->setAttribute("a_faceInd", triangleCellInds.getRenderAttributeBuffer());
+
+  size_t nTri = nFacesTriangulation();
+  const std::vector<uint32_t>& triVerts = triangleVertexInds.data;
+  std::vector<glm::uvec3> vertexInds(3 * nTri);
+  parallelForRanges(nTri, [&](size_t iStart, size_t iEnd) {
+    for (size_t iTri = iStart; iTri < iEnd; iTri++) {
+      glm::uvec3 inds{triVerts[3 * iTri + 0], triVerts[3 * iTri + 1], triVerts[3 * iTri + 2]};
+      for (size_t k = 0; k < 3; k++) vertexInds[3 * iTri + k] = inds;
     }
-  }
+  });
 
   // === Store data in buffers
 
-  std::shared_ptr<render::AttributeBuffer> vertexColorsBuff =
-      render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-  vertexColorsBuff->setData(vertexColors);
-
-  pickProgram->setAttribute("a_vertexColors", vertexColorsBuff);
-  pickProgram->setAttribute("a_faceColor", faceColor);
+  std::shared_ptr<render::AttributeBuffer> vertexIndsBuff =
+      render::engine->generateAttributeBuffer(RenderDataType::Vector3UInt);
+  vertexIndsBuff->setData(vertexInds);
+  pickProgram->setAttribute("a_vertexInds", vertexIndsBuff);
 }
 
 std::vector<std::string> VolumeMesh::addVolumeMeshRules(std::vector<std::string> initRules, bool withSurfaceShade,
@@ -772,6 +733,79 @@ void VolumeMesh::computeFaceNormals() {
 }
 
 
+void VolumeMesh::computeTetCornerVertexInds(int iCorner) {
+  ensureHaveTets();
+
+  std::vector<uint32_t>& inds = tetCornerVertexInds[iCorner].data;
+  inds.resize(tets.size());
+  for (size_t iT = 0; iT < tets.size(); iT++) {
+    inds[iT] = tets[iT][iCorner];
+  }
+
+  tetCornerVertexInds[iCorner].markHostBufferUpdated();
+}
+
+void VolumeMesh::ensureHaveTetBVH() {
+  ensureHaveTets();
+  vertexPositions.ensureHostBufferPopulated();
+
+  // note: populating the host buffer above may bump the version, so check it after
+  if (tetBVH.nPrimitives() == tets.size() && tetBVHPositionsVersion == vertexPositions.getDataVersion()) return;
+
+  // Bounding box of each tet
+  const std::vector<glm::vec3>& pos = vertexPositions.data;
+  std::vector<std::array<glm::vec3, 2>> tetBoxes(tets.size());
+  parallelForRanges(tets.size(), [&](size_t iStart, size_t iEnd) {
+    for (size_t iT = iStart; iT < iEnd; iT++) {
+      glm::vec3 boxMin = pos[tets[iT][0]];
+      glm::vec3 boxMax = boxMin;
+      for (int k = 1; k < 4; k++) {
+        boxMin = glm::min(boxMin, pos[tets[iT][k]]);
+        boxMax = glm::max(boxMax, pos[tets[iT][k]]);
+      }
+      tetBoxes[iT] = {boxMin, boxMax};
+    }
+  });
+
+  if (tetBVH.nPrimitives() == tets.size() && !tetBVH.empty()) {
+    tetBVH.refit(tetBoxes);
+  } else {
+    tetBVH.build(tetBoxes);
+  }
+  tetBVHPositionsVersion = vertexPositions.getDataVersion();
+}
+
+void VolumeMesh::gatherTetsInSlab(glm::vec3 normal, float planeMin, float planeMax, std::vector<uint32_t>& tetInds) {
+  ensureHaveTetBVH();
+
+  tetInds.clear();
+  const std::vector<glm::vec3>& pos = vertexPositions.data;
+  glm::vec3 absNormal = glm::abs(normal);
+
+  // Skip subtrees whose box does not reach in to the slab
+  auto boxInSlab = [&](glm::vec3 boxMin, glm::vec3 boxMax) {
+    float boxCenter = glm::dot(normal, 0.5f * (boxMin + boxMax));
+    float boxRadius = glm::dot(absNormal, 0.5f * (boxMax - boxMin));
+    return boxCenter + boxRadius >= planeMin && boxCenter - boxRadius <= planeMax;
+  };
+
+  // Then test the tets themselves, which is tighter than their boxes
+  auto testTet = [&](uint32_t iT) {
+    float tetMin = std::numeric_limits<float>::infinity();
+    float tetMax = -std::numeric_limits<float>::infinity();
+    for (int k = 0; k < 4; k++) {
+      float d = glm::dot(normal, pos[tets[iT][k]]);
+      tetMin = std::fmin(tetMin, d);
+      tetMax = std::fmax(tetMax, d);
+    }
+    if (tetMax >= planeMin && tetMin <= planeMax) {
+      tetInds.push_back(iT);
+    }
+  };
+
+  tetBVH.traverse(boxInSlab, testTet);
+}
+
 void VolumeMesh::computeCellCenters() {
 
   vertexPositions.ensureHostBufferPopulated();
@@ -798,6 +832,95 @@ void VolumeMesh::computeCellCenters() {
   cellCenters.markHostBufferUpdated();
 }
 
+void VolumeMesh::prepareRayCast() {
+
+  vertexPositions.ensureHostBufferPopulated();
+  triangleVertexInds.ensureHostBufferPopulated();
+  triangleCellInds.ensureHostBufferPopulated();
+  cellPickIndStart = nVertices(); // as in preparePick()
+
+  size_t nTri = nFacesTriangulation();
+  bool haveBVH = rayCastBVH.nPrimitives() == nTri && !rayCastBVH.empty();
+  if (haveBVH && rayCastBVHPositionsVersion == vertexPositions.getDataVersion()) return;
+
+  const std::vector<glm::vec3>& pos = vertexPositions.data;
+  const std::vector<uint32_t>& triVerts = triangleVertexInds.data;
+  std::vector<std::array<glm::vec3, 2>> triBoxes(nTri);
+  parallelForRanges(nTri, [&](size_t iStart, size_t iEnd) {
+    for (size_t iTri = iStart; iTri < iEnd; iTri++) {
+      glm::vec3 pA = pos[triVerts[3 * iTri + 0]];
+      glm::vec3 pB = pos[triVerts[3 * iTri + 1]];
+      glm::vec3 pC = pos[triVerts[3 * iTri + 2]];
+      triBoxes[iTri] = {glm::min(glm::min(pA, pB), pC), glm::max(glm::max(pA, pB), pC)};
+    }
+  });
+
+  if (haveBVH) {
+    rayCastBVH.refit(triBoxes);
+  } else {
+    rayCastBVH.build(triBoxes);
+  }
+  rayCastBVHPositionsVersion = vertexPositions.getDataVersion();
+}
+
+bool VolumeMesh::rayCast(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, float& tHit, size_t& localPickInd) {
+
+  // Intersect in object space. The ray parameter t is the same in both spaces.
+  glm::mat4 invTransform = glm::inverse(objectTransform.get());
+  glm::vec3 objRayStart = glm::vec3(invTransform * glm::vec4(rayStart, 1.));
+  glm::vec3 objRayDir = glm::vec3(invTransform * glm::vec4(rayDir, 0.));
+
+  const std::vector<glm::vec3>& pos = vertexPositions.data;
+  const std::vector<uint32_t>& triVerts = triangleVertexInds.data;
+  glm::vec3 hitBaryCoord;
+  auto hitTriangle = [&](uint32_t iTri, float tCurr) {
+    glm::vec3 baryCoord;
+    float t = rayTriangleIntersection(objRayStart, objRayDir, pos[triVerts[3 * iTri + 0]], pos[triVerts[3 * iTri + 1]],
+                                      pos[triVerts[3 * iTri + 2]], baryCoord);
+    if (!(t >= 0. && t < tCurr) || isCulledBySlicePlanes(rayStart + t * rayDir)) {
+      return std::numeric_limits<float>::infinity();
+    }
+    hitBaryCoord = baryCoord;
+    return t;
+  };
+
+  std::pair<uint64_t, float> hit = rayCastBVH.closestRayHit(objRayStart, objRayDir, tMax, hitTriangle);
+  if (hit.first == INVALID_IND_64) return false;
+  tHit = hit.second;
+
+  // Same rule as the MESH_PROPAGATE_PICK_SIMPLE shader, see preparePick()
+  for (int i = 0; i < 3; i++) {
+    if (hitBaryCoord[i] > 1. - 0.2) {
+      localPickInd = triVerts[3 * hit.first + i];
+      return true;
+    }
+  }
+  localPickInd = cellPickIndStart + triangleCellInds.data[3 * hit.first];
+  return true;
+}
+
+void VolumeMesh::updateSelectionQuantities(const SelectionSet& selection) {
+  // Show the selected vertices and cells. Each quantity is only added once something has been selected, but is kept up
+  // to date after that.
+  cellPickIndStart = nVertices(); // as in preparePick()
+
+  std::string vertexQName = selectionQuantityPrefix + " vertices";
+  bool vertexIsNew = getQuantity(vertexQName) == nullptr;
+  if (!vertexIsNew || selection.count(0, nVertices()) > 0) {
+    VolumeMeshVertexScalarQuantity* q =
+        addVertexScalarQuantityImpl(vertexQName, selection.indicator(0, nVertices()), DataType::STANDARD);
+    if (vertexIsNew) q->setEnabled(true);
+  }
+
+  std::string cellQName = selectionQuantityPrefix + " cells";
+  bool cellIsNew = getQuantity(cellQName) == nullptr;
+  if (!cellIsNew || selection.count(cellPickIndStart, cellPickIndStart + nCells()) > 0) {
+    VolumeMeshCellScalarQuantity* q =
+        addCellScalarQuantityImpl(cellQName, selection.indicator(cellPickIndStart, nCells()), DataType::STANDARD);
+    if (cellIsNew) q->setEnabled(true);
+  }
+}
+
 void VolumeMesh::buildPickUI(size_t localPickID) {
 
   // Selection type
@@ -947,25 +1070,10 @@ VolumeCellType VolumeMesh::cellType(size_t i) const {
 };
 
 void VolumeMesh::updateObjectSpaceBounds() {
+  if (applyObjectSpaceBoundsHint()) return;
 
   vertexPositions.ensureHostBufferPopulated();
-
-  // bounding box
-  glm::vec3 min = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  glm::vec3 max = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  for (const glm::vec3& p : vertexPositions.data) {
-    min = componentwiseMin(min, p);
-    max = componentwiseMax(max, p);
-  }
-  objectSpaceBoundingBox = std::make_tuple(min, max);
-
-  // length scale, as twice the radius from the center of the bounding box
-  glm::vec3 center = 0.5f * (min + max);
-  float lengthScale = 0.0;
-  for (const glm::vec3& p : vertexPositions.data) {
-    lengthScale = std::max(lengthScale, glm::length2(p - center));
-  }
-  objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  computeObjectSpaceBoundsFromPoints(vertexPositions.data);
 }
 
 std::string VolumeMesh::typeName() { return structureTypeName; }
@@ -68,47 +68,10 @@ VolumeMeshVertexScalarQuantity::VolumeMeshVertexScalarQuantity(std::string name,
   parent.refreshVolumeMeshListeners(); // just in case this quantity is being drawn
 }
 void VolumeMeshVertexScalarQuantity::fillLevelSetData(render::ShaderProgram& p) {
-
-  // TODO refactor to use new attribute buffers
-
-  parent.vertexPositions.ensureHostBufferPopulated();
-  values.ensureHostBufferPopulated();
-
-  std::vector<glm::vec3> point1;
-  std::vector<glm::vec3> point2;
-  std::vector<glm::vec3> point3;
-  std::vector<glm::vec3> point4;
-  std::vector<glm::vec3> slice1;
-  std::vector<glm::vec3> slice2;
-  std::vector<glm::vec3> slice3;
-  std::vector<glm::vec3> slice4;
-  size_t tetCount = parent.nTets();
-  slice1.resize(tetCount);
-  slice2.resize(tetCount);
-  slice3.resize(tetCount);
-  slice4.resize(tetCount);
-  point1.resize(tetCount);
-  point2.resize(tetCount);
-  point3.resize(tetCount);
-  point4.resize(tetCount);
-  for (size_t i = 0; i < parent.nTets(); i++) {
-    point1[i] = parent.vertexPositions.data[parent.tets[i][0]];
-    point2[i] = parent.vertexPositions.data[parent.tets[i][1]];
-    point3[i] = parent.vertexPositions.data[parent.tets[i][2]];
-    point4[i] = parent.vertexPositions.data[parent.tets[i][3]];
-    slice1[i] = glm::vec3(values.data[parent.tets[i][0]], 0, 0);
-    slice2[i] = glm::vec3(values.data[parent.tets[i][1]], 0, 0);
-    slice3[i] = glm::vec3(values.data[parent.tets[i][2]], 0, 0);
-    slice4[i] = glm::vec3(values.data[parent.tets[i][3]], 0, 0);
+  for (int i = 0; i < 4; i++) {
+    p.setAttribute("a_levelSetValue_" + std::to_string(i + 1),
+                   values.getIndexedRenderAttributeBuffer(parent.tetCornerVertexInds[i]));
   }
-  p.setAttribute("a_point_1", point1);
-  p.setAttribute("a_point_2", point2);
-  p.setAttribute("a_point_3", point3);
-  p.setAttribute("a_point_4", point4);
-  p.setAttribute("a_slice_1", slice1);
-  p.setAttribute("a_slice_2", slice2);
-  p.setAttribute("a_slice_3", slice3);
-  p.setAttribute("a_slice_4", slice4);
 }
 
 void VolumeMeshVertexScalarQuantity::setLevelSetUniforms(render::ShaderProgram& p) {
@@ -122,8 +85,7 @@ void VolumeMeshVertexScalarQuantity::draw() {
   auto programToDraw = program;
   if (isDrawingLevelSet) {
     if (levelSetProgram == nullptr) {
-      levelSetProgram = createSliceProgram();
-      fillLevelSetData(*levelSetProgram);
+      levelSetProgram = createLevelSetProgram();
     }
     setLevelSetUniforms(*levelSetProgram);
     programToDraw = levelSetProgram;
@@ -141,7 +103,11 @@ void VolumeMeshVertexScalarQuantity::draw() {
   programToDraw->draw();
 }
 
-void VolumeMeshVertexScalarQuantity::setLevelSetValue(float f) { levelSetValue = f; }
+void VolumeMeshVertexScalarQuantity::setLevelSetValue(float f) {
+  levelSetValue = f;
+  internal::sceneGeometryVersion++;
+  requestRedraw();
+}
 
 void VolumeMeshVertexScalarQuantity::setEnabledLevelSet(bool v) {
   if (v) {
@@ -152,6 +118,8 @@ void VolumeMeshVertexScalarQuantity::setEnabledLevelSet(bool v) {
     isDrawingLevelSet = false;
     parent.setLevelSetQuantity(nullptr);
   }
+  internal::sceneGeometryVersion++;
+  requestRedraw();
 }
 
 void VolumeMeshVertexScalarQuantity::drawSlice(polyscope::SlicePlane* sp) {
@@ -167,7 +135,9 @@ void VolumeMeshVertexScalarQuantity::drawSlice(polyscope::SlicePlane* sp) {
   parent.setVolumeMeshUniforms(*sliceProgram);
   setScalarUniforms(*sliceProgram);
   render::engine->setMaterialUniforms(*sliceProgram, parent.getMaterial());
-  sliceProgram->draw();
+  if (sp->setSliceGeomIndex(*sliceProgram)) {
+    sliceProgram->draw();
+  }
 }
 
 void VolumeMeshVertexScalarQuantity::setLevelSetVisibleQuantity(std::string name) {
@@ -181,24 +151,10 @@ void VolumeMeshVertexScalarQuantity::setLevelSetVisibleQuantity(std::string name
     return;
   }
 
-  // clang-format off
-  levelSetProgram = render::engine->requestShader("SLICE_TETS", 
-      render::engine->addMaterialRules(parent.getMaterial(),
-        parent.addVolumeMeshRules(
-          addScalarRules(
-            {"SLICE_TETS_PROPAGATE_VALUE"}), 
-        true, true)
-      )
-    );
-  // clang-format on
-
-  // Fill color buffers
-  parent.fillSliceGeometryBuffers(*levelSetProgram);
-  q->fillSliceColorBuffers(*levelSetProgram);
-  render::engine->setMaterial(*levelSetProgram, parent.getMaterial());
-  fillLevelSetData(*levelSetProgram);
-  setLevelSetUniforms(*levelSetProgram);
   showQuantity = q;
+  levelSetProgram = createLevelSetProgram();
+  internal::sceneGeometryVersion++;
+  requestRedraw();
 }
 
 
@@ -217,8 +173,11 @@ void VolumeMeshVertexScalarQuantity::buildCustomUI() {
   VolumeMeshScalarQuantity::buildCustomUI();
 
   if (isDrawingLevelSet) {
-    ImGui::DragFloat("##value", &levelSetValue, 0.01f, (float)hist.colormapRange.first,
-                     (float)hist.colormapRange.second);
+    if (ImGui::DragFloat("##value", &levelSetValue, 0.01f, (float)hist.colormapRange.first,
+                         (float)hist.colormapRange.second)) {
+      internal::sceneGeometryVersion++;
+      requestRedraw();
+    }
     if (ImGui::BeginMenu("Show Quantity")) {
       std::map<std::string, std::unique_ptr<polyscope::VolumeMeshQuantity>>::iterator it;
       for (it = parent.quantities.begin(); it != parent.quantities.end(); it++) {
@@ -262,7 +221,7 @@ void VolumeMeshVertexScalarQuantity::createProgram() {
 
 std::shared_ptr<render::ShaderProgram> VolumeMeshVertexScalarQuantity::createSliceProgram() {
   // clang-format off
-  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader("SLICE_TETS", 
+  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader("SLICE_TETS_INDEXED", 
       render::engine->addMaterialRules(parent.getMaterial(),
         parent.addVolumeMeshRules(
           addScalarRules(
@@ -280,35 +239,32 @@ std::shared_ptr<render::ShaderProgram> VolumeMeshVertexScalarQuantity::createSli
   return p;
 }
 
-void VolumeMeshVertexScalarQuantity::fillSliceColorBuffers(render::ShaderProgram& p) {
-
-  // TODO use new attribute buffers
-
-  values.ensureHostBufferPopulated();
-
-  size_t tetCount = parent.nTets();
-  std::vector<double> colorval_1;
-  std::vector<double> colorval_2;
-  std::vector<double> colorval_3;
-  std::vector<double> colorval_4;
+std::shared_ptr<render::ShaderProgram> VolumeMeshVertexScalarQuantity::createLevelSetProgram() {
+  // clang-format off
+  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader("SLICE_TETS", 
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addVolumeMeshRules(
+          addScalarRules(
+            {"SLICE_TETS_PROPAGATE_VALUE", "SLICE_TETS_LEVEL_SET"}
+          ), 
+        true, true)
+      )
+    );
+  // clang-format on
 
-  colorval_1.resize(tetCount);
-  colorval_2.resize(tetCount);
-  colorval_3.resize(tetCount);
-  colorval_4.resize(tetCount);
+  // Slice along this quantity, but color by the one which is shown
+  parent.fillSliceGeometryBuffers(*p);
+  showQuantity->fillSliceColorBuffers(*p);
+  fillLevelSetData(*p);
+  render::engine->setMaterial(*p, parent.getMaterial());
+  return p;
+}
 
-  for (size_t iT = 0; iT < parent.tets.size(); iT++) {
-    colorval_1[iT] = values.data[parent.tets[iT][0]];
-    colorval_2[iT] = values.data[parent.tets[iT][1]];
-    colorval_3[iT] = values.data[parent.tets[iT][2]];
-    colorval_4[iT] = values.data[parent.tets[iT][3]];
+void VolumeMeshVertexScalarQuantity::fillSliceColorBuffers(render::ShaderProgram& p) {
+  for (int i = 0; i < 4; i++) {
+    p.setAttribute("a_value_" + std::to_string(i + 1),
+                   values.getIndexedRenderAttributeBuffer(parent.tetCornerVertexInds[i]));
   }
-
-  // Store data in buffers
-  p.setAttribute("a_value_1", colorval_1);
-  p.setAttribute("a_value_2", colorval_2);
-  p.setAttribute("a_value_3", colorval_3);
-  p.setAttribute("a_value_4", colorval_4);
   p.setTextureFromColormap("t_colormap", cMap.get());
 }
 
@@ -2,10 +2,17 @@
 
 #include "polyscope_test.h"
 
+#include "polyscope/connected_components.h"
 #include "polyscope/curve_network.h"
+#include "polyscope/disjoint_sets.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/point_cloud.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/scheduler.h"
+#include "polyscope/slice_plane.h"
 #include "polyscope/surface_mesh.h"
 #include "polyscope/types.h"
 #include "polyscope/volume_mesh.h"
@@ -13,9 +20,14 @@
 #include "gtest/gtest.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <list>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 
@@ -87,3 +99,635 @@ TEST_F(PolyscopeTest, GroundPlaneTest) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, GroundPlaneEffectCachingTest) {
+  auto psMesh = registerTriangleMesh();
+  polyscope::render::GroundPlane& ground = polyscope::render::engine->groundPlane;
+  glm::mat4 orbit = glm::rotate(glm::mat4(1.), 0.1f, glm::vec3(0., 1., 0.));
+
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::ShadowOnly;
+  polyscope::refresh();
+  polyscope::show(3);
+  uint64_t nRenders = ground.getEffectRenderCount();
+
+  // Redrawing without changes reuses the shadow
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders);
+
+  // While the camera moves the shadow is reprojected, and re-rendered once it stops
+  polyscope::view::viewMat = polyscope::view::viewMat * orbit;
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders);
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 1);
+
+  // Changing the scene re-renders it
+  psMesh->setTransform(glm::translate(glm::mat4(1.), glm::vec3(0.1, 0., 0.)));
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 2);
+
+  // ...but recoloring it does not change the shadow
+  psMesh->setSurfaceColor(glm::vec3{1., 0., 0.});
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 2);
+
+  // Without temporal reuse, moving the camera re-renders
+  polyscope::options::groundPlaneTemporalReuse = false;
+  polyscope::view::viewMat = polyscope::view::viewMat * orbit;
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 3);
+  polyscope::options::groundPlaneTemporalReuse = true;
+
+  // Reflections are reused only from the same camera
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::TileReflection;
+  polyscope::refresh();
+  polyscope::frameTick();
+  nRenders = ground.getEffectRenderCount();
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders);
+  polyscope::view::viewMat = polyscope::view::viewMat * orbit;
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 1);
+
+  // The reflection shows the colors too
+  psMesh->setSurfaceColor(glm::vec3{0., 1., 0.});
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 2);
+
+  polyscope::removeAllStructures();
+}
+
+
+TEST_F(PolyscopeTest, RedrawDirtyTrackingTest) {
+  auto psPoints1 = registerPointCloud("points1");
+  auto psPoints2 = registerPointCloud("points2");
+  std::vector<glm::vec3> newPoints(psPoints2->nPoints(), glm::vec3{0.5, 0.5, 0.5});
+  std::vector<double> vScalar(psPoints2->nPoints(), 7.);
+  psPoints2->addScalarQuantity("vScalar", vScalar)->setEnabled(true);
+  polyscope::show(3);
+  ASSERT_FALSE(polyscope::redrawRequested());
+
+  // updating a visible structure redraws
+  psPoints2->updatePointPositions(newPoints);
+  EXPECT_TRUE(polyscope::redrawRequested());
+  polyscope::frameTick();
+
+  // updating a disabled structure, or its quantities, does not
+  psPoints2->setEnabled(false);
+  polyscope::frameTick();
+  psPoints2->updatePointPositions(newPoints);
+  psPoints2->getQuantity("vScalar")->refresh();
+  EXPECT_FALSE(polyscope::redrawRequested());
+
+  // re-enabling it does
+  psPoints2->setEnabled(true);
+  EXPECT_TRUE(polyscope::redrawRequested());
+  polyscope::frameTick();
+
+  // but updating a structure which is out of view does, since the new positions may be in view
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::None;
+  polyscope::view::lookAt(glm::vec3{0., 0., 50.}, glm::vec3{0., 0., 100.});
+  polyscope::frameTick();
+  psPoints2->updatePointPositions(newPoints);
+  EXPECT_TRUE(polyscope::redrawRequested());
+  polyscope::view::resetCameraToHomeView();
+
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::TileReflection;
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+
+// ============================================================
+// =============== Scene extents tests
+// ============================================================
+
+TEST_F(PolyscopeTest, SceneExtentsIncrementalUpdate) {
+
+  auto psPoints1 = registerPointCloud("points1");
+  auto psPoints2 = registerPointCloud("points2");
+  auto expectBbox = [](glm::vec3 expectMin, glm::vec3 expectMax) {
+    for (int i = 0; i < 3; i++) {
+      EXPECT_NEAR(std::get<0>(polyscope::state::boundingBox)[i], expectMin[i], 1e-5);
+      EXPECT_NEAR(std::get<1>(polyscope::state::boundingBox)[i], expectMax[i], 1e-5);
+    }
+  };
+  expectBbox(glm::vec3{0., 0., 0.}, glm::vec3{1., 1., 1.});
+
+  // growing the scene
+  psPoints2->translate(glm::vec3{2., 0., 0.});
+  expectBbox(glm::vec3{0., 0., 0.}, glm::vec3{3., 1., 1.});
+
+  // shrinking the scene again
+  psPoints2->resetTransform();
+  expectBbox(glm::vec3{0., 0., 0.}, glm::vec3{1., 1., 1.});
+
+  // a bounds hint replaces the data bounds
+  psPoints1->setObjectSpaceBoundsHint(glm::vec3{-1., -1., -1.}, glm::vec3{1., 1., 1.});
+  EXPECT_TRUE(psPoints1->hasObjectSpaceBoundsHint());
+  expectBbox(glm::vec3{-1., -1., -1.}, glm::vec3{1., 1., 1.});
+  psPoints1->clearObjectSpaceBoundsHint();
+  EXPECT_FALSE(psPoints1->hasObjectSpaceBoundsHint());
+  expectBbox(glm::vec3{0., 0., 0.}, glm::vec3{1., 1., 1.});
+
+  // moving and scaling the structures which define the extents always matches a full recompute
+  auto psPoints3 = registerPointCloud("points3");
+  for (int iStep = 0; iStep < 10; iStep++) {
+    float t = static_cast<float>(iStep);
+    psPoints2->setPosition(glm::vec3{std::sin(t), 2. * std::cos(t), -t});
+    psPoints3->setTransform(glm::scale(glm::mat4(1.), glm::vec3{1.f + std::abs(std::sin(t))}));
+    std::tuple<glm::vec3, glm::vec3> incrementalBbox = polyscope::state::boundingBox;
+    double incrementalLengthScale = polyscope::state::lengthScale;
+    polyscope::updateStructureExtents();
+    expectBbox(std::get<0>(incrementalBbox), std::get<1>(incrementalBbox));
+    EXPECT_NEAR(polyscope::state::lengthScale, incrementalLengthScale, 1e-5);
+  }
+
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SceneExtentsParallelBounds) {
+
+  // large enough that the bounds get computed in parallel
+  polyscope::options::maxParallelThreads = 4;
+  std::vector<glm::vec3> points(200000);
+  for (size_t i = 0; i < points.size(); i++) {
+    float t = static_cast<float>(i) / (points.size() - 1);
+    points[i] = glm::vec3{t, -2.f * t, 0.5f};
+  }
+  polyscope::PointCloud* psPoints = polyscope::registerPointCloud("big points", points);
+
+  std::tuple<glm::vec3, glm::vec3> bbox = psPoints->boundingBox();
+  EXPECT_NEAR(std::get<0>(bbox).x, 0., 1e-5);
+  EXPECT_NEAR(std::get<1>(bbox).x, 1., 1e-5);
+  EXPECT_NEAR(std::get<0>(bbox).y, -2., 1e-5);
+  EXPECT_NEAR(std::get<1>(bbox).y, 0., 1e-5);
+  EXPECT_NEAR(psPoints->lengthScale(), std::sqrt(5.f), 1e-4);
+
+  polyscope::options::maxParallelThreads = -1;
+  polyscope::removeAllStructures();
+}
+
+// ============================================================
+// =============== Staged updates from other threads
+// ============================================================
+
+TEST_F(PolyscopeTest, StagedBufferStressTest) {
+
+  // Each worker streams positions and scalar values in to its own point cloud, while the render loop keeps running
+  const int nWorkers = 16;
+  const int nUpdates = 100;
+  std::vector<polyscope::PointCloud*> clouds;
+  std::vector<std::shared_ptr<polyscope::render::BufferStagingSlot<glm::vec3>>> pointSlots;
+  std::vector<std::shared_ptr<polyscope::render::BufferStagingSlot<double>>> scalarSlots;
+  for (int iW = 0; iW < nWorkers; iW++) {
+    polyscope::PointCloud* psPoints = registerPointCloud("points" + std::to_string(iW));
+    std::vector<double> vScalar(psPoints->nPoints(), 0.);
+    polyscope::PointCloudScalarQuantity* q = psPoints->addScalarQuantity("vScalar", vScalar);
+    q->setEnabled(true);
+    clouds.push_back(psPoints);
+    pointSlots.push_back(psPoints->points.getStagingSlot());
+    scalarSlots.push_back(q->values.getStagingSlot());
+  }
+  polyscope::show(3);
+
+  std::atomic<int> nDone{0};
+  std::vector<std::thread> workers;
+  for (int iW = 0; iW < nWorkers; iW++) {
+    workers.emplace_back([&, iW]() {
+      for (int iUpdate = 1; iUpdate <= nUpdates; iUpdate++) {
+        std::vector<glm::vec3> points = pointSlots[iW]->acquire();
+        points.resize(pointSlots[iW]->getExpectedSize());
+        std::fill(points.begin(), points.end(), glm::vec3{iW, iUpdate, 0.});
+        pointSlots[iW]->publish(std::move(points));
+
+        std::vector<double> values = scalarSlots[iW]->acquire();
+        values.assign(scalarSlots[iW]->getExpectedSize(), iUpdate);
+        scalarSlots[iW]->publish(std::move(values));
+      }
+      nDone++;
+    });
+  }
+  while (nDone < nWorkers) {
+    polyscope::frameTick();
+  }
+  for (std::thread& w : workers) {
+    w.join();
+  }
+  polyscope::frameTick();
+
+  // Every cloud ends up with its worker's final update, and every update was either applied or dropped
+  for (int iW = 0; iW < nWorkers; iW++) {
+    EXPECT_EQ(clouds[iW]->points.getValue(0), glm::vec3(iW, nUpdates, 0.));
+    EXPECT_EQ(clouds[iW]->points.getValue(clouds[iW]->nPoints() - 1), glm::vec3(iW, nUpdates, 0.));
+    EXPECT_EQ(pointSlots[iW]->getPublishedCount(), nUpdates);
+    EXPECT_EQ(pointSlots[iW]->getConsumedCount() + pointSlots[iW]->getDroppedCount(), nUpdates);
+    EXPECT_GE(pointSlots[iW]->getConsumedCount(), 1u);
+    EXPECT_EQ(scalarSlots[iW]->getConsumedCount() + scalarSlots[iW]->getDroppedCount(), nUpdates);
+  }
+  EXPECT_NEAR(dynamic_cast<polyscope::PointCloudScalarQuantity*>(clouds[0]->getQuantity("vScalar"))->values.getValue(0),
+              nUpdates, 1e-6);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, StagedBufferLifetimeTest) {
+  polyscope::PointCloud* psPoints = registerPointCloud();
+  std::shared_ptr<polyscope::render::BufferStagingSlot<glm::vec3>> slot = psPoints->points.getStagingSlot();
+  EXPECT_EQ(slot, psPoints->points.getStagingSlot());
+
+  // the size is checked when publishing
+  EXPECT_THROW(slot->publish(std::vector<glm::vec3>(psPoints->nPoints() + 1)), std::runtime_error);
+
+  // the render loop drops its reference when the structure goes away, while the producer may keep publishing
+  std::weak_ptr<polyscope::render::BufferStagingSlot<glm::vec3>> weakSlot = slot;
+  polyscope::removeAllStructures();
+  polyscope::frameTick();
+  slot->publish(std::vector<glm::vec3>(slot->getExpectedSize()));
+  polyscope::frameTick();
+  EXPECT_EQ(slot->getConsumedCount(), 0u);
+  slot.reset();
+  EXPECT_TRUE(weakSlot.expired());
+}
+
+
+// ============================================================
+// =============== Scheduler tests
+// ============================================================
+
+TEST_F(PolyscopeTest, SchedulerDeferredTasksTest) {
+  polyscope::scheduler::finishDeferredTasks();
+
+  // tasks run on a later frame
+  int nRun = 0;
+  polyscope::scheduler::deferTask([&]() { nRun++; });
+  polyscope::scheduler::deferTask([&]() { nRun++; }, polyscope::scheduler::TaskPriority::High);
+  EXPECT_EQ(polyscope::scheduler::getDeferredTaskCount(), 2u);
+  EXPECT_EQ(nRun, 0);
+  for (int i = 0; i < 10 && polyscope::scheduler::getDeferredTaskCount() > 0; i++) {
+    polyscope::frameTick();
+  }
+  EXPECT_EQ(nRun, 2);
+
+  // tasks whose owner is gone are skipped
+  auto psPoints = registerPointCloud();
+  polyscope::scheduler::deferTask(psPoints->getGenericWeakHandle(), [&]() { nRun++; });
+  polyscope::removeAllStructures();
+  polyscope::scheduler::finishDeferredTasks();
+  EXPECT_EQ(nRun, 2);
+
+  // low-priority tasks wait while the user is interacting
+  polyscope::scheduler::markInteraction();
+  polyscope::scheduler::deferTask([&]() { nRun++; });
+  polyscope::frameTick();
+  EXPECT_EQ(nRun, 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  polyscope::frameTick();
+  EXPECT_EQ(nRun, 3);
+
+  // building a scalar quantity's histogram is deferred
+  psPoints = registerPointCloud();
+  std::vector<double> vScalar(psPoints->nPoints(), 7.);
+  polyscope::PointCloudScalarQuantity* q = psPoints->addScalarQuantity("vScalar", vScalar);
+  EXPECT_GT(polyscope::scheduler::getDeferredTaskCount(), 0u);
+  polyscope::scheduler::finishDeferredTasks();
+  EXPECT_EQ(polyscope::scheduler::getDeferredTaskCount(), 0u);
+
+  // the values are read when the build runs, so they may be updated in the meantime
+  q = psPoints->addScalarQuantity("vScalar2", vScalar);
+  q->updateData(std::vector<double>(psPoints->nPoints(), 3.));
+  q->setEnabled(true);
+  EXPECT_TRUE(q->getHistogram().hasPendingBuild());
+  polyscope::scheduler::finishDeferredTasks();
+  EXPECT_EQ(polyscope::scheduler::getDeferredTaskCount(), 0u);
+  EXPECT_FALSE(q->getHistogram().hasPendingBuild());
+  EXPECT_NEAR(q->getHistogram().getDataRange().first, 3., 1e-6);
+  EXPECT_NEAR(q->getHistogram().getDataRange().second, 3., 1e-6);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SchedulerFrameStatsTest) {
+  polyscope::scheduler::clearFrameTimeStats();
+  polyscope::show(10);
+
+  polyscope::scheduler::FrameTimeStats stats = polyscope::scheduler::getFrameTimeStats();
+  EXPECT_EQ(stats.nFrames, 10u);
+  EXPECT_LE(stats.p50Ms, stats.p90Ms);
+  EXPECT_LE(stats.p90Ms, stats.p99Ms);
+  EXPECT_LE(stats.p99Ms, stats.maxMs);
+  EXPECT_GT(stats.meanMs, 0.);
+  EXPECT_GE(polyscope::scheduler::getFrameBudgetMs(), 0.);
+  EXPECT_LE(polyscope::scheduler::getFrameBudgetMs(), polyscope::options::frameWorkBudgetMs);
+
+  // frames are paced to maxFPS
+  int oldMaxFPS = polyscope::options::maxFPS;
+  polyscope::options::maxFPS = 100;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 6; i++) {
+    polyscope::scheduler::waitForNextFrame();
+  }
+  double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_GE(elapsedMs, 45.);
+  polyscope::options::maxFPS = oldMaxFPS;
+}
+
+// ============================================================
+// =============== Profiler tests
+// ============================================================
+
+TEST_F(PolyscopeTest, ProfilerTest) {
+
+  polyscope::options::enableProfiler = true;
+  polyscope::profiler::clearHistory();
+
+  auto psPoints = registerPointCloud();
+  std::vector<double> vScalar(psPoints->nPoints(), 7.);
+  psPoints->addScalarQuantity("vScalar", vScalar)->setEnabled(true);
+
+  // a few extra frames, so GPU results from the first ones have a chance to arrive
+  for (int i = 0; i < 3; i++) {
+    polyscope::requestRedraw();
+    polyscope::show(3);
+  }
+
+  const std::deque<polyscope::profiler::FrameProfile>& history = polyscope::profiler::getFrameHistory();
+  ASSERT_FALSE(history.empty());
+
+  bool sawRenderScene = false;
+  bool sawQuantity = false;
+  bool sawGPUTime = false;
+  uint64_t drawCalls = 0;
+  for (const polyscope::profiler::FrameProfile& frame : history) {
+    drawCalls += frame.counters.drawCalls;
+    for (const polyscope::profiler::TimerEvent& e : frame.events) {
+      EXPECT_LE(e.cpuStartMs, e.cpuEndMs);
+      if (e.name == "renderScene") sawRenderScene = true;
+      if (e.name == "draw quantity: vScalar") sawQuantity = true;
+      if (e.gpuMs >= 0.) sawGPUTime = true;
+    }
+  }
+  EXPECT_TRUE(sawRenderScene);
+  EXPECT_TRUE(sawQuantity);
+  EXPECT_TRUE(sawGPUTime);
+  EXPECT_GT(drawCalls, 0u);
+
+  EXPECT_NE(polyscope::profiler::exportJSON().find("renderScene"), std::string::npos);
+  EXPECT_NE(polyscope::profiler::exportChromeTrace().find("traceEvents"), std::string::npos);
+
+  polyscope::options::enableProfiler = false;
+  polyscope::profiler::clearHistory();
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, RayCastPickTest) {
+
+  // One of each supported structure, side by side in the z = 0 plane
+  std::vector<glm::vec3> meshVerts{{0., 0., 0.}, {1., 0., 0.}, {1., 1., 0.}, {0., 1., 0.}};
+  std::vector<std::vector<size_t>> meshFaces{{0, 1, 2, 3}};
+  polyscope::SurfaceMesh* psMesh = polyscope::registerSurfaceMesh("mesh", meshVerts, meshFaces);
+
+  std::vector<glm::vec3> cloudPoints{{3., 0., 0.}, {3., 1., 0.}};
+  polyscope::PointCloud* psCloud = polyscope::registerPointCloud("cloud", cloudPoints);
+
+  std::vector<glm::vec3> curveNodes{{6., 0., 0.}, {6., 1., 0.}};
+  std::vector<std::array<size_t, 2>> curveEdges{{0, 1}};
+  polyscope::CurveNetwork* psCurve = polyscope::registerCurveNetwork("curve", curveNodes, curveEdges);
+
+  std::vector<glm::vec3> tetVerts{{9., 0., 0.}, {10., 0., 0.}, {9., 1., 0.}, {9., 0., 1.}};
+  std::vector<std::array<size_t, 4>> tetInds{{0, 1, 2, 3}};
+  polyscope::VolumeMesh* psVol = polyscope::registerTetMesh("vol", tetVerts, tetInds);
+
+  polyscope::show(3);
+
+  glm::vec3 down{0., 0., -1.};
+  auto castDown = [&](float x, float y) { return polyscope::pick::rayCast(glm::vec3{x, y, 5.}, down); };
+
+  // Surface mesh: a face, then a vertex
+  polyscope::pick::RayCastResult r = castDown(0.5, 0.4);
+  EXPECT_EQ(r.structure, psMesh);
+  EXPECT_EQ(r.localIndex, psMesh->nVertices());
+  EXPECT_NEAR(r.t, 5., 1e-4);
+  EXPECT_NEAR(r.position.x, 0.5, 1e-4);
+  r = castDown(0.02, 0.02);
+  EXPECT_EQ(r.structure, psMesh);
+  EXPECT_EQ(r.localIndex, 0u);
+
+  // Point cloud
+  r = castDown(3., 1.);
+  EXPECT_EQ(r.structure, psCloud);
+  EXPECT_EQ(r.localIndex, 1u);
+
+  // Curve network: a node, then the edge (which comes after the nodes)
+  r = castDown(6., 0.);
+  EXPECT_EQ(r.structure, psCurve);
+  EXPECT_EQ(r.localIndex, 0u);
+  r = castDown(6., 0.5);
+  EXPECT_EQ(r.structure, psCurve);
+  EXPECT_EQ(r.localIndex, psCurve->nNodes());
+
+  // Volume mesh: hits the slanted face at z = 0.6, in the cell
+  r = castDown(9.2, 0.2);
+  EXPECT_EQ(r.structure, psVol);
+  EXPECT_EQ(r.localIndex, psVol->nVertices());
+  EXPECT_NEAR(r.t, 4.4, 1e-4);
+
+  // Miss
+  r = castDown(20., 20.);
+  EXPECT_EQ(r.structure, nullptr);
+
+  // Batched rays give the same results
+  std::vector<glm::vec3> starts{{0.5, 0.4, 5.}, {3., 1., 5.}, {6., 0.5, 5.}, {20., 20., 5.}};
+  std::vector<glm::vec3> dirs(starts.size(), down);
+  std::vector<polyscope::pick::RayCastResult> results = polyscope::pick::rayCast(starts, dirs);
+  ASSERT_EQ(results.size(), starts.size());
+  for (size_t i = 0; i < starts.size(); i++) {
+    polyscope::pick::RayCastResult single = polyscope::pick::rayCast(starts[i], dirs[i]);
+    EXPECT_EQ(results[i].structure, single.structure);
+    EXPECT_EQ(results[i].localIndex, single.localIndex);
+  }
+
+  // Moving the geometry refits the index
+  for (glm::vec3& p : meshVerts) p.z -= 10.;
+  psMesh->updateVertexPositions(meshVerts);
+  r = castDown(0.5, 0.4);
+  EXPECT_EQ(r.structure, psMesh);
+  EXPECT_NEAR(r.t, 15., 1e-4);
+
+  // Hits in the culled half of a slice plane are ignored
+  polyscope::SlicePlane* plane = polyscope::addSceneSlicePlane();
+  plane->setPose(glm::vec3{2., 0., 0.}, glm::vec3{1., 0., 0.});
+  r = castDown(0.5, 0.4);
+  EXPECT_EQ(r.structure, nullptr);
+  r = castDown(3., 1.);
+  EXPECT_EQ(r.structure, psCloud);
+  polyscope::removeLastSceneSlicePlane();
+
+  // As the backend for regular pick queries
+  polyscope::options::pickBackend = polyscope::PickBackend::RayCast;
+  polyscope::pick::evaluatePickQuery(77, 88);
+  polyscope::show(3);
+  polyscope::options::pickBackend = polyscope::PickBackend::Render;
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, RegionSelectionTest) {
+
+  // The selection set itself
+  polyscope::SelectionSet set;
+  EXPECT_TRUE(set.empty());
+  set.insert(std::vector<size_t>{3, 64, 65, 200});
+  set.insert(3);
+  EXPECT_EQ(set.count(), 4u);
+  EXPECT_EQ(set.count(4, 66), 2u);
+  EXPECT_TRUE(set.contains(65));
+  EXPECT_FALSE(set.contains(66));
+  set.erase(64);
+  EXPECT_EQ(set.indices(), (std::vector<size_t>{3, 65, 200}));
+  EXPECT_EQ(set.indicator(64, 3), (std::vector<double>{0., 1., 0.}));
+
+  polyscope::PointCloud* psPoints = registerPointCloud();
+  polyscope::SurfaceMesh* psMesh = registerTriangleMesh();
+  std::vector<double> userSelection(psPoints->nPoints(), 0.5);
+  polyscope::PointCloudScalarQuantity* userQ = psPoints->addScalarQuantity("selection", userSelection);
+  polyscope::show(3);
+  polyscope::pick::evaluatePickQuery(77, 88); // allocates the pick indices
+
+  // Decoding pick buffer pixels, with repeats and background
+  std::vector<std::pair<polyscope::Structure*, size_t>> pixelElements{
+      {psPoints, 3}, {psPoints, 3}, {nullptr, 0}, {psMesh, 1}, {psPoints, 2}, {psPoints, 3}, {psMesh, 1}};
+  std::vector<float> pixels;
+  for (const std::pair<polyscope::Structure*, size_t>& e : pixelElements) {
+    glm::vec3 color = polyscope::pick::indToVec(polyscope::pick::localIndexToGlobal(e));
+    pixels.insert(pixels.end(), {color.x, color.y, color.z, 1.});
+  }
+  std::unordered_map<polyscope::Structure*, std::vector<size_t>> decoded = polyscope::pick::decodePickPixels(pixels);
+  EXPECT_EQ(decoded.size(), 2u);
+  EXPECT_EQ(decoded[psPoints], (std::vector<size_t>{2, 3}));
+  EXPECT_EQ(decoded[psMesh], (std::vector<size_t>{1}));
+  std::vector<char> mask{1, 1, 1, 0, 0, 1, 0};
+  decoded = polyscope::pick::decodePickPixels(pixels, mask);
+  EXPECT_EQ(decoded.size(), 1u);
+  EXPECT_EQ(decoded[psPoints], (std::vector<size_t>{3}));
+
+  // Region queries
+  polyscope::pick::selectRect(10, 20, 200, 100);
+  polyscope::pick::selectLasso({{10., 10.}, {300., 50.}, {40., 200.}}, polyscope::SelectionMode::Add);
+  polyscope::pick::evaluatePickQueryRect(500, 500, 0, 0);
+
+  // Updating selection sets
+  size_t faceInd = psMesh->nVertices() + 1;
+  polyscope::pick::applySelection({{psPoints, {0, 1, 2}}, {psMesh, {0, faceInd}}}, polyscope::SelectionMode::Replace);
+  polyscope::pick::applySelection({{psPoints, {1}}}, polyscope::SelectionMode::Remove);
+  polyscope::pick::applySelection({{psPoints, {3}}}, polyscope::SelectionMode::Add);
+  EXPECT_EQ(polyscope::pick::getSelectionSet(psPoints).indices(), (std::vector<size_t>{0, 2, 3}));
+  EXPECT_EQ(polyscope::pick::getSelectionSet(psMesh).count(), 2u);
+  EXPECT_NE(psPoints->getQuantity(polyscope::selectionQuantityPrefix), nullptr);
+  EXPECT_EQ(psPoints->getQuantity("selection"), userQ); // user quantities are never replaced
+  EXPECT_NE(psMesh->getQuantity(polyscope::selectionQuantityPrefix + " vertices"), nullptr);
+  EXPECT_NE(psMesh->getQuantity(polyscope::selectionQuantityPrefix + " faces"), nullptr);
+  polyscope::show(3);
+
+  // Replacing clears structures which are not in the new selection
+  polyscope::pick::applySelection({{psPoints, {0}}}, polyscope::SelectionMode::Replace);
+  EXPECT_TRUE(polyscope::pick::getSelectionSet(psMesh).empty());
+  polyscope::pick::setSelectionSet(psMesh, set);
+  EXPECT_EQ(polyscope::pick::getSelectionSet(psMesh), set);
+  polyscope::pick::clearSelectionSets();
+  EXPECT_TRUE(polyscope::pick::getSelectionSet(psPoints).empty());
+
+  // Removing a structure drops its selection
+  polyscope::pick::applySelection({{psPoints, {0}}}, polyscope::SelectionMode::Replace);
+  polyscope::removeAllStructures();
+  EXPECT_TRUE(polyscope::pick::getSelectionSet(psPoints).empty());
+}
+
+namespace {
+// A cheap deterministic stand-in for random links between elements
+uint64_t hashLinkTarget(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+} // namespace
+
+TEST_F(PolyscopeTest, ConnectedComponentsTest) {
+
+  // The parallel disjoint sets find the same partition as the serial ones
+  size_t n = 20000;
+  polyscope::DisjointSets serialSets(n);
+  polyscope::ParallelDisjointSets parallelSets(n);
+  for (size_t i = 0; i < n / 2; i++) {
+    size_t j = hashLinkTarget(i) % n;
+    serialSets.merge(i, j);
+    parallelSets.merge(i, j);
+  }
+  polyscope::ConnectedComponents comps = polyscope::labelConnectedComponents(parallelSets);
+  std::vector<size_t> labelOfRoot(n + 1, polyscope::INVALID_IND);
+  size_t total = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_t root = serialSets.find(i);
+    if (labelOfRoot[root] == polyscope::INVALID_IND) labelOfRoot[root] = comps.labels[i];
+    EXPECT_EQ(labelOfRoot[root], comps.labels[i]);
+  }
+  for (size_t iComp = 0; iComp < comps.nComponents(); iComp++) {
+    if (iComp > 0) {
+      EXPECT_GE(comps.sizes[iComp - 1], comps.sizes[iComp]);
+    }
+    total += comps.sizes[iComp];
+  }
+  EXPECT_EQ(total, n);
+}
+
+// Compares the parallel disjoint sets against the serial ones on a large random forest. Disabled by default since it
+// takes a while and several GB of memory; run it with --gtest_also_run_disabled_tests. The element count can be set
+// with the POLYSCOPE_BENCHMARK_SIZE environment variable.
+TEST_F(PolyscopeTest, DISABLED_ConnectedComponentsBenchmark) {
+  size_t n = 100000000;
+  if (const char* sizeStr = std::getenv("POLYSCOPE_BENCHMARK_SIZE")) n = std::stoull(sizeStr);
+  size_t nLinks = n / 2;
+
+  typedef std::chrono::steady_clock Clock;
+  auto msSince = [](Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  };
+
+  Clock::time_point serialStart = Clock::now();
+  polyscope::DisjointSets serialSets(n);
+  for (size_t i = 0; i < nLinks; i++) serialSets.merge(i, hashLinkTarget(i) % n);
+  double serialMergeMs = msSince(serialStart);
+
+  Clock::time_point parallelStart = Clock::now();
+  polyscope::ParallelDisjointSets parallelSets(n);
+  polyscope::parallelForRanges(nLinks, [&](size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) parallelSets.merge(i, hashLinkTarget(i) % n);
+  });
+  double parallelMergeMs = msSince(parallelStart);
+
+  Clock::time_point labelStart = Clock::now();
+  polyscope::ConnectedComponents comps = polyscope::labelConnectedComponents(parallelSets);
+  double labelMs = msSince(labelStart);
+
+  std::cout << "connected components of " << n << " elements with " << nLinks << " random links, "
+            << polyscope::parallelThreadCount() << " threads" << std::endl;
+  std::cout << "  DisjointSets merge:          " << serialMergeMs << " ms" << std::endl;
+  std::cout << "  ParallelDisjointSets merge:  " << parallelMergeMs << " ms" << std::endl;
+  std::cout << "  labelConnectedComponents:    " << labelMs << " ms (" << comps.nComponents() << " components)"
+            << std::endl;
+
+  // Spot-check that both agree on which elements are connected
+  for (size_t i = 0; i < 1000000; i++) {
+    size_t a = hashLinkTarget(2 * i + 1) % n;
+    size_t b = hashLinkTarget(2 * i + 2) % n;
+    ASSERT_EQ(serialSets.find(a) == serialSets.find(b), comps.labels[a] == comps.labels[b]);
+  }
+}
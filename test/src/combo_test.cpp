@@ -2,6 +2,9 @@
 
 #include "polyscope_test.h"
 
+#include "polyscope/render/mock_opengl/mock_gl_engine.h"
+#include "polyscope/viewport.h"
+
 
 // ============================================================
 // =============== Combo test
@@ -73,6 +76,240 @@ TEST_F(PolyscopeTest, TransparencyTest) {
   polyscope::removeAllStructures();
 }
 
+// Single-pass weighted transparency, with a mix of opaque and transparent structures
+TEST_F(PolyscopeTest, WeightedTransparencyTest) {
+
+  auto psMesh = registerTriangleMesh();
+  std::vector<double> vScalar(psMesh->nVertices(), 7.);
+  psMesh->addVertexScalarQuantity("vScalar", vScalar)->setEnabled(true);
+  psMesh->setTransparency(0.5);
+
+  auto psPoints = registerPointCloud();
+  auto psCurve = registerCurveNetwork();
+  psCurve->setTransparency(0.3);
+
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::Weighted;
+  polyscope::show(3);
+  EXPECT_EQ(polyscope::render::engine->getTransparencyMode(), polyscope::TransparencyMode::Weighted);
+  EXPECT_TRUE(polyscope::render::engine->transparencyEnabled());
+  EXPECT_FALSE(polyscope::render::engine->getWeightedTransparencyAccumulate());
+
+  // with a ground plane and slice plane
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::ShadowOnly;
+  polyscope::addSceneSlicePlane();
+  polyscope::show(3);
+  polyscope::removeLastSceneSlicePlane();
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::TileReflection;
+
+  // everything opaque
+  psMesh->setTransparency(1.);
+  psCurve->setTransparency(1.);
+  polyscope::show(3);
+
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+// Depth peeling stops once there is nothing left to peel, or when over budget while the camera moves
+TEST_F(PolyscopeTest, TransparencyPeelPassesTest) {
+
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::Pretty;
+  polyscope::options::transparencyRenderPasses = 8;
+  polyscope::options::transparencyPeelTimeBudgetMs = 0.;
+
+  auto psMesh = registerTriangleMesh();
+  psMesh->setTransparency(0.5);
+  polyscope::show(3);
+  EXPECT_EQ(polyscope::internal::transparencyPeelPassesLastFrame, 8);
+
+  // a tiny budget cuts the passes short while moving, then the still frame gets all of them
+  polyscope::options::transparencyPeelTimeBudgetMs = 1e-6;
+  polyscope::view::lookAt(glm::vec3{5., 3., 1.}, glm::vec3{0., 0., 0.});
+  polyscope::requestRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(polyscope::internal::transparencyPeelPassesLastFrame, 1);
+  EXPECT_TRUE(polyscope::redrawRequested());
+  polyscope::frameTick();
+  EXPECT_EQ(polyscope::internal::transparencyPeelPassesLastFrame, 8);
+
+  // an empty scene resolves in one pass, even though the ground plane draws something on every pass
+  polyscope::removeAllStructures();
+  ASSERT_EQ(polyscope::options::groundPlaneMode, polyscope::GroundPlaneMode::TileReflection);
+  polyscope::requestRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(polyscope::internal::transparencyPeelPassesLastFrame, 1);
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::ShadowOnly;
+  polyscope::requestRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(polyscope::internal::transparencyPeelPassesLastFrame, 1);
+
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::TileReflection;
+  polyscope::options::transparencyPeelTimeBudgetMs = 12.;
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
+}
+
+// Switching the transparency mode compiles the new programs over several frames, drawing the old mode meanwhile
+TEST_F(PolyscopeTest, BackgroundShaderCompileTest) {
+  auto mockEngine = dynamic_cast<polyscope::render::backend_openGL_mock::MockGLEngine*>(polyscope::render::engine);
+  ASSERT_NE(mockEngine, nullptr);
+
+  // (volume mesh quantities in weighted mode, so that the programs are not already cached by other tests)
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
+  std::vector<glm::vec3> verts;
+  std::vector<std::array<int, 8>> cells;
+  std::tie(verts, cells) = getVolumeMeshData();
+  polyscope::VolumeMesh* psVol1 = polyscope::registerVolumeMesh("vol1", verts, cells);
+  std::vector<double> vScalar(psVol1->nVertices(), 7.);
+  psVol1->addVertexScalarQuantity("vScalar", vScalar)->setEnabled(true);
+  polyscope::VolumeMesh* psVol2 = polyscope::registerVolumeMesh("vol2", verts, cells);
+  std::vector<glm::vec3> cColor(psVol2->nCells(), glm::vec3{0.2, 0.3, 0.4});
+  psVol2->addCellColorQuantity("cColor", cColor)->setEnabled(true);
+  polyscope::show(3);
+
+  mockEngine->simulatedCompileLatencyMs = 20.;
+  polyscope::options::shaderCompileBudgetMs = 1.;
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::Weighted;
+
+  polyscope::frameTick();
+  EXPECT_TRUE(polyscope::render::engine->hasPendingPrograms());
+  EXPECT_EQ(polyscope::render::engine->getTransparencyMode(), polyscope::TransparencyMode::None);
+
+  for (int i = 0; i < 100 && polyscope::render::engine->hasPendingPrograms(); i++) {
+    polyscope::frameTick();
+  }
+  EXPECT_FALSE(polyscope::render::engine->hasPendingPrograms());
+  EXPECT_EQ(polyscope::render::engine->getTransparencyMode(), polyscope::TransparencyMode::Weighted);
+
+  // switching back only needs programs which are already cached
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
+  polyscope::frameTick();
+  EXPECT_FALSE(polyscope::render::engine->hasPendingPrograms());
+  EXPECT_EQ(polyscope::render::engine->getTransparencyMode(), polyscope::TransparencyMode::None);
+
+  // forcing the switch to finish
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::Pretty;
+  polyscope::processLazyProperties();
+  EXPECT_TRUE(polyscope::render::engine->hasPendingPrograms());
+  polyscope::render::engine->finishPendingPrograms();
+  EXPECT_EQ(polyscope::render::engine->getTransparencyMode(), polyscope::TransparencyMode::Pretty);
+
+  mockEngine->simulatedCompileLatencyMs = 0.;
+  polyscope::options::shaderCompileBudgetMs = 8.;
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, TemporalAntiAliasingTest) {
+  auto psMesh = registerTriangleMesh();
+  polyscope::options::enableTAA = true;
+  polyscope::options::taaMaxSamples = 4;
+
+  // a still view accumulates samples until it converges
+  polyscope::requestRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(polyscope::render::engine->getTemporalSampleCount(), 1);
+  for (int i = 0; i < 10 && polyscope::redrawRequested(); i++) {
+    polyscope::frameTick();
+  }
+  EXPECT_EQ(polyscope::render::engine->getTemporalSampleCount(), 4);
+  EXPECT_FALSE(polyscope::redrawRequested());
+
+  // the jitter only applies while rendering
+  EXPECT_EQ(polyscope::view::getCameraPerspectiveMatrix(), polyscope::view::getUnjitteredCameraPerspectiveMatrix());
+
+  // moving the camera starts over
+  polyscope::view::viewMat = polyscope::view::viewMat * glm::rotate(glm::mat4(1.), 0.1f, glm::vec3(0., 1., 0.));
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(polyscope::render::engine->getTemporalSampleCount(), 1);
+
+  // so does changing the scene
+  polyscope::show(10);
+  psMesh->setTransparency(0.5);
+  polyscope::frameTick();
+  EXPECT_EQ(polyscope::render::engine->getTemporalSampleCount(), 1);
+
+  // screenshots wait for convergence
+  polyscope::screenshot();
+  EXPECT_EQ(polyscope::render::engine->getTemporalSampleCount(), 4);
+
+  polyscope::options::enableTAA = false;
+  polyscope::options::taaMaxSamples = 16;
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, MultiViewportTest) {
+  auto psMesh = registerTriangleMesh();
+  auto psPoints = registerPointCloud();
+
+  polyscope::Viewport* vpA = polyscope::addViewport("A");
+  polyscope::Viewport* vpB = polyscope::addViewport("B");
+  polyscope::arrangeViewportsInGrid();
+  EXPECT_EQ(vpA->getRegion(), glm::vec4(0., 0., 0.5, 1.));
+  EXPECT_EQ(vpB->getRegion(), glm::vec4(0.5, 0., 0.5, 1.));
+
+  // each viewport has its own camera and contents
+  vpB->lookAt(glm::vec3{3., 1., 0.}, glm::vec3{0., 0., 0.});
+  EXPECT_NE(vpA->getViewMatrix(), vpB->getViewMatrix());
+  vpB->setStructureVisible(psPoints, false);
+  EXPECT_TRUE(vpA->isStructureVisible(psPoints));
+  EXPECT_FALSE(vpB->isStructureVisible(psPoints));
+  vpB->setGroundPlaneEnabled(false);
+
+  polyscope::show(3);
+  EXPECT_NE(vpA->getColorTexture(), nullptr);
+  EXPECT_NE(vpB->getColorTexture(), nullptr);
+  EXPECT_EQ(polyscope::getCurrentViewport(), nullptr);
+
+  glm::vec2 centerB{0.75 * polyscope::view::windowWidth, 0.5 * polyscope::view::windowHeight};
+  EXPECT_FALSE(vpA->containsScreenCoords(centerB));
+  EXPECT_TRUE(vpB->containsScreenCoords(centerB));
+  vpB->pick(glm::ivec2{1, 1});
+
+  polyscope::removeViewport("A");
+  EXPECT_FALSE(polyscope::hasViewport("A"));
+  polyscope::show(3);
+
+  polyscope::removeAllViewports();
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, MultiViewportGroundPlaneCacheTest) {
+  auto psMesh = registerTriangleMesh();
+  auto psPoints = registerPointCloud();
+  polyscope::render::GroundPlane& ground = polyscope::render::engine->groundPlane;
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::ShadowOnly;
+
+  // Two viewports with the same camera and size, but different contents
+  polyscope::Viewport* vpA = polyscope::addViewport("A");
+  polyscope::Viewport* vpB = polyscope::addViewport("B");
+  polyscope::arrangeViewportsInGrid();
+  EXPECT_EQ(vpA->getViewMatrix(), vpB->getViewMatrix());
+  vpB->setStructureVisible(psPoints, false);
+  polyscope::frameTick();
+
+  // Neither may reuse the other's shadow, so each renders its own every frame
+  uint64_t nRenders = ground.getEffectRenderCount();
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 2);
+
+  // Drawing without viewports afterwards doesn't reuse the last viewport's shadow either
+  polyscope::removeAllViewports();
+  nRenders = ground.getEffectRenderCount();
+  polyscope::requestViewRedraw();
+  polyscope::frameTick();
+  EXPECT_EQ(ground.getEffectRenderCount(), nRenders + 1);
+
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::TileReflection;
+  polyscope::removeAllStructures();
+}
+
 // Do some slice plane stuff
 TEST_F(PolyscopeTest, SlicePlaneTest) {
 
@@ -39,6 +39,68 @@ TEST_F(PolyscopeTest, CurveNetworkPick) {
 }
 
 
+TEST_F(PolyscopeTest, CurveNetworkPolylineStrips) {
+  // A polyline with a right-angle bend, and a closed loop
+  std::vector<glm::vec3> nodes = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0}, {3, 1, 0},
+                                  {0, 0, 5}, {1, 0, 5}, {1, 1, 5}};
+  std::vector<std::array<size_t, 2>> edges = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {5, 6}, {6, 7}, {7, 5}};
+  auto psCurve = polyscope::registerCurveNetwork("strips", nodes, edges);
+  psCurve->setPolylineStrips(true);
+  EXPECT_TRUE(psCurve->getPolylineStrips());
+  polyscope::show(3);
+
+  // Every edge is drawn exactly once: 2 strips with 5 + 4 node indices, separated by one restart index
+  psCurve->polylineStripInds.ensureHostBufferPopulated();
+  EXPECT_EQ(psCurve->polylineStripInds.data.size(), 10);
+  EXPECT_EQ(psCurve->polylineStripInds.data[5], polyscope::INVALID_IND_32);
+
+  // Joints at the two ends, the right-angle bend, and the corners of the loop
+  psCurve->polylineJointInds.ensureHostBufferPopulated();
+  std::vector<uint32_t> expectedJoints = {0, 3, 4, 5, 6, 7};
+  EXPECT_EQ(psCurve->polylineJointInds.data, expectedJoints);
+
+  // Node quantities are drawn on the strips and joints too
+  std::vector<glm::vec3> vColors(psCurve->nNodes(), glm::vec3{.2, .3, .4});
+  psCurve->addNodeColorQuantity("vColor", vColors)->setEnabled(true);
+  polyscope::show(3);
+  std::vector<double> vValues(psCurve->nNodes(), 0.7);
+  psCurve->addNodeScalarQuantity("vValues", vValues)->setEnabled(true);
+  polyscope::show(3);
+
+  // Straightening the bend drops its joint
+  nodes[4] = {4, 0, 0};
+  psCurve->updateNodePositions(nodes);
+  polyscope::show(3);
+  expectedJoints = {0, 4, 5, 6, 7};
+  EXPECT_EQ(psCurve->polylineJointInds.data, expectedJoints);
+
+  // Picking and a variable radius (which falls back on separate cylinders) shouldn't crash
+  polyscope::pick::evaluatePickQuery(77, 88);
+  std::vector<double> vScalar(psCurve->nNodes(), 0.5);
+  auto q1 = psCurve->addNodeScalarQuantity("vScalar", vScalar);
+  psCurve->setNodeRadiusQuantity(q1);
+  polyscope::show(3);
+  psCurve->clearNodeRadiusQuantity();
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, CurveNetworkConnectedComponents) {
+  // Equal-sized components are ordered by their first node
+  std::vector<glm::vec3> nodes(5, glm::vec3{0., 0., 0.});
+  std::vector<std::array<size_t, 2>> edges{{4, 3}, {1, 0}};
+  polyscope::CurveNetwork* psCurve = polyscope::registerCurveNetwork("curve", nodes, edges);
+  polyscope::ConnectedComponents comps = psCurve->computeConnectedComponents();
+  EXPECT_EQ(comps.sizes, (std::vector<size_t>{2, 2, 1}));
+  EXPECT_EQ(comps.labels, (std::vector<size_t>{0, 0, 2, 1, 1}));
+  psCurve->addConnectedComponentsQuantity()->setEnabled(true);
+
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+
 TEST_F(PolyscopeTest, CurveNetworkColorNode) {
   auto psCurve = registerCurveNetwork();
   std::vector<glm::vec3> vColors(psCurve->nNodes(), glm::vec3{.2, .3, .4});
@@ -4,6 +4,8 @@
 
 #include "polyscope/floating_quantities.h"
 
+#include <thread>
+
 // ============================================================
 // =============== Floating image
 // ============================================================
@@ -71,6 +73,85 @@ TEST_F(PolyscopeTest, FloatingImageTest) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, FloatingStreamingImageTest) {
+
+  size_t dimX = 300;
+  size_t dimY = 200;
+
+  { // StreamingScalarImageQuantity, 16-bit frames from a producer thread
+    polyscope::StreamingScalarImageQuantity* im =
+        polyscope::addStreamingScalarImageQuantity("im stream depth", dimX, dimY, polyscope::ImageOrigin::UpperLeft);
+    im->setEnabled(true);
+    std::shared_ptr<polyscope::ImageStream> stream = im->getStream();
+    stream->setValueScale(0.001);
+    polyscope::show(3);
+
+    std::thread producer([&]() {
+      std::vector<uint16_t> frame(dimX * dimY);
+      for (uint16_t iFrame = 1; iFrame <= 5; iFrame++) {
+        std::fill(frame.begin(), frame.end(), static_cast<uint16_t>(1000 * iFrame));
+        stream->pushFrame(polyscope::ImageStreamFormat::UInt16, frame.data());
+      }
+    });
+    producer.join();
+    polyscope::show(3);
+    EXPECT_EQ(stream->getPushedFrameCount(), 5);
+    EXPECT_EQ(stream->getAcquiredFrameCount() + stream->getDroppedFrameCount(), 5);
+    EXPECT_NEAR(stream->currentPixels()[0], 5.0, 1e-6);
+    EXPECT_NEAR(im->getFrameRange().second, 5.0, 1e-6);
+
+    // a sub-rectangle update, followed by another which supersedes it before it is drawn
+    std::vector<float> patch(20 * 10, 9.);
+    stream->pushSubRect(polyscope::ImageStreamFormat::Float, 100, 50, 20, 10, patch.data());
+    std::vector<float> patch2(4 * 4, -2.);
+    stream->pushSubRect(polyscope::ImageStreamFormat::Float, 0, 0, 4, 4, patch2.data());
+    polyscope::show(3);
+    polyscope::ImageStreamRect changed = stream->currentChangedRect();
+    EXPECT_EQ(changed.x0, 0);
+    EXPECT_EQ(changed.x1, 120);
+    EXPECT_EQ(changed.y1, 60);
+    EXPECT_EQ(stream->currentPixels()[55 * dimX + 110], 9.);
+    EXPECT_EQ(stream->currentPixels()[0], -2.);
+    EXPECT_NEAR(im->getFrameRange().first, -2.0, 1e-6);
+    EXPECT_NEAR(im->getFrameRange().second, 9.0, 1e-6);
+
+    // each pushed frame is drawn once, acquiring it doesn't ask for another redraw
+    stream->pushSubRect(polyscope::ImageStreamFormat::Float, 0, 0, 4, 4, patch2.data());
+    EXPECT_TRUE(polyscope::redrawRequested());
+    polyscope::frameTick();
+    EXPECT_EQ(stream->getPushedFrameCount(), stream->getAcquiredFrameCount() + stream->getDroppedFrameCount());
+    EXPECT_FALSE(polyscope::redrawRequested());
+
+    im->setShowFullscreen(true);
+    polyscope::show(3);
+  }
+
+  { // StreamingColorImageQuantity, NV12 frames
+    polyscope::StreamingColorImageQuantity* im =
+        polyscope::addStreamingColorImageQuantity("im stream color", dimX, dimY, polyscope::ImageOrigin::UpperLeft);
+    im->setEnabled(true);
+    std::vector<uint8_t> frame(dimX * dimY * 3 / 2, 128);
+    std::fill(frame.begin(), frame.begin() + dimX * dimY, 235); // white in video range
+    im->pushFrame(polyscope::ImageStreamFormat::NV12, frame.data());
+    polyscope::show(3);
+    EXPECT_NEAR(im->getStream()->currentPixels()[0], 1.0, 1e-3);
+    EXPECT_EQ(im->getStream()->currentPixels()[3], 1.0);
+
+    std::vector<uint8_t> rgb(8 * 8 * 3, 0);
+    im->pushSubRect(polyscope::ImageStreamFormat::RGB8, 8, 8, 8, 8, rgb.data());
+    polyscope::show(3);
+    EXPECT_EQ(im->getStream()->currentPixels()[4 * (8 * dimX + 8)], 0.);
+
+    // wrong format for this stream
+    EXPECT_THROW(im->pushFrame(polyscope::ImageStreamFormat::Float, rgb.data()), std::runtime_error);
+
+    im->setShowFullscreen(true);
+    polyscope::show(3);
+  }
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, FloatingRenderImageTest) {
 
 
@@ -127,6 +127,69 @@ TEST_F(PolyscopeTest, PointCloudVector) {
 }
 
 
+TEST_F(PolyscopeTest, PointCloudBufferReductions) {
+  auto psPoints = registerPointCloud();
+
+  // Vector lengths, skipping non-finite entries
+  std::vector<glm::vec3> vals(psPoints->nPoints(), {1., 2., 2.});
+  vals[0] = {0., 0., 4.};
+  vals[1] = {std::nanf(""), 0., 0.};
+  auto q1 = psPoints->addVectorQuantity("vals", vals);
+  polyscope::render::BufferReduction r = q1->vectors.getReduction();
+  EXPECT_NEAR(r.minVal, 3., 1e-6);
+  EXPECT_NEAR(r.maxVal, 4., 1e-6);
+  EXPECT_EQ(r.nFinite, psPoints->nPoints() - 1);
+  EXPECT_EQ(r.nNonFinite, 1);
+
+  // The result is cached until the data changes
+  uint64_t version = q1->vectors.getDataVersion();
+  q1->vectors.getReduction();
+  EXPECT_EQ(q1->vectors.getDataVersion(), version);
+  vals[0] = {0., 0., 8.};
+  q1->updateData(vals);
+  EXPECT_GT(q1->vectors.getDataVersion(), version);
+  EXPECT_NEAR(q1->vectors.getReduction().maxVal, 8., 1e-6);
+  q1->setEnabled(true);
+  polyscope::show(3);
+
+  // Scalars, also when the data was last written on the device
+  std::vector<double> vScalar(psPoints->nPoints(), 2.);
+  vScalar[3] = -5.;
+  auto q2 = psPoints->addScalarQuantity("vScalar", vScalar);
+  EXPECT_NEAR(q2->values.getReduction().minVal, -5., 1e-6);
+  EXPECT_NEAR(q2->getDataRange().first, -5., 1e-6);
+  q2->values.getRenderAttributeBuffer()->setData(vScalar);
+  q2->values.markRenderAttributeBufferUpdated();
+  EXPECT_EQ(q2->values.getReduction().nFinite + q2->values.getReduction().nNonFinite, psPoints->nPoints());
+  polyscope::show(3);
+
+  // The on-device reduction (which the mock backend skips) leaves the render state as it found it
+  polyscope::render::engine->setDepthMode(polyscope::DepthMode::LEqual);
+  polyscope::render::engine->setBlendMode(polyscope::BlendMode::AlphaUnder);
+  polyscope::render::engine->Engine::computeBufferReduction(q2->values.getRenderAttributeBuffer(), r);
+  EXPECT_EQ(polyscope::render::engine->getDepthMode(), polyscope::DepthMode::LEqual);
+  EXPECT_EQ(polyscope::render::engine->getBlendMode(), polyscope::BlendMode::AlphaUnder);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PointCloudConnectedComponents) {
+  // Points are connected if they are within the distance of each other
+  std::vector<glm::vec3> points{{0., 0., 0.}, {5., 5., 5.}, {0.5, 0., 0.}, {1.0, 0.1, 0.}, {5., 5., 5.7}};
+  polyscope::PointCloud* psPoints = polyscope::registerPointCloud("points", points);
+  polyscope::ConnectedComponents comps = psPoints->computeConnectedComponents(0.6);
+  EXPECT_EQ(comps.sizes, (std::vector<size_t>{3, 1, 1}));
+  EXPECT_EQ(comps.labels, (std::vector<size_t>{0, 1, 0, 0, 2}));
+  EXPECT_EQ(psPoints->computeConnectedComponents(1.).nComponents(), 2u);
+  EXPECT_THROW(psPoints->computeConnectedComponents(0.), std::runtime_error);
+  psPoints->addConnectedComponentsQuantity("components", 0.6)->setEnabled(true);
+
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+
 TEST_F(PolyscopeTest, PointCloudParam) {
   auto psPoints = registerPointCloud();
   std::vector<glm::vec2> param(psPoints->nPoints(), glm::vec2{.2, .3});
@@ -121,6 +121,87 @@ TEST_F(PolyscopeTest, SurfaceMeshPick) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, SurfaceMeshPickIndexAttributes) {
+
+  // The digits passed to shaders re-assemble to the same encoding as indToVec()
+  for (uint64_t ind : {uint64_t(0), uint64_t(77), uint64_t(1) << 22, (uint64_t(1) << 44) + 5, ~uint64_t(0)}) {
+    glm::uvec3 digits = polyscope::pick::indToDigits(ind);
+    EXPECT_EQ(glm::vec3(digits) / 4194304.f, polyscope::pick::indToVec(ind));
+    EXPECT_EQ(polyscope::pick::vecToInd(polyscope::pick::indToVec(ind)), ind);
+  }
+
+  // Simple mode, then the full mode with corners and halfedges
+  auto psMesh = registerTriangleMesh();
+  polyscope::pick::evaluatePickQuery(77, 88);
+  psMesh->markCornersAsUsed();
+  polyscope::pick::evaluatePickQuery(77, 88);
+  psMesh->markHalfedgesAsUsed();
+  polyscope::pick::evaluatePickQuery(77, 88);
+
+  // Other structures which share the same pick shaders
+  std::vector<glm::vec3> tetVerts{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  std::vector<std::array<size_t, 4>> tetInds{{0, 1, 2, 3}};
+  polyscope::registerTetMesh("vol", tetVerts, tetInds);
+  polyscope::pick::evaluatePickQuery(77, 88);
+  polyscope::registerCameraView(
+      "cam", polyscope::CameraParameters(polyscope::CameraIntrinsics::fromFoVDegVerticalAndAspect(60, 2.),
+                                         polyscope::CameraExtrinsics::fromVectors(
+                                             glm::vec3{2., 2., 2.}, glm::vec3{-1., -1., -1.}, glm::vec3{0., 1., 0.})));
+  polyscope::pick::evaluatePickQuery(77, 88);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshPickBufferReuse) {
+  auto psMesh = registerTriangleMesh();
+  polyscope::pick::evaluatePickQuery(77, 88);
+  std::shared_ptr<polyscope::render::AttributeBuffer> vertexInds = psMesh->pickVertexIndsBuffer;
+  ASSERT_NE(vertexInds, nullptr);
+  EXPECT_EQ(psMesh->pickHalfedgeIndsBuffer, nullptr); // only vertices and faces are picked so far
+  EXPECT_EQ(psMesh->pickCornerIndsBuffer, nullptr);
+
+  // Refreshes and geometry changes rebuild the pick program, but reuse the index data
+  psMesh->setEdgeWidth(1.0);
+  polyscope::pick::evaluatePickQuery(77, 88);
+  EXPECT_EQ(psMesh->pickVertexIndsBuffer, vertexInds);
+  std::vector<glm::vec3> newPos(psMesh->nVertices(), glm::vec3{0.5, 0.5, 0.5});
+  psMesh->updateVertexPositions(newPos);
+  polyscope::pick::evaluatePickQuery(77, 88);
+  EXPECT_EQ(psMesh->pickVertexIndsBuffer, vertexInds);
+  polyscope::refresh();
+  polyscope::pick::evaluatePickQuery(77, 88);
+  EXPECT_EQ(psMesh->pickVertexIndsBuffer, vertexInds);
+
+  // Newly-used element types get built on the next pick, on top of the existing data
+  psMesh->markCornersAsUsed();
+  polyscope::pick::evaluatePickQuery(77, 88);
+  EXPECT_EQ(psMesh->pickVertexIndsBuffer, vertexInds);
+  std::shared_ptr<polyscope::render::AttributeBuffer> halfedgeInds = psMesh->pickHalfedgeIndsBuffer;
+  std::shared_ptr<polyscope::render::AttributeBuffer> cornerInds = psMesh->pickCornerIndsBuffer;
+  ASSERT_NE(halfedgeInds, nullptr); // (holds no edges yet)
+  ASSERT_NE(cornerInds, nullptr);
+  psMesh->markHalfedgesAsUsed();
+  polyscope::pick::evaluatePickQuery(77, 88);
+  EXPECT_EQ(psMesh->pickVertexIndsBuffer, vertexInds);
+  EXPECT_NE(psMesh->pickHalfedgeIndsBuffer, halfedgeInds);
+  EXPECT_EQ(psMesh->pickCornerIndsBuffer, cornerInds);
+  halfedgeInds = psMesh->pickHalfedgeIndsBuffer;
+
+  // All of them are reused from here on
+  psMesh->setMaterial("wax");
+  polyscope::pick::evaluatePickQuery(77, 88);
+  psMesh->updateVertexPositions(newPos);
+  polyscope::refresh();
+  polyscope::pick::evaluatePickQuery(77, 88);
+  EXPECT_EQ(psMesh->pickVertexIndsBuffer, vertexInds);
+  EXPECT_EQ(psMesh->pickHalfedgeIndsBuffer, halfedgeInds);
+  EXPECT_EQ(psMesh->pickCornerIndsBuffer, cornerInds);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, SurfaceMeshBackface) {
   auto psMesh = registerTriangleMesh();
 
@@ -500,3 +581,84 @@ TEST_F(PolyscopeTest, SimpleTriangleMesUpdate) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, SurfaceMeshConcurrentBufferCompute) {
+  auto psMesh = registerTriangleMesh("serial");
+  auto psMesh2 = registerTriangleMesh("concurrent");
+
+  // Vertex normals depend on face normals and areas, so those must be gathered first
+  std::vector<polyscope::render::PendingBufferCompute> computes;
+  EXPECT_TRUE(psMesh2->vertexNormals.gatherPendingCompute(computes));
+  EXPECT_TRUE(psMesh2->vertexAreas.gatherPendingCompute(computes));
+  ASSERT_EQ(computes.size(), 4u);
+  EXPECT_EQ(computes[2].bufferID, psMesh2->vertexNormals.uniqueID);
+  EXPECT_EQ(computes[2].dependencyIDs.size(), 2u);
+  EXPECT_EQ(computes[3].dependencyIDs.size(), 1u);
+  polyscope::render::computeBuffersConcurrently(computes);
+
+  // Already-computed buffers don't get gathered again
+  std::vector<polyscope::render::PendingBufferCompute> recomputes;
+  EXPECT_FALSE(psMesh2->vertexNormals.gatherPendingCompute(recomputes));
+  EXPECT_TRUE(recomputes.empty());
+
+  // Same results as computing on demand
+  EXPECT_EQ(psMesh2->vertexNormals.data, psMesh->vertexNormals.getPopulatedHostBufferRef());
+  EXPECT_EQ(psMesh2->vertexAreas.data, psMesh->vertexAreas.getPopulatedHostBufferRef());
+
+  // Drawing gathers buffers for all of the structures at once
+  for (int i = 0; i < 8; i++) {
+    registerTriangleMesh("mesh" + std::to_string(i))->setSmoothShade(true);
+  }
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshStagedPositions) {
+  auto psMesh = registerTriangleMesh("staged");
+  auto psRef = registerTriangleMesh("reference");
+  psMesh->setSmoothShade(true);
+  polyscope::show(3);
+  std::vector<glm::vec3> oldNormals = psMesh->vertexNormals.getPopulatedHostBufferRef();
+
+  // rotate the mesh, by staging new positions for one and updating the other directly
+  std::vector<glm::vec3> newPositions = psMesh->vertexPositions.getPopulatedHostBufferRef();
+  for (glm::vec3& p : newPositions) {
+    p = glm::vec3{p.x, -p.z, p.y};
+  }
+  std::shared_ptr<polyscope::render::BufferStagingSlot<glm::vec3>> slot = psMesh->vertexPositions.getStagingSlot();
+  slot->publish(std::vector<glm::vec3>(newPositions));
+  psRef->updateVertexPositions(newPositions);
+  polyscope::frameTick();
+  EXPECT_EQ(slot->getConsumedCount(), 1u);
+
+  // the normals follow the staged positions
+  const std::vector<glm::vec3>& newNormals = psMesh->vertexNormals.getPopulatedHostBufferRef();
+  const std::vector<glm::vec3>& refNormals = psRef->vertexNormals.getPopulatedHostBufferRef();
+  ASSERT_EQ(newNormals.size(), oldNormals.size());
+  for (size_t i = 0; i < newNormals.size(); i++) {
+    EXPECT_NEAR(glm::length(newNormals[i] - refNormals[i]), 0., 1e-5);
+    EXPECT_NEAR(glm::length(newNormals[i] - glm::vec3{oldNormals[i].x, -oldNormals[i].z, oldNormals[i].y}), 0., 1e-5);
+  }
+  EXPECT_EQ(psMesh->faceNormals.getPopulatedHostBufferRef(), psRef->faceNormals.getPopulatedHostBufferRef());
+
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshConnectedComponents) {
+  // Two pieces and an unreferenced vertex
+  std::vector<glm::vec3> verts(8, glm::vec3{0., 0., 0.});
+  for (size_t i = 0; i < verts.size(); i++) verts[i] = glm::vec3{i % 2, i / 2, i % 3};
+  std::vector<std::array<size_t, 3>> faces{{0, 1, 2}, {1, 2, 3}, {4, 5, 6}};
+  polyscope::SurfaceMesh* psMesh = polyscope::registerSurfaceMesh("mesh", verts, faces);
+  polyscope::ConnectedComponents comps = psMesh->computeConnectedComponents();
+  EXPECT_EQ(comps.sizes, (std::vector<size_t>{4, 3, 1}));
+  EXPECT_EQ(comps.labels, (std::vector<size_t>{0, 0, 0, 0, 1, 1, 1, 2}));
+  EXPECT_EQ(comps.mask(2), (std::vector<bool>{true, true, true, true, true, true, true, false}));
+  EXPECT_EQ(comps.indicator(1, 1), (std::vector<double>{1., 1., 1., 1., 0., 0., 0., 0.}));
+  psMesh->addConnectedComponentsQuantity()->setEnabled(true);
+
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
@@ -125,6 +125,41 @@ TEST_F(PolyscopeTest, VolumeGridScalar) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, VolumeGridScalarChunkedCallable) {
+
+  // enough nodes for several chunks
+  polyscope::VolumeGrid* psGrid =
+      polyscope::registerVolumeGrid("test grid", {60, 60, 40}, glm::vec3{-1., -1., -1.}, glm::vec3{1., 1., 1.});
+  ASSERT_GT(psGrid->nNodes(), 2 * polyscope::VolumeGrid::CALLABLE_SAMPLE_CHUNK_SIZE);
+
+  size_t nCalls = 0;
+  size_t maxBatch = 0;
+  auto batchFunc = [&](const float* pos, float* result, size_t N) {
+    nCalls++;
+    maxBatch = std::max(maxBatch, N);
+    for (size_t i = 0; i < N; i++) {
+      result[i] = pos[3 * i + 0] + 2. * pos[3 * i + 1] + 3. * pos[3 * i + 2];
+    }
+  };
+  auto q1 = psGrid->addNodeScalarQuantityFromBatchCallable("serial", batchFunc);
+  EXPECT_GT(nCalls, 1u);
+  EXPECT_LE(maxBatch, polyscope::VolumeGrid::CALLABLE_SAMPLE_CHUNK_SIZE);
+
+  auto pointFunc = [](glm::vec3 p) { return p.x + 2. * p.y + 3. * p.z; };
+  auto q2 = psGrid->addNodeScalarQuantityFromCallable("parallel", pointFunc, polyscope::DataType::STANDARD, true);
+
+  for (size_t i = 0; i < psGrid->nNodes(); i += 997) {
+    glm::vec3 p = psGrid->positionOfNodeIndex(i);
+    EXPECT_NEAR(q1->values.getValue(i), pointFunc(p), 1e-5);
+    EXPECT_NEAR(q2->values.getValue(i), pointFunc(p), 1e-5);
+  }
+
+  q2->setEnabled(true);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, VolumeGridScalarIsosurfaceAndOpts) {
   
   // these are node dim
@@ -174,3 +209,163 @@ TEST_F(PolyscopeTest, VolumeGridScalarIsosurfaceAndOpts) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, VolumeGridScalarVolumeRender) {
+
+  // non-cubic, to catch any mixup of the axes
+  polyscope::VolumeGrid* psGrid =
+      polyscope::registerVolumeGrid("test grid", {33, 41, 49}, glm::vec3{-2., -2., -2.}, glm::vec3{2., 2., 2.});
+
+  auto sphereSDF = [](glm::vec3 p) { return glm::length(p) - 1.f; };
+  polyscope::VolumeGridNodeScalarQuantity* q = psGrid->addNodeScalarQuantityFromCallable("sdf", sphereSDF);
+  q->setEnabled(true);
+
+  // the blocks bound the values
+  q->blockMinValues.ensureHostBufferPopulated();
+  EXPECT_NEAR(*std::min_element(q->blockMinValues.data.begin(), q->blockMinValues.data.end()),
+              *std::min_element(q->values.data.begin(), q->values.data.end()), 1e-6);
+  EXPECT_NEAR(*std::max_element(q->blockMaxValues.data.begin(), q->blockMaxValues.data.end()),
+              *std::max_element(q->values.data.begin(), q->values.data.end()), 1e-6);
+
+  // opaque only inside the sphere, so most of the grid is empty space
+  q->setVolumeOpacityRamp(0., -0.5);
+  q->setVolumeDensity(0.5);
+
+  // empty space skipping must not change the result
+  for (int i = 0; i < 40; i++) {
+    float a = 0.37f * i;
+    glm::vec3 start{5.f * std::cos(a), 3.f * std::sin(1.3f * a), 4.f * std::sin(a)};
+    glm::vec3 target{0.5f * std::sin(2.1f * a), 0.4f * std::cos(a), 0.3f * std::sin(0.7f * a)};
+    glm::vec4 skipped = q->marchVolumeRay(start, target - start, true);
+    glm::vec4 full = q->marchVolumeRay(start, target - start, false);
+    for (int j = 0; j < 4; j++) {
+      EXPECT_NEAR(skipped[j], full[j], 1e-6);
+    }
+    EXPECT_GT(skipped.a, 0.);
+  }
+
+  // rays which miss the sphere, or the whole grid
+  EXPECT_EQ(q->marchVolumeRay(glm::vec3{-5., 1.5, 0.}, glm::vec3{1., 0., 0.}).a, 0.);
+  EXPECT_EQ(q->marchVolumeRay(glm::vec3{-5., 3., 0.}, glm::vec3{1., 0., 0.}).a, 0.);
+
+  // a dense volume terminates early
+  q->setVolumeDensity(100.);
+  EXPECT_GT(q->marchVolumeRay(glm::vec3{-5., 0.1, 0.2}, glm::vec3{1., 0., 0.}).a, 0.99);
+
+  // isosurface, with a transparent volume
+  q->setVolumeOpacityRamp(100., 101.);
+  q->setVolumeIsosurfaceEnabled(true);
+  q->setIsosurfaceLevel(0.);
+  glm::vec4 isoHit = q->marchVolumeRay(glm::vec3{0.1, -5., 0.2}, glm::vec3{0., 1., 0.});
+  EXPECT_NEAR(isoHit.a, 1., 1e-6);
+  EXPECT_NEAR(glm::length(glm::vec3(isoHit) - q->getIsosurfaceColor()), 0., 1e-5);
+  EXPECT_EQ(q->marchVolumeRay(glm::vec3{0., -5., 1.2}, glm::vec3{0., 1., 0.}).a, 0.);
+  EXPECT_EQ(q->marchVolumeRay(glm::vec3{0., -5., 1.2}, glm::vec3{0., 1., 0.}, false).a, 0.);
+
+  // updated values are picked up
+  q->setVolumeIsosurfaceEnabled(false);
+  q->setVolumeOpacityRamp(0., -0.5);
+  q->setVolumeDensity(0.5);
+  EXPECT_GT(q->marchVolumeRay(glm::vec3{-5., 0.7, 0.}, glm::vec3{1., 0., 0.}).a, 0.);
+  std::vector<double> smallerSphere(psGrid->nNodes());
+  for (size_t i = 0; i < psGrid->nNodes(); i++) {
+    smallerSphere[i] = glm::length(psGrid->positionOfNodeIndex(i)) - 0.5;
+  }
+  q->updateData(smallerSphere);
+  EXPECT_EQ(q->marchVolumeRay(glm::vec3{-5., 0.7, 0.}, glm::vec3{1., 0., 0.}).a, 0.);
+
+  // render it
+  q->setGridcubeVizEnabled(false);
+  q->setVolumeVizEnabled(true);
+  polyscope::show(3);
+
+  q->setVolumeIsosurfaceEnabled(true);
+  q->setIsosurfaceLevel(-0.2);
+  q->setVolumeStepSize(0.25);
+  polyscope::show(3);
+
+  q->updateData(smallerSphere);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SparseVolumeGrid) {
+
+  // A narrow band of bricks around a sphere
+  glm::vec3 origin{0., 0., 0.};
+  glm::vec3 spacing{0.05, 0.05, 0.05};
+  float radius = 1.;
+  float brickWidth = spacing.x * polyscope::SparseVolumeGrid::BRICK_SIZE;
+  std::vector<glm::ivec3> bricks;
+  for (int i = -4; i < 4; i++) {
+    for (int j = -4; j < 4; j++) {
+      for (int k = -4; k < 4; k++) {
+        glm::vec3 lo = glm::vec3(i, j, k) * brickWidth;
+        glm::vec3 hi = lo + brickWidth;
+        glm::vec3 nearest = glm::clamp(glm::vec3(0.), lo, hi);
+        glm::vec3 farthest = glm::max(glm::abs(lo), glm::abs(hi));
+        if (glm::length(nearest) <= radius && radius <= glm::length(farthest)) bricks.push_back({i, j, k});
+      }
+    }
+  }
+  auto sphereSDF = [&](glm::vec3 p) { return glm::length(p) - radius; };
+
+  polyscope::SparseVolumeGrid* psGrid = polyscope::registerSparseVolumeGrid("test sparse grid", origin, spacing, bricks);
+  EXPECT_TRUE(polyscope::hasSparseVolumeGrid("test sparse grid"));
+  polyscope::show(3);
+
+  // Element counts and lookups
+  EXPECT_EQ(psGrid->nBricks(), bricks.size());
+  EXPECT_EQ(psGrid->nCells(), bricks.size() * 512);
+  EXPECT_LT(psGrid->nNodes(), bricks.size() * 729); // nodes between neighboring bricks are shared
+  for (size_t i = 0; i < psGrid->nNodes(); i++) {
+    EXPECT_EQ(psGrid->nodeIndexOf(psGrid->nodeCoordOfIndex(i)), i);
+  }
+  for (size_t i = 0; i < psGrid->nCells(); i += 7) {
+    EXPECT_EQ(psGrid->cellIndexOf(psGrid->cellCoordOfIndex(i)), i);
+  }
+  EXPECT_EQ(psGrid->cellIndexOf(glm::ivec3{0, 0, 0}), polyscope::INVALID_IND_64); // inside the band
+  EXPECT_EQ(psGrid->nodeIndexOf(glm::ivec3{1000, 0, 0}), polyscope::INVALID_IND_64);
+
+  // Options
+  psGrid->setEdgeWidth(0.5);
+  polyscope::show(3);
+
+  { // node scalar from callable
+    polyscope::SparseVolumeGridNodeScalarQuantity* q =
+        psGrid->addNodeScalarQuantityFromCallable("node scalar", sphereSDF, polyscope::DataType::SYMMETRIC, true);
+    q->setEnabled(true);
+    polyscope::show(3);
+
+    q->setIsosurfaceVizEnabled(true);
+    polyscope::show(3);
+
+    polyscope::SurfaceMesh* isoMesh = q->registerIsosurfaceAsMesh("sparse isosurface");
+    EXPECT_GT(isoMesh->nVertices(), 0u);
+    for (size_t i = 0; i < isoMesh->nVertices(); i += 11) {
+      EXPECT_NEAR(glm::length(isoMesh->vertexPositions.getValue(i)), radius, 0.01);
+    }
+
+    // updated values get re-uploaded to the atlas
+    std::vector<double> vals(psGrid->nNodes(), 1.);
+    q->updateData(vals);
+    polyscope::show(3);
+  }
+
+  { // cell scalar from array
+    std::vector<double> cellScalar(psGrid->nCells());
+    for (size_t i = 0; i < psGrid->nCells(); i++) {
+      cellScalar[i] = sphereSDF(psGrid->positionOfCellIndex(i));
+    }
+    psGrid->addCellScalarQuantity("cell scalar", cellScalar)->setEnabled(true);
+    polyscope::show(3);
+  }
+
+  polyscope::SlicePlane* p = polyscope::addSceneSlicePlane();
+  polyscope::show(3);
+  polyscope::removeLastSceneSlicePlane();
+
+  polyscope::removeAllStructures();
+  EXPECT_FALSE(polyscope::hasSparseVolumeGrid("test sparse grid"));
+}
@@ -228,3 +228,129 @@ TEST_F(PolyscopeTest, VolumeMeshInspect) {
 
   polyscope::removeLastSceneSlicePlane();
 }
+
+TEST_F(PolyscopeTest, VolumeMeshLevelSet) {
+  std::vector<glm::vec3> verts;
+  std::vector<std::array<int, 8>> cells;
+  std::tie(verts, cells) = getVolumeMeshData();
+  polyscope::VolumeMesh* psVol = polyscope::registerVolumeMesh("vol", verts, cells);
+
+  std::vector<float> valsX, valsY;
+  for (const glm::vec3& v : verts) {
+    valsX.push_back(v.x);
+    valsY.push_back(v.y);
+  }
+  auto qX = psVol->addVertexScalarQuantity("valsX", valsX);
+  auto qY = psVol->addVertexScalarQuantity("valsY", valsY);
+
+  // the tet corner buffers index in to the vertices
+  std::vector<uint32_t>& corners = psVol->tetCornerVertexInds[2].getPopulatedHostBufferRef();
+  ASSERT_EQ(corners.size(), psVol->nTets());
+  for (size_t iT = 0; iT < psVol->nTets(); iT++) {
+    EXPECT_EQ(corners[iT], psVol->tets[iT][2]);
+  }
+
+  qX->setEnabledLevelSet(true);
+  qX->setLevelSetValue(0.5);
+  polyscope::show(3);
+
+  // changing the value doesn't rebuild anything
+  std::shared_ptr<polyscope::render::ShaderProgram> levelSetProgram = qX->levelSetProgram;
+  qX->setLevelSetValue(0.25);
+  polyscope::show(3);
+  EXPECT_EQ(qX->levelSetProgram, levelSetProgram);
+
+  // color the level set by another quantity
+  qX->setLevelSetVisibleQuantity("valsY");
+  polyscope::show(3);
+
+  // slicing with both quantities shown
+  polyscope::SlicePlane* p = polyscope::addSceneSlicePlane();
+  p->setVolumeMeshToInspect("vol");
+  qY->setEnabled(true);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+  polyscope::removeLastSceneSlicePlane();
+}
+
+TEST_F(PolyscopeTest, VolumeMeshInspectSpatialIndex) {
+  // a grid of hexes, large enough that a plane only cuts a small fraction of the tets
+  const size_t n = 12;
+  auto vertInd = [&](size_t i, size_t j, size_t k) { return (i * (n + 1) + j) * (n + 1) + k; };
+  std::vector<glm::vec3> verts;
+  for (size_t i = 0; i <= n; i++) {
+    for (size_t j = 0; j <= n; j++) {
+      for (size_t k = 0; k <= n; k++) {
+        verts.push_back(glm::vec3{i, j, k} / static_cast<float>(n));
+      }
+    }
+  }
+  std::vector<std::array<size_t, 8>> cells;
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      for (size_t k = 0; k < n; k++) {
+        cells.push_back({vertInd(i, j, k), vertInd(i + 1, j, k), vertInd(i + 1, j + 1, k), vertInd(i, j + 1, k),
+                         vertInd(i, j, k + 1), vertInd(i + 1, j, k + 1), vertInd(i + 1, j + 1, k + 1),
+                         vertInd(i, j + 1, k + 1)});
+      }
+    }
+  }
+  polyscope::VolumeMesh* psVol = polyscope::registerHexMesh("vol", verts, cells);
+
+  // the gathered tets include every tet which the plane cuts, and not many others
+  glm::vec3 normal = glm::normalize(glm::vec3{1., 0.3, 0.2});
+  float planePoint = glm::dot(normal, glm::vec3{0.51, 0.5, 0.5});
+  std::vector<uint32_t> tetInds;
+  psVol->gatherTetsInSlab(normal, planePoint, planePoint, tetInds);
+  std::vector<char> gathered(psVol->nTets(), false);
+  for (uint32_t iT : tetInds) gathered[iT] = true;
+  size_t nCut = 0;
+  for (size_t iT = 0; iT < psVol->nTets(); iT++) {
+    bool above = false, below = false;
+    for (int k = 0; k < 4; k++) {
+      float d = glm::dot(normal, verts[psVol->tets[iT][k]]) - planePoint;
+      above = above || d > 0;
+      below = below || d < 0;
+    }
+    if (above && below) {
+      nCut++;
+      EXPECT_TRUE(gathered[iT]);
+    }
+  }
+  EXPECT_GT(nCut, 0u);
+  EXPECT_LT(tetInds.size(), psVol->nTets() / 4);
+
+  // inspecting draws only the tets near the plane
+  polyscope::SlicePlane* p = polyscope::addSceneSlicePlane();
+  p->setPose(glm::vec3{0.51, 0.5, 0.5}, normal);
+  p->setVolumeMeshToInspect("vol");
+  polyscope::show(3);
+  size_t nCandidates = p->getSliceCandidateTetCount();
+  EXPECT_GE(nCandidates, nCut);
+  EXPECT_LT(nCandidates, psVol->nTets() / 4);
+
+  // with quantities, while moving the plane
+  std::vector<float> vals;
+  for (const glm::vec3& v : verts) vals.push_back(v.x);
+  psVol->addVertexScalarQuantity("vals", vals)->setEnabled(true);
+  polyscope::show(3);
+  psVol->addVertexColorQuantity("colors", verts)->setEnabled(true);
+  p->setPose(glm::vec3{0.25, 0.5, 0.5}, normal);
+  polyscope::show(3);
+  EXPECT_GT(p->getSliceCandidateTetCount(), 0u);
+
+  // a plane which misses the mesh draws nothing
+  p->setPose(glm::vec3{5., 0.5, 0.5}, normal);
+  polyscope::show(3);
+  EXPECT_EQ(p->getSliceCandidateTetCount(), 0u);
+
+  // moving the mesh updates the candidates
+  for (glm::vec3& v : verts) v.x += 4.5;
+  psVol->updateVertexPositions(verts);
+  polyscope::show(3);
+  EXPECT_GT(p->getSliceCandidateTetCount(), 0u);
+
+  polyscope::removeAllStructures();
+  polyscope::removeLastSceneSlicePlane();
+}